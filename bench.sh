@@ -0,0 +1,71 @@
+if [[ $1 != "--no-compile" ]] ; then
+    ./compile.sh
+    if [ $? -ne 0 ] ; then
+        exit 1
+    fi
+fi
+
+# Measures how the compiler's throughput scales by compiling synthetic programs, scaling one axis
+# of bin/purple_generate at a time while the others keep their defaults. Extra flags for the
+# compiler, such as -O1, may be passed in BENCH_FLAGS. Results are printed as CSV
+BENCH_DIR=$(mktemp -d)
+trap "rm -rf $BENCH_DIR" EXIT
+
+AXES=(
+    "functions          -f 25 100 400"
+    "statements         -s 5 20 80"
+    "depth              -d 1 2 3 4"
+    "width              -w 2 3 4 6"
+    "globals            -g 10 100 1000"
+    "identifier_length  -i 8 64 200"
+    "literal_density    -l 0 50 100"
+)
+PHASES="target_probes scanning parsing optimization codegen link_globals clang build_cache other"
+
+# Print a number that follows a key in a JSON report
+# $1 - Report
+# $2 - Pattern matching the key and anything between it and the number
+function json_number() {
+    echo "$1" | grep -o "$2: [0-9.]*" | head -n 1 | sed 's/.*: //'
+}
+
+printf "axis,value,lines,tokens,total_ms,purple_ms,lines_per_sec,tokens_per_sec,peak_rss_kb"
+printf ",clang_peak_rss_kb,peak_tracked_bytes"
+for phase in $PHASES ; do
+    printf ",${phase}_ms"
+done
+printf "\n"
+
+for axis in "${AXES[@]}" ; do
+    read name option values <<< "$axis"
+    for value in $values ; do
+        stats=$(bin/purple_generate $option $value --stats 2>&1 > $BENCH_DIR/bench.prp)
+        read lines tokens <<< "$stats"
+
+        bin/purple $BENCH_DIR/bench.prp -o $BENCH_DIR/bench.out --ftime-report=json \
+            --fmem-report=json $BENCH_FLAGS > /dev/null 2> $BENCH_DIR/report.txt
+        if [ $? -ne 0 ] ; then
+            echo "Failed to compile with $option $value:" >&2
+            cat $BENCH_DIR/report.txt >&2
+            exit 1
+        fi
+        time_report=$(grep '"phases"' $BENCH_DIR/report.txt)
+        mem_report=$(grep '"subsystems"' $BENCH_DIR/report.txt)
+
+        total_ms=$(json_number "$time_report" '"total": {"wall_ms"')
+        clang_ms=$(json_number "$time_report" '"clang": {"wall_ms"')
+        probes_ms=$(json_number "$time_report" '"target_probes": {"wall_ms"')
+        # clang's time is reported but not counted against the compiler's own throughput
+        purple_ms=$(awk "BEGIN {print $total_ms - $clang_ms - $probes_ms}")
+
+        printf "%s,%s,%s,%s,%s,%s" $name $value $lines $tokens $total_ms $purple_ms
+        awk "BEGIN {printf \",%.0f,%.0f\", $lines * 1000 / $purple_ms, $tokens * 1000 / $purple_ms}"
+        printf ",%s" $(json_number "$mem_report" '"peak_rss_kb"')
+        printf ",%s" $(json_number "$mem_report" '"clang_peak_rss_kb"')
+        printf ",%s" $(json_number "$mem_report" '"total": {"live_bytes": [0-9]*, "peak_bytes"')
+        for phase in $PHASES ; do
+            printf ",%s" $(json_number "$time_report" "\"$phase\": {\"wall_ms\"")
+        done
+        printf "\n"
+    done
+done
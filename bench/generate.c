@@ -0,0 +1,579 @@
+/**
+ * @file generate.c
+ * @author Charles Averill
+ * @brief Generator of synthetic Purple programs, which are scaled along independent axes to
+ * benchmark how the compiler's throughput scales. The same options always generate the same program
+ * @date 19-Oct-2026
+ */
+
+#include <argp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "generate.h"
+
+static char doc[] = "Generates a synthetic Purple program scaled along independent axes, for "
+                    "benchmarking the Purple compiler";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+    {"functions", 'f', "NUM", 0, "Number of functions (default is 100)", 0},
+    {"statements", 's', "NUM", 0, "Number of statements in each function (default is 20)", 0},
+    {"depth", 'd', "NUM", 0, "Depth of each expression's tree of operators (default is 2)", 0},
+    {"width", 'w', "NUM", 0, "Number of operands each operator joins (default is 3)", 0},
+    {"globals", 'g', "NUM", 0, "Number of global variables (default is 10)", 0},
+    {"identifier-length", 'i', "NUM", 0,
+     "Length that identifiers are padded to (default is 8)", 0},
+    {"literal-density", 'l', "PERCENT", 0,
+     "Percent of operands that are literals (default is 50)", 0},
+    {"seed", GENERATE_ARGP_SEED, "NUM", 0, "Seed of the program's random choices (default is 1)",
+     0},
+    {"stats", GENERATE_ARGP_STATS, 0, 0,
+     "Print the number of lines and tokens generated to stderr", 0},
+    {0},
+};
+
+/**
+ * @brief Parse a number given to an option
+ *
+ * @param arg   Number given
+ * @param min   Smallest number allowed
+ * @param max   Largest number allowed
+ * @param state State of the argument parser
+ * @return int  Number given
+ */
+static int parse_number(const char* arg, int min, int max, struct argp_state* state)
+{
+    char* end;
+    long value = strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || value < min || value > max) {
+        argp_error(state, "Expected a number from %d to %d, but got \"%s\"", min, max, arg);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Parse a single option
+ *
+ * @param key   Key of the option
+ * @param arg   Argument given to the option
+ * @param state State of the argument parser
+ * @return error_t 0 if the option was parsed, or ARGP_ERR_UNKNOWN
+ */
+static error_t parse_opt(int key, char* arg, struct argp_state* state)
+{
+    GenerateOptions* generate_options = state->input;
+
+    switch (key) {
+    case 'f':
+        generate_options->functions = parse_number(arg, 0, 1000000, state);
+        break;
+    case 's':
+        generate_options->statements = parse_number(arg, 0, 1000000, state);
+        break;
+    case 'd':
+        generate_options->depth = parse_number(arg, 0, 64, state);
+        break;
+    case 'w':
+        generate_options->width = parse_number(arg, 1, 1000, state);
+        break;
+    case 'g':
+        generate_options->globals = parse_number(arg, 0, 1000000, state);
+        break;
+    case 'i':
+        generate_options->identifier_length =
+            parse_number(arg, 1, GENERATE_MAX_IDENTIFIER_LENGTH, state);
+        break;
+    case 'l':
+        generate_options->literal_density = parse_number(arg, 0, 100, state);
+        break;
+    case GENERATE_ARGP_SEED:
+        generate_options->seed = parse_number(arg, 0, 0x7FFFFFFF, state);
+        break;
+    case GENERATE_ARGP_STATS:
+        generate_options->print_stats = true;
+        break;
+    case ARGP_KEY_ARG:
+        argp_usage(state);
+        break;
+    default:
+        return ARGP_ERR_UNKNOWN;
+    }
+
+    return 0;
+}
+
+static struct argp argp = {options, parse_opt, args_doc, doc, 0, 0, 0};
+
+/**
+ * @brief Get the next random number, with splitmix64 so that programs are the same on every
+ * platform
+ *
+ * @param gen       Generator to get a random number from
+ * @param limit     Random numbers are less than this
+ * @return int      Random number from 0 to limit - 1
+ */
+static int random_below(Generator* gen, int limit)
+{
+    uint64_t z = (gen->random_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+
+    return z % limit;
+}
+
+/**
+ * @brief Write a token, separated from the token before it by a space unless it is glued to it
+ *
+ * @param gen       Generator to write with
+ * @param token     Token to write
+ * @param is_glued  True if the token is written directly after the token before it
+ */
+static void emit_token(Generator* gen, const char* token, bool is_glued)
+{
+    if (gen->at_line_start) {
+        fprintf(gen->out, "%*s", gen->indent * 4, "");
+    } else if (!is_glued && !gen->after_left_paren) {
+        fputc(' ', gen->out);
+    }
+
+    fputs(token, gen->out);
+    gen->at_line_start = false;
+    gen->after_left_paren = !strcmp(token, "(");
+    gen->tokens++;
+}
+
+/**
+ * @brief Write a token, separated from the token before it by a space unless it closes something
+ *
+ * @param gen   Generator to write with
+ * @param token Token to write
+ */
+static void emit(Generator* gen, const char* token)
+{
+    emit_token(gen, token,
+               !strcmp(token, ";") || !strcmp(token, ",") || !strcmp(token, ")"));
+}
+
+/**
+ * @brief Finish the current line
+ *
+ * @param gen Generator to write with
+ */
+static void end_line(Generator* gen)
+{
+    fputc('\n', gen->out);
+    gen->lines++;
+    gen->at_line_start = true;
+    gen->after_left_paren = false;
+}
+
+/**
+ * @brief Write an identifier, padded to the identifier length
+ *
+ * @param gen   Generator to write with
+ * @param kind  Prefix naming the kind of symbol identified
+ * @param index Index of the symbol among symbols of its kind
+ */
+static void emit_identifier(Generator* gen, const char* kind, int index)
+{
+    char name[GENERATE_MAX_IDENTIFIER_LENGTH + 32];
+    int length = sprintf(name, "%s_%d", kind, index);
+    while (length < gen->options.identifier_length) {
+        name[length++] = 'x';
+    }
+    name[length] = '\0';
+
+    emit(gen, name);
+}
+
+/**
+ * @brief Write the identifier of a variable declared by the function being generated. Variables
+ * declared in functions are global in Purple, so each function's are named apart
+ *
+ * @param gen   Generator to write with
+ * @param local Index of the variable among the function's variables
+ */
+static void emit_local(Generator* gen, int local)
+{
+    char kind[32];
+    sprintf(kind, "v_%d", gen->function);
+
+    emit_identifier(gen, kind, local);
+}
+
+/**
+ * @brief Write a literal
+ *
+ * @param gen   Generator to write with
+ * @param value Value of the literal
+ */
+static void emit_literal(Generator* gen, int value)
+{
+    char literal[16];
+    sprintf(literal, "%d", value);
+
+    emit(gen, literal);
+}
+
+/**
+ * @brief Write an operand of an expression: a literal, a parameter, a variable of the function
+ * being generated or a global variable
+ *
+ * @param gen Generator to write with
+ */
+static void emit_operand(Generator* gen)
+{
+    int num_variables = gen->num_parameters + gen->num_locals;
+
+    if (num_variables == 0 || random_below(gen, 100) < gen->options.literal_density) {
+        emit_literal(gen, random_below(gen, GENERATE_LITERAL_LIMIT));
+    } else if (gen->options.globals > 0 && random_below(gen, 4) == 0) {
+        emit_identifier(gen, "g", random_below(gen, gen->options.globals));
+    } else {
+        int variable = random_below(gen, num_variables);
+        if (variable < gen->num_parameters) {
+            emit_identifier(gen, "p", variable);
+        } else {
+            emit_local(gen, variable - gen->num_parameters);
+        }
+    }
+}
+
+/**
+ * @brief Write an expression, with a tree of operators of the given depth
+ *
+ * @param gen   Generator to write with
+ * @param depth Depth of the tree of operators
+ */
+static void emit_expression(Generator* gen, int depth)
+{
+    static const char* operators[] = {"+", "-", "*"};
+
+    if (depth == 0) {
+        emit_operand(gen);
+        return;
+    }
+
+    for (int i = 0; i < gen->options.width; i++) {
+        if (i > 0) {
+            emit(gen, operators[random_below(gen, 3)]);
+        }
+
+        if (depth > 1) {
+            emit_identifier(gen, "e", 0);
+            emit_token(gen, "(", true);
+            emit_expression(gen, depth - 1);
+            emit(gen, ")");
+        } else {
+            emit_operand(gen);
+        }
+    }
+}
+
+/**
+ * @brief Write an assignment of an expression to a variable, on a line of its own
+ *
+ * @param gen   Generator to write with
+ * @param local Index of the local variable to assign to
+ */
+static void emit_assignment(Generator* gen, int local)
+{
+    emit_local(gen, local);
+    emit(gen, "=");
+    emit_expression(gen, gen->options.depth);
+    emit(gen, ";");
+    end_line(gen);
+}
+
+/**
+ * @brief Write the declaration of a new local variable, and its initial assignment
+ *
+ * @param gen   Generator to write with
+ * @return int  Index of the new local variable
+ */
+static int emit_declaration(Generator* gen)
+{
+    emit(gen, "int");
+    emit_local(gen, gen->num_locals);
+    emit(gen, ";");
+    end_line(gen);
+
+    // The variable may not be read before it is first assigned
+    emit_assignment(gen, gen->num_locals);
+    return gen->num_locals++;
+}
+
+/**
+ * @brief Write an opening brace and indent the lines after it
+ *
+ * @param gen Generator to write with
+ */
+static void open_block(Generator* gen)
+{
+    emit(gen, "{");
+    end_line(gen);
+    gen->indent++;
+}
+
+/**
+ * @brief Unindent and write a closing brace
+ *
+ * @param gen Generator to write with
+ */
+static void close_block(Generator* gen)
+{
+    gen->indent--;
+    emit(gen, "}");
+}
+
+/**
+ * @brief Write a statement of a function's body, chosen at random
+ *
+ * @param gen Generator to write with
+ */
+static void emit_statement(Generator* gen)
+{
+    int choice = random_below(gen, 100);
+
+    if (gen->num_locals == 0 || choice < 30) {
+        emit_declaration(gen);
+    } else if (choice < 55) {
+        emit_assignment(gen, random_below(gen, gen->num_locals));
+    } else if (choice < 70) {
+        emit(gen, "if");
+        emit(gen, "(");
+        emit_expression(gen, gen->options.depth);
+        emit(gen, "<");
+        emit_expression(gen, gen->options.depth);
+        emit(gen, ")");
+        open_block(gen);
+        emit_assignment(gen, random_below(gen, gen->num_locals));
+        close_block(gen);
+        emit(gen, "else");
+        open_block(gen);
+        emit(gen, "print");
+        emit_expression(gen, gen->options.depth);
+        emit(gen, ";");
+        end_line(gen);
+        close_block(gen);
+        end_line(gen);
+    } else if (choice < 80) {
+        // Loops are bounded so that generated programs may also be run
+        int counter = gen->num_locals++;
+        emit(gen, "int");
+        emit_local(gen, counter);
+        emit(gen, ";");
+        end_line(gen);
+        emit_local(gen, counter);
+        emit(gen, "=");
+        emit_literal(gen, 0);
+        emit(gen, ";");
+        end_line(gen);
+        emit(gen, "while");
+        emit(gen, "(");
+        emit_local(gen, counter);
+        emit(gen, "<");
+        emit_literal(gen, GENERATE_LOOP_ITERATIONS);
+        emit(gen, ")");
+        open_block(gen);
+        emit_local(gen, counter);
+        emit(gen, "=");
+        emit_local(gen, counter);
+        emit(gen, "+");
+        emit_literal(gen, 1);
+        emit(gen, ";");
+        end_line(gen);
+        close_block(gen);
+        end_line(gen);
+    } else if (choice < 90 && gen->function % 2 == 1) {
+        // Odd functions only call the even functions before them, which make no calls, so that
+        // calls never recurse and running a program takes time linear in its size
+        emit_local(gen, random_below(gen, gen->num_locals));
+        emit(gen, "=");
+        emit_identifier(gen, "f", 2 * random_below(gen, (gen->function + 1) / 2));
+        emit_token(gen, "(", true);
+        for (int i = 0; i < GENERATE_NUM_PARAMETERS; i++) {
+            if (i > 0) {
+                emit(gen, ",");
+            }
+            emit_expression(gen, gen->options.depth);
+        }
+        emit(gen, ")");
+        emit(gen, ";");
+        end_line(gen);
+    } else {
+        emit(gen, "print");
+        emit_expression(gen, gen->options.depth);
+        emit(gen, ";");
+        end_line(gen);
+    }
+}
+
+/**
+ * @brief Write the header of a function
+ *
+ * @param gen               Generator to write with
+ * @param kind              Prefix naming the kind of function
+ * @param index             Index of the function among functions of its kind
+ * @param num_parameters    Number of parameters the function takes
+ */
+static void emit_function_header(Generator* gen, const char* kind, int index, int num_parameters)
+{
+    emit(gen, "int");
+    emit_identifier(gen, kind, index);
+    emit_token(gen, "(", true);
+    if (num_parameters == 0) {
+        emit(gen, "void");
+    }
+    for (int i = 0; i < num_parameters; i++) {
+        if (i > 0) {
+            emit(gen, ",");
+        }
+        emit(gen, "int");
+        emit_identifier(gen, "p", i);
+    }
+    emit(gen, ")");
+    open_block(gen);
+
+    gen->num_parameters = num_parameters;
+    gen->num_locals = 0;
+}
+
+/**
+ * @brief Write a return statement and the end of a function
+ *
+ * @param gen Generator to write with
+ */
+static void emit_function_footer(Generator* gen)
+{
+    emit(gen, "return");
+    emit_expression(gen, gen->options.depth);
+    emit(gen, ";");
+    end_line(gen);
+    close_block(gen);
+    end_line(gen);
+    end_line(gen);
+}
+
+/**
+ * @brief Write a whole program
+ *
+ * @param gen Generator to write with
+ */
+static void generate_program(Generator* gen)
+{
+    GenerateOptions* options = &gen->options;
+
+    fprintf(gen->out,
+            "/**\n * @brief Generated with --functions=%d --statements=%d --depth=%d --width=%d "
+            "--globals=%d --identifier-length=%d --literal-density=%d --seed=%llu\n */\n\n",
+            options->functions, options->statements, options->depth, options->width,
+            options->globals, options->identifier_length, options->literal_density,
+            (unsigned long long int)options->seed);
+    gen->lines += 4;
+
+    // Nested expressions are passed through this, since Purple has no parentheses
+    emit_function_header(gen, "e", 0, 1);
+    emit(gen, "return");
+    emit_identifier(gen, "p", 0);
+    emit(gen, ";");
+    end_line(gen);
+    close_block(gen);
+    end_line(gen);
+    end_line(gen);
+
+    // Purple has no declarations outside of functions, so the globals are declared in one
+    emit_function_header(gen, "d", 0, 0);
+    for (int i = 0; i < options->globals; i++) {
+        emit(gen, "int");
+        emit_identifier(gen, "g", i);
+        emit(gen, ";");
+        end_line(gen);
+        emit_identifier(gen, "g", i);
+        emit(gen, "=");
+        emit_literal(gen, random_below(gen, GENERATE_LITERAL_LIMIT));
+        emit(gen, ";");
+        end_line(gen);
+    }
+    emit(gen, "return");
+    emit_literal(gen, 0);
+    emit(gen, ";");
+    end_line(gen);
+    close_block(gen);
+    end_line(gen);
+    end_line(gen);
+
+    for (gen->function = 0; gen->function < options->functions; gen->function++) {
+        emit_function_header(gen, "f", gen->function, GENERATE_NUM_PARAMETERS);
+        for (int i = 0; i < options->statements; i++) {
+            emit_statement(gen);
+        }
+        emit_function_footer(gen);
+    }
+
+    // main assigns the globals, then calls every function so that none of them are unreachable
+    emit(gen, "int");
+    emit(gen, "main");
+    emit_token(gen, "(", true);
+    emit(gen, "void");
+    emit(gen, ")");
+    open_block(gen);
+    emit_identifier(gen, "d", 0);
+    emit_token(gen, "(", true);
+    emit(gen, ")");
+    emit(gen, ";");
+    end_line(gen);
+    for (int i = 0; i < options->functions; i++) {
+        emit(gen, "print");
+        emit_identifier(gen, "f", i);
+        emit_token(gen, "(", true);
+        emit_literal(gen, random_below(gen, GENERATE_LITERAL_LIMIT));
+        emit(gen, ",");
+        emit_literal(gen, random_below(gen, GENERATE_LITERAL_LIMIT));
+        emit(gen, ")");
+        emit(gen, ";");
+        end_line(gen);
+    }
+    close_block(gen);
+    end_line(gen);
+}
+
+/**
+ * @brief Generator entrypoint. The program is written to stdout
+ *
+ * @param argc Number of command line arguments
+ * @param argv Array of command line arguments
+ * @return int 0
+ */
+int main(int argc, char* argv[])
+{
+    Generator gen = {.out = stdout,
+                     .options = {.functions = 100,
+                                 .statements = 20,
+                                 .depth = 2,
+                                 .width = 3,
+                                 .globals = 10,
+                                 .identifier_length = 8,
+                                 .literal_density = 50,
+                                 .seed = 1,
+                                 .print_stats = false},
+                     .lines = 0,
+                     .tokens = 0,
+                     .indent = 0,
+                     .at_line_start = true,
+                     .after_left_paren = false};
+
+    argp_parse(&argp, argc, argv, 0, 0, &gen.options);
+    gen.random_state = gen.options.seed;
+
+    generate_program(&gen);
+
+    if (gen.options.print_stats) {
+        fprintf(stderr, "%llu %llu\n", gen.lines, gen.tokens);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file generate.h
+ * @author Charles Averill
+ * @brief Definitions for the generator of synthetic Purple programs, which are scaled along
+ * independent axes to benchmark how the compiler's throughput scales
+ * @date 19-Oct-2026
+ */
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Longest identifier the generator pads names to, within the compiler's limit
+ */
+#define GENERATE_MAX_IDENTIFIER_LENGTH 200
+/**
+ * @brief Number of parameters every generated function takes
+ */
+#define GENERATE_NUM_PARAMETERS 2
+/**
+ * @brief Number of times every generated loop runs
+ */
+#define GENERATE_LOOP_ITERATIONS 3
+/**
+ * @brief Literals are generated from 0 up to, but not including, this
+ */
+#define GENERATE_LITERAL_LIMIT 100
+
+/**
+ * @brief Keys of options without short names
+ */
+#define GENERATE_ARGP_SEED 0x100
+#define GENERATE_ARGP_STATS 0x101
+
+/**
+ * @brief Axes that generated programs are scaled along
+ */
+typedef struct GenerateOptions {
+    /**Number of functions, not counting main or the functions declaring globals and nesting
+     * expressions*/
+    int functions;
+    /**Number of statements in the body of each function*/
+    int statements;
+    /**Depth of each expression's tree of operators. Purple has no parentheses, so each subtree
+     * below the top is passed through a call to a function that returns its argument*/
+    int depth;
+    /**Number of operands each operator in an expression's tree joins*/
+    int width;
+    /**Number of global variables that every function may read, declared in a function of their
+     * own that main calls first*/
+    int globals;
+    /**Length that identifiers are padded to*/
+    int identifier_length;
+    /**Percent of expressions' operands that are literals, rather than variables and globals*/
+    int literal_density;
+    /**Seed of the random choices made while generating, so that programs may be generated again*/
+    uint64_t seed;
+    /**True if the number of lines and tokens generated are printed to stderr*/
+    bool print_stats;
+} GenerateOptions;
+
+/**
+ * @brief State of a program being generated
+ */
+typedef struct Generator {
+    /**Stream the program is written to*/
+    FILE* out;
+    /**Axes the program is scaled along*/
+    GenerateOptions options;
+    /**State of the random number generator*/
+    uint64_t random_state;
+    /**Number of lines written*/
+    unsigned long long int lines;
+    /**Number of tokens written*/
+    unsigned long long int tokens;
+    /**Number of levels of braces that the current line is indented by*/
+    int indent;
+    /**True if nothing has been written on the current line*/
+    bool at_line_start;
+    /**True if the last token written was an opening parenthesis*/
+    bool after_left_paren;
+    /**Index of the function being generated*/
+    int function;
+    /**Number of parameters of the function being generated*/
+    int num_parameters;
+    /**Number of local variables declared so far in the function being generated*/
+    int num_locals;
+} Generator;
+
+#endif /* GENERATE_H */
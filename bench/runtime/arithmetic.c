@@ -0,0 +1,22 @@
+/**
+ * @file arithmetic.c
+ * @author Charles Averill
+ * @brief C reference for the mix of integer arithmetic benchmark
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+
+int main(void)
+{
+    long state = 1;
+    long total = 0;
+
+    for (int i = 0; i < 20000000; i = i + 1) {
+        state = state * 1103515245 + 12345;
+        state = state - state / 2147483648L * 2147483648L;
+        total = total + state / 65536 - i / 3;
+    }
+
+    printf("%ld\n", total);
+}
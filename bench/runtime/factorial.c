@@ -0,0 +1,32 @@
+/**
+ * @file factorial.c
+ * @author Charles Averill
+ * @brief C reference for the factorials benchmark
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+
+long factorial(int n)
+{
+    long product = 1;
+
+    for (int k = 2; k <= n; k = k + 1) {
+        product = product * k;
+    }
+
+    return product;
+}
+
+int main(void)
+{
+    long total = 0;
+
+    for (int round = 0; round < 300000; round = round + 1) {
+        for (int n = 1; n <= 20; n = n + 1) {
+            total = total + factorial(n) / 1000000;
+        }
+    }
+
+    printf("%ld\n", total);
+}
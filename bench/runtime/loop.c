@@ -0,0 +1,21 @@
+/**
+ * @file loop.c
+ * @author Charles Averill
+ * @brief C reference for the nested counted loops benchmark
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+
+int main(void)
+{
+    long total = 0;
+
+    for (int i = 0; i < 4000; i = i + 1) {
+        for (int j = 0; j < 4000; j = j + 1) {
+            total = total + i * j;
+        }
+    }
+
+    printf("%ld\n", total);
+}
@@ -0,0 +1,22 @@
+/**
+ * @file pointer_chase.c
+ * @author Charles Averill
+ * @brief C reference for the chain of pointers benchmark
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+
+int main(void)
+{
+    long value = 0;
+    long* first = &value;
+    long** second = &first;
+    long*** third = &second;
+
+    for (int i = 0; i < 30000000; i = i + 1) {
+        ***third = ***third + i;
+    }
+
+    printf("%ld\n", value);
+}
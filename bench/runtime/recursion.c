@@ -0,0 +1,22 @@
+/**
+ * @file recursion.c
+ * @author Charles Averill
+ * @brief C reference for the doubly recursive calls benchmark
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+
+int fibonacci(int n)
+{
+    if (n < 2) {
+        return n;
+    }
+
+    return fibonacci(n - 1) + fibonacci(n - 2);
+}
+
+int main(void)
+{
+    printf("%d\n", fibonacci(35));
+}
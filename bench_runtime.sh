@@ -0,0 +1,125 @@
+if [[ $1 != "--no-compile" ]] ; then
+    ./compile.sh
+    if [ $? -ne 0 ] ; then
+        exit 1
+    fi
+fi
+
+# Measures the speed of the code the compiler generates by running the kernels in bench/runtime,
+# built at each optimization level, against their C references built by BENCH_CC at the same level.
+# Each program is checked to print what its reference prints, warmed up BENCH_WARMUP times, then
+# timed over BENCH_RUNS runs. Results are printed as CSV, or as JSON if BENCH_FORMAT is json
+BENCH_RUNS=${BENCH_RUNS:-10}
+BENCH_WARMUP=${BENCH_WARMUP:-2}
+BENCH_OPT_LEVELS=${BENCH_OPT_LEVELS:-"0 1 2 3"}
+BENCH_CC=${BENCH_CC:-clang}
+BENCH_FORMAT=${BENCH_FORMAT:-csv}
+
+BENCH_DIR=$(mktemp -d)
+trap "rm -rf $BENCH_DIR" EXIT
+
+KERNELS="loop recursion factorial pointer_chase arithmetic"
+
+# Run a program BENCH_WARMUP times, then print the milliseconds each of BENCH_RUNS runs took
+# $1 - Program
+function time_runs() {
+    for (( run = 0; run < BENCH_WARMUP; run++ )) ; do
+        $1 > /dev/null
+    done
+
+    for (( run = 0; run < BENCH_RUNS; run++ )) ; do
+        start=$(date +%s%N)
+        $1 > /dev/null
+        end=$(date +%s%N)
+        awk "BEGIN {printf \"%.3f\n\", ($end - $start) / 1e6}"
+    done
+}
+
+# Summarize the times read from stdin as their median, 95th percentile, mean, standard deviation,
+# and minimum
+function summarize() {
+    sort -n | awk '{
+        times[NR] = $1
+        sum += $1
+    } END {
+        median = NR % 2 ? times[(NR + 1) / 2] : (times[NR / 2] + times[NR / 2 + 1]) / 2
+        p95 = int(0.95 * NR)
+        if (p95 < 0.95 * NR) {
+            p95++
+        }
+        mean = sum / NR
+        for (i = 1; i <= NR; i++) {
+            variance += (times[i] - mean) ^ 2
+        }
+        stddev = NR > 1 ? sqrt(variance / (NR - 1)) : 0
+        printf "%.3f %.3f %.3f %.3f %.3f\n", median, times[p95], mean, stddev, times[1]
+    }'
+}
+
+# Print the results of one program
+# $1 - Kernel
+# $2 - Language the kernel was written in
+# $3 - Optimization level
+# $4 - Summary of the program's times
+# $5 - Median time of the program's C reference
+function print_result() {
+    read median p95 mean stddev min <<< "$4"
+    vs_c=$(awk "BEGIN {printf \"%.3f\", $median / $5}")
+
+    if [ "$BENCH_FORMAT" == "json" ] ; then
+        [ -n "$wrote_result" ] && printf ",\n"
+        printf '{"kernel": "%s", "language": "%s", "opt_level": %s, "runs": %s, ' $1 $2 $3 \
+            $BENCH_RUNS
+        printf '"median_ms": %s, "p95_ms": %s, "mean_ms": %s, "stddev_ms": %s, "min_ms": %s, ' \
+            $median $p95 $mean $stddev $min
+        printf '"vs_c": %s}' $vs_c
+    else
+        printf "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n" $1 $2 $3 $BENCH_RUNS $median $p95 $mean $stddev \
+            $min $vs_c
+    fi
+    wrote_result=1
+}
+
+if [ "$BENCH_FORMAT" == "json" ] ; then
+    printf "[\n"
+else
+    echo "kernel,language,opt_level,runs,median_ms,p95_ms,mean_ms,stddev_ms,min_ms,vs_c"
+fi
+
+for kernel in $KERNELS ; do
+    for opt_level in $BENCH_OPT_LEVELS ; do
+        purple_program=$BENCH_DIR/${kernel}_purple_O$opt_level
+        c_program=$BENCH_DIR/${kernel}_c_O$opt_level
+
+        bin/purple bench/runtime/$kernel.prp -O$opt_level -o $purple_program $BENCH_FLAGS \
+            > /dev/null
+        if [ $? -ne 0 ] ; then
+            echo "Failed to compile $kernel.prp at -O$opt_level" >&2
+            exit 1
+        fi
+        $BENCH_CC bench/runtime/$kernel.c -O$opt_level -o $c_program
+        if [ $? -ne 0 ] ; then
+            echo "Failed to compile $kernel.c at -O$opt_level" >&2
+            exit 1
+        fi
+
+        purple_output=$($purple_program)
+        c_output=$($c_program)
+        if [ "$purple_output" != "$c_output" ] ; then
+            echo "$kernel.prp printed '$purple_output' at -O$opt_level, but $kernel.c" \
+                "printed '$c_output'" >&2
+            exit 1
+        fi
+
+        c_summary=$(time_runs $c_program | summarize)
+        purple_summary=$(time_runs $purple_program | summarize)
+        c_median=${c_summary%% *}
+
+        print_result $kernel c $opt_level "$c_summary" $c_median
+        print_result $kernel purple $opt_level "$purple_summary" $c_median
+    done
+done
+
+if [ "$BENCH_FORMAT" == "json" ] ; then
+    printf "\n]\n"
+fi
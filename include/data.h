@@ -26,8 +26,9 @@ extern_ int D_CHAR_NUMBER;
 extern_ char D_PUT_BACK;
 /**The file pointer to the open filestream for the Scanner*/
 extern_ FILE* D_INPUT_FILE;
-/**The file pointer to the open filestream for the output LLVM-IR file*/
-extern_ FILE* D_LLVM_FILE;
+/**The file pointer to the open filestream for the output LLVM-IR file, or for the LLVM-IR of the
+ * function being translated on this thread*/
+extern_ _Thread_local FILE* D_LLVM_FILE;
 /**The file pointer to the open filestream for the output LLVM-IR Global Variables file*/
 extern_ FILE* D_LLVM_GLOBALS_FILE;
 /**Filename corresponding to D_INPUT_FILE*/
@@ -37,15 +38,13 @@ extern_ char* D_LLVM_FN;
 /**Filename corresponding to D_LLVM_GLOBALS_FILE*/
 extern_ char* D_LLVM_GLOBALS_FN;
 /**Current number of the latest-used LLVM virtual register within a function*/
-extern_ unsigned long long int D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER;
-/**Current label index*/
-extern_ unsigned long long int D_LABEL_INDEX;
+extern_ _Thread_local unsigned long long int D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER;
+/**Current label index within a function*/
+extern_ _Thread_local unsigned long long int D_LABEL_INDEX;
 /**The symbol name of the function currently being parsed*/
 extern_ char D_CURRENT_FUNCTION_BUFFER[MAX_IDENTIFIER_LENGTH + 1];
-/**Whether or not the current function has printed its preamble to LLVM_FILE yet*/
-extern_ bool D_CURRENT_FUNCTION_PREAMBLE_PRINTED;
-/**Whether or not the current function has returned a value*/
-extern_ bool D_CURRENT_FUNCTION_HAS_RETURNED;
+/**Whether or not the block currently being generated ends in a return*/
+extern_ _Thread_local bool D_CURRENT_FUNCTION_HAS_RETURNED;
 /**Whether or not a type is currently being scanned in*/
 extern_ bool D_SCANNING_TYPE;
 
@@ -62,7 +61,7 @@ extern_ PurpleArgs* D_ARGS;
 extern_ struct Token D_GLOBAL_TOKEN;
 
 /**Symbol Table Stack with the Global Symbol Table as its bottom*/
-extern_ SymbolTableStack* D_SYMBOL_TABLE_STACK;
+extern_ _Thread_local SymbolTableStack* D_SYMBOL_TABLE_STACK;
 /**Global Symbol Table (pointer to bottom of D_SYMBOL_TABLE_STACK)*/
 extern_ SymbolTable* D_GLOBAL_SYMBOL_TABLE;
 
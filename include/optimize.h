@@ -0,0 +1,154 @@
+/**
+ * @file optimize.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for optimization passes run over ASTs before translation
+ * @date 19-Oct-2026
+ */
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "translate/symbol_table.h"
+#include "tree.h"
+#include "types/number.h"
+
+/**
+ * @brief The known constant value of a variable at some point in a function
+ */
+typedef struct ConstantFact {
+    /**Variable whose value is known*/
+    SymbolTableEntry* variable;
+    /**Value of the variable*/
+    Number value;
+} ConstantFact;
+
+/**
+ * @brief Set of variables with known constant values
+ */
+typedef struct ConstantFacts {
+    /**Known values, at most one per variable*/
+    ConstantFact* facts;
+    /**Number of known values*/
+    unsigned long long int num_facts;
+    /**Size of facts*/
+    unsigned long long int capacity;
+} ConstantFacts;
+
+/**
+ * @brief A parsed function waiting to be translated, along with the scope of its parameters
+ */
+typedef struct ParsedFunction {
+    /**Function declaration AST*/
+    ASTNode* root;
+    /**Symbol Table holding the function's parameters*/
+    SymbolTable* scope;
+    /**Whether or not the function may be called from main, or is exported*/
+    bool is_reachable;
+} ParsedFunction;
+
+/**
+ * @brief Every function in a program, in the order they were declared
+ */
+typedef struct ParsedProgram {
+    /**Parsed functions*/
+    ParsedFunction* functions;
+    /**Number of parsed functions*/
+    unsigned long long int num_functions;
+    /**Size of functions*/
+    unsigned long long int capacity;
+} ParsedProgram;
+
+/**
+ * @brief How a function's self-recursive tail calls may be turned into a loop
+ */
+typedef struct TailRecursion {
+    /**Whether or not the function calls itself in tail position*/
+    bool is_tail_recursive;
+    /**Operation combining each call's result with the result of its recursive call, or T_EOF if
+     * recursive calls are returned directly*/
+    TokenType accumulator_operation;
+} TailRecursion;
+
+/**
+ * @brief Every value that may be stored to a variable, as far as it is known so far
+ */
+typedef struct VariableRange {
+    /**Variable whose values are bounded*/
+    SymbolTableEntry* variable;
+    /**Type of the variable's values*/
+    NumberType type;
+    /**Whether or not no value has been found to be stored to the variable yet*/
+    bool is_empty;
+    /**Bounds on every value found to be stored to the variable*/
+    ValueRange range;
+    /**Number of times range has grown*/
+    int num_widenings;
+} VariableRange;
+
+/**
+ * @brief Set of variables whose values are bounded
+ */
+typedef struct VariableRanges {
+    /**Bounded variables, at most one entry per variable*/
+    VariableRange* ranges;
+    /**Number of bounded variables*/
+    unsigned long long int num_ranges;
+    /**Size of ranges*/
+    unsigned long long int capacity;
+} VariableRanges;
+
+/**
+ * @brief The possible values of an expression, along with the type it is computed in
+ */
+typedef struct ExpressionRange {
+    /**Type the expression is computed in*/
+    NumberType type;
+    /**Bounds on the expression's value*/
+    ValueRange range;
+} ExpressionRange;
+
+/**
+ * @brief A pointer argument of a call, or an address taken anywhere else
+ */
+typedef struct AddressUse {
+    /**Variable whose address is taken, or NULL if the argument is not an address*/
+    SymbolTableEntry* variable;
+    /**Function receiving the address, or NULL if it is not directly passed to a function*/
+    ParsedFunction* callee;
+    /**Index of the parameter receiving the address*/
+    unsigned long long int argument_index;
+} AddressUse;
+
+/**
+ * @brief Every AddressUse in a program
+ */
+typedef struct AddressUses {
+    /**Uses of addresses*/
+    AddressUse* uses;
+    /**Number of uses*/
+    unsigned long long int num_uses;
+    /**Size of uses*/
+    unsigned long long int capacity;
+} AddressUses;
+
+/**
+ * @brief Largest function body, in AST nodes, that is inlined without being declared "inline"
+ */
+#define PURPLE_INLINE_THRESHOLD 24
+
+/**
+ * @brief Number of times a variable's range may grow before it is assumed to hold any value of its
+ * type, so that variables changed by loops are bounded quickly
+ */
+#define PURPLE_RANGE_WIDENING_LIMIT 4
+
+ParsedFunction* find_parsed_function(ParsedProgram* program, char* symbol_name);
+ASTNode* fold_constants(ASTNode* function_root);
+ASTNode* eliminate_unreachable_statements(ASTNode* function_root);
+void eliminate_dead_code(ParsedProgram* program);
+void inline_functions(ParsedProgram* program);
+TailRecursion mark_tail_calls(ASTNode* function_root);
+void infer_function_attributes(ParsedProgram* program);
+void infer_variable_ranges(ParsedProgram* program);
+
+#endif /* OPTIMIZE_H */
@@ -50,6 +50,7 @@ static TokenType operatorPrecedence[] = {
 
 static TokenType rightAssociativeOperators[TOKENTYPE_MAX + 1] = {
     [T_ASSIGN] = 1,
+    [T_EXPONENT] = 1,
 };
 
 ASTNode* parse_binary_expression(void);
@@ -65,6 +65,15 @@ typedef enum
     T_WHILE,
     T_FOR,
     T_RETURN,
+    T_EXPORT,
+    T_INLINE,
+    T_NOINLINE,
+    T_UNROLL,
+    T_NOUNROLL,
+    T_VECTORIZE,
+    T_LIKELY,
+    T_UNLIKELY,
+    T_COLD,
     // Miscellaneous
     T_SEMICOLON,
     T_LEFT_PAREN,
@@ -97,7 +106,9 @@ static char* tokenStrings[] = {
     "EOF", "+", "-", "*", "/", "pow", "==", "!=", "<", ">", "<=", ">=", "and", "or", "xor", "nand",
     "nor", "xnor", "&", "*", "true", "false", "character literal", "short literal",
     "integer literal", "long literal", "void", "bool", "char", "short", "int", "long", "=", "print",
-    "if", "else", "while", "for", "return", ";", "(", ")", "{", "}", "identifier", ",",
+    "if", "else", "while", "for", "return", "export", "inline", "noinline", "unroll", "nounroll",
+    "vectorize", "likely", "unlikely", "cold", ";", "(", ")", "{", "}",
+    "identifier", ",",
     //    "lvalue identifier",
     "ast glue", "function", "function call", "TOKENTYPE_MAX"};
 
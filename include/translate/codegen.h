@@ -0,0 +1,52 @@
+/**
+ * @file codegen.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for translating the functions of a program on several
+ * threads and merging their LLVM-IR in the order they were declared
+ * @date 19-Oct-2026
+ */
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "optimize.h"
+#include "translate/llvm.h"
+#include "translate/profile.h"
+
+/**
+ * @brief Everything a function's translation adds to the module, kept apart from every other
+ * function's until it is merged so that functions may be translated at the same time
+ */
+typedef struct CodegenContext {
+    /**Function to translate*/
+    ParsedFunction* function;
+    /**LLVM-IR of the function*/
+    char* llvm;
+    /**Size of llvm*/
+    size_t llvm_size;
+    /**Metadata nodes referenced by the function, numbered from
+     * PURPLE_FIRST_FUNCTION_METADATA_NODE*/
+    LLVMMetadataTable metadata;
+    /**Counters added to the function, if the program is instrumented*/
+    ProfileCounters counters;
+} CodegenContext;
+
+/**
+ * @brief Functions waiting to be translated by a pool of threads
+ */
+typedef struct CodegenQueue {
+    /**Contexts of the functions, in the order they were declared*/
+    CodegenContext* contexts;
+    /**Number of contexts*/
+    unsigned long long int num_contexts;
+    /**Index of the next context that no thread has started translating*/
+    atomic_ullong next_context;
+} CodegenQueue;
+
+CodegenContext* codegen_current_context(void);
+void codegen_functions(ParsedProgram* program);
+
+#endif /* CODEGEN_H */
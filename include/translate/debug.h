@@ -0,0 +1,38 @@
+/**
+ * @file debug.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for describing generated programs to debuggers and
+ * profilers with DWARF metadata
+ * @date 19-Oct-2026
+ */
+
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include "translate/symbol_table.h"
+#include "tree.h"
+
+/**
+ * @brief Placeholder written to function bodies before the instructions generated for a source
+ * location, followed by the location's line and column
+ */
+#define PURPLE_DEBUG_LOCATION_PLACEHOLDER ";<purple_debug_location>"
+/**
+ * @brief Length of PURPLE_DEBUG_LOCATION_PLACEHOLDER
+ */
+#define PURPLE_DEBUG_LOCATION_PLACEHOLDER_LEN (sizeof(PURPLE_DEBUG_LOCATION_PLACEHOLDER) - 1)
+/**
+ * @brief Version of DWARF to emit
+ */
+#define PURPLE_DWARF_VERSION 5
+
+void debug_preamble(void);
+void debug_begin_function(ASTNode* function_root);
+int debug_current_subprogram(void);
+void debug_location(int line_number, int char_number);
+void debug_declare_parameter(unsigned long long int index, SymbolTableEntry* parameter);
+char* debug_attach_locations(char* body);
+int debug_global_variable_metadata(SymbolTableEntry* variable);
+int debug_postamble(void);
+
+#endif /* DEBUG_H */
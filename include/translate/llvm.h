@@ -9,6 +9,7 @@
 #define LLVM_H
 
 #include "scan.h"
+#include "types/function.h"
 #include "types/number.h"
 #include "utils/llvm_stack_entry.h"
 
@@ -17,11 +18,6 @@
  */
 static const char* numberTypeLLVMReprs[] = {"i1", "i8", "i16", "i32", "i64"};
 
-/**
- * @brief Head node of linked list containing register indices that are free to have values stored in them
- */
-extern LLVMStackEntryNode* freeVirtualRegistersHead;
-
 /**
  * @brief Size of buffer for generating refstrings
  */
@@ -30,9 +26,16 @@ extern LLVMStackEntryNode* freeVirtualRegistersHead;
 /**
  * @brief Temporary buffer used to generate pointer star strings for LLVM code
  */
-static char _refstring_buf[REFSTRING_BUF_MAXLEN];
+static _Thread_local char _refstring_buf[REFSTRING_BUF_MAXLEN];
+
+/**Suffix appended to the name of a local to name its stack slot*/
+#define PURPLE_LOCAL_SLOT_SUFFIX ".addr"
+/**
+ * @brief Size of the names of LLVMValues, which may be an identifier with a suffix appended
+ */
+#define LLVMVALUE_NAME_LENGTH (MAX_IDENTIFIER_LENGTH + sizeof(PURPLE_LOCAL_SLOT_SUFFIX))
 
-static char _llvm_name_buf[MAX_IDENTIFIER_LENGTH + 3];
+static _Thread_local char _llvm_name_buf[LLVMVALUE_NAME_LENGTH + 3];
 
 /**
  * @brief Types of values possibly returned by ast_to_llvm
@@ -43,12 +46,13 @@ typedef enum
     LLVMVALUETYPE_VIRTUAL_REGISTER,
     LLVMVALUETYPE_LABEL,
     LLVMVALUETYPE_CONSTANT,
+    LLVMVALUETYPE_UNDEF,
 } LLVMValueType;
 
 /**
  * @brief String representations of LLVMValueTypes for debugging
  */
-static const char* valueTypeStrings[] = {"None", "Virtual Register", "Label", "Constant"};
+static const char* valueTypeStrings[] = {"None", "Virtual Register", "Label", "Constant", "Undef"};
 
 /**
  * @brief Value returned by ast_to_llvm
@@ -62,12 +66,16 @@ typedef struct LLVMValue {
     char just_loaded[MAX_IDENTIFIER_LENGTH];
     /**Whether or not the value has a custom name rather than a register index*/
     bool has_name;
+    /**Whether or not the value is known to be within range, rather than anywhere in its type*/
+    bool has_range;
+    /**Bounds on the value, if has_range is set*/
+    ValueRange range;
     /**Contents of the value returned*/
     union {
         /**Index of a virtual register*/
         type_register virtual_register_index;
         /**Name of virtual register*/
-        char name[MAX_IDENTIFIER_LENGTH];
+        char name[LLVMVALUE_NAME_LENGTH];
         /**Constant value*/
         long long int constant;
         /**Index of an LLVM label*/
@@ -136,6 +144,16 @@ typedef struct LLVMValue {
         .num_info = (Number){.number_type = n_t, .pointer_depth = depth},                          \
     }
 
+/**
+ * @brief Generates an undefined LLVMValue struct of a given Number type
+ */
+#define LLVMVALUE_UNDEF(n)                                                                         \
+    (LLVMValue)                                                                                    \
+    {                                                                                              \
+        .value_type = LLVMVALUETYPE_UNDEF, .value.constant = 0, .num_info = n, .just_loaded = 0,   \
+        .has_name = false                                                                          \
+    }
+
 /**
  * @brief Inline initializes an LLVMValue struct from a label number
  */
@@ -149,7 +167,11 @@ typedef struct LLVMValue {
 /**
  * @brief Shorthand for providing a "%" string if needed in generation statements
  */
-#define LLVMVALUE_REGMARKER(llvmvalue) (llvmvalue.value_type == LLVMVALUETYPE_CONSTANT ? "" : "%")
+#define LLVMVALUE_REGMARKER(llvmvalue)                                                             \
+    (llvmvalue.value_type == LLVMVALUETYPE_CONSTANT ||                                             \
+             llvmvalue.value_type == LLVMVALUETYPE_UNDEF                                           \
+         ? ""                                                                                      \
+         : "%")
 
 #define LLVMVALUE_SET_JUSTLOADED(llvmvalue, symbol_name)                                           \
     memset(llvmvalue.just_loaded, 0, MAX_IDENTIFIER_LENGTH);                                       \
@@ -157,17 +179,106 @@ typedef struct LLVMValue {
 
 /**Prefix to prepend to LLVM label indices*/
 #define PURPLE_LABEL_PREFIX "L"
+/**Prefix to prepend to the indices of stack slots holding temporaries*/
+#define PURPLE_STACK_SLOT_PREFIX "slot."
+/**Prefix to prepend to the names of constants that a function's instructions refer to*/
+#define PURPLE_FUNCTION_CONSTANT_PREFIX "purple.const."
+/**Alignment of stack slots holding pointers*/
+#define PURPLE_POINTER_ALIGN_BYTES 8
+/**Prefix to prepend to the names of values in exponentiation loops*/
+#define PURPLE_POWER_PREFIX "pow."
+/**Largest constant exponent that is expanded into a chain of multiplications instead of a loop*/
+#define PURPLE_MAX_UNROLLED_EXPONENT 64
+/**Attributes describing the target, given to every function definition*/
+#define PURPLE_TARGET_ATTRIBUTES                                                                   \
+    "\"frame-pointer\"=\"all\" \"min-legal-vector-width\"=\"0\" "                                  \
+    "\"no-trapping-math\"=\"true\" \"stack-protector-buffer-size\"=\"8\" "                         \
+    "\"target-cpu\"=\"x86-64\" \"target-features\"=\"+cx8,+fxsr,+mmx,+sse,+sse2,+x87\" "           \
+    "\"tune-cpu\"=\"generic\""
+/**Number of the first attribute group holding inferred function attributes*/
+#define PURPLE_FIRST_INFERRED_ATTRIBUTE_GROUP 2
+/**Number of the first metadata node that isn't a module flag or identifier*/
+#define PURPLE_FIRST_METADATA_NODE 6
+/**Number of the first metadata node added while translating a function, which is renumbered after
+ * the module's nodes when the function is merged into the module*/
+#define PURPLE_FIRST_FUNCTION_METADATA_NODE 1000000000
+/**Branch weight of the edge taken when a condition wrapped in "likely" or "unlikely" goes as
+ * expected, which matches clang's __builtin_expect*/
+#define PURPLE_LIKELY_BRANCH_WEIGHT 2000
+/**Branch weight of the edge taken when a condition wrapped in "likely" or "unlikely" doesn't go as
+ * expected*/
+#define PURPLE_UNLIKELY_BRANCH_WEIGHT 1
+
+/**
+ * @brief Metadata nodes, numbered in the order they were added
+ */
+typedef struct LLVMMetadataTable {
+    /**Contents of each node, or NULL if a node's contents aren't known yet*/
+    char** nodes;
+    /**Whether or not each node was numbered before its contents were known, and so may refer to
+     * itself or to the nodes after it*/
+    bool* is_reserved;
+    /**Number of nodes*/
+    int num_nodes;
+    /**Number of the first node*/
+    int first_node;
+    /**Index plus one of the node in each bucket, hashed by contents, or 0 if a bucket is empty*/
+    int* buckets;
+    /**Number of buckets*/
+    int num_buckets;
+} LLVMMetadataTable;
+
+/**
+ * @brief A register holding an extended value, and the value it was extended from
+ */
+typedef struct LLVMExtension {
+    /**Register holding the extended value*/
+    type_register extended;
+    /**Value before it was extended*/
+    LLVMValue source;
+} LLVMExtension;
+
+/**
+ * @brief What LLVM may assume about a call that its caller returns from immediately
+ */
+typedef enum
+{
+    /**The call is not in tail position*/
+    TAIL_CALL_NONE,
+    /**The callee doesn't access the caller's stack, so the caller's frame may be reused*/
+    TAIL_CALL_ALLOWED,
+    /**The caller's frame must be reused, the call's prototype matches the caller's and its
+     * result is returned unchanged*/
+    TAIL_CALL_REQUIRED,
+} TailCallKind;
+
+/**
+ * @brief How likely a condition is to be true, as given by the wrapper written around it
+ */
+typedef enum
+{
+    BRANCH_HINT_NONE,
+    BRANCH_HINT_LIKELY,
+    BRANCH_HINT_UNLIKELY,
+} BranchHint;
 
 LLVMValue* llvm_ensure_registers_loaded(int n_registers, LLVMValue registers[], int load_depth);
 
 void llvm_preamble(void);
 void llvm_postamble(void);
+int llvm_metadata_node(const char* contents);
+int llvm_reserve_metadata_node(void);
+void llvm_fill_metadata_node(int node, const char* contents);
+char* llvm_merge_function_metadata(LLVMMetadataTable* metadata, const char* llvm);
+int llvm_function_attribute_group(Function* function);
 
-bool llvm_stack_allocation(LLVMStackEntryNode* stack_entries);
+LLVMValue llvm_allocate_stack_slot(NumberType type, int pointer_depth);
+LLVMValue llvm_allocate_stack_array(NumberType type, unsigned long long int length);
+void llvm_release_stack_slots(void);
 
 LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_register,
                                  LLVMValue right_virtual_register);
-LLVMValue llvm_store_constant(Number value);
+LLVMValue llvm_accumulate(TokenType operation, LLVMValue accumulator, LLVMValue value);
 type_register get_next_local_virtual_register(void);
 LLVMValue get_next_label(void);
 
@@ -176,19 +287,27 @@ void llvm_store_global_variable(char* symbol_name, LLVMValue rvalue_register);
 void llvm_declare_global_number_variable(char* symbol_name, Number n);
 LLVMValue llvm_int_resize(LLVMValue reg, NumberType new_tye);
 void llvm_declare_assign_global_number_variable(char* symbol_name, Number number);
+void llvm_declare_external_function(char* symbol_name);
 void llvm_print_int(LLVMValue print_vr);
 void llvm_print_bool(LLVMValue print_vr);
+void llvm_print_values(LLVMValue* values, unsigned long long int num_values);
+void llvm_print_constant(const char* text);
+void llvm_flush_constant_prints(void);
 LLVMValue llvm_compare(TokenType comparison_type, LLVMValue left_virtual_register,
                        LLVMValue right_virtual_register);
 LLVMValue llvm_compare_jump(TokenType comparison_type, LLVMValue left_virtual_register,
-                            LLVMValue right_virtual_register, LLVMValue false_label);
+                            LLVMValue right_virtual_register, LLVMValue false_label,
+                            BranchHint hint);
 void llvm_label(LLVMValue label);
+void llvm_loop_header_label(LLVMValue label);
 void llvm_jump(LLVMValue label);
 void llvm_conditional_jump(LLVMValue condition_register, LLVMValue true_label,
-                           LLVMValue false_label);
+                           LLVMValue false_label, BranchHint hint);
+void llvm_loop_latch_jump(LLVMValue header_label, int loop_hints, int unroll_count);
 LLVMValue* llvm_function_preamble(char* symbol_name);
 void llvm_function_postamble(void);
-LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, char* symbol_name);
+LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, char* symbol_name,
+                             TailCallKind tail_call_kind);
 const char* type_to_llvm_type(TokenType type);
 void llvm_return(LLVMValue virtual_register, char* symbol_name);
 char* refstring(char* buf, int pointer_depth);
@@ -196,6 +315,7 @@ char* llvmvalue_repr_notype(char* buf, LLVMValue reg);
 LLVMValue llvm_get_address(char* symbol_name);
 LLVMValue llvm_dereference(LLVMValue reg);
 void llvm_store_dereference(LLVMValue destination, LLVMValue value);
+LLVMValue llvm_load_local(char* symbol_name);
 void llvm_store_local(char* symbol_name, LLVMValue val);
 
 /**
@@ -0,0 +1,62 @@
+/**
+ * @file profile.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for instrumenting programs with profile counters, and
+ * for passing the profiles they write back to LLVM
+ * @date 19-Oct-2026
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+
+#include "translate/llvm.h"
+#include "tree.h"
+
+/**
+ * @brief Prefix of the globals and functions added to instrumented programs
+ */
+#define PURPLE_PROFILE_PREFIX "purple.profile."
+/**
+ * @brief Format of each line of a profile: function name, function checksum, counter index and
+ * count
+ */
+#define PURPLE_PROFILE_LINE_FORMAT "%s %llu %d %llu\n"
+
+/**
+ * @brief A counter of how many times a point in a function was reached
+ */
+typedef struct ProfileCounter {
+    /**Name of the function holding the counter*/
+    char function_name[MAX_IDENTIFIER_LENGTH];
+    /**Checksum of the function's AST when the counter was added*/
+    unsigned long long int checksum;
+    /**Index of the counter within its function*/
+    int index;
+    /**Number of times the counter was reached, if it has been read from a profile*/
+    unsigned long long int count;
+} ProfileCounter;
+
+/**
+ * @brief Every counter added to or read from a program
+ */
+typedef struct ProfileCounters {
+    /**Counters, grouped by function and in order of their indices*/
+    ProfileCounter* counters;
+    /**Number of counters*/
+    unsigned long long int num_counters;
+    /**Size of counters*/
+    unsigned long long int capacity;
+} ProfileCounters;
+
+void profile_load(char* filename);
+void profile_begin_function(ASTNode* function_root);
+int profile_next_counter(void);
+void profile_merge_counters(ProfileCounters* counters);
+void profile_increment_counter(int counter, LLVMValue amount);
+bool profile_counter_value(int counter, unsigned long long int* out);
+int profile_weights_metadata(unsigned long long int* counts, int num_counts);
+int profile_postamble(void);
+
+#endif /* PROFILE_H */
@@ -0,0 +1,35 @@
+/**
+ * @file runtime.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for the runtime that Purple programs print through
+ * @date 19-Oct-2026
+ */
+
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+/**
+ * @brief Prefix of the globals and functions of the print runtime
+ */
+#define PURPLE_PRINT_PREFIX "purple.print."
+/**
+ * @brief Number of bytes of output the print runtime holds before writing them to stdout
+ */
+#define PURPLE_PRINT_BUFFER_SIZE 65536
+/**
+ * @brief Most bytes a single print may add to the buffer: the digits and sign of the smallest long,
+ * and a newline
+ */
+#define PURPLE_PRINT_MAX_LENGTH 21
+/**
+ * @brief Kind of a value printed among several that is a long
+ */
+#define PURPLE_PRINT_KIND_LONG 0
+/**
+ * @brief Kind of a value printed among several that is a bool
+ */
+#define PURPLE_PRINT_KIND_BOOL 1
+
+void runtime_postamble(void);
+
+#endif /* RUNTIME_H */
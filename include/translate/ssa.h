@@ -0,0 +1,83 @@
+/**
+ * @file ssa.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for on-the-fly SSA construction of local variables
+ * @date 19-Oct-2026
+ */
+
+#ifndef SSA_H
+#define SSA_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "translate/llvm.h"
+#include "translate/symbol_table.h"
+
+/**
+ * @brief Placeholder in a buffered function body where a block's phi instructions are inserted
+ */
+#define PURPLE_PHI_PLACEHOLDER ";<purple_phi_placeholder>"
+/**
+ * @brief Length of PURPLE_PHI_PLACEHOLDER
+ */
+#define PURPLE_PHI_PLACEHOLDER_LEN (sizeof(PURPLE_PHI_PLACEHOLDER) - 1)
+
+/**
+ * @brief Prefix of the names given to phi instructions
+ */
+#define PURPLE_PHI_PREFIX "phi."
+
+/**
+ * @brief A phi instruction merging the definitions of a local variable at the start of a block
+ */
+typedef struct PhiNode {
+    /**Index used to name this phi, as in %phi.<index>*/
+    unsigned long long int index;
+    /**Index of the basic block this phi is placed at the start of*/
+    unsigned long long int block;
+    /**Symbol whose definitions this phi merges*/
+    SymbolTableEntry* variable;
+    /**Incoming values, one for each predecessor of block*/
+    LLVMValue* operands;
+    /**Number of incoming values*/
+    unsigned long long int num_operands;
+    /**Whether or not all operands of this phi are the same value (or the phi itself)*/
+    bool is_trivial;
+    /**If is_trivial, the value every use of this phi is replaced with*/
+    LLVMValue replacement;
+} PhiNode;
+
+/**
+ * @brief A basic block of the function currently being translated
+ */
+typedef struct BasicBlock {
+    /**Label of this block, or the virtual register number of an unnamed block*/
+    LLVMValue label;
+    /**Indices of the predecessors of this block*/
+    unsigned long long int* predecessors;
+    /**Number of predecessors of this block*/
+    unsigned long long int num_predecessors;
+    /**Size of predecessors*/
+    unsigned long long int predecessors_capacity;
+    /**Whether or not all predecessors of this block are known*/
+    bool sealed;
+    /**Phis created while this block was unsealed, completed when it is sealed*/
+    PhiNode** incomplete_phis;
+    /**Number of incomplete phis*/
+    unsigned long long int num_incomplete_phis;
+    /**Size of incomplete_phis*/
+    unsigned long long int incomplete_phis_capacity;
+} BasicBlock;
+
+void ssa_begin_function(type_register entry_block_register);
+void ssa_end_function(void);
+unsigned long long int ssa_begin_block(LLVMValue label, bool seal);
+void ssa_begin_unnamed_block(type_register block_register);
+void ssa_add_successor(LLVMValue label);
+void ssa_seal_block(LLVMValue label);
+void ssa_write_variable(SymbolTableEntry* variable, LLVMValue value);
+LLVMValue ssa_read_variable(SymbolTableEntry* variable);
+void ssa_write_function_body(FILE* out, char* body);
+
+#endif /* SSA_H */
@@ -29,8 +29,22 @@ typedef struct SymbolTableEntry {
     unsigned long int bucket_index;
     /**Contains information about the type of this symbol*/
     Type type;
+    /**Line of the input that this symbol was declared on*/
+    int line_number;
     /**LLVMValue containing the latest information of this symbol during the compile phase*/
     LLVMValue latest_llvmvalue;
+    /**Whether or not this local has its address taken, and so must live in a stack slot*/
+    bool in_memory;
+    /**Definitions of this local in each basic block of the current function, indexed by block*/
+    LLVMValue* block_llvmvalues;
+    /**Length of block_llvmvalues*/
+    unsigned long long int num_block_llvmvalues;
+    /**Whether or not this variable is read anywhere in the generated program*/
+    bool is_used;
+    /**Whether or not every value stored to this variable is known to be within range*/
+    bool has_range;
+    /**Bounds on the values of this variable, if has_range is set*/
+    ValueRange range;
     /**Symbol Tables are a chained Hash Table, this is the chain*/
     struct SymbolTableEntry* next;
     /**Index in chain*/
@@ -43,6 +57,8 @@ typedef struct SymbolTableEntry {
 typedef struct SymbolTable {
     /**Number of non-empty buckets in the Symbol Table*/
     unsigned long int length;
+    /**Number of symbols in the Symbol Table*/
+    unsigned long int num_entries;
     /**Number of empty buckets in the Symbol Table*/
     unsigned long int capacity;
     /**Total number of buckets in the Symbol Table*/
@@ -66,6 +82,7 @@ typedef struct SymbolTableStack {
 // Symbol Table Stack functions
 SymbolTableStack* new_symbol_table_stack(void);
 SymbolTableStack* new_nonempty_symbol_table_stack(void);
+SymbolTableStack* new_function_symbol_table_stack(SymbolTable* function_scope);
 void free_symbol_table_stack(SymbolTableStack* stack);
 void push_symbol_table(SymbolTableStack* stack);
 void push_existing_symbol_table(SymbolTableStack* stack, SymbolTable* new_table);
@@ -12,8 +12,6 @@
 #include "translate/llvm.h"
 #include "tree.h"
 
-LLVMStackEntryNode* determine_binary_expression_stack_allocation(ASTNode* root);
-
 LLVMValue ast_to_llvm(ASTNode* n, LLVMValue llvm_value, TokenType parent_operation);
 void generate_llvm(void);
 
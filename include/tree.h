@@ -14,6 +14,16 @@
 #include "translate/symbol_table.h"
 #include "utils/logging.h"
 
+/**
+ * @brief Hints passed to LLVM's loop optimizations by the specifiers written before a loop
+ */
+typedef enum
+{
+    LOOP_HINT_UNROLL = 1 << 0,
+    LOOP_HINT_NOUNROLL = 1 << 1,
+    LOOP_HINT_VECTORIZE = 1 << 2,
+} LoopHint;
+
 /**
  * @brief Component of the abstract syntax tree built during parsing
  */
@@ -42,6 +52,15 @@ typedef struct ASTNode {
     unsigned long long int num_args;
     /**Array of arguments for a function call node*/
     struct ASTNode** function_call_arguments;
+    /**Whether or not this function call is the last thing its caller does before returning*/
+    bool is_tail_call;
+    /**How likely a condition node is to be true*/
+    BranchHint branch_hint;
+    /**LoopHint flags of a while node*/
+    int loop_hints;
+    /**Number of times a while node's body is unrolled if it has LOOP_HINT_UNROLL, or 0 to let LLVM
+     * decide*/
+    int loop_unroll_count;
     /**Value of AST Node's Token*/
     union {
         /**Value of integer token*/
@@ -67,6 +86,7 @@ ASTNode* create_ast_nonidentifier_leaf(TokenType ttype, Type type);
 ASTNode* create_ast_identifier_leaf(TokenType ttype, char* symbol_name);
 ASTNode* create_unary_ast_node(TokenType ttype, ASTNode* child, Type type, char* symbol_name);
 void ast_debug_level_order(ASTNode* root, LogLevel log_level);
+ASTNode* copy_ast(ASTNode* root);
 void free_ast_node(ASTNode* root);
 
 #endif /* TREE */
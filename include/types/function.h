@@ -18,8 +18,46 @@ typedef struct FunctionParameter {
     Number parameter_type;
     /**Name of this parameter*/
     char parameter_name[MAX_IDENTIFIER_LENGTH];
+    /**Whether or not every call passes the address of a variable, so this pointer is never null*/
+    bool is_nonnull;
+    /**Whether or not this parameter's pointee is only accessed through it during a call*/
+    bool is_noalias;
 } FunctionParameter;
 
+/**
+ * @brief How a function's declaration asks to be treated by the inliner
+ */
+typedef enum
+{
+    INLINE_DEFAULT,
+    INLINE_ALWAYS,
+    INLINE_NEVER,
+} InlineHint;
+
+/**
+ * @brief Properties of a function inferred from its body and the functions it calls
+ */
+typedef enum
+{
+    /**Doesn't access memory visible to its callers*/
+    FUNCTION_ATTRIBUTE_READNONE = 1 << 0,
+    /**Doesn't write memory visible to its callers*/
+    FUNCTION_ATTRIBUTE_READONLY = 1 << 1,
+    /**Always returns*/
+    FUNCTION_ATTRIBUTE_WILLRETURN = 1 << 2,
+    /**Never calls itself, directly or indirectly*/
+    FUNCTION_ATTRIBUTE_NORECURSE = 1 << 3,
+    /**Doesn't communicate with other threads, such as through the locks of standard output*/
+    FUNCTION_ATTRIBUTE_NOSYNC = 1 << 4,
+} FunctionAttribute;
+
+/**
+ * @brief Every FunctionAttribute, which functions start with before inference
+ */
+#define FUNCTION_ATTRIBUTES_ALL                                                                    \
+    (FUNCTION_ATTRIBUTE_READNONE | FUNCTION_ATTRIBUTE_READONLY | FUNCTION_ATTRIBUTE_WILLRETURN |   \
+     FUNCTION_ATTRIBUTE_NORECURSE | FUNCTION_ATTRIBUTE_NOSYNC)
+
 /**
  * @brief Container for function information
  */
@@ -30,6 +68,19 @@ typedef struct Function {
     FunctionParameter* parameters;
     /**Number of function parameters*/
     unsigned long long int num_parameters;
+    /**Whether or not this function is kept even if it is never called from main*/
+    bool is_exported;
+    /**Whether this function was declared "inline", "noinline", or neither*/
+    InlineHint inline_hint;
+    /**Whether or not this function was declared "cold", meaning it is rarely called*/
+    bool is_cold;
+    /**Whether or not this function is only called from within the program, and so may use a
+     * faster calling convention*/
+    bool is_internal;
+    /**Whether or not this function is only declared by a prototype, and defined in another file*/
+    bool is_external;
+    /**Bitmask of the FunctionAttributes inferred for this function*/
+    int attributes;
 } Function;
 
 /**
@@ -9,6 +9,7 @@
 #define NUMBER
 
 #include <limits.h>
+#include <stdbool.h>
 
 /**
  * @brief Types of numbers supported by Purple
@@ -117,6 +118,16 @@ typedef struct Number {
         .number_type = t, .value = v                                                               \
     }
 
+/**
+ * @brief Inclusive bounds on the values an integer may hold
+ */
+typedef struct ValueRange {
+    /**Smallest possible value*/
+    long long int min;
+    /**Largest possible value*/
+    long long int max;
+} ValueRange;
+
 /**
  * @brief Determines if two Number structs have equivalent types
  */
@@ -125,6 +136,13 @@ typedef struct Number {
 
 NumberType token_type_to_number_type(int token_type);
 int number_to_token_type(Number number);
+bool value_fits_number_type(long long int value, NumberType type);
+long long int wrap_to_number_type(long long int value, NumberType type);
+bool wrapping_arithmetic(int operation, Number left, Number right, Number* out);
 NumberType max_numbertype_for_val(long long int value);
+ValueRange number_type_range(NumberType type);
+bool range_fits_number_type(ValueRange range, NumberType type);
+ValueRange range_union(ValueRange a, ValueRange b);
+bool range_arithmetic(int operation, ValueRange left, ValueRange right, ValueRange* out);
 
 #endif /* NUMBER */
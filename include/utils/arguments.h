@@ -13,6 +13,45 @@
 
 #include "info.h"
 
+/**
+ * @brief How the files of a program are optimized together when they are linked
+ */
+typedef enum
+{
+    /**Files are only optimized on their own*/
+    LTO_NONE,
+    /**Files are merged into one module and optimized as a whole*/
+    LTO_FULL,
+    /**Files are optimized separately, importing the functions they call from each other*/
+    LTO_THIN,
+} LTOMode;
+
+/**
+ * @brief How much DWARF debug information is given to generated programs
+ */
+typedef enum
+{
+    /**No debug information*/
+    DEBUG_INFO_NONE,
+    /**Only the source locations of instructions, so that profilers can attribute samples to lines*/
+    DEBUG_INFO_LINE_TABLES_ONLY,
+    /**Source locations, along with the types and locations of variables and parameters*/
+    DEBUG_INFO_FULL,
+} DebugInfoLevel;
+
+/**
+ * @brief Format of a report that the compiler prints about its own work when it exits
+ */
+typedef enum
+{
+    /**No report*/
+    REPORT_NONE,
+    /**A table for people to read*/
+    REPORT_TABLE,
+    /**A JSON object for tools to read*/
+    REPORT_JSON,
+} ReportFormat;
+
 /**
  * @struct PurpleArgs
  * @brief Structure containing command line arguments
@@ -20,8 +59,18 @@
 typedef struct PurpleArgs {
     /**Logging level to use*/
     int logging;
-    /**Input filename followed by output ASM filename*/
+    /**First input filename, followed by output LLVM filename and output binary filename*/
     char* filenames[3];
+    /**Every input file: Purple programs, and LLVM-IR, bitcode or object files to link them with*/
+    char** input_filenames;
+    /**Number of input files*/
+    int num_input_filenames;
+    /**True if Purple programs should be compiled to object files, but not linked*/
+    bool compile_only;
+    /**How the files of the program are optimized together when they are linked*/
+    LTOMode lto;
+    /**How much DWARF debug information is given to the generated program*/
+    DebugInfoLevel debug_info;
     /**Path to clang executable*/
     char* clang_executable;
     /**Program read from stdin*/
@@ -29,21 +78,116 @@ typedef struct PurpleArgs {
 
     /**True if constant expressions should be reduced*/
     bool const_expr_reduce;
+    /**True if known constant values of variables should be substituted for their uses*/
+    bool const_propagate;
+    /**True if unreachable functions and unused variables should be removed*/
+    bool dead_code_elim;
+    /**True if small functions should be inlined at their call sites*/
+    bool inline_functions;
+    /**True if calls in tail position should be marked as tail calls, and self-recursive tail
+     * calls turned into loops*/
+    bool tail_calls;
+    /**True if the effects of functions should be inferred and given to LLVM as attributes*/
+    bool infer_attributes;
+    /**True if the ranges of integer values should be tracked to pick widths and overflow flags*/
+    bool range_analysis;
+    /**Profile that the generated program should count its branches, calls and function entries
+     * into, or NULL if it shouldn't be instrumented*/
+    char* profile_generate;
+    /**Profile written by an instrumented build of the program, used to tell LLVM which code is
+     * hot, or NULL if there is none*/
+    char* profile_use;
+    /**Level of optimization that clang compiles the generated LLVM-IR with*/
+    int opt_level;
+    /**Number of threads that translate functions into LLVM-IR at the same time*/
+    int codegen_threads;
+    /**True if the generated program should write its output after every print, instead of when
+     * its output buffer fills or it exits*/
+    bool line_buffered_output;
+    /**True if each PROGRAM is compiled into a program of its own, named after it*/
+    bool batch;
+    /**Number of PROGRAMs compiled at the same time, each in a process of its own*/
+    int jobs;
+    /**Unix domain socket to listen on for programs to compile, or NULL if this isn't a compile
+     * server*/
+    char* server_socket;
+    /**Unix domain socket of a compile server to send the arguments to, instead of compiling them
+     * in this process, or NULL*/
+    char* connect_socket;
+    /**Directory of the build cache that compiled programs are stored in and restored from, or NULL
+     * if programs aren't cached*/
+    char* cache_dir;
+    /**Number of megabytes the build cache may hold before its least recently used entries are
+     * evicted*/
+    int cache_size;
+    /**Format of the report of how long each phase of the compile took, printed to stderr when the
+     * compiler exits*/
+    ReportFormat time_report;
+    /**Format of the report of how much memory each subsystem of the compiler allocated, printed to
+     * stderr when the compiler exits*/
+    ReportFormat memory_report;
+    /**File that Chrome trace events of the compile are written to, or NULL if it isn't traced*/
+    char* trace_fn;
     /**True if '; function_name' should be printed to llvm file whenver 
      * llvm code is written*/
     bool print_func_annotations;
 } PurpleArgs;
 
+/**
+ * @brief Profile written by instrumented programs when --fprofile-generate is given no filename
+ */
+#define PURPLE_DEFAULT_PROFILE_FILENAME "default.purpleprof"
+/**
+ * @brief Largest number of threads that may translate functions at once
+ */
+#define PURPLE_MAX_CODEGEN_THREADS 1024
+/**
+ * @brief Largest number of PROGRAMs that may be compiled at once
+ */
+#define PURPLE_MAX_JOBS 1024
+/**
+ * @brief Megabytes the build cache may hold before its least recently used entries are evicted,
+ * when --cache-size isn't given
+ */
+#define PURPLE_DEFAULT_CACHE_SIZE 512
+/**
+ * @brief Largest number of megabytes the build cache may be allowed to hold
+ */
+#define PURPLE_MAX_CACHE_SIZE (1 << 20)
+
 void parse_args(PurpleArgs* args, int argc, char* argv[]);
+bool is_purple_program(const char* filename);
 void set_opt_level(PurpleArgs* args, int opt_level);
 void help_flags();
 
 // CL Argument Shorthands for argp.h
 #define ARGP_HELP_FLAGS 0x100
 #define ARGP_LLVM_OUTPUT 0x101
+#define ARGP_LTO 0x102
+#define ARGP_THIN_LTO 0x103
+#define ARGP_COMPILE_ONLY 0x104
+#define ARGP_DEBUG_INFO 0x105
+#define ARGP_DEBUG_LINE_TABLES_ONLY 0x106
+#define ARGP_CODEGEN_THREADS 0x107
+#define ARGP_LINE_BUFFERED_OUTPUT 0x108
+#define ARGP_SERVER 0x109
+#define ARGP_CONNECT 0x10A
+#define ARGP_CACHE_DIR 0x10B
+#define ARGP_CACHE_SIZE 0x10C
 #define FLAGS_START 0x201
 #define FCONST_EXPR_REDUCE_CODE 0x202
 #define FPRINT_FUNC_ANNOTATIONS 0x203
+#define FCONST_PROPAGATE_CODE 0x204
+#define FDEAD_CODE_ELIM_CODE 0x205
+#define FINLINE_FUNCTIONS_CODE 0x206
+#define FTAIL_CALLS_CODE 0x207
+#define FINFER_ATTRIBUTES_CODE 0x208
+#define FRANGE_ANALYSIS_CODE 0x209
+#define FPROFILE_GENERATE_CODE 0x20A
+#define FPROFILE_USE_CODE 0x20B
+#define FTIME_REPORT_CODE 0x20C
+#define FMEM_REPORT_CODE 0x20D
+#define FTRACE_CODE 0x20E
 #define FLAGS_END 0x300
 
 #endif /* ARGUMENTS_H */
@@ -0,0 +1,46 @@
+/**
+ * @file cache.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for the build cache, which stores the LLVM and output
+ * files compiled from a program so that compiling the same program again restores them
+ * @date 19-Oct-2026
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Name of the file in a cache entry holding everything the entry was compiled from
+ */
+#define PURPLE_CACHE_KEY_FN "key"
+/**
+ * @brief Name of the file in a cache entry holding the LLVM file
+ */
+#define PURPLE_CACHE_LLVM_FN "llvm"
+/**
+ * @brief Name of the file in a cache entry holding the object file or binary
+ */
+#define PURPLE_CACHE_OUTPUT_FN "output"
+
+/**
+ * @brief Entry of the build cache for a program about to be compiled
+ */
+typedef struct CacheEntry {
+    /**Everything the outputs are compiled from: the compiler's version, the target, the flags that
+     * change the outputs and the program's source*/
+    char* key;
+    /**Number of bytes in key*/
+    size_t key_length;
+    /**Directory of the entry, named after the key's hash*/
+    char* directory;
+} CacheEntry;
+
+CacheEntry* cache_entry(const char* input_fn, bool is_binary);
+bool cache_restore(CacheEntry* entry, const char* llvm_fn, const char* output_fn);
+void cache_store(CacheEntry* entry, const char* llvm_fn, const char* output_fn);
+void free_cache_entry(CacheEntry* entry);
+
+#endif /* CACHE_H */
@@ -40,14 +40,22 @@ static bool generatorProgramWritten = false;
  * @brief Placeholder in main LLVM file used when linking globals
  */
 #define PURPLE_GLOBALS_PLACEHOLDER ";<purple_globals_placeholder>"
+/**
+ * @brief Suffix appended to the name of the main LLVM file to name the file its global variables
+ * are written to until they are linked into it
+ */
+#define PURPLE_GLOBALS_SUFFIX ".globals"
 /**
  * @brief Length of PURPLE_GLOBALS_PLACEHOLDER
  */
 #define PURPLE_GLOBALS_PLACEHOLDER_LEN sizeof(PURPLE_GLOBALS_PLACEHOLDER) - 1
 
-void clang_compile_llvm(const char* fn);
+int clang_compile_llvm(const char* fn);
+int clang_compile_object(const char* llvm_fn, const char* object_fn);
+int clang_link(char** fns, int num_fns);
 void link_globals(void);
 void create_tmp_generator_program(void);
+void clang_cache_target_information(void);
 char* get_target_datalayout(void);
 char* get_target_triple(void);
 char* get_postamble(void);
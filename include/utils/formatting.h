@@ -11,4 +11,8 @@
 #define TAB "\t"
 #define NEWLINE "\n"
 
+#include <stdio.h>
+
+void fprint_json_string(FILE* stream, const char* string);
+
 #endif /* FORMATTING_H */
@@ -13,6 +13,9 @@
 /**Prime number for FNV-1 algorithm*/
 #define FNV_PRIME 0x100000001B3
 
+#include <stddef.h>
+
 unsigned long int FNV_1(char* str);
+unsigned long int FNV_1_bytes(const char* data, size_t length);
 
 #endif /* HASH_H */
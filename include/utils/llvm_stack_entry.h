@@ -34,6 +34,8 @@ typedef struct LLVMStackEntryNode {
     NumberType type;
     /**Number of bytes to align stack to for this data*/
     int align_bytes;
+    /**Number of elements of the data if it is an array, or 0 if it is a single value*/
+    unsigned long long int length;
     /**Next node in linked list*/
     struct LLVMStackEntryNode* next;
 } LLVMStackEntryNode;
@@ -0,0 +1,71 @@
+/**
+ * @file memory.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for memory accounting, which counts the memory each
+ * subsystem of the compiler allocates and prints a report of it when the compiler exits
+ * @date 19-Oct-2026
+ */
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+
+#include "utils/arguments.h"
+
+/**
+ * @brief Number of allocations the table of live allocations holds before it first grows
+ */
+#define PURPLE_MEMORY_INITIAL_CAPACITY 1024
+
+/**
+ * @brief Subsystems of the compiler that allocations are charged to
+ */
+typedef enum
+{
+    /**Scanning tokens*/
+    MEMORY_SCANNER,
+    /**Parsing, and building and optimizing ASTs*/
+    MEMORY_PARSER,
+    /**Symbol Tables*/
+    MEMORY_SYMBOL_TABLES,
+    /**Translating the program into LLVM-IR*/
+    MEMORY_CODEGEN,
+    /**Running clang, the build cache, the compile server and the compiler's arguments*/
+    MEMORY_DRIVER,
+    /**Number of subsystems*/
+    NUM_MEMORY_SUBSYSTEMS,
+} MemorySubsystem;
+
+/**
+ * @brief Memory a subsystem has allocated
+ */
+typedef struct MemoryUsage {
+    /**Bytes allocated and not yet freed*/
+    size_t live_bytes;
+    /**Most bytes that were live at once*/
+    size_t peak_bytes;
+    /**Number of allocations made*/
+    unsigned long long int allocations;
+} MemoryUsage;
+
+/**
+ * @brief An allocation that has not been freed, in the table of live allocations
+ */
+typedef struct MemoryAllocation {
+    /**Allocated memory, or NULL if the table's slot is empty*/
+    void* pointer;
+    /**Number of bytes allocated*/
+    size_t size;
+    /**Subsystem the allocation is charged to*/
+    MemorySubsystem subsystem;
+} MemoryAllocation;
+
+void memory_report_start(ReportFormat format, const char* label);
+void* tracked_malloc(MemorySubsystem subsystem, size_t size);
+void* tracked_calloc(MemorySubsystem subsystem, size_t count, size_t size);
+void* tracked_realloc(MemorySubsystem subsystem, void* pointer, size_t size);
+char* tracked_strdup(MemorySubsystem subsystem, const char* string);
+void tracked_free(void* pointer);
+
+#endif /* MEMORY_H */
@@ -0,0 +1,42 @@
+/**
+ * @file server.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for the compile server and its clients
+ * @date 19-Oct-2026
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Number of standard streams a client passes to the compile server: stdin, stdout and
+ * stderr
+ */
+#define PURPLE_SERVER_NUM_STREAMS 3
+/**
+ * @brief Largest number of bytes of strings a request to the compile server may hold
+ */
+#define PURPLE_SERVER_MAX_REQUEST_LENGTH (1 << 20)
+
+/**
+ * @brief Start of a request sent to the compile server. It is followed by the client's working
+ * directory and then its arguments, each ending in a NUL, and carries the client's standard streams
+ */
+typedef struct ServerRequestHeader {
+    /**Number of bytes of strings following the header*/
+    uint64_t length;
+    /**Number of arguments among the strings*/
+    uint32_t num_arguments;
+} ServerRequestHeader;
+
+/**
+ * @brief Function that the compile server runs to handle a request, in a process of its own
+ */
+typedef void (*ServerCompileFunction)(int argc, char* argv[]);
+
+void server_run(const char* socket_fn, ServerCompileFunction compile);
+int server_forward(const char* socket_fn, int argc, char* argv[]);
+
+#endif /* SERVER_H */
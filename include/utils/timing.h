@@ -0,0 +1,90 @@
+/**
+ * @file timing.h
+ * @author Charles Averill
+ * @brief Function headers and definitions for the time report, which records how long each phase
+ * of a compile and each function takes, and prints them when the compiler exits
+ * @date 19-Oct-2026
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+#include "utils/arguments.h"
+
+/**
+ * @brief Most phases that may be nested within each other while they are timed
+ */
+#define PURPLE_TIME_REPORT_MAX_DEPTH 16
+/**
+ * @brief Number of the slowest functions listed for each of parsing and code generation
+ */
+#define PURPLE_TIME_REPORT_NUM_FUNCTIONS 10
+
+/**
+ * @brief Phases of a compile that time is charged to. Time spent in a phase nested in another is
+ * charged only to the nested phase
+ */
+typedef enum
+{
+    /**Asking clang about the target*/
+    TIME_PHASE_TARGET_PROBES,
+    /**Scanning tokens*/
+    TIME_PHASE_SCANNING,
+    /**Parsing functions, not counting the tokens scanned for them*/
+    TIME_PHASE_PARSING,
+    /**Folding, pruning, inlining and analyzing the parsed program*/
+    TIME_PHASE_OPTIMIZATION,
+    /**Translating the program into LLVM-IR*/
+    TIME_PHASE_CODEGEN,
+    /**Linking the globals file into the LLVM file*/
+    TIME_PHASE_LINK_GLOBALS,
+    /**Running clang to compile and link the LLVM-IR*/
+    TIME_PHASE_CLANG,
+    /**Looking up, restoring and storing programs in the build cache*/
+    TIME_PHASE_BUILD_CACHE,
+    /**Number of phases*/
+    NUM_TIME_PHASES,
+} TimePhase;
+
+/**
+ * @brief Kinds of work that the time spent on each function is recorded for
+ */
+typedef enum
+{
+    /**Parsing the function, along with the folding and pruning done as it is parsed*/
+    TIME_FUNCTION_PARSE,
+    /**Translating the function into LLVM-IR*/
+    TIME_FUNCTION_CODEGEN,
+    /**Number of kinds of work*/
+    NUM_TIME_FUNCTION_KINDS,
+} TimeFunctionKind;
+
+/**
+ * @brief Wall and CPU time, in nanoseconds
+ */
+typedef struct TimeSpan {
+    /**Nanoseconds of monotonic wall time*/
+    uint64_t wall;
+    /**Nanoseconds of CPU time*/
+    uint64_t cpu;
+} TimeSpan;
+
+/**
+ * @brief Time spent on one kind of work for one function
+ */
+typedef struct FunctionTime {
+    /**Name of the function*/
+    char* name;
+    /**Time spent on the function*/
+    TimeSpan time;
+} FunctionTime;
+
+void time_report_start(ReportFormat format, const char* label);
+void time_phase_begin(TimePhase phase);
+void time_phase_end(TimePhase phase);
+TimeSpan time_function_begin(void);
+void time_function_end(TimeFunctionKind kind, const char* name, TimeSpan start);
+
+#endif /* TIMING_H */
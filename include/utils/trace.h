@@ -0,0 +1,35 @@
+/**
+ * @file trace.h
+ * @author Charles Averill
+ * @brief Function headers for the trace, which records the compiler's phases, functions, Symbol
+ * Tables and clang processes as Chrome trace events, to be loaded into a trace viewer
+ * @date 19-Oct-2026
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Trace event being written, as one line of JSON
+ */
+typedef struct TraceEvent {
+    /**Stream the event is printed to*/
+    FILE* stream;
+    /**Text of the event, once stream is closed*/
+    char* text;
+    /**Number of bytes in text*/
+    size_t length;
+} TraceEvent;
+
+bool is_tracing(void);
+void trace_start(const char* trace_fn, const char* label);
+void trace_begin(const char* name, const char* category, const char* command);
+void trace_end(void);
+void trace_complete(const char* name, const char* category, uint64_t start);
+void trace_counter(const char* name, const char* series, unsigned long int value);
+
+#endif /* TRACE_H */
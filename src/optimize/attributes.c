@@ -0,0 +1,518 @@
+/**
+ * @file attributes.c
+ * @author Charles Averill
+ * @brief Inference of the effects of functions and the pointers passed to them, so that LLVM may
+ * delete, hoist and merge calls
+ * @date 19-Oct-2026
+ */
+
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**
+ * @brief Determine if an identifier refers to a global variable, rather than a parameter that may
+ * shadow one. The scope of the function containing the identifier must be on top of the Symbol
+ * Table Stack
+ *
+ * @param symbol_name   Identifier to check
+ * @return bool         True if symbol_name refers to a global
+ */
+static bool is_global_variable(char* symbol_name)
+{
+    SymbolTableEntry* entry = STS_FIND(symbol_name);
+    return entry != NULL && entry == GST_FIND(symbol_name);
+}
+
+/**
+ * @brief Clear the attributes of a function that are contradicted by its own statements, ignoring
+ * the functions it calls
+ *
+ * @param node          Root of AST
+ * @param attributes    Bitmask of FunctionAttributes to clear
+ */
+static void clear_local_attributes(ASTNode* node, int* attributes)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+        if (is_global_variable(node->value.symbol_name)) {
+            *attributes &= ~FUNCTION_ATTRIBUTE_READNONE;
+        }
+        return;
+    case T_DEREFERENCE:
+        *attributes &= ~FUNCTION_ATTRIBUTE_READNONE;
+        clear_local_attributes(node->left, attributes);
+        return;
+    case T_ASSIGN:
+        clear_local_attributes(node->left, attributes);
+        if (node->right == NULL) {
+            return;
+        }
+
+        if (node->right->ttype == T_IDENTIFIER) {
+            // Parameters are copies in the callee's frame, so storing to them isn't visible
+            if (is_global_variable(node->right->value.symbol_name)) {
+                *attributes &= ~(FUNCTION_ATTRIBUTE_READNONE | FUNCTION_ATTRIBUTE_READONLY);
+            }
+        } else {
+            *attributes &= ~(FUNCTION_ATTRIBUTE_READNONE | FUNCTION_ATTRIBUTE_READONLY);
+            clear_local_attributes(node->right->left, attributes);
+        }
+        return;
+    case T_PRINT:
+        // Prints write to standard output, and may block forever
+        *attributes &= ~(FUNCTION_ATTRIBUTE_READNONE | FUNCTION_ATTRIBUTE_READONLY |
+                         FUNCTION_ATTRIBUTE_WILLRETURN | FUNCTION_ATTRIBUTE_NOSYNC);
+        break;
+    case T_WHILE:
+        // Loops aren't proven to terminate
+        *attributes &= ~FUNCTION_ATTRIBUTE_WILLRETURN;
+        break;
+    case T_FUNCTION_CALL:
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            clear_local_attributes(node->function_call_arguments[i], attributes);
+        }
+        break;
+    default:
+        break;
+    }
+
+    clear_local_attributes(node->left, attributes);
+    clear_local_attributes(node->mid, attributes);
+    clear_local_attributes(node->right, attributes);
+}
+
+/**
+ * @brief Determine if an AST may call a function, directly or through the functions it calls
+ *
+ * @param program   Program containing callees
+ * @param node      AST to search for calls
+ * @param target    Function to search for
+ * @param visited   Which functions of program have already been searched
+ * @return bool     True if target may be called while node is evaluated
+ */
+static bool may_call(ParsedProgram* program, ASTNode* node, ParsedFunction* target, bool* visited)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        if (callee == NULL || callee == target) {
+            return true;
+        }
+
+        if (!visited[callee - program->functions]) {
+            visited[callee - program->functions] = true;
+            if (may_call(program, callee->root->left, target, visited)) {
+                return true;
+            }
+        }
+
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            if (may_call(program, node->function_call_arguments[i], target, visited)) {
+                return true;
+            }
+        }
+    }
+
+    return may_call(program, node->left, target, visited) ||
+           may_call(program, node->mid, target, visited) ||
+           may_call(program, node->right, target, visited);
+}
+
+/**
+ * @brief Restrict the attributes of a function to those shared by every function it calls
+ *
+ * @param program       Program containing callees
+ * @param node          AST to search for calls
+ * @param attributes    Bitmask of FunctionAttributes to restrict
+ */
+static void intersect_callee_attributes(ParsedProgram* program, ASTNode* node, int* attributes)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        if (callee == NULL) {
+            *attributes = 0;
+            return;
+        }
+
+        // A call to a function that doesn't recurse doesn't make its caller recurse
+        *attributes &= GST_FIND(node->value.symbol_name)->type.value.function.attributes |
+                       FUNCTION_ATTRIBUTE_NORECURSE;
+
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            intersect_callee_attributes(program, node->function_call_arguments[i], attributes);
+        }
+    }
+
+    intersect_callee_attributes(program, node->left, attributes);
+    intersect_callee_attributes(program, node->mid, attributes);
+    intersect_callee_attributes(program, node->right, attributes);
+}
+
+/**
+ * @brief Add an AddressUse to a list
+ *
+ * @param uses              List to add to
+ * @param variable          Variable whose address is taken, if any
+ * @param callee            Function receiving the address, if any
+ * @param argument_index    Index of the parameter receiving the address
+ */
+static void add_address_use(AddressUses* uses, SymbolTableEntry* variable, ParsedFunction* callee,
+                            unsigned long long int argument_index)
+{
+    if (uses->num_uses == uses->capacity) {
+        uses->capacity = uses->capacity ? uses->capacity * 2 : 16;
+        uses->uses =
+            tracked_realloc(MEMORY_PARSER, uses->uses, sizeof(AddressUse) * uses->capacity);
+        if (uses->uses == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to reallocate list of address uses");
+        }
+    }
+
+    uses->uses[uses->num_uses++] = (AddressUse){
+        .variable = variable, .callee = callee, .argument_index = argument_index};
+}
+
+/**
+ * @brief Collect the arguments of every call and every other address taken in an AST. The scope
+ * of the function containing node must be on top of the Symbol Table Stack
+ *
+ * @param program   Program containing callees
+ * @param node      AST to search
+ * @param uses      List to add to
+ */
+static void collect_address_uses(ParsedProgram* program, ASTNode* node, AddressUses* uses)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->ttype == T_AMPERSAND) {
+        add_address_use(uses, STS_FIND(node->value.symbol_name), NULL, 0);
+    } else if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            ASTNode* argument = node->function_call_arguments[i];
+            if (argument && argument->ttype == T_AMPERSAND) {
+                add_address_use(uses, STS_FIND(argument->value.symbol_name), callee, i);
+            } else {
+                add_address_use(uses, NULL, callee, i);
+                collect_address_uses(program, argument, uses);
+            }
+        }
+    }
+
+    collect_address_uses(program, node->left, uses);
+    collect_address_uses(program, node->mid, uses);
+    collect_address_uses(program, node->right, uses);
+}
+
+/**
+ * @brief Determine if a parameter is only ever dereferenced, so that no copies of it are made
+ *
+ * @param node              Root of function body AST
+ * @param parameter_name    Name of parameter
+ * @param is_dereferenced   Whether or not node is the operand of a dereference
+ * @return bool             True if every use of parameter_name in node is dereferenced
+ */
+static bool is_only_dereferenced(ASTNode* node, char* parameter_name, bool is_dereferenced)
+{
+    if (node == NULL) {
+        return true;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+        return is_dereferenced || strcmp(node->value.symbol_name, parameter_name);
+    case T_AMPERSAND:
+        return strcmp(node->value.symbol_name, parameter_name);
+    case T_DEREFERENCE:
+        return is_only_dereferenced(node->left, parameter_name, true);
+    case T_FUNCTION_CALL:
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            if (!is_only_dereferenced(node->function_call_arguments[i], parameter_name, false)) {
+                return false;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    return is_only_dereferenced(node->left, parameter_name, false) &&
+           is_only_dereferenced(node->mid, parameter_name, false) &&
+           is_only_dereferenced(node->right, parameter_name, false);
+}
+
+/**
+ * @brief Determine if an AST names a variable. The scope of the function containing node must be
+ * on top of the Symbol Table Stack
+ *
+ * @param node      Root of AST
+ * @param variable  Variable to search for
+ * @return bool     True if node reads, writes, or takes the address of variable
+ */
+static bool names_variable(ASTNode* node, SymbolTableEntry* variable)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if ((node->ttype == T_IDENTIFIER || node->ttype == T_AMPERSAND) &&
+        STS_FIND(node->value.symbol_name) == variable) {
+        return true;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            if (names_variable(node->function_call_arguments[i], variable)) {
+                return true;
+            }
+        }
+    }
+
+    return names_variable(node->left, variable) || names_variable(node->mid, variable) ||
+           names_variable(node->right, variable);
+}
+
+static bool function_may_name(ParsedProgram* program, ParsedFunction* function,
+                              SymbolTableEntry* variable, bool* visited);
+
+/**
+ * @brief Determine if any function called by an AST may name a variable, directly or through the
+ * functions it calls
+ *
+ * @param program   Program containing callees
+ * @param node      AST to search for calls
+ * @param variable  Variable to search for
+ * @param visited   Which functions of program have already been searched
+ * @return bool     True if a callee may name variable
+ */
+static bool callees_may_name(ParsedProgram* program, ASTNode* node, SymbolTableEntry* variable,
+                             bool* visited)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        if (callee == NULL || function_may_name(program, callee, variable, visited)) {
+            return true;
+        }
+
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            if (callees_may_name(program, node->function_call_arguments[i], variable, visited)) {
+                return true;
+            }
+        }
+    }
+
+    return callees_may_name(program, node->left, variable, visited) ||
+           callees_may_name(program, node->mid, variable, visited) ||
+           callees_may_name(program, node->right, variable, visited);
+}
+
+/**
+ * @brief Determine if a function may name a variable, directly or through the functions it calls
+ *
+ * @param program   Program containing function
+ * @param function  Function to search
+ * @param variable  Variable to search for
+ * @param visited   Which functions of program have already been searched
+ * @return bool     True if variable may be accessed by name during a call to function
+ */
+static bool function_may_name(ParsedProgram* program, ParsedFunction* function,
+                              SymbolTableEntry* variable, bool* visited)
+{
+    if (visited[function - program->functions]) {
+        return false;
+    }
+    visited[function - program->functions] = true;
+
+    push_existing_symbol_table(D_SYMBOL_TABLE_STACK, function->scope);
+    bool names = names_variable(function->root->left, variable);
+    pop_symbol_table(D_SYMBOL_TABLE_STACK);
+
+    return names || callees_may_name(program, function->root->left, variable, visited);
+}
+
+/**
+ * @brief Determine if the memory a parameter points to is only accessed through it while its
+ * function runs
+ *
+ * @param program           Whole program
+ * @param function          Function taking the parameter
+ * @param parameter_index   Index of the parameter
+ * @param uses              Every AddressUse in program
+ * @return bool             True if the parameter may be marked noalias
+ */
+static bool is_noalias_parameter(ParsedProgram* program, ParsedFunction* function,
+                                 unsigned long long int parameter_index, AddressUses* uses)
+{
+    Function* type = &GST_FIND(function->root->value.symbol_name)->type.value.function;
+    if (!is_only_dereferenced(function->root->left,
+                              type->parameters[parameter_index].parameter_name, false)) {
+        return false;
+    }
+
+    bool* visited = tracked_calloc(MEMORY_PARSER, program->num_functions, sizeof(bool));
+    bool is_noalias = true;
+
+    for (unsigned long long int i = 0; i < uses->num_uses && is_noalias; i++) {
+        AddressUse* argument = &uses->uses[i];
+        if (argument->callee != function || argument->argument_index != parameter_index) {
+            continue;
+        }
+
+        // No other pointer to the variable may exist
+        for (unsigned long long int j = 0; j < uses->num_uses && is_noalias; j++) {
+            AddressUse* other = &uses->uses[j];
+            if (other->variable == argument->variable &&
+                (other->callee != function || other->argument_index != parameter_index)) {
+                is_noalias = false;
+            }
+        }
+
+        // A global variable may also be accessed by name
+        if (is_noalias && argument->variable == GST_FIND(argument->variable->symbol_name)) {
+            memset(visited, 0, program->num_functions * sizeof(bool));
+            is_noalias = !function_may_name(program, function, argument->variable, visited);
+        }
+    }
+
+    tracked_free(visited);
+    return is_noalias;
+}
+
+/**
+ * @brief Mark the pointer parameters of functions that only ever receive the address of a
+ * variable. Only functions called from within the program are considered, since other callers
+ * aren't known
+ *
+ * @param program Whole program
+ */
+static void infer_parameter_attributes(ParsedProgram* program)
+{
+    AddressUses uses = {.uses = NULL, .num_uses = 0, .capacity = 0};
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        if (program->functions[i].root) {
+            push_existing_symbol_table(D_SYMBOL_TABLE_STACK, program->functions[i].scope);
+            collect_address_uses(program, program->functions[i].root->left, &uses);
+            pop_symbol_table(D_SYMBOL_TABLE_STACK);
+        }
+    }
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        ParsedFunction* function = &program->functions[i];
+        if (function->root == NULL) {
+            continue;
+        }
+
+        Function* type = &GST_FIND(function->root->value.symbol_name)->type.value.function;
+        if (!type->is_internal) {
+            continue;
+        }
+
+        for (unsigned long long int p = 0; p < type->num_parameters; p++) {
+            if (type->parameters[p].parameter_type.pointer_depth != 1) {
+                continue;
+            }
+
+            bool is_called = false;
+            bool is_nonnull = true;
+            for (unsigned long long int u = 0; u < uses.num_uses; u++) {
+                if (uses.uses[u].callee == function && uses.uses[u].argument_index == p) {
+                    is_called = true;
+                    is_nonnull &= uses.uses[u].variable != NULL;
+                }
+            }
+
+            type->parameters[p].is_nonnull = is_called && is_nonnull;
+            type->parameters[p].is_noalias = type->parameters[p].is_nonnull &&
+                                             is_noalias_parameter(program, function, p, &uses);
+        }
+    }
+
+    tracked_free(uses.uses);
+}
+
+/**
+ * @brief Infer which functions don't access memory, always return, and don't recurse, and which
+ * pointer parameters always point to a variable that nothing else accesses during the call
+ *
+ * @param program Whole program, whose functions' Symbol Table Entries receive the attributes
+ */
+void infer_function_attributes(ParsedProgram* program)
+{
+    bool* visited = tracked_calloc(MEMORY_PARSER, program->num_functions, sizeof(bool));
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        ParsedFunction* function = &program->functions[i];
+        if (function->root == NULL) {
+            continue;
+        }
+
+        int attributes = FUNCTION_ATTRIBUTES_ALL;
+
+        push_existing_symbol_table(D_SYMBOL_TABLE_STACK, function->scope);
+        clear_local_attributes(function->root->left, &attributes);
+        pop_symbol_table(D_SYMBOL_TABLE_STACK);
+
+        memset(visited, 0, program->num_functions * sizeof(bool));
+        if (may_call(program, function->root->left, function, visited)) {
+            // Recursion isn't proven to terminate
+            attributes &= ~(FUNCTION_ATTRIBUTE_NORECURSE | FUNCTION_ATTRIBUTE_WILLRETURN);
+        }
+
+        GST_FIND(function->root->value.symbol_name)->type.value.function.attributes = attributes;
+    }
+
+    tracked_free(visited);
+
+    // A function has an attribute only if every function it calls does too, so repeat until none
+    // change
+    bool changed;
+    do {
+        changed = false;
+        for (unsigned long long int i = 0; i < program->num_functions; i++) {
+            ParsedFunction* function = &program->functions[i];
+            if (function->root == NULL) {
+                continue;
+            }
+
+            Function* type = &GST_FIND(function->root->value.symbol_name)->type.value.function;
+            int attributes = type->attributes;
+            intersect_callee_attributes(program, function->root->left, &attributes);
+            if (attributes != type->attributes) {
+                type->attributes = attributes;
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        if (program->functions[i].root) {
+            purple_log(LOG_DEBUG, "Function \"%s\" has attributes 0x%x",
+                       program->functions[i].root->value.symbol_name,
+                       GST_FIND(program->functions[i].root->value.symbol_name)
+                           ->type.value.function.attributes);
+        }
+    }
+
+    infer_parameter_attributes(program);
+}
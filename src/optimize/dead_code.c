@@ -0,0 +1,387 @@
+/**
+ * @file dead_code.c
+ * @author Charles Averill
+ * @brief Removal of unreachable statements, unused variables and stores, and uncalled functions
+ * @date 19-Oct-2026
+ */
+
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+#include "utils/logging.h"
+
+/**
+ * @brief Determine if control can never reach the end of a statement
+ *
+ * @param node  Root of statement AST
+ * @return bool True if every path through node returns
+ */
+static bool statement_terminates(ASTNode* node)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    switch (node->ttype) {
+    case T_RETURN:
+        return true;
+    case T_AST_GLUE:
+        return statement_terminates(node->left) || statement_terminates(node->mid) ||
+               statement_terminates(node->right);
+    case T_IF:
+        return statement_terminates(node->mid) && statement_terminates(node->right);
+    default:
+        // Loop conditions are checked before the first iteration, so a loop body may never run
+        return false;
+    }
+}
+
+/**
+ * @brief Free the statements of a statement list that follow a returning statement
+ *
+ * @param node      Root of statement AST
+ * @return ASTNode* Statement AST without unreachable statements
+ */
+static ASTNode* remove_unreachable_statements(ASTNode* node)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    switch (node->ttype) {
+    case T_AST_GLUE:
+        node->left = remove_unreachable_statements(node->left);
+        if (statement_terminates(node->left) && (node->mid || node->right)) {
+            purple_log(LOG_DEBUG, "Removing unreachable statements after line %d",
+                       node->left->line_number);
+            ASTNode* reachable = node->left;
+            node->left = NULL;
+            free_ast_node(node);
+            return reachable;
+        }
+
+        node->mid = remove_unreachable_statements(node->mid);
+        if (statement_terminates(node->mid) && node->right) {
+            free_ast_node(node->right);
+            node->right = NULL;
+        }
+
+        node->right = remove_unreachable_statements(node->right);
+        return node;
+    case T_IF:
+        node->mid = remove_unreachable_statements(node->mid);
+        node->right = remove_unreachable_statements(node->right);
+        return node;
+    case T_WHILE:
+        node->mid = remove_unreachable_statements(node->mid);
+        if (node->right && node->right->ttype == T_AST_GLUE) {
+            // For loop, the left child is the postamble
+            node->right->right = remove_unreachable_statements(node->right->right);
+        } else {
+            node->right = remove_unreachable_statements(node->right);
+        }
+        return node;
+    default:
+        return node;
+    }
+}
+
+/**
+ * @brief Remove statements that can never run because they follow a return. Nothing may follow a
+ * ret instruction in its block, so this is always done before translation
+ *
+ * @param function_root Function declaration AST
+ * @return ASTNode*     Function declaration AST without unreachable statements
+ */
+ASTNode* eliminate_unreachable_statements(ASTNode* function_root)
+{
+    function_root->left = remove_unreachable_statements(function_root->left);
+    return function_root;
+}
+
+/**
+ * @brief Find a parsed function by name
+ *
+ * @param program           Program to search
+ * @param symbol_name       Name of function
+ * @return ParsedFunction*  Function named symbol_name, or NULL if it was not found
+ */
+ParsedFunction* find_parsed_function(ParsedProgram* program, char* symbol_name)
+{
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        if (program->functions[i].root &&
+            !strcmp(program->functions[i].root->value.symbol_name, symbol_name)) {
+            return &program->functions[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void mark_reachable_function(ParsedProgram* program, ParsedFunction* function);
+
+/**
+ * @brief Mark every function called by an AST as reachable
+ *
+ * @param program   Program containing callees
+ * @param node      AST to search for calls
+ */
+static void mark_called_functions(ParsedProgram* program, ASTNode* node)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        if (callee) {
+            mark_reachable_function(program, callee);
+        }
+
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            mark_called_functions(program, node->function_call_arguments[i]);
+        }
+    }
+
+    mark_called_functions(program, node->left);
+    mark_called_functions(program, node->mid);
+    mark_called_functions(program, node->right);
+}
+
+/**
+ * @brief Mark a function, and every function it may call, as reachable
+ *
+ * @param program   Program containing function
+ * @param function  Function to mark
+ */
+static void mark_reachable_function(ParsedProgram* program, ParsedFunction* function)
+{
+    if (function->is_reachable) {
+        return;
+    }
+
+    function->is_reachable = true;
+    mark_called_functions(program, function->root->left);
+}
+
+/**
+ * @brief Mark every variable read by an AST as used
+ *
+ * @param node AST to search for reads
+ */
+static void mark_used_variables(ASTNode* node)
+{
+    SymbolTableEntry* variable;
+
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+    case T_AMPERSAND:
+        if ((variable = STS_FIND(node->value.symbol_name))) {
+            variable->is_used = true;
+        }
+        return;
+    case T_ASSIGN:
+        mark_used_variables(node->left);
+        // Storing to a variable is not a use of it, but storing through a pointer reads the pointer
+        if (node->right && node->right->ttype != T_IDENTIFIER) {
+            mark_used_variables(node->right);
+        }
+        return;
+    case T_FUNCTION_CALL:
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            mark_used_variables(node->function_call_arguments[i]);
+        }
+        return;
+    default:
+        mark_used_variables(node->left);
+        mark_used_variables(node->mid);
+        mark_used_variables(node->right);
+        return;
+    }
+}
+
+/**
+ * @brief Determine if evaluating an expression does anything other than produce its value
+ *
+ * @param node  Root of expression AST
+ * @return bool True if node contains a call or an assignment
+ */
+static bool has_side_effects(ASTNode* node)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL || node->ttype == T_ASSIGN) {
+        return true;
+    }
+
+    return has_side_effects(node->left) || has_side_effects(node->mid) ||
+           has_side_effects(node->right);
+}
+
+/**
+ * @brief Determine if an assignment stores to a global variable that is never read
+ *
+ * @param node  Assignment AST node
+ * @return bool True if the store may be removed
+ */
+static bool is_dead_store(ASTNode* node)
+{
+    if (node->right == NULL || node->right->ttype != T_IDENTIFIER) {
+        return false;
+    }
+
+    SymbolTableEntry* variable = STS_FIND(node->right->value.symbol_name);
+    return variable != NULL && variable == GST_FIND(node->right->value.symbol_name) &&
+           !variable->is_used;
+}
+
+/**
+ * @brief Remove stores to global variables that are never read, keeping the side effects of the
+ * stored values
+ *
+ * @param node          Root of AST
+ * @param is_statement  Whether or not node's value is discarded
+ * @param num_removed   Incremented for each removed store
+ * @return ASTNode*     AST without dead stores
+ */
+static ASTNode* remove_dead_stores(ASTNode* node, bool is_statement, int* num_removed)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    switch (node->ttype) {
+    case T_AST_GLUE:
+        node->left = remove_dead_stores(node->left, true, num_removed);
+        node->mid = remove_dead_stores(node->mid, true, num_removed);
+        node->right = remove_dead_stores(node->right, true, num_removed);
+        return node;
+    case T_IF:
+        node->left = remove_dead_stores(node->left, false, num_removed);
+        node->mid = remove_dead_stores(node->mid, true, num_removed);
+        node->right = remove_dead_stores(node->right, true, num_removed);
+        return node;
+    case T_WHILE:
+        node->left = remove_dead_stores(node->left, false, num_removed);
+        node->mid = remove_dead_stores(node->mid, true, num_removed);
+        if (node->right && node->right->ttype == T_AST_GLUE) {
+            node->right->left = remove_dead_stores(node->right->left, true, num_removed);
+            node->right->right = remove_dead_stores(node->right->right, true, num_removed);
+        } else {
+            node->right = remove_dead_stores(node->right, true, num_removed);
+        }
+        return node;
+    case T_ASSIGN:
+        node->left = remove_dead_stores(node->left, false, num_removed);
+        if (!is_dead_store(node)) {
+            node->right = remove_dead_stores(node->right, false, num_removed);
+            return node;
+        }
+
+        purple_log(LOG_DEBUG, "Removing store to unused variable \"%s\"",
+                   node->right->value.symbol_name);
+        (*num_removed)++;
+
+        ASTNode* value = node->left;
+        node->left = NULL;
+        free_ast_node(node);
+
+        if (is_statement && !has_side_effects(value)) {
+            free_ast_node(value);
+            return NULL;
+        }
+        return value;
+    case T_FUNCTION_CALL:
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            node->function_call_arguments[i] =
+                remove_dead_stores(node->function_call_arguments[i], false, num_removed);
+        }
+        return node;
+    default:
+        node->left = remove_dead_stores(node->left, false, num_removed);
+        node->mid = remove_dead_stores(node->mid, false, num_removed);
+        node->right = remove_dead_stores(node->right, false, num_removed);
+        return node;
+    }
+}
+
+/**
+ * @brief Mark every global variable as unused
+ */
+static void reset_global_variable_usage(void)
+{
+    for (unsigned long int i = 0; i < D_GLOBAL_SYMBOL_TABLE->total_buckets; i++) {
+        for (SymbolTableEntry* entry = D_GLOBAL_SYMBOL_TABLE->buckets[i]; entry;
+             entry = entry->next) {
+            entry->is_used = false;
+        }
+    }
+}
+
+/**
+ * @brief Remove functions that can't be reached from main, and stores to and declarations of
+ * global variables that are never read. Functions declared with "export" are always kept
+ *
+ * @param program Whole program, whose unreachable functions are freed and set to NULL
+ */
+void eliminate_dead_code(ParsedProgram* program)
+{
+    ParsedFunction* main_function = find_parsed_function(program, "main");
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        program->functions[i].is_reachable = false;
+    }
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        ParsedFunction* function = &program->functions[i];
+        // Without an entry point, every function is part of the program's interface
+        if (main_function == NULL ||
+            GST_FIND(function->root->value.symbol_name)->type.value.function.is_exported) {
+            mark_reachable_function(program, function);
+        }
+    }
+
+    if (main_function) {
+        mark_reachable_function(program, main_function);
+    }
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        if (!program->functions[i].is_reachable) {
+            purple_log(LOG_DEBUG, "Removing unreachable function \"%s\"",
+                       program->functions[i].root->value.symbol_name);
+            free_ast_node(program->functions[i].root);
+            program->functions[i].root = NULL;
+        }
+    }
+
+    // Removing a store may remove the last read of another variable, so repeat until none change
+    int num_removed;
+    do {
+        num_removed = 0;
+        reset_global_variable_usage();
+
+        for (unsigned long long int i = 0; i < program->num_functions; i++) {
+            if (program->functions[i].root) {
+                push_existing_symbol_table(D_SYMBOL_TABLE_STACK, program->functions[i].scope);
+                mark_used_variables(program->functions[i].root->left);
+                pop_symbol_table(D_SYMBOL_TABLE_STACK);
+            }
+        }
+
+        for (unsigned long long int i = 0; i < program->num_functions; i++) {
+            ParsedFunction* function = &program->functions[i];
+            if (function->root) {
+                push_existing_symbol_table(D_SYMBOL_TABLE_STACK, function->scope);
+                function->root->left = remove_dead_stores(function->root->left, true, &num_removed);
+                pop_symbol_table(D_SYMBOL_TABLE_STACK);
+            }
+        }
+    } while (num_removed > 0);
+}
@@ -0,0 +1,531 @@
+/**
+ * @file fold.c
+ * @author Charles Averill
+ * @brief Constant folding, constant propagation, and constant branch resolution over ASTs
+ * @date 19-Oct-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+#include "types/type.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**
+ * @brief Find the known value of a variable
+ *
+ * @param facts         Known values to search
+ * @param variable      Variable to look for
+ * @return ConstantFact* Known value of variable, or NULL if its value is not known
+ */
+static ConstantFact* find_fact(ConstantFacts* facts, SymbolTableEntry* variable)
+{
+    for (unsigned long long int i = 0; i < facts->num_facts; i++) {
+        if (facts->facts[i].variable == variable) {
+            return &facts->facts[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Forget the value of a variable
+ *
+ * @param facts     Known values to remove from
+ * @param variable  Variable whose value is no longer known
+ */
+static void kill_fact(ConstantFacts* facts, SymbolTableEntry* variable)
+{
+    ConstantFact* fact = find_fact(facts, variable);
+    if (fact) {
+        *fact = facts->facts[--facts->num_facts];
+    }
+}
+
+/**
+ * @brief Record the value of a variable
+ *
+ * @param facts     Known values to add to
+ * @param variable  Variable whose value is now known
+ * @param value     Value of variable
+ */
+static void set_fact(ConstantFacts* facts, SymbolTableEntry* variable, Number value)
+{
+    ConstantFact* fact = find_fact(facts, variable);
+    if (fact) {
+        fact->value = value;
+        return;
+    }
+
+    if (facts->num_facts >= facts->capacity) {
+        facts->capacity = facts->capacity ? facts->capacity * 2 : 16;
+        facts->facts = (ConstantFact*)tracked_realloc(MEMORY_PARSER, facts->facts,
+                                                      sizeof(ConstantFact) * facts->capacity);
+        if (facts->facts == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for constant propagation");
+        }
+    }
+
+    facts->facts[facts->num_facts++] = (ConstantFact){.variable = variable, .value = value};
+}
+
+/**
+ * @brief Copy a set of known values
+ *
+ * @param facts             Known values to copy
+ * @return ConstantFacts    Independent copy of facts
+ */
+static ConstantFacts copy_facts(ConstantFacts* facts)
+{
+    ConstantFacts out = {.facts = NULL, .num_facts = 0, .capacity = 0};
+
+    for (unsigned long long int i = 0; i < facts->num_facts; i++) {
+        set_fact(&out, facts->facts[i].variable, facts->facts[i].value);
+    }
+
+    return out;
+}
+
+/**
+ * @brief Keep only the known values that two paths of control flow agree on
+ *
+ * @param facts Known values along one path, filtered in place
+ * @param other Known values along the other path
+ */
+static void intersect_facts(ConstantFacts* facts, ConstantFacts* other)
+{
+    unsigned long long int i = 0;
+
+    while (i < facts->num_facts) {
+        ConstantFact* other_fact = find_fact(other, facts->facts[i].variable);
+        if (other_fact && other_fact->value.number_type == facts->facts[i].value.number_type &&
+            other_fact->value.value == facts->facts[i].value.value) {
+            i++;
+        } else {
+            facts->facts[i] = facts->facts[--facts->num_facts];
+        }
+    }
+}
+
+/**
+ * @brief Find the variable an identifier refers to, if its value may be propagated
+ *
+ * @param symbol_name       Identifier to look up
+ * @return SymbolTableEntry* Variable named by symbol_name, or NULL if it is not a number variable
+ */
+static SymbolTableEntry* propagatable_variable(char* symbol_name)
+{
+    SymbolTableEntry* variable = STS_FIND(symbol_name);
+    if (variable == NULL || variable->type.is_function) {
+        return NULL;
+    }
+
+    // Globals are stored as pointers to their values, locals are not
+    int value_pointer_depth = variable->type.value.number.pointer_depth;
+    if (variable == GST_FIND(symbol_name)) {
+        value_pointer_depth--;
+    }
+
+    return value_pointer_depth == 0 ? variable : NULL;
+}
+
+/**
+ * @brief Evaluate a comparison or logical operation on two constants
+ *
+ * @param operation     Operation to evaluate
+ * @param left          Left operand
+ * @param right         Right operand
+ * @param out           Filled with the boolean result
+ * @return bool         True if the operation could be evaluated at compile-time
+ */
+static bool evaluate_binary_condition(TokenType operation, Number left, Number right, Number* out)
+{
+    long long int l = left.value;
+    long long int r = right.value;
+    bool result;
+
+    switch (operation) {
+    case T_EQ:
+        result = l == r;
+        break;
+    case T_NEQ:
+        result = l != r;
+        break;
+    case T_LT:
+        result = l < r;
+        break;
+    case T_LE:
+        result = l <= r;
+        break;
+    case T_GT:
+        result = l > r;
+        break;
+    case T_GE:
+        result = l >= r;
+        break;
+    case T_AND:
+        result = l && r;
+        break;
+    case T_OR:
+        result = l || r;
+        break;
+    case T_XOR:
+        result = (l != 0) ^ (r != 0);
+        break;
+    default:
+        // N- logical operators are not supported by code generation either
+        return false;
+    }
+
+    *out = NUMBER_BOOL(result);
+    return true;
+}
+
+/**
+ * @brief Get the Number held by a literal AST node
+ *
+ * @param node      Literal AST node
+ * @return Number   Value and type of node
+ */
+static Number literal_number(ASTNode* node)
+{
+    return NUMBER_FROM_TYPE_VAL(token_type_to_number_type(node->ttype), node->value.number_value);
+}
+
+/**
+ * @brief Evaluate an operator whose operands are both literals
+ *
+ * @param node      Binary operator AST node
+ * @param out       Filled with the result
+ * @return bool     True if node could be evaluated at compile-time
+ */
+static bool evaluate_constant_operator(ASTNode* node, Number* out)
+{
+    if (!D_ARGS->const_expr_reduce || node->left == NULL || node->right == NULL ||
+        !TOKENTYPE_IS_LITERAL(node->left->ttype) || !TOKENTYPE_IS_LITERAL(node->right->ttype)) {
+        return false;
+    }
+
+    if (TOKENTYPE_IS_BINARY_ARITHMETIC(node->ttype)) {
+        return wrapping_arithmetic(node->ttype, literal_number(node->left),
+                                   literal_number(node->right), out);
+    } else if (TOKENTYPE_IS_COMPARATOR(node->ttype) || TOKENTYPE_IS_LOGICAL_OPERATOR(node->ttype)) {
+        return evaluate_binary_condition(node->ttype, literal_number(node->left),
+                                         literal_number(node->right), out);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Replace an AST node with a literal
+ *
+ * @param replaced  AST node to replace, which is freed
+ * @param value     Value of the new literal
+ * @return ASTNode* New literal AST node
+ */
+static ASTNode* replace_with_literal(ASTNode* replaced, Number value)
+{
+    ASTNode* out = create_ast_nonidentifier_leaf(number_to_token_type(value),
+                                                 TYPE_NUMBER_FROM_NUMBERTYPE_FROM_NUMBER(value));
+    strcpy(out->filename, replaced->filename);
+    out->line_number = replaced->line_number;
+    out->char_number = replaced->char_number;
+    out->is_rvalue = replaced->is_rvalue;
+    out->largest_number_type = value.number_type;
+
+    free_ast_node(replaced);
+    return out;
+}
+
+static ASTNode* fold_expression(ASTNode* node, ConstantFacts* facts);
+
+/**
+ * @brief Fold both operands of a binary operator, then the operator itself if possible
+ *
+ * @param node      Binary operator AST node
+ * @param facts     Known variable values before node is evaluated
+ * @return ASTNode* Folded AST
+ */
+static ASTNode* fold_binary_operator(ASTNode* node, ConstantFacts* facts)
+{
+    Number result;
+
+    node->left = fold_expression(node->left, facts);
+    node->right = fold_expression(node->right, facts);
+
+    if (evaluate_constant_operator(node, &result)) {
+        return replace_with_literal(node, result);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Fold an assignment's value and record what is known about the assigned variable
+ *
+ * @param node      Assignment AST node
+ * @param facts     Known variable values before node is evaluated
+ * @return ASTNode* Folded AST
+ */
+static ASTNode* fold_assignment(ASTNode* node, ConstantFacts* facts)
+{
+    node->left = fold_expression(node->left, facts);
+
+    if (node->right == NULL || node->right->ttype != T_IDENTIFIER) {
+        // Storing through a pointer may change any variable
+        facts->num_facts = 0;
+        return node;
+    }
+
+    SymbolTableEntry* variable = STS_FIND(node->right->value.symbol_name);
+    if (variable == NULL) {
+        return node;
+    }
+
+    if (D_ARGS->const_propagate && node->left && TOKENTYPE_IS_LITERAL(node->left->ttype) &&
+        propagatable_variable(variable->symbol_name) &&
+        value_fits_number_type(node->left->value.number_value,
+                        variable->type.value.number.number_type)) {
+        set_fact(facts, variable,
+                 NUMBER_FROM_TYPE_VAL(variable->type.value.number.number_type,
+                                      node->left->value.number_value));
+    } else {
+        kill_fact(facts, variable);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Fold the constant parts of an expression
+ *
+ * @param node      Root of expression AST
+ * @param facts     Known variable values before node is evaluated, updated with any assignments
+ * @return ASTNode* Folded AST, which may be a different node than the one passed in
+ */
+static ASTNode* fold_expression(ASTNode* node, ConstantFacts* facts)
+{
+    ConstantFact* fact;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+        if (node->is_rvalue && (fact = find_fact(facts, STS_FIND(node->value.symbol_name)))) {
+            return replace_with_literal(node, fact->value);
+        }
+        return node;
+    case T_ASSIGN:
+        return fold_assignment(node, facts);
+    case T_FUNCTION_CALL:
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            node->function_call_arguments[i] =
+                fold_expression(node->function_call_arguments[i], facts);
+        }
+        // The callee may change any variable it can reach
+        facts->num_facts = 0;
+        return node;
+    case T_AMPERSAND:
+    case T_DEREFERENCE:
+        return node;
+    default:
+        break;
+    }
+
+    if (TOKENTYPE_IS_BINARY_ARITHMETIC(node->ttype) || TOKENTYPE_IS_COMPARATOR(node->ttype) ||
+        TOKENTYPE_IS_LOGICAL_OPERATOR(node->ttype)) {
+        return fold_binary_operator(node, facts);
+    }
+
+    node->left = fold_expression(node->left, facts);
+    node->mid = fold_expression(node->mid, facts);
+    node->right = fold_expression(node->right, facts);
+    return node;
+}
+
+/**
+ * @brief Forget the value of every variable that an AST may assign to
+ *
+ * @param node  AST that may run any number of times
+ * @param facts Known variable values to remove from
+ */
+static void kill_assigned_facts(ASTNode* node, ConstantFacts* facts)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->ttype == T_ASSIGN) {
+        if (node->right && node->right->ttype == T_IDENTIFIER) {
+            kill_fact(facts, STS_FIND(node->right->value.symbol_name));
+        } else {
+            facts->num_facts = 0;
+        }
+    } else if (node->ttype == T_FUNCTION_CALL) {
+        facts->num_facts = 0;
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            kill_assigned_facts(node->function_call_arguments[i], facts);
+        }
+    }
+
+    kill_assigned_facts(node->left, facts);
+    kill_assigned_facts(node->mid, facts);
+    kill_assigned_facts(node->right, facts);
+}
+
+/**
+ * @brief Fold the operands of a condition, and determine if the condition's outcome is known
+ *
+ * @param condition Condition AST, whose root is kept as a comparison or logical operator
+ * @param facts     Known variable values before the condition is evaluated
+ * @param outcome   Filled with the condition's outcome, if it is known
+ * @return bool     True if the condition's outcome is known at compile-time
+ */
+static bool fold_condition(ASTNode* condition, ConstantFacts* facts, bool* outcome)
+{
+    Number result;
+
+    condition->left = fold_expression(condition->left, facts);
+    condition->right = fold_expression(condition->right, facts);
+
+    // Conditions compare values, which don't depend on how their operands were typed
+    if (evaluate_constant_operator(condition, &result)) {
+        *outcome = result.value;
+        return true;
+    }
+
+    return false;
+}
+
+static ASTNode* fold_statement(ASTNode* node, ConstantFacts* facts);
+
+/**
+ * @brief Fold an if statement, replacing it with one of its branches if its condition is known
+ *
+ * @param node      If statement AST node
+ * @param facts     Known variable values before the statement, updated to those after it
+ * @return ASTNode* Folded AST
+ */
+static ASTNode* fold_if_statement(ASTNode* node, ConstantFacts* facts)
+{
+    bool outcome;
+
+    if (fold_condition(node->left, facts, &outcome)) {
+        ASTNode* taken;
+        if (outcome) {
+            taken = node->mid;
+            node->mid = NULL;
+        } else {
+            taken = node->right;
+            node->right = NULL;
+        }
+
+        purple_log(LOG_DEBUG, "Removing branch of if statement with constant condition");
+        free_ast_node(node);
+        return fold_statement(taken, facts);
+    }
+
+    ConstantFacts false_facts = copy_facts(facts);
+    node->mid = fold_statement(node->mid, facts);
+    node->right = fold_statement(node->right, &false_facts);
+
+    intersect_facts(facts, &false_facts);
+    tracked_free(false_facts.facts);
+
+    return node;
+}
+
+/**
+ * @brief Fold a while or for loop, replacing it with its else body if its body can never run
+ *
+ * @param node      Loop AST node
+ * @param facts     Known variable values before the loop, updated to those after it
+ * @return ASTNode* Folded AST
+ */
+static ASTNode* fold_while_statement(ASTNode* node, ConstantFacts* facts)
+{
+    bool outcome;
+    bool is_for_loop = node->right && node->right->ttype == T_AST_GLUE;
+    ASTNode** else_body = is_for_loop ? &node->right->right : &node->right;
+
+    // The condition and body run any number of times, so nothing they assign is known
+    kill_assigned_facts(node->left, facts);
+    kill_assigned_facts(node->mid, facts);
+    if (is_for_loop) {
+        kill_assigned_facts(node->right->left, facts);
+    }
+
+    if (fold_condition(node->left, facts, &outcome) && !outcome) {
+        ASTNode* taken = *else_body;
+        *else_body = NULL;
+
+        purple_log(LOG_DEBUG, "Removing loop with constant false condition");
+        free_ast_node(node);
+        return fold_statement(taken, facts);
+    }
+
+    ConstantFacts body_facts = copy_facts(facts);
+    node->mid = fold_statement(node->mid, &body_facts);
+    if (is_for_loop) {
+        node->right->left = fold_statement(node->right->left, &body_facts);
+    }
+    tracked_free(body_facts.facts);
+
+    *else_body = fold_statement(*else_body, facts);
+
+    return node;
+}
+
+/**
+ * @brief Fold the constant parts of a statement
+ *
+ * @param node      Root of statement AST
+ * @param facts     Known variable values before the statement, updated to those after it
+ * @return ASTNode* Folded AST, which may be a different node than the one passed in
+ */
+static ASTNode* fold_statement(ASTNode* node, ConstantFacts* facts)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    switch (node->ttype) {
+    case T_AST_GLUE:
+        node->left = fold_statement(node->left, facts);
+        node->mid = fold_statement(node->mid, facts);
+        node->right = fold_statement(node->right, facts);
+        return node;
+    case T_IF:
+        return fold_if_statement(node, facts);
+    case T_WHILE:
+        return fold_while_statement(node, facts);
+    default:
+        return fold_expression(node, facts);
+    }
+}
+
+/**
+ * @brief Fold constant expressions, propagate constants through straight-line assignments, and
+ * remove branches whose conditions are known at compile-time
+ *
+ * @param function_root Function declaration AST, whose parameters must be in scope
+ * @return ASTNode*     Folded function declaration AST
+ */
+ASTNode* fold_constants(ASTNode* function_root)
+{
+    ConstantFacts facts = {.facts = NULL, .num_facts = 0, .capacity = 0};
+
+    purple_log(LOG_DEBUG, "Folding constants in function \"%s\"", function_root->value.symbol_name);
+
+    function_root->left = fold_statement(function_root->left, &facts);
+
+    tracked_free(facts.facts);
+    return function_root;
+}
@@ -0,0 +1,603 @@
+/**
+ * @file inline.c
+ * @author Charles Averill
+ * @brief Substitution of small function bodies at their call sites
+ * @date 19-Oct-2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+#include "types/type.h"
+#include "utils/logging.h"
+
+/**Program whose functions are being inlined*/
+static ParsedProgram* inline_program = NULL;
+/**Function whose body calls are currently being inlined into*/
+static ParsedFunction* inline_caller = NULL;
+/**Number of fresh variables created by the inliner, used to keep their names unique*/
+static unsigned long long int num_inline_variables = 0;
+
+/**
+ * @brief Count the nodes of an AST, which is used as the cost of inlining it
+ *
+ * @param node                      Root of AST
+ * @return unsigned long long int   Number of nodes in node, including call arguments
+ */
+static unsigned long long int ast_size(ASTNode* node)
+{
+    if (node == NULL) {
+        return 0;
+    }
+
+    unsigned long long int size =
+        1 + ast_size(node->left) + ast_size(node->mid) + ast_size(node->right);
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        size += ast_size(node->function_call_arguments[i]);
+    }
+
+    return size;
+}
+
+/**
+ * @brief Determine if an AST contains a node of some TokenType
+ *
+ * @param node  Root of AST
+ * @param ttype TokenType to search for
+ * @return bool True if node or any of its descendants has type ttype
+ */
+static bool ast_contains(ASTNode* node, TokenType ttype)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == ttype) {
+        return true;
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        if (ast_contains(node->function_call_arguments[i], ttype)) {
+            return true;
+        }
+    }
+
+    return ast_contains(node->left, ttype) || ast_contains(node->mid, ttype) ||
+           ast_contains(node->right, ttype);
+}
+
+/**
+ * @brief Count the references to a symbol in an AST
+ *
+ * @param node          Root of AST
+ * @param symbol_name   Name of symbol
+ * @param ttype         Only nodes of this type are counted
+ * @return int          Number of nodes of type ttype that name symbol_name
+ */
+static int count_references(ASTNode* node, char* symbol_name, TokenType ttype)
+{
+    if (node == NULL) {
+        return 0;
+    }
+
+    int count = node->ttype == ttype && !strcmp(node->value.symbol_name, symbol_name);
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        count += count_references(node->function_call_arguments[i], symbol_name, ttype);
+    }
+
+    return count + count_references(node->left, symbol_name, ttype) +
+           count_references(node->mid, symbol_name, ttype) +
+           count_references(node->right, symbol_name, ttype);
+}
+
+/**
+ * @brief Determine if an expression has the same type as a variable it is bound to
+ *
+ * @param expression    Expression AST
+ * @param type          NumberType of variable
+ * @return bool         True if the expression can be used in place of the variable
+ */
+static bool expression_matches_type(ASTNode* expression, NumberType type)
+{
+    if (TOKENTYPE_IS_LITERAL(expression->ttype)) {
+        return value_fits_number_type(expression->value.number_value, type);
+    }
+
+    return expression->tree_type.number_type == type;
+}
+
+/**
+ * @brief Determine if an expression is computed only from literals. Literals keep their own types,
+ * which may be narrower than the callee's parameter and return types, so arithmetic on an inlined
+ * one could wrap where the call's value wouldn't
+ *
+ * @param expression    Expression AST
+ * @return bool         True if the expression reads no variables and makes no calls
+ */
+static bool is_literal_expression(ASTNode* expression)
+{
+    return !ast_contains(expression, T_IDENTIFIER) && !ast_contains(expression, T_FUNCTION_CALL);
+}
+
+/**
+ * @brief Determine if an AST refers to a global that is shadowed in the caller's scope, and so
+ * would refer to something else if it were moved into the caller
+ *
+ * @param node      Root of AST from the callee
+ * @param function  Callee, whose parameters are not globals
+ * @return bool     True if node refers to a global shadowed by one of the caller's locals
+ */
+static bool references_shadowed_global(ASTNode* node, Function* function)
+{
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == T_IDENTIFIER || node->ttype == T_AMPERSAND) {
+        char* symbol_name = node->value.symbol_name;
+        bool is_parameter = false;
+        for (unsigned long long int i = 0; i < function->num_parameters; i++) {
+            is_parameter |= !strcmp(symbol_name, function->parameters[i].parameter_name);
+        }
+
+        if (!is_parameter && STS_FIND(symbol_name) != GST_FIND(symbol_name)) {
+            return true;
+        }
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        if (references_shadowed_global(node->function_call_arguments[i], function)) {
+            return true;
+        }
+    }
+
+    return references_shadowed_global(node->left, function) ||
+           references_shadowed_global(node->mid, function) ||
+           references_shadowed_global(node->right, function);
+}
+
+/**
+ * @brief Find a function that a call may be inlined from
+ *
+ * @param call              Function call AST node
+ * @return ParsedFunction*  Function called by call, or NULL if it may not be inlined
+ */
+static ParsedFunction* find_inlinable_callee(ASTNode* call)
+{
+    ParsedFunction* callee = find_parsed_function(inline_program, call->value.symbol_name);
+    if (callee == NULL || callee == inline_caller) {
+        return NULL;
+    }
+
+    Function function = GST_FIND(call->value.symbol_name)->type.value.function;
+    ASTNode* body = callee->root->left;
+
+    // Cold functions are rarely called, so inlining them only grows their callers
+    if (function.inline_hint == INLINE_NEVER ||
+        (function.inline_hint != INLINE_ALWAYS &&
+         (function.is_cold || ast_size(body) > PURPLE_INLINE_THRESHOLD)) ||
+        count_references(body, call->value.symbol_name, T_FUNCTION_CALL) > 0 ||
+        references_shadowed_global(body, &function)) {
+        return NULL;
+    }
+
+    // A parameter whose address is taken lives in memory, which inlined variables never do
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        if (count_references(body, function.parameters[i].parameter_name, T_AMPERSAND) > 0) {
+            return NULL;
+        }
+    }
+
+    return callee;
+}
+
+/**
+ * @brief Split a function body into the statements before its final return and the returned value
+ *
+ * @param body          Function body AST
+ * @param statements    Filled with the statements before the final return
+ * @param result        Filled with the returned value, or NULL if there is none
+ * @return bool         True if the body has no returns other than a final top-level one
+ */
+static bool split_function_body(ASTNode* body, ASTNode** statements, ASTNode** result)
+{
+    *statements = body;
+    *result = NULL;
+
+    if (body && body->ttype == T_RETURN) {
+        *statements = NULL;
+        *result = body->left;
+    } else if (body && body->ttype == T_AST_GLUE && body->mid == NULL && body->right &&
+               body->right->ttype == T_RETURN) {
+        *statements = body->left;
+        *result = body->right->left;
+    }
+
+    return !ast_contains(*statements, T_RETURN);
+}
+
+/**
+ * @brief Copy the position information of one AST node into another
+ *
+ * @param dest      AST node to copy into
+ * @param source    AST node to copy from
+ */
+static void copy_position_info(ASTNode* dest, ASTNode* source)
+{
+    strcpy(dest->filename, source->filename);
+    dest->line_number = source->line_number;
+    dest->char_number = source->char_number;
+}
+
+/**
+ * @brief Create a fresh local variable in the scope of the caller
+ *
+ * @param base_name     Name the new variable is derived from
+ * @param type          Type of the new variable
+ * @param buffer        Filled with the name of the new variable
+ */
+static void new_inline_variable(char* base_name, Type type, char* buffer)
+{
+    // Purple identifiers can't contain '.', so this never collides with a user's variable
+    snprintf(buffer, MAX_IDENTIFIER_LENGTH, "%.200s.%llu", base_name, num_inline_variables++);
+    add_symbol_table_entry(inline_caller->scope, buffer, type);
+}
+
+/**
+ * @brief Create an identifier AST node
+ *
+ * @param symbol_name   Name of identifier
+ * @param is_rvalue     Whether or not the identifier is read
+ * @param position      AST node to copy position information from
+ * @return ASTNode*     New identifier AST node
+ */
+static ASTNode* new_identifier(char* symbol_name, bool is_rvalue, ASTNode* position)
+{
+    ASTNode* out = create_ast_identifier_leaf(T_IDENTIFIER, symbol_name);
+    out->is_rvalue = is_rvalue;
+    copy_position_info(out, position);
+    return out;
+}
+
+/**
+ * @brief Append a statement to a statement list
+ *
+ * @param list      Statement list, or NULL if it is empty
+ * @param statement Statement to append, ignored if NULL
+ * @return ASTNode* Statement list ending in statement
+ */
+static ASTNode* append_statement(ASTNode* list, ASTNode* statement)
+{
+    if (list == NULL) {
+        return statement;
+    } else if (statement == NULL) {
+        return list;
+    }
+
+    return create_ast_node(T_AST_GLUE, list, NULL, statement, TYPE_VOID, NULL);
+}
+
+/**
+ * @brief Rename every reference to a symbol in an AST
+ *
+ * @param node      Root of AST
+ * @param old_name  Name to replace
+ * @param new_name  Replacement name
+ */
+static void rename_symbol(ASTNode* node, char* old_name, char* new_name)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if ((node->ttype == T_IDENTIFIER || node->ttype == T_DEREFERENCE) &&
+        !strcmp(node->value.symbol_name, old_name)) {
+        strcpy(node->value.symbol_name, new_name);
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        rename_symbol(node->function_call_arguments[i], old_name, new_name);
+    }
+
+    rename_symbol(node->left, old_name, new_name);
+    rename_symbol(node->mid, old_name, new_name);
+    rename_symbol(node->right, old_name, new_name);
+}
+
+/**
+ * @brief Replace every read of a parameter in an expression with a copy of its argument
+ *
+ * @param node      Root of expression AST
+ * @param function  Function whose parameters are replaced
+ * @param arguments Arguments passed for each parameter
+ * @return ASTNode* Expression AST with parameters replaced
+ */
+static ASTNode* substitute_arguments(ASTNode* node, Function* function, ASTNode** arguments)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (node->ttype == T_IDENTIFIER) {
+        for (unsigned long long int i = 0; i < function->num_parameters; i++) {
+            if (!strcmp(node->value.symbol_name, function->parameters[i].parameter_name)) {
+                ASTNode* out = copy_ast(arguments[i]);
+                free_ast_node(node);
+                return out;
+            }
+        }
+        return node;
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        node->function_call_arguments[i] =
+            substitute_arguments(node->function_call_arguments[i], function, arguments);
+    }
+
+    node->left = substitute_arguments(node->left, function, arguments);
+    node->mid = substitute_arguments(node->mid, function, arguments);
+    node->right = substitute_arguments(node->right, function, arguments);
+    return node;
+}
+
+/**
+ * @brief Replace a call inside an expression with the value its callee returns. Only callees
+ * whose bodies are a single return of an expression without assignments are inlined this way, and
+ * only if evaluating the arguments where the parameters are read can't be observed and neither the
+ * arguments nor the result are computed from literals alone
+ *
+ * @param call      Function call AST node
+ * @return ASTNode* Inlined expression, or call if it could not be inlined
+ */
+static ASTNode* inline_call_expression(ASTNode* call)
+{
+    ASTNode* statements;
+    ASTNode* result;
+
+    ParsedFunction* callee = find_inlinable_callee(call);
+    if (callee == NULL || !split_function_body(callee->root->left, &statements, &result) ||
+        statements != NULL || result == NULL || ast_contains(result, T_ASSIGN)) {
+        return call;
+    }
+
+    Function function = GST_FIND(call->value.symbol_name)->type.value.function;
+    if (!expression_matches_type(result, token_type_to_number_type(function.return_type)) ||
+        is_literal_expression(result)) {
+        return call;
+    }
+
+    bool result_has_calls = ast_contains(result, T_FUNCTION_CALL);
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        ASTNode* argument = call->function_call_arguments[i];
+        Number parameter_type = function.parameters[i].parameter_type;
+
+        if (parameter_type.pointer_depth != 0 ||
+            !expression_matches_type(argument, parameter_type.number_type) ||
+            is_literal_expression(argument) || ast_contains(argument, T_FUNCTION_CALL) ||
+            ast_contains(argument, T_ASSIGN)) {
+            return call;
+        }
+
+        // Calls in the callee may change the variables an argument reads
+        if (result_has_calls) {
+            return call;
+        }
+
+        // Don't duplicate the work of an argument read more than once
+        if (argument->ttype != T_IDENTIFIER &&
+            count_references(result, function.parameters[i].parameter_name, T_IDENTIFIER) > 1) {
+            return call;
+        }
+    }
+
+    purple_log(LOG_DEBUG, "Inlining call to \"%s\" into expression in \"%s\"",
+               call->value.symbol_name, inline_caller->root->value.symbol_name);
+
+    ASTNode* out = substitute_arguments(copy_ast(result), &function, call->function_call_arguments);
+    out->is_rvalue = call->is_rvalue;
+    free_ast_node(call);
+    return out;
+}
+
+/**
+ * @brief Replace a call whose value is used directly by a statement with the callee's body. Each
+ * argument is bound to a fresh variable, and the returned value is stored in a fresh variable that
+ * the statement reads instead of the call
+ *
+ * @param statement Statement AST using the call
+ * @param call      Location of the call in statement, replaced by a read of the returned value
+ * @param inlined   Filled with the statement list replacing statement, which is NULL if the
+ * callee's body does nothing
+ * @return bool     True if the call was inlined
+ */
+static bool inline_call_statement(ASTNode* statement, ASTNode** call, ASTNode** inlined)
+{
+    ASTNode* statements;
+    ASTNode* result;
+    ASTNode* out = NULL;
+    char variable_name[MAX_IDENTIFIER_LENGTH + 1];
+
+    ParsedFunction* callee = find_inlinable_callee(*call);
+    if (callee == NULL || !split_function_body(callee->root->left, &statements, &result)) {
+        return false;
+    }
+
+    Function function = GST_FIND((*call)->value.symbol_name)->type.value.function;
+    bool value_is_used = statement != *call;
+    if (value_is_used && function.return_type != T_VOID && result == NULL) {
+        return false;
+    }
+
+    purple_log(LOG_DEBUG, "Inlining call to \"%s\" into statement in \"%s\"",
+               (*call)->value.symbol_name, inline_caller->root->value.symbol_name);
+
+    statements = copy_ast(statements);
+    result = copy_ast(result);
+
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        new_inline_variable(function.parameters[i].parameter_name,
+                            TYPE_NUMBER_FROM_NUMBERTYPE_FROM_NUMBER(
+                                function.parameters[i].parameter_type),
+                            variable_name);
+        rename_symbol(statements, function.parameters[i].parameter_name, variable_name);
+        rename_symbol(result, function.parameters[i].parameter_name, variable_name);
+
+        ASTNode* binding = create_ast_node(T_ASSIGN, (*call)->function_call_arguments[i], NULL,
+                                           new_identifier(variable_name, false, *call), TYPE_VOID,
+                                           NULL);
+        copy_position_info(binding, *call);
+        (*call)->function_call_arguments[i] = NULL;
+        out = append_statement(out, binding);
+    }
+
+    out = append_statement(out, statements);
+
+    if (value_is_used) {
+        // Storing the returned value first converts it to the callee's return type
+        new_inline_variable((*call)->value.symbol_name,
+                            TYPE_NUMBER_FROM_NUMBERTYPE_FROM_TOKEN(function.return_type),
+                            variable_name);
+        ASTNode* binding = create_ast_node(T_ASSIGN, result, NULL,
+                                           new_identifier(variable_name, false, *call), TYPE_VOID,
+                                           NULL);
+        copy_position_info(binding, *call);
+        out = append_statement(out, binding);
+
+        ASTNode* read = new_identifier(variable_name, true, *call);
+        free_ast_node(*call);
+        *call = read;
+        out = append_statement(out, statement);
+    } else {
+        // The returned value is discarded, but evaluating it may still have side effects
+        out = append_statement(out, result);
+        free_ast_node(statement);
+    }
+
+    *inlined = out;
+    return true;
+}
+
+/**
+ * @brief Inline calls inside an expression
+ *
+ * @param node      Root of expression AST
+ * @return ASTNode* Expression AST with calls inlined
+ */
+static ASTNode* inline_expression(ASTNode* node)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        node->function_call_arguments[i] = inline_expression(node->function_call_arguments[i]);
+    }
+
+    node->left = inline_expression(node->left);
+    node->mid = inline_expression(node->mid);
+    node->right = inline_expression(node->right);
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        return inline_call_expression(node);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Inline calls inside a statement
+ *
+ * @param node      Root of statement AST
+ * @return ASTNode* Statement AST with calls inlined
+ */
+static ASTNode* inline_statement(ASTNode* node)
+{
+    ASTNode** call = NULL;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    switch (node->ttype) {
+    case T_AST_GLUE:
+        node->left = inline_statement(node->left);
+        node->mid = inline_statement(node->mid);
+        node->right = inline_statement(node->right);
+        return node;
+    case T_IF:
+        node->left = inline_expression(node->left);
+        node->mid = inline_statement(node->mid);
+        node->right = inline_statement(node->right);
+        return node;
+    case T_WHILE:
+        node->left = inline_expression(node->left);
+        node->mid = inline_statement(node->mid);
+        if (node->right) {
+            // For loop postamble, then the else body
+            node->right->left = inline_statement(node->right->left);
+            node->right->right = inline_statement(node->right->right);
+        }
+        return node;
+    case T_FUNCTION_CALL:
+        call = &node;
+        break;
+    case T_ASSIGN:
+    case T_PRINT:
+        // Only the assigned or first printed value may have its callee inlined as statements
+        // before the assignment or print
+        node->right = inline_expression(node->right);
+        // Fall through
+    case T_RETURN:
+        if (node->left && node->left->ttype == T_FUNCTION_CALL) {
+            call = &node->left;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (call == NULL) {
+        return inline_expression(node);
+    }
+
+    for (unsigned long long int i = 0; i < (*call)->num_args; i++) {
+        (*call)->function_call_arguments[i] =
+            inline_expression((*call)->function_call_arguments[i]);
+    }
+
+    ASTNode* inlined;
+    return inline_call_statement(node, call, &inlined) ? inlined : inline_expression(node);
+}
+
+/**
+ * @brief Substitute the bodies of small, non-recursive functions at their call sites. Functions
+ * declared "inline" are inlined regardless of size, and functions declared "noinline" never are
+ *
+ * @param program Whole program, whose functions are inlined into in declaration order so that
+ * callees have already been inlined into when they are inlined
+ */
+void inline_functions(ParsedProgram* program)
+{
+    inline_program = program;
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        inline_caller = &program->functions[i];
+        if (inline_caller->root == NULL) {
+            continue;
+        }
+
+        push_existing_symbol_table(D_SYMBOL_TABLE_STACK, inline_caller->scope);
+
+        inline_caller->root->left = inline_statement(inline_caller->root->left);
+        if (D_ARGS->const_expr_reduce || D_ARGS->const_propagate) {
+            inline_caller->root = fold_constants(inline_caller->root);
+        }
+
+        pop_symbol_table(D_SYMBOL_TABLE_STACK);
+    }
+
+    inline_program = NULL;
+    inline_caller = NULL;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file range.c
+ * @author Charles Averill
+ * @brief Flow-insensitive analysis of the ranges of values stored to variables
+ * @date 19-Oct-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**
+ * @brief Find the bounds of a variable
+ *
+ * @param ranges            Bounded variables to search
+ * @param variable          Variable to look for
+ * @return VariableRange*   Bounds of variable, or NULL if it isn't bounded
+ */
+static VariableRange* find_range(VariableRanges* ranges, SymbolTableEntry* variable)
+{
+    for (unsigned long long int i = 0; i < ranges->num_ranges; i++) {
+        if (ranges->ranges[i].variable == variable) {
+            return &ranges->ranges[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Start bounding a variable
+ *
+ * @param ranges    Bounded variables to add to
+ * @param variable  Variable to bound
+ * @param type      Type of variable's values
+ * @param initial   Value the variable holds before anything is stored to it, or NULL if it has none
+ */
+static void add_range(VariableRanges* ranges, SymbolTableEntry* variable, NumberType type,
+                      long long int* initial)
+{
+    if (find_range(ranges, variable)) {
+        return;
+    }
+
+    if (ranges->num_ranges >= ranges->capacity) {
+        ranges->capacity = ranges->capacity ? ranges->capacity * 2 : 16;
+        ranges->ranges =
+            (VariableRange*)tracked_realloc(MEMORY_PARSER, ranges->ranges,
+                                            sizeof(VariableRange) * ranges->capacity);
+        if (ranges->ranges == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for range analysis");
+        }
+    }
+
+    ranges->ranges[ranges->num_ranges++] = (VariableRange){
+        .variable = variable,
+        .type = type,
+        .is_empty = initial == NULL,
+        .range = initial ? (ValueRange){.min = *initial, .max = *initial} : (ValueRange){0, 0},
+        .num_widenings = 0};
+}
+
+/**
+ * @brief Stop bounding a variable
+ *
+ * @param ranges    Bounded variables to remove from
+ * @param variable  Variable that may hold any value of its type
+ */
+static void remove_range(VariableRanges* ranges, SymbolTableEntry* variable)
+{
+    VariableRange* range = find_range(ranges, variable);
+    if (range) {
+        *range = ranges->ranges[--ranges->num_ranges];
+    }
+}
+
+/**
+ * @brief Get the range of an expression whose value isn't known
+ *
+ * @return ExpressionRange Every 64-bit value, which contains the value of any expression
+ */
+static ExpressionRange unknown_range(void)
+{
+    return (ExpressionRange){.type = NT_INT64, .range = number_type_range(NT_INT64)};
+}
+
+/**
+ * @brief Get the range of a variable that isn't bounded
+ *
+ * @param variable          Variable to get the range of
+ * @return ExpressionRange  Every value of variable's type, or unknown_range if it isn't a number
+ */
+static ExpressionRange unbounded_variable_range(SymbolTableEntry* variable)
+{
+    if (variable == NULL || variable->type.is_function) {
+        return unknown_range();
+    }
+
+    // Globals are stored as pointers to their values, locals are not
+    Number number = variable->type.value.number;
+    if (number.pointer_depth - (variable == GST_FIND(variable->symbol_name)) != 0) {
+        return unknown_range();
+    }
+
+    return (ExpressionRange){.type = number.number_type,
+                             .range = number_type_range(number.number_type)};
+}
+
+/**
+ * @brief Compute the range of an expression's value from the current bounds of the variables it
+ * reads. The scope of the function containing node must be on top of the Symbol Table Stack
+ *
+ * @param node      Root of expression AST
+ * @param ranges    Current bounds of variables
+ * @param out       Filled with the range of node's value
+ * @return bool     False if node reads a variable that nothing has been stored to yet
+ */
+static bool expression_range(ASTNode* node, VariableRanges* ranges, ExpressionRange* out)
+{
+    ExpressionRange left, right;
+    VariableRange* variable;
+
+    if (node == NULL) {
+        *out = unknown_range();
+        return true;
+    }
+
+    if (TOKENTYPE_IS_LITERAL(node->ttype)) {
+        out->type = token_type_to_number_type(node->ttype);
+        out->range = (ValueRange){.min = node->value.number_value, .max = node->value.number_value};
+        return true;
+    } else if (TOKENTYPE_IS_COMPARATOR(node->ttype) ||
+               TOKENTYPE_IS_LOGICAL_OPERATOR(node->ttype)) {
+        *out = (ExpressionRange){.type = NT_INT1, .range = number_type_range(NT_INT1)};
+        return true;
+    } else if (TOKENTYPE_IS_BINARY_ARITHMETIC(node->ttype)) {
+        if (!expression_range(node->left, ranges, &left) ||
+            !expression_range(node->right, ranges, &right)) {
+            return false;
+        }
+
+        // Operands are widened to the larger of their types, which the result may wrap around in
+        out->type = MAX(left.type, right.type);
+        if (!range_arithmetic(node->ttype, left.range, right.range, &out->range) ||
+            !range_fits_number_type(out->range, out->type)) {
+            out->range = number_type_range(out->type);
+        }
+        return true;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+        variable = find_range(ranges, STS_FIND(node->value.symbol_name));
+        if (variable == NULL) {
+            *out = unbounded_variable_range(STS_FIND(node->value.symbol_name));
+            return true;
+        } else if (variable->is_empty) {
+            return false;
+        }
+
+        *out = (ExpressionRange){.type = variable->type, .range = variable->range};
+        return true;
+    case T_FUNCTION_CALL:;
+        SymbolTableEntry* function = GST_FIND(node->value.symbol_name);
+        if (function == NULL || function->type.value.function.return_type == T_VOID) {
+            *out = unknown_range();
+            return true;
+        }
+
+        out->type = token_type_to_number_type(function->type.value.function.return_type);
+        out->range = number_type_range(out->type);
+        return true;
+    default:
+        *out = unknown_range();
+        return true;
+    }
+}
+
+/**
+ * @brief Widen the bounds of a variable to contain a value stored to it
+ *
+ * @param range Bounds of variable
+ * @param value Range of the stored value, which is resized to the variable's type
+ * @return bool True if the bounds grew
+ */
+static bool store_range(VariableRange* range, ExpressionRange value)
+{
+    ValueRange stored = range_fits_number_type(value.range, range->type)
+                            ? value.range
+                            : number_type_range(range->type);
+
+    if (range->is_empty) {
+        range->is_empty = false;
+        range->range = stored;
+        return true;
+    }
+
+    ValueRange grown = range_union(range->range, stored);
+    if (grown.min == range->range.min && grown.max == range->range.max) {
+        return false;
+    }
+
+    range->range = ++range->num_widenings > PURPLE_RANGE_WIDENING_LIMIT
+                       ? number_type_range(range->type)
+                       : grown;
+    return true;
+}
+
+/**
+ * @brief Widen the bounds of every variable stored to by an AST, including the parameters of
+ * called functions. The scope of the function containing node must be on top of the Symbol Table
+ * Stack
+ *
+ * @param program   Program containing callees
+ * @param node      Root of AST
+ * @param ranges    Current bounds of variables
+ * @return bool     True if any bounds grew
+ */
+static bool record_stores(ParsedProgram* program, ASTNode* node, VariableRanges* ranges)
+{
+    ExpressionRange value;
+    VariableRange* variable;
+    bool changed = false;
+
+    if (node == NULL) {
+        return false;
+    }
+
+    if (node->ttype == T_ASSIGN && node->right && node->right->ttype == T_IDENTIFIER &&
+        (variable = find_range(ranges, STS_FIND(node->right->value.symbol_name))) &&
+        expression_range(node->left, ranges, &value)) {
+        changed |= store_range(variable, value);
+    } else if (node->ttype == T_FUNCTION_CALL) {
+        ParsedFunction* callee = find_parsed_function(program, node->value.symbol_name);
+        Function* function = &GST_FIND(node->value.symbol_name)->type.value.function;
+
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            // Arguments are stored to the callee's parameters
+            if (callee && i < function->num_parameters &&
+                (variable = find_range(ranges, find_symbol_table_entry(
+                                                   callee->scope,
+                                                   function->parameters[i].parameter_name))) &&
+                expression_range(node->function_call_arguments[i], ranges, &value)) {
+                changed |= store_range(variable, value);
+            }
+
+            changed |= record_stores(program, node->function_call_arguments[i], ranges);
+        }
+    }
+
+    changed |= record_stores(program, node->left, ranges);
+    changed |= record_stores(program, node->mid, ranges);
+    changed |= record_stores(program, node->right, ranges);
+    return changed;
+}
+
+/**
+ * @brief Stop bounding every variable whose address is taken in an AST, since it may be stored to
+ * through a pointer. The scope of the function containing node must be on top of the Symbol Table
+ * Stack
+ *
+ * @param node      Root of AST
+ * @param ranges    Bounded variables to remove from
+ */
+static void remove_addressed_variables(ASTNode* node, VariableRanges* ranges)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->ttype == T_AMPERSAND) {
+        remove_range(ranges, STS_FIND(node->value.symbol_name));
+    } else if (node->ttype == T_FUNCTION_CALL) {
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            remove_addressed_variables(node->function_call_arguments[i], ranges);
+        }
+    }
+
+    remove_addressed_variables(node->left, ranges);
+    remove_addressed_variables(node->mid, ranges);
+    remove_addressed_variables(node->right, ranges);
+}
+
+/**
+ * @brief Bound the global variables, and the parameters of functions only called from within the
+ * program, that may only hold some of the values of their types. The bounds are stored in the
+ * variables' Symbol Table Entries so that loads of them can be given !range metadata, and so that
+ * arithmetic on them can be narrowed and given overflow flags
+ *
+ * @param program Whole program
+ */
+void infer_variable_ranges(ParsedProgram* program)
+{
+    VariableRanges ranges = {.ranges = NULL, .num_ranges = 0, .capacity = 0};
+
+    // Globals start out holding the value they are declared with
+    for (unsigned long int i = 0; i < D_GLOBAL_SYMBOL_TABLE->total_buckets; i++) {
+        for (SymbolTableEntry* entry = D_GLOBAL_SYMBOL_TABLE->buckets[i]; entry;
+             entry = entry->next) {
+            if (!entry->type.is_function && entry->type.value.number.pointer_depth == 1) {
+                add_range(&ranges, entry, entry->type.value.number.number_type,
+                          &entry->type.value.number.value);
+            }
+        }
+    }
+
+    // Parameters only hold the arguments they are passed
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        ParsedFunction* function = &program->functions[i];
+        if (function->root == NULL) {
+            continue;
+        }
+
+        Function* type = &GST_FIND(function->root->value.symbol_name)->type.value.function;
+        for (unsigned long long int p = 0; type->is_internal && p < type->num_parameters; p++) {
+            if (type->parameters[p].parameter_type.pointer_depth == 0) {
+                add_range(&ranges,
+                          find_symbol_table_entry(function->scope,
+                                                  type->parameters[p].parameter_name),
+                          type->parameters[p].parameter_type.number_type, NULL);
+            }
+        }
+    }
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        if (program->functions[i].root) {
+            push_existing_symbol_table(D_SYMBOL_TABLE_STACK, program->functions[i].scope);
+            remove_addressed_variables(program->functions[i].root->left, &ranges);
+            pop_symbol_table(D_SYMBOL_TABLE_STACK);
+        }
+    }
+
+    // Storing to a variable may widen the values stored to others, so repeat until none change
+    bool changed;
+    do {
+        changed = false;
+        for (unsigned long long int i = 0; i < program->num_functions; i++) {
+            if (program->functions[i].root) {
+                push_existing_symbol_table(D_SYMBOL_TABLE_STACK, program->functions[i].scope);
+                changed |= record_stores(program, program->functions[i].root->left, &ranges);
+                pop_symbol_table(D_SYMBOL_TABLE_STACK);
+            }
+        }
+    } while (changed);
+
+    for (unsigned long long int i = 0; i < ranges.num_ranges; i++) {
+        VariableRange* range = &ranges.ranges[i];
+        ValueRange full = number_type_range(range->type);
+        range->variable->has_range = !range->is_empty && (range->range.min != full.min ||
+                                                          range->range.max != full.max);
+        range->variable->range = range->range;
+
+        if (range->variable->has_range) {
+            purple_log(LOG_DEBUG, "Variable \"%s\" is within [%lld, %lld]",
+                       range->variable->symbol_name, range->range.min, range->range.max);
+        }
+    }
+
+    tracked_free(ranges.ranges);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file tail_call.c
+ * @author Charles Averill
+ * @brief Detection of calls in tail position, and of self-recursion that can be turned into a loop
+ * @date 19-Oct-2026
+ */
+
+#include <string.h>
+
+#include "data.h"
+#include "optimize.h"
+
+/**
+ * @brief Determine if an AST node is a call to a given function
+ *
+ * @param node          AST node to check
+ * @param function_name Name of function
+ * @return bool         True if node calls function_name
+ */
+static bool is_call_to(ASTNode* node, char* function_name)
+{
+    return node != NULL && node->ttype == T_FUNCTION_CALL &&
+           !strcmp(node->value.symbol_name, function_name);
+}
+
+/**
+ * @brief Determine if the value of an expression can't be changed by a call
+ *
+ * @param node  Root of expression AST
+ * @return bool True if node only reads literals and parameters
+ */
+static bool reads_only_parameters(ASTNode* node)
+{
+    if (node == NULL) {
+        return true;
+    }
+
+    switch (node->ttype) {
+    case T_IDENTIFIER:
+        return STS_FIND(node->value.symbol_name) != GST_FIND(node->value.symbol_name);
+    case T_FUNCTION_CALL:
+    case T_ASSIGN:
+    case T_DEREFERENCE:
+    case T_AMPERSAND:
+        return false;
+    default:
+        return reads_only_parameters(node->left) && reads_only_parameters(node->mid) &&
+               reads_only_parameters(node->right);
+    }
+}
+
+/**
+ * @brief Determine if a function's parameters are only ever read and written directly. Any
+ * parameter whose address is taken lives in the caller's stack frame, which a tail call may not
+ * access and which a loop would share between recursive calls
+ *
+ * @param node  Root of function body AST
+ * @return bool True if no address of a parameter is taken in node
+ */
+static bool parameters_stay_in_registers(ASTNode* node)
+{
+    if (node == NULL) {
+        return true;
+    }
+
+    if (node->ttype == T_AMPERSAND &&
+        STS_FIND(node->value.symbol_name) != GST_FIND(node->value.symbol_name)) {
+        return false;
+    }
+
+    if (node->ttype == T_FUNCTION_CALL) {
+        for (unsigned long long int i = 0; i < node->num_args; i++) {
+            if (!parameters_stay_in_registers(node->function_call_arguments[i])) {
+                return false;
+            }
+        }
+    }
+
+    return parameters_stay_in_registers(node->left) && parameters_stay_in_registers(node->mid) &&
+           parameters_stay_in_registers(node->right);
+}
+
+/**
+ * @brief Mark the call returned by a return statement, or the self-recursive call of an
+ * accumulating return statement, as a tail call
+ *
+ * @param node          Return statement AST node
+ * @param function      Function containing node
+ * @param recursion     Self-recursion found so far
+ */
+static void mark_tail_return(ASTNode* node, SymbolTableEntry* function, TailRecursion* recursion)
+{
+    ASTNode* value = node->left;
+    if (value == NULL) {
+        return;
+    }
+
+    if (value->ttype == T_FUNCTION_CALL) {
+        value->is_tail_call = true;
+        if (is_call_to(value, function->symbol_name)) {
+            recursion->is_tail_recursive = true;
+        }
+        return;
+    }
+
+    // return e + f(...) becomes accumulator = accumulator + e, which only holds for associative and
+    // commutative operations. Every accumulating return must use the same operation
+    if ((value->ttype != T_PLUS && value->ttype != T_STAR) ||
+        function->type.value.function.return_type == T_VOID ||
+        (recursion->accumulator_operation != T_EOF &&
+         recursion->accumulator_operation != value->ttype)) {
+        return;
+    }
+
+    ASTNode* call;
+    if (is_call_to(value->right, function->symbol_name)) {
+        // e is evaluated before the call, and the loop evaluates it before the next iteration
+        call = value->right;
+    } else if (is_call_to(value->left, function->symbol_name) &&
+               reads_only_parameters(value->right)) {
+        // e is evaluated after the call, so the recursion must not be able to change it
+        call = value->left;
+    } else {
+        return;
+    }
+
+    call->is_tail_call = true;
+    recursion->is_tail_recursive = true;
+    recursion->accumulator_operation = value->ttype;
+}
+
+/**
+ * @brief Mark calls in tail position within a statement
+ *
+ * @param node          Root of statement AST
+ * @param is_last       Whether or not the function returns once node is done
+ * @param function      Function containing node
+ * @param recursion     Self-recursion found so far
+ */
+static void mark_tail_statements(ASTNode* node, bool is_last, SymbolTableEntry* function,
+                                 TailRecursion* recursion)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->ttype) {
+    case T_RETURN:
+        mark_tail_return(node, function, recursion);
+        return;
+    case T_AST_GLUE:
+        mark_tail_statements(node->left, is_last && !node->mid && !node->right, function,
+                             recursion);
+        mark_tail_statements(node->mid, is_last && !node->right, function, recursion);
+        mark_tail_statements(node->right, is_last, function, recursion);
+        return;
+    case T_IF:
+        mark_tail_statements(node->mid, is_last, function, recursion);
+        mark_tail_statements(node->right, is_last, function, recursion);
+        return;
+    case T_WHILE:
+        // The body is followed by another check of the condition, but returns may still be in it
+        mark_tail_statements(node->mid, false, function, recursion);
+        if (node->right) {
+            mark_tail_statements(node->right->left, false, function, recursion);
+            mark_tail_statements(node->right->right, is_last, function, recursion);
+        }
+        return;
+    case T_FUNCTION_CALL:
+        // A void function may end with a call whose value is discarded
+        if (is_last && function->type.value.function.return_type == T_VOID) {
+            node->is_tail_call = true;
+            if (is_call_to(node, function->symbol_name)) {
+                recursion->is_tail_recursive = true;
+            }
+        }
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * @brief Mark every call in a function that is the last thing the function does before
+ * returning, and determine if its self-recursive calls can be replaced by jumps back to its
+ * entry. The function's scope must be on top of the Symbol Table Stack
+ *
+ * @param function_root     Function declaration AST
+ * @return TailRecursion    How the function's self-recursive tail calls may be turned into a loop
+ */
+TailRecursion mark_tail_calls(ASTNode* function_root)
+{
+    TailRecursion recursion = {.is_tail_recursive = false, .accumulator_operation = T_EOF};
+
+    if (!parameters_stay_in_registers(function_root->left)) {
+        return recursion;
+    }
+
+    mark_tail_statements(function_root->left, true, GST_FIND(function_root->value.symbol_name),
+                         &recursion);
+
+    return recursion;
+}
@@ -11,6 +11,7 @@
 #include "parse.h"
 #include "translate/llvm.h"
 #include "translate/symbol_table.h"
+#include "utils/memory.h"
 
 /**
  * @brief Parse a variable declaration statement into an AST
@@ -32,18 +33,65 @@ void variable_declaration(void)
         fatal(RC_COMPILER_ERROR, "Failed to insert symbol '%s' into Global Symbol Table",
               D_IDENTIFIER_BUFFER);
     }
-    llvm_declare_global_number_variable(D_IDENTIFIER_BUFFER, n);
 }
 
 /**
- * @brief Parse a function declaration statement into an AST
+ * @brief Determine if two declarations of a function have the same prototype
+ *
+ * @param a     First declaration
+ * @param b     Second declaration
+ * @return bool True if a and b return the same type and take the same parameter types
+ */
+static bool prototypes_match(Function* a, Function* b)
+{
+    if (a->return_type != b->return_type || a->num_parameters != b->num_parameters) {
+        return false;
+    }
+
+    for (unsigned long long int i = 0; i < a->num_parameters; i++) {
+        if (!NUMBERS_TYPEQUIV(a->parameters[i].parameter_type, b->parameters[i].parameter_type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse a function declaration statement into an AST. A declaration ending in a semicolon
+ * rather than a body is a prototype of a function defined in another file
  * 
- * @return ASTNode* 
+ * @return ASTNode* AST of the function, or NULL if it is a prototype
  */
 ASTNode* function_declaration(void)
 {
     ASTNode* out;
     SymbolTableEntry* entry;
+    bool is_exported = false;
+    InlineHint inline_hint = INLINE_DEFAULT;
+    bool is_cold = false;
+
+    // Function specifiers may come in any order before the return type
+    while (!TOKENTYPE_IS_TYPE(D_GLOBAL_TOKEN.token_type)) {
+        switch (D_GLOBAL_TOKEN.token_type) {
+        case T_EXPORT:
+            is_exported = true;
+            break;
+        case T_INLINE:
+            inline_hint = INLINE_ALWAYS;
+            break;
+        case T_NOINLINE:
+            inline_hint = INLINE_NEVER;
+            break;
+        case T_COLD:
+            is_cold = true;
+            break;
+        default:
+            syntax_error(0, 0, 0, "Expected function specifier or return type but got \"%s\"",
+                         tokenStrings[D_GLOBAL_TOKEN.token_type]);
+        }
+        scan();
+    }
 
     TokenType function_return_type = check_for_type();
     match_token(T_IDENTIFIER);
@@ -56,14 +104,26 @@ ASTNode* function_declaration(void)
 
     // The TYPE_VOID is later overwritten by function_type
     Type function_type = TYPE_FUNCTION(function_return_type, 0, 0);
-    entry = GST_INSERT(D_IDENTIFIER_BUFFER, TYPE_VOID);
+    function_type.value.function.is_exported = is_exported;
+    function_type.value.function.inline_hint = inline_hint;
+    function_type.value.function.is_cold = is_cold;
+
+    // A function may be defined after a prototype has declared it
+    entry = GST_FIND(D_IDENTIFIER_BUFFER);
+    Function* prototype = NULL;
+    if (entry && entry->type.is_function && entry->type.value.function.is_external) {
+        prototype = &entry->type.value.function;
+    } else {
+        entry = GST_INSERT(D_IDENTIFIER_BUFFER, TYPE_VOID);
+    }
 
     match_token(T_LEFT_PAREN);
 
     unsigned long long int parameters_size = 32;
     int num_inputs = 0;
     FunctionParameter* parameters =
-        (FunctionParameter*)malloc(sizeof(FunctionParameter) * parameters_size);
+        (FunctionParameter*)tracked_malloc(MEMORY_PARSER,
+                                           sizeof(FunctionParameter) * parameters_size);
     while (D_GLOBAL_TOKEN.token_type != T_RIGHT_PAREN) {
         Number param_type;
         if (match_type(&param_type) == 1) {
@@ -71,11 +131,14 @@ ASTNode* function_declaration(void)
         }
         // param_type.pointer_depth++;
 
-        parameters[num_inputs].parameter_type = param_type;
         if (num_inputs >= parameters_size) {
             parameters_size *= 2;
-            parameters = (FunctionParameter*)realloc(parameters, parameters_size);
+            parameters = (FunctionParameter*)tracked_realloc(MEMORY_PARSER, parameters,
+                                                     sizeof(FunctionParameter) * parameters_size);
         }
+        parameters[num_inputs].parameter_type = param_type;
+        parameters[num_inputs].is_nonnull = false;
+        parameters[num_inputs].is_noalias = false;
 
         num_inputs++;
         function_type.value.function.num_parameters++;
@@ -86,13 +149,33 @@ ASTNode* function_declaration(void)
         // TODO : Locals
         STS_INSERT(D_IDENTIFIER_BUFFER, TYPE_NUMBER_FROM_NUMBERTYPE_FROM_NUMBER(param_type));
         // llvm_declare_global_number_variable(D_IDENTIFIER_BUFFER, param_type);
+
+        if (D_GLOBAL_TOKEN.token_type != T_RIGHT_PAREN) {
+            match_token(T_COMMA);
+        }
     }
 
     function_type.value.function.parameters = parameters;
-    entry->type = function_type;
 
     match_token(T_RIGHT_PAREN);
 
+    if (prototype) {
+        if (!prototypes_match(prototype, &function_type.value.function)) {
+            identifier_error(0, 0, 0, "Declaration of \"%s\" does not match its prototype",
+                             entry->symbol_name);
+        }
+        tracked_free(prototype->parameters);
+    }
+
+    if (D_GLOBAL_TOKEN.token_type == T_SEMICOLON) {
+        scan();
+        function_type.value.function.is_external = true;
+        entry->type = function_type;
+        return NULL;
+    }
+
+    entry->type = function_type;
+
     out = parse_statements();
 
     out =
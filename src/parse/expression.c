@@ -7,6 +7,7 @@
 
 #include "data.h"
 #include "parse.h"
+#include "utils/memory.h"
 
 /**
  * @brief Get the integer operator precedence value of a Token
@@ -144,8 +145,8 @@ ASTNode* function_call_expression(void)
     }
 
     match_token(T_LEFT_PAREN);
-    ASTNode** passed_args =
-        (ASTNode**)malloc(sizeof(ASTNode*) * found_entry->type.value.function.num_parameters);
+    ASTNode** passed_args = (ASTNode**)tracked_malloc(
+        MEMORY_PARSER, sizeof(ASTNode*) * found_entry->type.value.function.num_parameters);
     for (int i = 0; i < found_entry->type.value.function.num_parameters; i++) {
         passed_args[i] = parse_binary_expression();
         if (i != found_entry->type.value.function.num_parameters - 1) {
@@ -158,6 +159,7 @@ ASTNode* function_call_expression(void)
     root =
         create_unary_ast_node(T_FUNCTION_CALL, NULL, found_entry->type, found_entry->symbol_name);
     root->function_call_arguments = passed_args;
+    root->num_args = found_entry->type.value.function.num_parameters;
     root->tree_type.number_type =
         token_type_to_number_type(found_entry->type.value.function.return_type);
     add_position_info(root, ident_pos);
@@ -184,7 +186,8 @@ static ASTNode* parse_binary_expression_recursive(int previous_token_precedence,
     *nt_max = MAX(*nt_max, left->tree_type.number_type);
     add_position_info(left, pre_pos);
     current_ttype = D_GLOBAL_TOKEN.token_type;
-    if (current_ttype == T_SEMICOLON || current_ttype == T_RIGHT_PAREN) {
+    if (current_ttype == T_SEMICOLON || current_ttype == T_RIGHT_PAREN ||
+        current_ttype == T_COMMA) {
         left->is_rvalue = true;
         return left;
     }
@@ -218,7 +221,8 @@ static ASTNode* parse_binary_expression_recursive(int previous_token_precedence,
 
         // Update current_ttype and check for EOF
         current_ttype = D_GLOBAL_TOKEN.token_type;
-        if (current_ttype == T_SEMICOLON || current_ttype == T_RIGHT_PAREN) {
+        if (current_ttype == T_SEMICOLON || current_ttype == T_RIGHT_PAREN ||
+            current_ttype == T_COMMA) {
             left->is_rvalue = true;
             return left;
         }
@@ -55,7 +55,7 @@ int match_type(Number* out)
     D_SCANNING_TYPE = true;
 
     TokenType ttype =
-        match_tokens((TokenType[]){T_VOID, T_BOOL, T_CHAR, T_SHORT, T_INT, T_LONG}, 7);
+        match_tokens((TokenType[]){T_VOID, T_BOOL, T_CHAR, T_SHORT, T_INT, T_LONG}, 6);
 
     int pointer_depth;
     for (pointer_depth = 0;
@@ -94,13 +94,15 @@ TokenType check_for_type(void)
 }
 
 /**
- * @brief Parse a print statement into an AST
+ * @brief Parse a print statement into an AST. Each value after the first is the left child of a
+ * print node to the right of the previous value's
  * 
  * @return ASTNode* AST for print statement
  */
 static ASTNode* print_statement(void)
 {
     ASTNode* root;
+    ASTNode* last;
 
     purple_log(LOG_DEBUG, "Parsing print statement");
 
@@ -113,6 +115,17 @@ static ASTNode* print_statement(void)
     root = create_unary_ast_node(T_PRINT, root, TYPE_VOID, NULL);
     add_position_info(root, print_position);
 
+    // Parse any further values, which are printed on the same line
+    last = root;
+    while (D_GLOBAL_TOKEN.token_type == T_COMMA) {
+        match_token(T_COMMA);
+        position value_position = D_GLOBAL_TOKEN.pos;
+
+        last->right = create_unary_ast_node(T_PRINT, parse_binary_expression(), TYPE_VOID, NULL);
+        last = last->right;
+        add_position_info(last, value_position);
+    }
+
     return root;
 }
 
@@ -158,6 +171,37 @@ static ASTNode* assignment_statement(void)
     return root;
 }
 
+/**
+ * @brief Parse the condition of a branch or loop, which may be wrapped in "likely" or "unlikely",
+ * into an AST
+ * 
+ * @return ASTNode* AST for condition
+ */
+static ASTNode* condition_expression(void)
+{
+    ASTNode* condition;
+    BranchHint hint = BRANCH_HINT_NONE;
+
+    if (D_GLOBAL_TOKEN.token_type == T_LIKELY || D_GLOBAL_TOKEN.token_type == T_UNLIKELY) {
+        hint = D_GLOBAL_TOKEN.token_type == T_LIKELY ? BRANCH_HINT_LIKELY : BRANCH_HINT_UNLIKELY;
+        scan();
+        match_token(T_LEFT_PAREN);
+    }
+
+    condition = parse_binary_expression();
+    if (!TOKENTYPE_IS_COMPARATOR(condition->ttype) &&
+        !TOKENTYPE_IS_LOGICAL_OPERATOR(condition->ttype)) {
+        syntax_error(0, 0, 0, "Condition clauses must use a logical or comparison operator");
+    }
+
+    if (hint != BRANCH_HINT_NONE) {
+        match_token(T_RIGHT_PAREN);
+    }
+
+    condition->branch_hint = hint;
+    return condition;
+}
+
 /**
  * @brief Parse an if statement into an AST
  * 
@@ -174,14 +218,9 @@ static ASTNode* if_statement(void)
     match_token(T_IF);
     match_token(T_LEFT_PAREN);
 
-    condition = parse_binary_expression();
+    condition = condition_expression();
     position condition_pos = D_GLOBAL_TOKEN.pos;
 
-    if (!TOKENTYPE_IS_COMPARATOR(condition->ttype) &&
-        !TOKENTYPE_IS_LOGICAL_OPERATOR(condition->ttype)) {
-        syntax_error(0, 0, 0, "Condition clauses must use a logical or comparison operator");
-    }
-
     match_token(T_RIGHT_PAREN);
 
     true_branch = parse_statements();
@@ -213,14 +252,9 @@ static ASTNode* while_statement(void)
     match_token(T_WHILE);
     match_token(T_LEFT_PAREN);
 
-    condition = parse_binary_expression();
+    condition = condition_expression();
     position condition_pos = D_GLOBAL_TOKEN.pos;
 
-    if (!TOKENTYPE_IS_COMPARATOR(condition->ttype) &&
-        !TOKENTYPE_IS_LOGICAL_OPERATOR(condition->ttype)) {
-        syntax_error(0, 0, 0, "Condition clauses must use a logical or comparison operator");
-    }
-
     match_token(T_RIGHT_PAREN);
 
     body = parse_statements();
@@ -230,6 +264,9 @@ static ASTNode* while_statement(void)
 
         match_token(T_ELSE);
         else_body = parse_statements();
+        // Loops always keep their else body in the right child of a glue node, so that an else
+        // body of several statements is not mistaken for a for loop's postamble
+        else_body = create_ast_node(T_AST_GLUE, NULL, NULL, else_body, TYPE_VOID, NULL);
     }
 
     condition = create_ast_node(T_WHILE, condition, body, else_body, TYPE_VOID, NULL);
@@ -262,11 +299,7 @@ static ASTNode* for_statement(void)
 
     match_token(T_SEMICOLON);
 
-    condition = parse_binary_expression();
-    if (!TOKENTYPE_IS_COMPARATOR(condition->ttype) &&
-        !TOKENTYPE_IS_LOGICAL_OPERATOR(condition->ttype)) {
-        syntax_error(0, 0, 0, "Condition clauses must use a logical or comparison operator");
-    }
+    condition = condition_expression();
 
     match_token(T_SEMICOLON);
 
@@ -290,6 +323,72 @@ static ASTNode* for_statement(void)
     return out;
 }
 
+/**
+ * @brief Parse a loop preceded by hints for LLVM's loop optimizations into an AST
+ * 
+ * @return ASTNode* AST for the hinted while or for statement
+ */
+static ASTNode* hinted_loop_statement(void)
+{
+    int loop_hints = 0;
+    int unroll_count = 0;
+    ASTNode* out;
+    ASTNode* loop;
+
+    purple_log(LOG_DEBUG, "Parsing loop hints");
+
+    // Loop specifiers may come in any order before the loop
+    while (D_GLOBAL_TOKEN.token_type != T_WHILE && D_GLOBAL_TOKEN.token_type != T_FOR) {
+        switch (D_GLOBAL_TOKEN.token_type) {
+        case T_UNROLL:
+            loop_hints |= LOOP_HINT_UNROLL;
+            scan();
+            if (D_GLOBAL_TOKEN.token_type != T_LEFT_PAREN) {
+                continue;
+            }
+
+            match_token(T_LEFT_PAREN);
+            if (!TOKENTYPE_IS_LITERAL(D_GLOBAL_TOKEN.token_type) ||
+                TOKENTYPE_IS_BOOL_LITERAL(D_GLOBAL_TOKEN.token_type) ||
+                D_GLOBAL_TOKEN.value.number_value.value < 1 ||
+                D_GLOBAL_TOKEN.value.number_value.value > INT_MAX) {
+                syntax_error(0, 0, 0, "Unroll count must be a positive integer literal");
+            }
+            unroll_count = D_GLOBAL_TOKEN.value.number_value.value;
+            scan();
+            match_token(T_RIGHT_PAREN);
+            continue;
+        case T_NOUNROLL:
+            loop_hints |= LOOP_HINT_NOUNROLL;
+            break;
+        case T_VECTORIZE:
+            loop_hints |= LOOP_HINT_VECTORIZE;
+            break;
+        default:
+            syntax_error(0, 0, 0, "Expected loop specifier or loop but got \"%s\"",
+                         tokenStrings[D_GLOBAL_TOKEN.token_type]);
+        }
+        scan();
+    }
+
+    if ((loop_hints & LOOP_HINT_UNROLL) && (loop_hints & LOOP_HINT_NOUNROLL)) {
+        syntax_error(0, 0, 0, "Loops cannot be both \"%s\" and \"%s\"", tokenStrings[T_UNROLL],
+                     tokenStrings[T_NOUNROLL]);
+    }
+
+    // For loops are glued after their preamble
+    if (D_GLOBAL_TOKEN.token_type == T_WHILE) {
+        out = loop = while_statement();
+    } else {
+        out = for_statement();
+        loop = out->right;
+    }
+
+    loop->loop_hints = loop_hints;
+    loop->loop_unroll_count = unroll_count;
+    return out;
+}
+
 static ASTNode* return_statement(void)
 {
     ASTNode* out;
@@ -356,6 +455,12 @@ ASTNode* parse_statements(void)
                 root = for_statement();
                 match_semicolon = false;
                 break;
+            case T_UNROLL:
+            case T_NOUNROLL:
+            case T_VECTORIZE:
+                root = hinted_loop_statement();
+                match_semicolon = false;
+                break;
             case T_RIGHT_BRACE:
                 match_token(T_RIGHT_BRACE);
                 return_left = true;
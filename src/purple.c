@@ -6,10 +6,13 @@
  */
 
 #include <ctype.h>
+#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Define, then undef extern_ to transfer ownership to purple.c
 #define extern_
@@ -21,11 +24,16 @@
 #include "translate/symbol_table.h"
 #include "translate/translate.h"
 #include "utils/arguments.h"
+#include "utils/cache.h"
 #include "utils/clang.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/server.h"
+#include "utils/timing.h"
+#include "utils/trace.h"
 
 /**
- * @brief Parse compiler arguments, open input file, and allocate memory 
+ * @brief Parse compiler arguments and allocate memory
  * 
  * @param argc 
  * @param argv 
@@ -35,21 +43,31 @@ static void init(int argc, char* argv[])
     // Argument parsing
     // D_ARGS must be 0-initialized so that default-0 flags don't need to be set
     // in the compiler
-    D_ARGS = calloc(1, sizeof(PurpleArgs));
+    D_ARGS = tracked_calloc(MEMORY_DRIVER, 1, sizeof(PurpleArgs));
     if (D_ARGS == NULL) {
         fatal(RC_MEMORY_ERROR, "Unable to allocate memory for command line arguments");
     }
 
     parse_args(D_ARGS, argc, argv);
 
-    if (D_ARGS->from_command_line_argument != NULL) {
+    purple_log(LOG_DEBUG, "Compiler initialized");
+}
+
+/**
+ * @brief Open a program's input file and set up the Scanner and Symbol Tables to compile it
+ *
+ * @param input_fn Name of program's file, or NULL if the program was passed in as a string
+ */
+static void init_program(char* input_fn)
+{
+    if (input_fn == NULL) {
         D_INPUT_FN = "argument";
         D_INPUT_FILE = tmpfile();
         fwrite(D_ARGS->from_command_line_argument, strlen(D_ARGS->from_command_line_argument), 1,
                D_INPUT_FILE);
         rewind(D_INPUT_FILE);
     } else {
-        D_INPUT_FN = D_ARGS->filenames[0];
+        D_INPUT_FN = input_fn;
         D_INPUT_FILE = fopen(D_INPUT_FN, "r");
         if (D_INPUT_FILE == NULL) {
             fatal(RC_FILE_ERROR, "Unable to open %s: %s", D_INPUT_FN, strerror(errno));
@@ -67,8 +85,331 @@ static void init(int argc, char* argv[])
     // Symbol Tables
     D_SYMBOL_TABLE_STACK = new_nonempty_symbol_table_stack();
     D_GLOBAL_SYMBOL_TABLE = D_SYMBOL_TABLE_STACK->top;
+}
 
-    purple_log(LOG_DEBUG, "Compiler initialized");
+/**
+ * @brief Translate a program into an LLVM file
+ *
+ * @param input_fn  Name of program's file, or NULL if the program was passed in as a string
+ * @param llvm_fn   Name of LLVM file to write
+ */
+static void translate_program(char* input_fn, char* llvm_fn)
+{
+    init_program(input_fn);
+
+    D_LLVM_FN = llvm_fn;
+    generate_llvm();
+
+    close_files();
+
+    time_phase_begin(TIME_PHASE_LINK_GLOBALS);
+    link_globals();
+    time_phase_end(TIME_PHASE_LINK_GLOBALS);
+}
+
+/**
+ * @brief Compile a program file into an object file or a binary, restoring it from the build cache
+ * instead if it was compiled the same way before
+ *
+ * @param input_fn  Name of the program file, or NULL if the program is the command line argument
+ * @param llvm_fn   Name of the LLVM file to write
+ * @param output_fn Name of the object file or binary to write
+ * @param is_binary True if the program file is a whole program, compiled into a binary
+ * @return int      RC_OK, or RC_ERROR if clang failed
+ */
+static int compile_program(char* input_fn, char* llvm_fn, char* output_fn, bool is_binary)
+{
+    trace_begin(input_fn ? input_fn : "argument", "compile", NULL);
+    time_phase_begin(TIME_PHASE_BUILD_CACHE);
+    CacheEntry* entry = input_fn ? cache_entry(input_fn, is_binary) : NULL;
+    bool restored = entry && cache_restore(entry, llvm_fn, output_fn);
+    time_phase_end(TIME_PHASE_BUILD_CACHE);
+    if (restored) {
+        free_cache_entry(entry);
+        trace_end();
+        return RC_OK;
+    }
+
+    translate_program(input_fn, llvm_fn);
+
+    int rc;
+    if (is_binary) {
+        D_ARGS->filenames[2] = output_fn;
+        rc = clang_compile_llvm(llvm_fn) ? RC_ERROR : RC_OK;
+    } else {
+        rc = clang_compile_object(llvm_fn, output_fn) ? RC_ERROR : RC_OK;
+    }
+
+    if (entry && rc == RC_OK) {
+        time_phase_begin(TIME_PHASE_BUILD_CACHE);
+        cache_store(entry, llvm_fn, output_fn);
+        time_phase_end(TIME_PHASE_BUILD_CACHE);
+    }
+    free_cache_entry(entry);
+    trace_end();
+
+    return rc;
+}
+
+/**
+ * @brief Name an output file after an input file, in the current directory
+ *
+ * @param input_fn  Name of input file
+ * @param extension Extension of output file, replacing the input file's extension
+ * @return char*    Name of output file
+ */
+static char* output_filename(const char* input_fn, const char* extension)
+{
+    const char* basename = strrchr(input_fn, '/') ? strrchr(input_fn, '/') + 1 : input_fn;
+    const char* input_extension = strrchr(basename, '.');
+    int stem_length = input_extension ? input_extension - basename : strlen(basename);
+
+    char* out = (char*)tracked_malloc(MEMORY_DRIVER, stem_length + strlen(extension) + 1);
+    if (out == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for output filename");
+    }
+    sprintf(out, "%.*s%s", stem_length, basename, extension);
+
+    return out;
+}
+
+/**
+ * @brief Compile program files, each in a child process since the compiler's state belongs to one
+ * program at a time, with up to D_ARGS->jobs children running at once
+ *
+ * @param input_fns     Names of the program files to compile
+ * @param llvm_fns      Names of the LLVM files to write for each program file
+ * @param output_fns    Names of the object files to write for each program file, or of the binaries
+ *                      if is_binary
+ * @param num_programs  Number of program files
+ * @param is_binary     True if each program file is a whole program, compiled into a binary
+ * @param keep_going    True if the remaining program files are compiled after one fails
+ * @return int          RC_OK, or the return code of the first program file that failed to compile
+ */
+static int compile_programs(char** input_fns, char** llvm_fns, char** output_fns, int num_programs,
+                            bool is_binary, bool keep_going)
+{
+    pid_t* pids = (pid_t*)tracked_malloc(MEMORY_DRIVER, sizeof(pid_t) * (num_programs + 1));
+    if (pids == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for compile processes");
+    }
+
+    // Children inherit what clang says about the target, instead of each asking for it
+    if (num_programs > 1) {
+        clang_cache_target_information();
+    }
+
+    int rc = RC_OK;
+    int next = 0;
+    int running = 0;
+    while (running > 0 || (next < num_programs && (rc == RC_OK || keep_going))) {
+        if (next < num_programs && running < D_ARGS->jobs && (rc == RC_OK || keep_going)) {
+            // Buffered output would otherwise be written again by the child
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+            if (pid < 0) {
+                fatal(RC_ERROR, "Failed to start compiling %s: %s", input_fns[next],
+                      strerror(errno));
+            } else if (pid == 0) {
+                // The child reports only on compiling its own program, and is named after it in the
+                // trace
+                if (D_ARGS->time_report != REPORT_NONE) {
+                    time_report_start(D_ARGS->time_report, input_fns[next]);
+                }
+                if (D_ARGS->memory_report != REPORT_NONE) {
+                    memory_report_start(D_ARGS->memory_report, input_fns[next]);
+                }
+                if (D_ARGS->trace_fn) {
+                    trace_start(D_ARGS->trace_fn, input_fns[next]);
+                }
+                exit(compile_program(input_fns[next], llvm_fns[next], output_fns[next],
+                                     is_binary));
+            }
+
+            pids[next++] = pid;
+            running++;
+            continue;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            fatal(RC_ERROR, "Failed to wait for compiles: %s", strerror(errno));
+        }
+        running--;
+
+        int i = 0;
+        while (i < next && pids[i] != pid) {
+            i++;
+        }
+        if (!WIFEXITED(status)) {
+            purple_log(LOG_ERROR, "Failed to compile %s", input_fns[i]);
+            rc = rc == RC_OK ? RC_ERROR : rc;
+        } else if (WEXITSTATUS(status) != RC_OK && rc == RC_OK) {
+            // The child has already reported the error
+            rc = WEXITSTATUS(status);
+        }
+    }
+
+    tracked_free(pids);
+    return rc;
+}
+
+/**
+ * @brief Compile each program file into its own object file, then link them and any other input
+ * files together unless only compiling
+ */
+static void compile_separately(void)
+{
+    char** link_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    char** program_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    char** llvm_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    char** object_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    int num_link_fns = 0;
+    int num_programs = 0;
+    if (link_fns == NULL || program_fns == NULL || llvm_fns == NULL || object_fns == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for files to link");
+    }
+
+    for (int i = 0; i < D_ARGS->num_input_filenames; i++) {
+        char* input_fn = D_ARGS->input_filenames[i];
+        if (!is_purple_program(input_fn)) {
+            if (D_ARGS->compile_only) {
+                purple_log(LOG_WARNING, "%s is not a Purple program, so it is not compiled",
+                           input_fn);
+            } else {
+                link_fns[num_link_fns++] = input_fn;
+            }
+            continue;
+        }
+
+        // Output names were only allowed to be given if there is one program
+        program_fns[num_programs] = input_fn;
+        llvm_fns[num_programs] =
+            D_ARGS->filenames[1] ? D_ARGS->filenames[1] : output_filename(input_fn, ".ll");
+        object_fns[num_programs] = D_ARGS->compile_only && D_ARGS->filenames[2]
+                                       ? D_ARGS->filenames[2]
+                                       : output_filename(input_fn, ".o");
+
+        link_fns[num_link_fns++] = object_fns[num_programs++];
+    }
+
+    int rc = compile_programs(program_fns, llvm_fns, object_fns, num_programs, false,
+                              D_ARGS->batch);
+    if (rc != RC_OK) {
+        shutdown();
+        exit(rc);
+    }
+
+    if (!D_ARGS->compile_only && clang_link(link_fns, num_link_fns)) {
+        shutdown();
+        exit(RC_ERROR);
+    }
+
+    tracked_free(link_fns);
+    tracked_free(program_fns);
+    tracked_free(llvm_fns);
+    tracked_free(object_fns);
+}
+
+/**
+ * @brief Compile each program file into a program of its own, named after it, continuing past
+ * programs that fail to compile
+ */
+static void compile_batch(void)
+{
+    char** llvm_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    char** binary_fns =
+        (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * D_ARGS->num_input_filenames);
+    if (llvm_fns == NULL || binary_fns == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for output filenames");
+    }
+
+    for (int i = 0; i < D_ARGS->num_input_filenames; i++) {
+        char* input_fn = D_ARGS->input_filenames[i];
+        const char* basename = strrchr(input_fn, '/') ? strrchr(input_fn, '/') + 1 : input_fn;
+
+        // Output names were only allowed to be given if there is one program
+        llvm_fns[i] =
+            D_ARGS->filenames[1] ? D_ARGS->filenames[1] : output_filename(input_fn, ".ll");
+        // A program without an extension would otherwise be overwritten by its binary
+        binary_fns[i] = D_ARGS->filenames[2]
+                            ? D_ARGS->filenames[2]
+                            : output_filename(input_fn, strrchr(basename, '.') ? "" : ".out");
+    }
+
+    int rc = compile_programs(D_ARGS->input_filenames, llvm_fns, binary_fns,
+                              D_ARGS->num_input_filenames, true, true);
+    if (rc != RC_OK) {
+        shutdown();
+        exit(rc);
+    }
+
+    tracked_free(llvm_fns);
+    tracked_free(binary_fns);
+}
+
+/**
+ * @brief Compile the programs given in the compiler's arguments
+ */
+static void compile(void)
+{
+    const char* report_label = D_ARGS->from_command_line_argument ? "argument"
+                               : D_ARGS->num_input_filenames == 1 ? D_ARGS->input_filenames[0]
+                                                                  : "purple";
+    if (D_ARGS->time_report != REPORT_NONE) {
+        time_report_start(D_ARGS->time_report, report_label);
+    }
+    if (D_ARGS->memory_report != REPORT_NONE) {
+        memory_report_start(D_ARGS->memory_report, report_label);
+    }
+    if (D_ARGS->trace_fn) {
+        trace_start(D_ARGS->trace_fn, report_label);
+    }
+
+    // A program in a single file is translated and compiled directly
+    if (D_ARGS->batch && !D_ARGS->compile_only) {
+        compile_batch();
+    } else if (!D_ARGS->compile_only &&
+        (D_ARGS->num_input_filenames == 0 ||
+         (D_ARGS->num_input_filenames == 1 && is_purple_program(D_ARGS->filenames[0])))) {
+        int rc = compile_program(D_ARGS->from_command_line_argument ? NULL : D_ARGS->filenames[0],
+                                 D_ARGS->filenames[1], D_ARGS->filenames[2], true);
+        if (rc != RC_OK) {
+            shutdown();
+            exit(rc);
+        }
+    } else {
+        compile_separately();
+    }
+}
+
+/**
+ * @brief Compile the programs in a request sent to the compile server, in the process forked for it
+ *
+ * @param argc Number of command line arguments sent by the client
+ * @param argv Array of command line arguments sent by the client
+ */
+static void compile_request(int argc, char* argv[])
+{
+    init(argc, argv);
+
+    // The client has already sent the request here
+    D_ARGS->connect_socket = NULL;
+    if (D_ARGS->server_socket) {
+        fatal(RC_ARG_ERROR, "A compile server may not be started by another");
+    }
+
+    compile();
+
+    shutdown();
 }
 
 /**
@@ -82,13 +423,15 @@ int main(int argc, char* argv[])
 {
     init(argc, argv);
 
-    generate_llvm();
-
-    close_files();
-
-    link_globals();
+    if (D_ARGS->server_socket) {
+        server_run(D_ARGS->server_socket, compile_request);
+    } else if (D_ARGS->connect_socket) {
+        int rc = server_forward(D_ARGS->connect_socket, argc, argv);
+        shutdown();
+        return rc;
+    }
 
-    clang_compile_llvm(D_LLVM_FN);
+    compile();
 
     shutdown();
 
@@ -11,6 +11,7 @@
 #include "data.h"
 #include "scan.h"
 #include "utils/logging.h"
+#include "utils/timing.h"
 
 /**
  * @brief Get the next valid character from the current input file
@@ -320,11 +321,15 @@ static TokenType parse_keyword(char* keyword_string)
     case 'c':
         if (!strcmp(keyword_string, tokenStrings[T_CHAR])) {
             return T_CHAR;
+        } else if (!strcmp(keyword_string, tokenStrings[T_COLD])) {
+            return T_COLD;
         }
         break;
     case 'e':
         if (!strcmp(keyword_string, tokenStrings[T_ELSE])) {
             return T_ELSE;
+        } else if (!strcmp(keyword_string, tokenStrings[T_EXPORT])) {
+            return T_EXPORT;
         }
     case 'f':
         if (!strcmp(keyword_string, tokenStrings[T_FALSE])) {
@@ -337,11 +342,15 @@ static TokenType parse_keyword(char* keyword_string)
             return T_IF;
         } else if (!strcmp(keyword_string, tokenStrings[T_INT])) {
             return T_INT;
+        } else if (!strcmp(keyword_string, tokenStrings[T_INLINE])) {
+            return T_INLINE;
         }
         break;
     case 'l':
         if (!strcmp(keyword_string, tokenStrings[T_LONG])) {
             return T_LONG;
+        } else if (!strcmp(keyword_string, tokenStrings[T_LIKELY])) {
+            return T_LIKELY;
         }
         break;
     case 'n':
@@ -349,6 +358,10 @@ static TokenType parse_keyword(char* keyword_string)
             return T_NAND;
         } else if (!strcmp(keyword_string, tokenStrings[T_NOR])) {
             return T_NOR;
+        } else if (!strcmp(keyword_string, tokenStrings[T_NOINLINE])) {
+            return T_NOINLINE;
+        } else if (!strcmp(keyword_string, tokenStrings[T_NOUNROLL])) {
+            return T_NOUNROLL;
         }
         break;
     case 'o':
@@ -376,9 +389,18 @@ static TokenType parse_keyword(char* keyword_string)
             return T_TRUE;
         }
         break;
+    case 'u':
+        if (!strcmp(keyword_string, tokenStrings[T_UNROLL])) {
+            return T_UNROLL;
+        } else if (!strcmp(keyword_string, tokenStrings[T_UNLIKELY])) {
+            return T_UNLIKELY;
+        }
+        break;
     case 'v':
         if (!strcmp(keyword_string, tokenStrings[T_VOID])) {
             return T_VOID;
+        } else if (!strcmp(keyword_string, tokenStrings[T_VECTORIZE])) {
+            return T_VECTORIZE;
         }
         break;
     case 'w':
@@ -432,11 +454,11 @@ static bool scan_check_keyword_identifier(char c)
 }
 
 /**
- * @brief Scan tokens into the Token struct
+ * @brief Scan the next token into the Token struct
  * 
  * @return bool Returns true if a Token was scanned successfully
  */
-bool scan()
+static bool scan_token(void)
 {
     char c;
     TokenType temp_type;
@@ -623,3 +645,17 @@ bool scan()
 
     return no_switch_match_output;
 }
+
+/**
+ * @brief Scan tokens into the Token struct, charging the time to scanning in the time report
+ * 
+ * @return bool Returns true if a Token was scanned successfully
+ */
+bool scan()
+{
+    time_phase_begin(TIME_PHASE_SCANNING);
+    bool scanned = scan_token();
+    time_phase_end(TIME_PHASE_SCANNING);
+
+    return scanned;
+}
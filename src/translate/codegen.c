@@ -0,0 +1,166 @@
+/**
+ * @file codegen.c
+ * @author Charles Averill
+ * @brief Logic for translating the functions of a program on several threads. Each function is
+ * translated into its own CodegenContext, with its own registers, labels, metadata and output, and
+ * the contexts are merged into the module in the order their functions were declared, so the
+ * module is the same however many threads translated it
+ * @date 19-Oct-2026
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "translate/codegen.h"
+#include "translate/translate.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/misc.h"
+#include "utils/timing.h"
+
+/**Context of the function being translated on this thread, or NULL if there is none*/
+static _Thread_local CodegenContext* current_context = NULL;
+
+/**
+ * @brief Get the context of the function being translated on this thread
+ *
+ * @return CodegenContext* Context of the function, or NULL if no function is being translated
+ */
+CodegenContext* codegen_current_context(void)
+{
+    return current_context;
+}
+
+/**
+ * @brief Translate a function into its context. The thread's registers, labels, output file and
+ * Symbol Table Stack belong to the function until it is translated, and are then put back
+ *
+ * @param context Context of the function to translate
+ */
+static void translate_function(CodegenContext* context)
+{
+    ParsedFunction* function = context->function;
+    TimeSpan start = time_function_begin();
+    FILE* module_llvm_file = D_LLVM_FILE;
+    SymbolTableStack* module_symbol_table_stack = D_SYMBOL_TABLE_STACK;
+
+    current_context = context;
+    context->metadata = (LLVMMetadataTable){.nodes = NULL,
+                                            .is_reserved = NULL,
+                                            .num_nodes = 0,
+                                            .first_node = PURPLE_FIRST_FUNCTION_METADATA_NODE,
+                                            .buckets = NULL,
+                                            .num_buckets = 0};
+    D_LLVM_FILE = open_memstream(&context->llvm, &context->llvm_size);
+    if (D_LLVM_FILE == NULL) {
+        fatal(RC_FILE_ERROR, "Failed to open buffer for function \"%s\"",
+              function->root->value.symbol_name);
+    }
+    D_SYMBOL_TABLE_STACK = new_function_symbol_table_stack(function->scope);
+
+    // Registers and labels are numbered from the start of every function
+    D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER = 1;
+    D_LABEL_INDEX = 0;
+    D_CURRENT_FUNCTION_HAS_RETURNED = false;
+
+    ast_to_llvm(function->root, LLVMVALUE_NULL, function->root->ttype);
+    time_function_end(TIME_FUNCTION_CODEGEN, function->root->value.symbol_name, start);
+
+    fclose(D_LLVM_FILE);
+    tracked_free(D_SYMBOL_TABLE_STACK);
+    free_ast_node(function->root);
+    function->root = NULL;
+
+    D_LLVM_FILE = module_llvm_file;
+    D_SYMBOL_TABLE_STACK = module_symbol_table_stack;
+    current_context = NULL;
+}
+
+/**
+ * @brief Translate functions from a queue until every function has been started
+ *
+ * @param queue_pointer CodegenQueue to take functions from
+ * @return void*        NULL
+ */
+static void* codegen_worker(void* queue_pointer)
+{
+    CodegenQueue* queue = (CodegenQueue*)queue_pointer;
+
+    unsigned long long int i;
+    while ((i = atomic_fetch_add(&queue->next_context, 1)) < queue->num_contexts) {
+        translate_function(&queue->contexts[i]);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Translate every function of a program on up to D_ARGS->codegen_threads threads, then
+ * write them to D_LLVM_FILE in the order they were declared. Frees the functions' ASTs
+ *
+ * @param program Every function in the input
+ */
+void codegen_functions(ParsedProgram* program)
+{
+    CodegenQueue queue = {.num_contexts = 0};
+    queue.contexts = (CodegenContext*)tracked_calloc(MEMORY_CODEGEN, program->num_functions + 1,
+                                                     sizeof(CodegenContext));
+    if (queue.contexts == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for codegen contexts");
+    }
+    atomic_init(&queue.next_context, 0);
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        ParsedFunction* function = &program->functions[i];
+        if (function->root == NULL) {
+            continue;
+        }
+
+        // Attribute groups are numbered in declaration order, so that threads only look them up
+        if (D_ARGS->infer_attributes) {
+            llvm_function_attribute_group(
+                &GST_FIND(function->root->value.symbol_name)->type.value.function);
+        }
+
+        queue.contexts[queue.num_contexts++].function = function;
+    }
+
+    int num_threads = MIN(D_ARGS->codegen_threads, queue.num_contexts);
+    if (num_threads <= 1) {
+        codegen_worker(&queue);
+    } else {
+        purple_log(LOG_DEBUG, "Translating %llu functions on %d threads", queue.num_contexts,
+                   num_threads);
+
+        pthread_t* threads =
+            (pthread_t*)tracked_malloc(MEMORY_CODEGEN, sizeof(pthread_t) * num_threads);
+        if (threads == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for codegen threads");
+        }
+        for (int i = 0; i < num_threads; i++) {
+            int error = pthread_create(&threads[i], NULL, codegen_worker, &queue);
+            if (error) {
+                fatal(RC_ERROR, "Failed to start codegen thread: %s", strerror(error));
+            }
+        }
+        for (int i = 0; i < num_threads; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        tracked_free(threads);
+    }
+
+    for (unsigned long long int i = 0; i < queue.num_contexts; i++) {
+        CodegenContext* context = &queue.contexts[i];
+
+        char* llvm = llvm_merge_function_metadata(&context->metadata, context->llvm);
+        fputs(llvm, D_LLVM_FILE);
+        tracked_free(llvm);
+        tracked_free(context->llvm);
+
+        profile_merge_counters(&context->counters);
+    }
+
+    tracked_free(queue.contexts);
+}
@@ -0,0 +1,389 @@
+/**
+ * @file debug.c
+ * @author Charles Averill
+ * @brief Logic for describing generated programs to debuggers and profilers with DWARF metadata:
+ * a compile unit per file, a subprogram per function, a source location per instruction and,
+ * with full debug information, the types of variables and parameters
+ * @date 19-Oct-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "data.h"
+#include "info.h"
+#include "translate/debug.h"
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**Metadata node describing the input file, or -1 if it hasn't been needed yet*/
+static int file_node = -1;
+/**Metadata node describing the compile unit, which is filled once every global is known*/
+static int compile_unit_node = -1;
+/**Metadata nodes of the global variables described to the compile unit*/
+static int* global_variable_nodes = NULL;
+/**Number of nodes in global_variable_nodes*/
+static int num_global_variable_nodes = 0;
+
+/**Metadata node describing the function currently being translated, or -1 if there is none*/
+static _Thread_local int current_subprogram = -1;
+/**Line the function currently being translated was declared on*/
+static _Thread_local int current_function_line = 0;
+/**Source location most recently written to the current function's body*/
+static _Thread_local int last_line_number = -1;
+/**Column of the source location most recently written to the current function's body*/
+static _Thread_local int last_char_number = -1;
+
+/**
+ * @brief Number the metadata nodes describing the input file and compile unit, if they haven't
+ * been already
+ */
+static void begin_compile_unit(void)
+{
+    if (compile_unit_node >= 0) {
+        return;
+    }
+
+    char directory[1024];
+    if (getcwd(directory, sizeof(directory)) == NULL) {
+        strcpy(directory, ".");
+    }
+
+    char contents[1536];
+    snprintf(contents, sizeof(contents), "!DIFile(filename: \"%s\", directory: \"%s\")",
+             D_INPUT_FN, directory);
+    file_node = llvm_metadata_node(contents);
+
+    // Every global must be known before the compile unit can list them
+    compile_unit_node = llvm_reserve_metadata_node();
+}
+
+/**
+ * @brief Number the metadata nodes describing the input file and compile unit before any function
+ * is translated, so that functions translated at the same time may refer to them
+ */
+void debug_preamble(void)
+{
+    if (D_ARGS->debug_info != DEBUG_INFO_NONE) {
+        begin_compile_unit();
+    }
+}
+
+/**
+ * @brief Get the metadata node describing a type
+ *
+ * @param number    Type to describe
+ * @return int      Number of the metadata node
+ */
+static int type_metadata(Number number)
+{
+    char contents[256];
+
+    if (number.pointer_depth > 0) {
+        Number pointee = number;
+        pointee.pointer_depth--;
+        snprintf(contents, sizeof(contents),
+                 "!DIDerivedType(tag: DW_TAG_pointer_type, baseType: !%d, size: %d)",
+                 type_metadata(pointee), PURPLE_POINTER_ALIGN_BYTES * 8);
+        return llvm_metadata_node(contents);
+    }
+
+    const char* encoding = number.number_type == NT_INT1   ? "DW_ATE_boolean"
+                           : number.number_type == NT_INT8 ? "DW_ATE_signed_char"
+                                                           : "DW_ATE_signed";
+    snprintf(contents, sizeof(contents), "!DIBasicType(name: \"%s\", size: %d, encoding: %s)",
+             numberTypeNames[number.number_type], numberTypeByteSizes[number.number_type] * 8,
+             encoding);
+    return llvm_metadata_node(contents);
+}
+
+/**
+ * @brief Get the metadata node describing a function's type. Line tables don't describe types, so
+ * they only need an empty one
+ *
+ * @param function  Function to describe
+ * @return int      Number of the metadata node
+ */
+static int subroutine_type_metadata(Function* function)
+{
+    char* types = NULL;
+    size_t types_size = 0;
+    FILE* types_stream = open_memstream(&types, &types_size);
+    if (types_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for function type metadata");
+    }
+
+    fprintf(types_stream, "!{");
+    if (D_ARGS->debug_info == DEBUG_INFO_FULL) {
+        // The return type comes first, and is null for void functions
+        if (function->return_type == T_VOID) {
+            fprintf(types_stream, "null");
+        } else {
+            Number return_number = {.number_type = token_type_to_number_type(function->return_type),
+                                    .pointer_depth = 0};
+            fprintf(types_stream, "!%d", type_metadata(return_number));
+        }
+        for (unsigned long long int i = 0; i < function->num_parameters; i++) {
+            fprintf(types_stream, ", !%d", type_metadata(function->parameters[i].parameter_type));
+        }
+    }
+    fprintf(types_stream, "}");
+    fclose(types_stream);
+
+    char contents[64];
+    snprintf(contents, sizeof(contents), "!DISubroutineType(types: !%d)",
+             llvm_metadata_node(types));
+    tracked_free(types);
+
+    return llvm_metadata_node(contents);
+}
+
+/**
+ * @brief Describe a function about to be translated, so that its instructions may be given source
+ * locations within it
+ *
+ * @param function_root Function declaration AST
+ */
+void debug_begin_function(ASTNode* function_root)
+{
+    if (D_ARGS->debug_info == DEBUG_INFO_NONE) {
+        return;
+    }
+
+    Function* function = &GST_FIND(function_root->value.symbol_name)->type.value.function;
+    char contents[1024];
+    snprintf(contents, sizeof(contents),
+             "distinct !DISubprogram(name: \"%s\", scope: !%d, file: !%d, line: %d, type: !%d, "
+             "scopeLine: %d, flags: DIFlagPrototyped, spFlags: DISPFlagDefinition%s%s, unit: !%d)",
+             function_root->value.symbol_name, file_node, file_node, function_root->line_number,
+             subroutine_type_metadata(function), function_root->line_number,
+             function->is_internal ? " | DISPFlagLocalToUnit" : "",
+             D_ARGS->opt_level ? " | DISPFlagOptimized" : "", compile_unit_node);
+
+    current_subprogram = llvm_metadata_node(contents);
+    current_function_line = function_root->line_number;
+    last_line_number = -1;
+    last_char_number = -1;
+}
+
+/**
+ * @brief Get the metadata node describing the function currently being translated
+ *
+ * @return int Number of the metadata node, or -1 if debug information isn't being emitted
+ */
+int debug_current_subprogram(void)
+{
+    return current_subprogram;
+}
+
+/**
+ * @brief Give the instructions generated after this point the source location of an AST node
+ *
+ * @param line_number   Line of the node, or 0 if the node has no position
+ * @param char_number   Column of the node
+ */
+void debug_location(int line_number, int char_number)
+{
+    if (current_subprogram < 0 || line_number <= 0 ||
+        (line_number == last_line_number && char_number == last_char_number)) {
+        return;
+    }
+
+    fprintf(D_LLVM_FILE, PURPLE_DEBUG_LOCATION_PLACEHOLDER "%d %d" NEWLINE, line_number,
+            char_number);
+    last_line_number = line_number;
+    last_char_number = char_number;
+}
+
+/**
+ * @brief Describe a parameter of the function currently being translated, at the start of its body
+ *
+ * @param index     Index of the parameter, which is also the number of its incoming register
+ * @param parameter Symbol Table Entry of the parameter
+ */
+void debug_declare_parameter(unsigned long long int index, SymbolTableEntry* parameter)
+{
+    if (D_ARGS->debug_info != DEBUG_INFO_FULL || current_subprogram < 0) {
+        return;
+    }
+
+    Number number = parameter->type.value.number;
+    char contents[512];
+    snprintf(contents, sizeof(contents),
+             "!DILocalVariable(name: \"%s\", arg: %llu, scope: !%d, file: !%d, line: %d, "
+             "type: !%d)",
+             parameter->symbol_name, index + 1, current_subprogram, file_node,
+             current_function_line, type_metadata(number));
+    int variable = llvm_metadata_node(contents);
+
+    // Parameters whose addresses are taken live in a stack slot, the rest are SSA values
+    if (parameter->in_memory) {
+        fprintf(D_LLVM_FILE, TAB "call void @llvm.dbg.declare(metadata %s%s* %%%s",
+                numberTypeLLVMReprs[number.number_type], REFSTRING(number.pointer_depth),
+                parameter->symbol_name);
+        fprintf(D_LLVM_FILE,
+                PURPLE_LOCAL_SLOT_SUFFIX ", metadata !%d, metadata !DIExpression())" NEWLINE,
+                variable);
+    } else {
+        fprintf(D_LLVM_FILE, TAB "call void @llvm.dbg.value(metadata %s%s %%%llu",
+                numberTypeLLVMReprs[number.number_type], REFSTRING(number.pointer_depth), index);
+        fprintf(D_LLVM_FILE, ", metadata !%d, metadata !DIExpression())" NEWLINE, variable);
+    }
+}
+
+/**
+ * @brief Give every instruction of a buffered function body the source location written before
+ * it, removing the location placeholders. Instructions before the first placeholder are located
+ * at the function's declaration
+ *
+ * @param body      Buffered function body
+ * @return char*    Body with locations attached, which must be freed, or NULL if debug
+ *                  information isn't being emitted
+ */
+char* debug_attach_locations(char* body)
+{
+    if (current_subprogram < 0) {
+        return NULL;
+    }
+
+    char* out = NULL;
+    size_t out_size = 0;
+    FILE* out_stream = open_memstream(&out, &out_size);
+    if (out_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for located function body");
+    }
+
+    char contents[128];
+    snprintf(contents, sizeof(contents), "!DILocation(line: %d, column: 0, scope: !%d)",
+             current_function_line, current_subprogram);
+    int location = llvm_metadata_node(contents);
+
+    while (*body) {
+        char* line_end = strchr(body, '\n');
+        size_t line_length = line_end ? (size_t)(line_end - body) : strlen(body);
+
+        if (!strncmp(body, PURPLE_DEBUG_LOCATION_PLACEHOLDER,
+                     PURPLE_DEBUG_LOCATION_PLACEHOLDER_LEN)) {
+            int line_number, char_number;
+            sscanf(body + PURPLE_DEBUG_LOCATION_PLACEHOLDER_LEN, "%d %d", &line_number,
+                   &char_number);
+            snprintf(contents, sizeof(contents), "!DILocation(line: %d, column: %d, scope: !%d)",
+                     line_number, char_number, current_subprogram);
+            location = llvm_metadata_node(contents);
+        } else if (body[0] == '\t' && body[1] != ';' && body[line_length - 1] != ':') {
+            // Every indented line that isn't a comment or label is an instruction
+            fprintf(out_stream, "%.*s, !dbg !%d" NEWLINE, (int)line_length, body, location);
+        } else {
+            fprintf(out_stream, "%.*s" NEWLINE, (int)line_length, body);
+        }
+
+        body += line_length + (line_end != NULL);
+    }
+
+    fclose(out_stream);
+    current_subprogram = -1;
+
+    return out;
+}
+
+/**
+ * @brief Describe a global variable to the compile unit
+ *
+ * @param variable  Symbol Table Entry of the global variable
+ * @return int      Number of the metadata node to attach to the variable, or -1 if variables
+ *                  aren't being described
+ */
+int debug_global_variable_metadata(SymbolTableEntry* variable)
+{
+    if (D_ARGS->debug_info != DEBUG_INFO_FULL) {
+        return -1;
+    }
+
+    begin_compile_unit();
+
+    // Globals are stored as pointers to their values
+    Number number = variable->type.value.number;
+    number.pointer_depth--;
+
+    char contents[512];
+    snprintf(contents, sizeof(contents),
+             "distinct !DIGlobalVariable(name: \"%s\", scope: !%d, file: !%d, line: %d, "
+             "type: !%d, isLocal: true, isDefinition: true)",
+             variable->symbol_name, compile_unit_node, file_node, variable->line_number,
+             type_metadata(number));
+    int global_variable = llvm_metadata_node(contents);
+
+    snprintf(contents, sizeof(contents),
+             "!DIGlobalVariableExpression(var: !%d, expr: !DIExpression())", global_variable);
+    int expression = llvm_metadata_node(contents);
+
+    global_variable_nodes =
+        (int*)tracked_realloc(MEMORY_CODEGEN, global_variable_nodes,
+                              sizeof(int) * (num_global_variable_nodes + 1));
+    if (global_variable_nodes == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for global variable metadata");
+    }
+    global_variable_nodes[num_global_variable_nodes++] = expression;
+
+    return expression;
+}
+
+/**
+ * @brief Fill in the compile unit once every function and global variable has been described, and
+ * declare the intrinsics that describe parameters
+ *
+ * @return int Number of the compile unit's metadata node, or -1 if debug information isn't being
+ *             emitted
+ */
+int debug_postamble(void)
+{
+    if (compile_unit_node < 0) {
+        return -1;
+    }
+
+    if (D_ARGS->debug_info == DEBUG_INFO_FULL) {
+        fprintf(D_LLVM_FILE, "declare void @llvm.dbg.declare(metadata, metadata, metadata)" NEWLINE
+                                 NEWLINE);
+        fprintf(D_LLVM_FILE,
+                "declare void @llvm.dbg.value(metadata, metadata, metadata)" NEWLINE NEWLINE);
+    }
+
+    // The compile unit lists every global variable it describes
+    char globals[64] = "";
+    if (num_global_variable_nodes) {
+        char* list = NULL;
+        size_t list_size = 0;
+        FILE* list_stream = open_memstream(&list, &list_size);
+        if (list_stream == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for compile unit metadata");
+        }
+        for (int i = 0; i < num_global_variable_nodes; i++) {
+            fprintf(list_stream, "%s!%d", i ? ", " : "!{", global_variable_nodes[i]);
+        }
+        fprintf(list_stream, "}");
+        fclose(list_stream);
+
+        snprintf(globals, sizeof(globals), ", globals: !%d", llvm_metadata_node(list));
+        tracked_free(list);
+    }
+
+    // Purple has no DWARF language code of its own, and is closest to C
+    char contents[1024];
+    snprintf(contents, sizeof(contents),
+             "distinct !DICompileUnit(language: DW_LANG_C99, file: !%d, producer: \"%s\", "
+             "isOptimized: %s, runtimeVersion: 0, emissionKind: %s%s)",
+             file_node, PROJECT_NAME_AND_VERS, D_ARGS->opt_level ? "true" : "false",
+             D_ARGS->debug_info == DEBUG_INFO_FULL ? "FullDebug" : "LineTablesOnly", globals);
+    llvm_fill_metadata_node(compile_unit_node, contents);
+
+    int compile_unit = compile_unit_node;
+    file_node = -1;
+    compile_unit_node = -1;
+    tracked_free(global_variable_nodes);
+    global_variable_nodes = NULL;
+    num_global_variable_nodes = 0;
+
+    return compile_unit;
+}
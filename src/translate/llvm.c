@@ -5,16 +5,25 @@
  * @date 12-Sep-2022
  */
 
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "data.h"
+#include "info.h"
 #include "translate/llvm.h"
+#include "translate/codegen.h"
+#include "translate/debug.h"
+#include "translate/profile.h"
+#include "translate/runtime.h"
+#include "translate/ssa.h"
 #include "translate/translate.h"
 #include "types/type.h"
 #include "utils/clang.h"
 #include "utils/formatting.h"
+#include "utils/hash.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
 
 static void print_function_annotation(const char* function_name)
 {
@@ -31,7 +40,7 @@ static void print_function_annotation(const char* function_name)
  */
 static char* number_string(Number number)
 {
-    char* out = (char*)calloc(1, sizeof(char) * 300);
+    char* out = (char*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(char) * 300);
     sprintf(out, "%s%s", numberTypeLLVMReprs[number.number_type], REFSTRING(number.pointer_depth));
     return out;
 }
@@ -44,12 +53,14 @@ static char* number_string(Number number)
  */
 static char* llvmvalue_repr(LLVMValue val)
 {
-    char* out = (char*)calloc(1, sizeof(char) * 600);
+    char* out = (char*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(char) * 600);
     char* numstring = number_string(val.num_info);
     sprintf(out, "%s %s", numstring, LLVMVALUE_REGMARKER(val));
-    free(numstring);
+    tracked_free(numstring);
     if (val.has_name) {
         sprintf(out + strlen(out), "%s", val.value.name);
+    } else if (val.value_type == LLVMVALUETYPE_UNDEF) {
+        sprintf(out + strlen(out), "undef");
     } else {
         sprintf(out + strlen(out), "%llu", val.value.virtual_register_index);
     }
@@ -87,7 +98,8 @@ LLVMValue* llvm_ensure_registers_loaded(int n_registers, LLVMValue registers[],
 
     // Haven't loaded all of our registers yet
     print_function_annotation("llvm_ensure_registers_loaded");
-    LLVMValue* loaded_registers = (LLVMValue*)malloc(sizeof(LLVMValue) * (n_registers - n_found));
+    LLVMValue* loaded_registers =
+        (LLVMValue*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMValue) * (n_registers - n_found));
     for (int i = 0; i < n_registers; i++) {
         if (found_registers[i]) {
             loaded_registers[i] = registers[i];
@@ -135,32 +147,388 @@ LLVMValue* llvm_ensure_registers_fully_loaded(int n_registers, LLVMValue registe
 void llvm_preamble(void)
 {
     print_function_annotation("llvm_preamble");
-    fprintf(D_LLVM_FILE, "; ModuleID = '%s'" NEWLINE, D_INPUT_FN);
+    // Named without its directory, so the same program gives the same module wherever it's compiled
+    const char* module_name = strrchr(D_INPUT_FN, '/') ? strrchr(D_INPUT_FN, '/') + 1 : D_INPUT_FN;
+    fprintf(D_LLVM_FILE, "; ModuleID = '%s'" NEWLINE, module_name);
 
     // Target layout
     char* target_datalayout = get_target_datalayout();
     fprintf(D_LLVM_FILE, "target datalayout = \"%s\"" NEWLINE, target_datalayout);
     purple_log(LOG_DEBUG, "Freeing %s", "target_datalayout");
-    free(target_datalayout);
+    tracked_free(target_datalayout);
 
     // Target triple
     char* target_triple = get_target_triple();
     fprintf(D_LLVM_FILE, "target triple = \"%s\"" NEWLINE NEWLINE, target_triple);
     purple_log(LOG_DEBUG, "Freeing %s", "target_triple");
-    free(target_triple);
+    tracked_free(target_triple);
 
     // Globals placeholder
     fprintf(D_LLVM_FILE, PURPLE_GLOBALS_PLACEHOLDER NEWLINE NEWLINE);
+}
+
+/**Attribute groups of inferred function attributes, numbered from
+ * PURPLE_FIRST_INFERRED_ATTRIBUTE_GROUP*/
+static char** attribute_groups = NULL;
+/**Number of attribute groups in attribute_groups*/
+static int num_attribute_groups = 0;
+
+/**
+ * @brief Get the number of the attribute group holding a function's inferred attributes, adding
+ * the group if no other function has the same attributes. Groups are numbered before functions are
+ * translated, so that translating functions on several threads only looks them up
+ *
+ * @param function  Function to get the attribute group of
+ * @return int      Number of the function's attribute group
+ */
+int llvm_function_attribute_group(Function* function)
+{
+    char group[128];
+    snprintf(group, sizeof(group), "%s%snounwind%s%s%s%s uwtable",
+             function->is_cold ? "cold " : "",
+             function->inline_hint == INLINE_NEVER ? "noinline " : "",
+             function->attributes & FUNCTION_ATTRIBUTE_READNONE   ? " readnone"
+             : function->attributes & FUNCTION_ATTRIBUTE_READONLY ? " readonly"
+                                                                  : "",
+             function->attributes & FUNCTION_ATTRIBUTE_WILLRETURN ? " willreturn" : "",
+             function->attributes & FUNCTION_ATTRIBUTE_NORECURSE ? " norecurse" : "",
+             function->attributes & FUNCTION_ATTRIBUTE_NOSYNC ? " nosync" : "");
+
+    for (int i = 0; i < num_attribute_groups; i++) {
+        if (!strcmp(attribute_groups[i], group)) {
+            return PURPLE_FIRST_INFERRED_ATTRIBUTE_GROUP + i;
+        }
+    }
+
+    attribute_groups = tracked_realloc(MEMORY_CODEGEN, attribute_groups,
+                                       sizeof(char*) * (num_attribute_groups + 1));
+    if (attribute_groups == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to reallocate list of attribute groups");
+    }
+    attribute_groups[num_attribute_groups] = tracked_strdup(MEMORY_CODEGEN, group);
+
+    return PURPLE_FIRST_INFERRED_ATTRIBUTE_GROUP + num_attribute_groups++;
+}
+
+/**Metadata nodes of the module, numbered from PURPLE_FIRST_METADATA_NODE*/
+static LLVMMetadataTable module_metadata = {.nodes = NULL,
+                                            .is_reserved = NULL,
+                                            .num_nodes = 0,
+                                            .first_node = PURPLE_FIRST_METADATA_NODE,
+                                            .buckets = NULL,
+                                            .num_buckets = 0};
+
+/**
+ * @brief Get the metadata nodes that instructions currently being generated refer to: those of the
+ * function being translated on this thread, or otherwise the module's
+ *
+ * @return LLVMMetadataTable* Metadata nodes to add to
+ */
+static LLVMMetadataTable* current_metadata(void)
+{
+    CodegenContext* context = codegen_current_context();
+    return context ? &context->metadata : &module_metadata;
+}
+
+/**
+ * @brief Add a node to the buckets used to find nodes by their contents, unless a node with the
+ * same contents is already there
+ *
+ * @param metadata  Metadata nodes holding the node
+ * @param index     Index of the node, which must have contents
+ */
+static void index_metadata_node(LLVMMetadataTable* metadata, int index)
+{
+    unsigned long int bucket = FNV_1(metadata->nodes[index]) % metadata->num_buckets;
+    while (metadata->buckets[bucket]) {
+        if (!strcmp(metadata->nodes[metadata->buckets[bucket] - 1], metadata->nodes[index])) {
+            return;
+        }
+        bucket = (bucket + 1) % metadata->num_buckets;
+    }
+
+    metadata->buckets[bucket] = index + 1;
+}
+
+/**
+ * @brief Number a new metadata node
+ *
+ * @param metadata      Metadata nodes to add the node to
+ * @param contents      Contents of the node, or NULL if they aren't known yet
+ * @param is_reserved   Whether or not the node's contents may refer to the node itself
+ * @return int          Number of the metadata node
+ */
+static int add_metadata_node(LLVMMetadataTable* metadata, const char* contents, bool is_reserved)
+{
+    metadata->nodes =
+        tracked_realloc(MEMORY_CODEGEN, metadata->nodes, sizeof(char*) * (metadata->num_nodes + 1));
+    metadata->is_reserved =
+        tracked_realloc(MEMORY_CODEGEN, metadata->is_reserved,
+                        sizeof(bool) * (metadata->num_nodes + 1));
+    if (metadata->nodes == NULL || metadata->is_reserved == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to reallocate list of metadata nodes");
+    }
+    metadata->nodes[metadata->num_nodes] =
+        contents ? tracked_strdup(MEMORY_CODEGEN, contents) : NULL;
+    metadata->is_reserved[metadata->num_nodes] = is_reserved;
+
+    // Buckets are kept at most half full, so that nodes are found in constant time
+    if (metadata->num_nodes * 2 >= metadata->num_buckets) {
+        tracked_free(metadata->buckets);
+        metadata->num_buckets = metadata->num_buckets ? metadata->num_buckets * 2 : 64;
+        metadata->buckets =
+            (int*)tracked_calloc(MEMORY_CODEGEN, metadata->num_buckets, sizeof(int));
+        if (metadata->buckets == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for metadata buckets");
+        }
+        for (int i = 0; i < metadata->num_nodes; i++) {
+            if (metadata->nodes[i]) {
+                index_metadata_node(metadata, i);
+            }
+        }
+    }
+    if (contents) {
+        index_metadata_node(metadata, metadata->num_nodes);
+    }
 
-    fprintf(D_LLVM_FILE, "@print_int_fstring = private unnamed_addr constant [4 x i8] "
-                         "c\"%%d\\0A\\00\", align 1" NEWLINE NEWLINE);
-    fprintf(D_LLVM_FILE, "@print_long_fstring = private unnamed_addr constant [5 x i8] "
-                         "c\"%%ld\\0A\\00\", align 1" NEWLINE NEWLINE);
-    fprintf(D_LLVM_FILE, "@print_true_fstring = private unnamed_addr constant [6 x i8] "
-                         "c\"true\\0A\\00\", align 1" NEWLINE NEWLINE);
-    fprintf(D_LLVM_FILE, "@print_false_fstring = private unnamed_addr constant [7 x i8] "
-                         "c\"false\\0A\\00\", align 1" NEWLINE NEWLINE);
-    fprintf(D_LLVM_FILE, "; Function Attrs: noinline nounwind optnone uwtable" NEWLINE);
+    return metadata->first_node + metadata->num_nodes++;
+}
+
+/**
+ * @brief Get the number of a metadata node in a list of nodes, adding the node if no instruction
+ * references the same contents yet
+ *
+ * @param metadata  Metadata nodes to search
+ * @param contents  Contents of the metadata node
+ * @return int      Number of the metadata node
+ */
+static int find_metadata_node(LLVMMetadataTable* metadata, const char* contents)
+{
+    if (metadata->num_buckets) {
+        unsigned long int bucket = FNV_1((char*)contents) % metadata->num_buckets;
+        while (metadata->buckets[bucket]) {
+            if (!strcmp(metadata->nodes[metadata->buckets[bucket] - 1], contents)) {
+                return metadata->first_node + metadata->buckets[bucket] - 1;
+            }
+            bucket = (bucket + 1) % metadata->num_buckets;
+        }
+    }
+
+    return add_metadata_node(metadata, contents, false);
+}
+
+/**
+ * @brief Free the nodes of a list of metadata nodes
+ *
+ * @param metadata Metadata nodes to free
+ */
+static void free_metadata_nodes(LLVMMetadataTable* metadata)
+{
+    for (int i = 0; i < metadata->num_nodes; i++) {
+        tracked_free(metadata->nodes[i]);
+    }
+    tracked_free(metadata->nodes);
+    tracked_free(metadata->is_reserved);
+    tracked_free(metadata->buckets);
+    metadata->nodes = NULL;
+    metadata->is_reserved = NULL;
+    metadata->buckets = NULL;
+    metadata->num_nodes = 0;
+    metadata->num_buckets = 0;
+}
+
+/**
+ * @brief Get the number of a metadata node, adding the node if no instruction references the same
+ * contents yet
+ *
+ * @param contents  Contents of the metadata node
+ * @return int      Number of the metadata node
+ */
+int llvm_metadata_node(const char* contents)
+{
+    return find_metadata_node(current_metadata(), contents);
+}
+
+/**
+ * @brief Number a metadata node whose contents aren't known yet, so that other nodes may refer to
+ * it. The node must be filled by llvm_fill_metadata_node before the module ends
+ *
+ * @return int Number of the metadata node
+ */
+int llvm_reserve_metadata_node(void)
+{
+    return add_metadata_node(current_metadata(), NULL, true);
+}
+
+/**
+ * @brief Set the contents of a metadata node numbered by llvm_reserve_metadata_node
+ *
+ * @param node      Number of the metadata node
+ * @param contents  Contents of the metadata node
+ */
+void llvm_fill_metadata_node(int node, const char* contents)
+{
+    // Nodes of the module may be filled while a function is being translated
+    LLVMMetadataTable* metadata =
+        node < PURPLE_FIRST_FUNCTION_METADATA_NODE ? &module_metadata : current_metadata();
+
+    tracked_free(metadata->nodes[node - metadata->first_node]);
+    metadata->nodes[node - metadata->first_node] = tracked_strdup(MEMORY_CODEGEN, contents);
+    index_metadata_node(metadata, node - metadata->first_node);
+}
+
+/**
+ * @brief Replace the numbers of a function's metadata nodes in LLVM-IR with their numbers in the
+ * module
+ *
+ * @param llvm      LLVM-IR referring to the function's metadata nodes
+ * @param numbers   Number in the module of each of the function's nodes
+ * @return char*    Renumbered LLVM-IR, which must be freed
+ */
+static char* renumber_metadata(const char* llvm, int* numbers)
+{
+    char* out = NULL;
+    size_t out_size = 0;
+    FILE* out_stream = open_memstream(&out, &out_size);
+    if (out_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for renumbered metadata");
+    }
+
+    while (*llvm) {
+        char* end;
+        long node;
+        if (*llvm == '!' && isdigit((unsigned char)llvm[1]) &&
+            (node = strtol(llvm + 1, &end, 10)) >= PURPLE_FIRST_FUNCTION_METADATA_NODE) {
+            fprintf(out_stream, "!%d", numbers[node - PURPLE_FIRST_FUNCTION_METADATA_NODE]);
+            llvm = end;
+        } else {
+            fputc(*llvm++, out_stream);
+        }
+    }
+
+    fclose(out_stream);
+    return out;
+}
+
+/**
+ * @brief Add the metadata nodes of a translated function to the module, in the order the function
+ * added them, and renumber the function's references to them. Merging functions in the order they
+ * were declared numbers nodes the same way however many threads translated them. Frees the
+ * function's nodes
+ *
+ * @param metadata  Metadata nodes of the function
+ * @param llvm      LLVM-IR of the function
+ * @return char*    LLVM-IR of the function referring to the module's nodes, which must be freed
+ */
+char* llvm_merge_function_metadata(LLVMMetadataTable* metadata, const char* llvm)
+{
+    int* numbers = (int*)tracked_malloc(MEMORY_CODEGEN, sizeof(int) * (metadata->num_nodes + 1));
+    if (numbers == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for renumbered metadata");
+    }
+
+    // Nodes that weren't reserved only refer to the nodes added before them
+    for (int i = 0; i < metadata->num_nodes; i++) {
+        if (metadata->is_reserved[i]) {
+            numbers[i] = add_metadata_node(&module_metadata, NULL, true);
+        } else {
+            char* contents = renumber_metadata(metadata->nodes[i], numbers);
+            numbers[i] = find_metadata_node(&module_metadata, contents);
+            tracked_free(contents);
+        }
+    }
+    for (int i = 0; i < metadata->num_nodes; i++) {
+        if (metadata->is_reserved[i]) {
+            char* contents = renumber_metadata(metadata->nodes[i], numbers);
+            llvm_fill_metadata_node(numbers[i], contents);
+            tracked_free(contents);
+        }
+    }
+    free_metadata_nodes(metadata);
+
+    char* out = renumber_metadata(llvm, numbers);
+    tracked_free(numbers);
+    return out;
+}
+
+/**
+ * @brief Get the number of a metadata node giving the range of values an instruction produces
+ *
+ * @param type      Type of the instruction's value
+ * @param range     Bounds of the instruction's value, which must not cover its whole type
+ * @return int      Number of the metadata node
+ */
+static int llvm_range_metadata(NumberType type, ValueRange range)
+{
+    // The upper bound is exclusive, and wraps around if the range reaches the type's maximum
+    long long int end = range.max == number_type_range(type).max ? number_type_range(type).min
+                                                                  : range.max + 1;
+
+    char contents[128];
+    snprintf(contents, sizeof(contents), "!{%s %lld, %s %lld}", numberTypeLLVMReprs[type],
+             range.min, numberTypeLLVMReprs[type], end);
+    return llvm_metadata_node(contents);
+}
+
+/**
+ * @brief Get the number of a metadata node identifying a loop and passing it the hints it was
+ * written with
+ *
+ * @param loop_hints    LoopHint flags of the loop
+ * @param unroll_count  Number of times to unroll the loop, or 0 to let LLVM decide
+ * @return int          Number of the metadata node, which is distinct to this loop
+ */
+static int llvm_loop_metadata(int loop_hints, int unroll_count)
+{
+    char contents[256];
+    char hint[64];
+
+    // The hints are shared between loops, so they are numbered before the loop's own node
+    int hint_nodes[3];
+    int num_hint_nodes = 0;
+    if (loop_hints & LOOP_HINT_UNROLL) {
+        if (unroll_count) {
+            snprintf(hint, sizeof(hint), "!{!\"llvm.loop.unroll.count\", i32 %d}", unroll_count);
+            hint_nodes[num_hint_nodes++] = llvm_metadata_node(hint);
+        } else {
+            hint_nodes[num_hint_nodes++] = llvm_metadata_node("!{!\"llvm.loop.unroll.enable\"}");
+        }
+    }
+    if (loop_hints & LOOP_HINT_NOUNROLL) {
+        hint_nodes[num_hint_nodes++] = llvm_metadata_node("!{!\"llvm.loop.unroll.disable\"}");
+    }
+    if (loop_hints & LOOP_HINT_VECTORIZE) {
+        hint_nodes[num_hint_nodes++] =
+            llvm_metadata_node("!{!\"llvm.loop.vectorize.enable\", i1 true}");
+    }
+
+    // A loop's node refers to itself, so that no two loops share one
+    int loop = llvm_reserve_metadata_node();
+    int length = snprintf(contents, sizeof(contents), "distinct !{!%d", loop);
+    for (int i = 0; i < num_hint_nodes; i++) {
+        length += snprintf(contents + length, sizeof(contents) - length, ", !%d", hint_nodes[i]);
+    }
+    snprintf(contents + length, sizeof(contents) - length, "}");
+    llvm_fill_metadata_node(loop, contents);
+
+    return loop;
+}
+
+/**
+ * @brief Get the number of a metadata node giving the weights of a conditional branch's edges
+ *
+ * @param hint      How likely the branch's condition is to be true
+ * @return int      Number of the metadata node
+ */
+static int llvm_branch_weights_metadata(BranchHint hint)
+{
+    char contents[128];
+    snprintf(contents, sizeof(contents), "!{!\"branch_weights\", i32 %d, i32 %d}",
+             hint == BRANCH_HINT_LIKELY ? PURPLE_LIKELY_BRANCH_WEIGHT
+                                        : PURPLE_UNLIKELY_BRANCH_WEIGHT,
+             hint == BRANCH_HINT_LIKELY ? PURPLE_UNLIKELY_BRANCH_WEIGHT
+                                        : PURPLE_LIKELY_BRANCH_WEIGHT);
+    return llvm_metadata_node(contents);
 }
 
 /**
@@ -169,68 +537,338 @@ void llvm_preamble(void)
 void llvm_postamble(void)
 {
     print_function_annotation("llvm_postamble");
-    fprintf(D_LLVM_FILE, "declare i32 @printf(i8*, ...) #1" NEWLINE NEWLINE);
-    fprintf(
-        D_LLVM_FILE,
-        "attributes #0 = { noinline nounwind optnone uwtable \"frame-pointer\"=\"all\" "
-        "\"min-legal-vector-width\"=\"0\" \"no-trapping-math\"=\"true\" "
-        "\"stack-protector-buffer-size\"=\"8\" \"target-cpu\"=\"x86-64\" "
-        "\"target-features\"=\"+cx8,+fxsr,+mmx,+sse,+sse2,+x87\" \"tune-cpu\"=\"generic\" }" NEWLINE
-            NEWLINE);
+    int profile_summary = profile_postamble();
+    int compile_unit = debug_postamble();
+    runtime_postamble();
+    // Functions are only left unoptimized if their attributes aren't inferred
+    if (!D_ARGS->infer_attributes) {
+        fprintf(D_LLVM_FILE,
+                "attributes #0 = { noinline nounwind optnone uwtable " PURPLE_TARGET_ATTRIBUTES
+                " }" NEWLINE NEWLINE);
+    }
     fprintf(
         D_LLVM_FILE,
         "attributes #1 = { \"frame-pointer\"=\"all\" \"no-trapping-math\"=\"true\" "
         "\"stack-protector-buffer-size\"=\"8\" \"target-cpu\"=\"x86-64\" "
         "\"target-features\"=\"+cx8,+fxsr,+mmx,+sse,+sse2,+x87\" \"tune-cpu\"=\"generic\" }" NEWLINE
             NEWLINE);
-    fprintf(D_LLVM_FILE, "!llvm.module.flags = !{!0, !1, !2, !3, !4}" NEWLINE);
+    for (int i = 0; i < num_attribute_groups; i++) {
+        fprintf(D_LLVM_FILE, "attributes #%d = { %s " PURPLE_TARGET_ATTRIBUTES " }" NEWLINE NEWLINE,
+                PURPLE_FIRST_INFERRED_ATTRIBUTE_GROUP + i, attribute_groups[i]);
+        tracked_free(attribute_groups[i]);
+    }
+    tracked_free(attribute_groups);
+    attribute_groups = NULL;
+    num_attribute_groups = 0;
+    fprintf(D_LLVM_FILE, "!llvm.module.flags = !{!0, !1, !2, !3, !4");
+    if (profile_summary >= 0) {
+        fprintf(D_LLVM_FILE, ", !%d", profile_summary);
+    }
+    if (compile_unit >= 0) {
+        char dwarf_version[64];
+        snprintf(dwarf_version, sizeof(dwarf_version), "!{i32 7, !\"Dwarf Version\", i32 %d}",
+                 PURPLE_DWARF_VERSION);
+        fprintf(D_LLVM_FILE, ", !%d, !%d", llvm_metadata_node(dwarf_version),
+                llvm_metadata_node("!{i32 2, !\"Debug Info Version\", i32 3}"));
+    }
+    fprintf(D_LLVM_FILE, "}" NEWLINE);
+    if (compile_unit >= 0) {
+        fprintf(D_LLVM_FILE, "!llvm.dbg.cu = !{!%d}" NEWLINE, compile_unit);
+    }
     fprintf(D_LLVM_FILE, "!llvm.ident = !{!5}" NEWLINE NEWLINE);
     fprintf(D_LLVM_FILE, "!0 = !{i32 1, !\"wchar_size\", i32 4}" NEWLINE);
     fprintf(D_LLVM_FILE, "!1 = !{i32 7, !\"PIC Level\", i32 2}" NEWLINE);
     fprintf(D_LLVM_FILE, "!2 = !{i32 7, !\"PIE Level\", i32 2}" NEWLINE);
     fprintf(D_LLVM_FILE, "!3 = !{i32 7, !\"uwtable\", i32 1}" NEWLINE);
     fprintf(D_LLVM_FILE, "!4 = !{i32 7, !\"frame-pointer\", i32 2}" NEWLINE);
-    fprintf(D_LLVM_FILE, "!5 = !{!\"Ubuntu clang version 14.0.0-1ubuntu1\"}" NEWLINE);
+    fprintf(D_LLVM_FILE, "!5 = !{!\"" PROJECT_NAME_AND_VERS "\"}" NEWLINE);
+    for (int i = 0; i < module_metadata.num_nodes; i++) {
+        fprintf(D_LLVM_FILE, "!%d = %s" NEWLINE, PURPLE_FIRST_METADATA_NODE + i,
+                module_metadata.nodes[i]);
+    }
+    free_metadata_nodes(&module_metadata);
 }
 
-LLVMStackEntryNode* buffered_stack_entries_head = NULL;
+/**Every stack slot of the current function, emitted together at the start of its entry block*/
+static _Thread_local LLVMStackEntryNode* function_stack_slots = NULL;
+/**Stack slots that no live temporary occupies, and so may be handed out again*/
+static _Thread_local LLVMStackEntryNode* free_stack_slots = NULL;
+/**Stack slots handed out during the statement currently being generated*/
+static _Thread_local LLVMStackEntryNode* statement_stack_slots = NULL;
+/**Number of stack slots in the current function*/
+static _Thread_local type_register num_function_stack_slots = 0;
 
 /**
- * @brief Allocate space on stack for variables
+ * @brief Get a stack slot, reusing a slot of the same shape left free by an earlier statement if
+ * there is one. Slots are hoisted into the entry block when the function ends, so a slot requested
+ * inside a loop does not grow the stack on every iteration
  * 
- * @param stack_entries LLVMStackEntryNode pointers holding stack allocation information
- * @return bool True if stack_entries may be freed
+ * @param type                  NumberType of the value the slot holds
+ * @param pointer_depth         Pointer depth of the value the slot holds
+ * @param length                Number of values the slot holds if it is an array, or 0
+ * @return LLVMStackEntryNode*  The stack slot
  */
-bool llvm_stack_allocation(LLVMStackEntryNode* stack_entries)
+static LLVMStackEntryNode* llvm_find_stack_slot(NumberType type, int pointer_depth,
+                                                unsigned long long int length)
 {
-    LLVMStackEntryNode* current = stack_entries;
+    LLVMStackEntryNode* slot = NULL;
+
+    // Look for a free slot of the same shape
+    for (LLVMStackEntryNode** current = &free_stack_slots; *current; current = &(*current)->next) {
+        if ((*current)->type == type && (*current)->pointer_depth == pointer_depth &&
+            (*current)->length == length) {
+            slot = *current;
+            *current = slot->next;
+            break;
+        }
+    }
 
-    // If the preamble hasn't been printed, buffer the stack entries and allocate them once it is printed
-    if (!D_CURRENT_FUNCTION_PREAMBLE_PRINTED) {
-        if (buffered_stack_entries_head == NULL) {
-            buffered_stack_entries_head = stack_entries;
-        } else {
-            LLVMStackEntryNode* current_buffer = buffered_stack_entries_head;
-            while (current_buffer->next != NULL) {
-                current_buffer = current_buffer->next;
-            }
-            current_buffer->next = stack_entries;
+    if (slot == NULL) {
+        slot = (LLVMStackEntryNode*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMStackEntryNode));
+        if (slot == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for stack slot");
         }
+        slot->reg = num_function_stack_slots++;
+        slot->type = type;
+        slot->pointer_depth = pointer_depth;
+        slot->align_bytes = pointer_depth ? PURPLE_POINTER_ALIGN_BYTES : numberTypeByteSizes[type];
+        slot->length = length;
+
+        // Remember the slot so that it can be allocated in the entry block
+        LLVMStackEntryNode* record =
+            (LLVMStackEntryNode*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMStackEntryNode));
+        if (record == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for stack slot");
+        }
+        *record = *slot;
+        record->next = function_stack_slots;
+        function_stack_slots = record;
+    }
 
-        return false;
+    slot->next = statement_stack_slots;
+    statement_stack_slots = slot;
+
+    return slot;
+}
+
+/**
+ * @brief Get a stack slot for a temporary
+ * 
+ * @param type          NumberType of the value the slot holds
+ * @param pointer_depth Pointer depth of the value the slot holds
+ * @return LLVMValue    Pointer to the stack slot
+ */
+LLVMValue llvm_allocate_stack_slot(NumberType type, int pointer_depth)
+{
+    LLVMStackEntryNode* slot = llvm_find_stack_slot(type, pointer_depth, 0);
+
+    LLVMValue out = LLVMVALUE_VIRTUAL_REGISTER_POINTER(0, type, pointer_depth + 1);
+    out.has_name = true;
+    sprintf(out.value.name, PURPLE_STACK_SLOT_PREFIX "%llu", slot->reg);
+    return out;
+}
+
+/**
+ * @brief Get a stack slot for a temporary array of numbers
+ * 
+ * @param type          NumberType of the array's elements
+ * @param length        Number of elements in the array
+ * @return LLVMValue    Pointer to the stack slot, whose type is a pointer to [length x type] even
+ * though it is described as a pointer to type
+ */
+LLVMValue llvm_allocate_stack_array(NumberType type, unsigned long long int length)
+{
+    LLVMStackEntryNode* slot = llvm_find_stack_slot(type, 0, length);
+
+    LLVMValue out = LLVMVALUE_VIRTUAL_REGISTER_POINTER(0, type, 1);
+    out.has_name = true;
+    sprintf(out.value.name, PURPLE_STACK_SLOT_PREFIX "%llu", slot->reg);
+    return out;
+}
+
+/**
+ * @brief Mark every stack slot handed out during the current statement as free. Temporaries
+ * never outlive the statement that created them, so statements may share slots
+ */
+void llvm_release_stack_slots(void)
+{
+    while (statement_stack_slots) {
+        LLVMStackEntryNode* slot = statement_stack_slots;
+        statement_stack_slots = slot->next;
+        slot->next = free_stack_slots;
+        free_stack_slots = slot;
     }
+}
 
-    if (current) {
+/**
+ * @brief Allocate every stack slot of the current function, and reset the slot allocator
+ */
+static void llvm_stack_allocation(void)
+{
+    llvm_release_stack_slots();
+
+    if (function_stack_slots) {
         print_function_annotation("llvm_stack_allocation");
     }
-    while (current) {
-        fprintf(D_LLVM_FILE, TAB "%%%llu = alloca %s%s, align %d" NEWLINE, current->reg,
-                numberTypeLLVMReprs[current->type], REFSTRING(current->pointer_depth),
+
+    // Slots were prepended as they were created, so reverse them to allocate in creation order
+    LLVMStackEntryNode* reversed = NULL;
+    while (function_stack_slots) {
+        LLVMStackEntryNode* next = function_stack_slots->next;
+        function_stack_slots->next = reversed;
+        reversed = function_stack_slots;
+        function_stack_slots = next;
+    }
+    function_stack_slots = reversed;
+
+    for (LLVMStackEntryNode* current = function_stack_slots; current; current = current->next) {
+        if (current->length) {
+            fprintf(D_LLVM_FILE,
+                    TAB "%%" PURPLE_STACK_SLOT_PREFIX "%llu = alloca [%llu x %s], align %d" NEWLINE,
+                    current->reg, current->length, numberTypeLLVMReprs[current->type],
+                    current->align_bytes);
+            continue;
+        }
+        fprintf(D_LLVM_FILE,
+                TAB "%%" PURPLE_STACK_SLOT_PREFIX "%llu = alloca %s%s, align %d" NEWLINE,
+                current->reg, numberTypeLLVMReprs[current->type], REFSTRING(current->pointer_depth),
                 current->align_bytes);
-        current = current->next;
     }
 
-    return true;
+    free_llvm_stack_entry_node_list(function_stack_slots);
+    free_llvm_stack_entry_node_list(free_stack_slots);
+    function_stack_slots = NULL;
+    free_stack_slots = NULL;
+    num_function_stack_slots = 0;
+}
+
+/**Registers of the current function holding extended values*/
+static _Thread_local LLVMExtension* extensions = NULL;
+/**Number of extensions in extensions*/
+static _Thread_local unsigned long long int num_extensions = 0;
+/**Size of extensions*/
+static _Thread_local unsigned long long int extensions_capacity = 0;
+
+/**
+ * @brief Get the bounds of an LLVMValue
+ * 
+ * @param value         Number value to get the bounds of
+ * @return ValueRange   Bounds of value, or every value of its type if it is not known
+ */
+static ValueRange llvmvalue_range(LLVMValue value)
+{
+    if (value.value_type == LLVMVALUETYPE_CONSTANT) {
+        return (ValueRange){.min = value.value.constant, .max = value.value.constant};
+    } else if (value.has_range) {
+        return value.range;
+    }
+
+    return number_type_range(value.num_info.number_type);
+}
+
+/**
+ * @brief Bound an LLVMValue, if ranges are being tracked and the bounds are tighter than its type
+ * 
+ * @param value         Number value to bound
+ * @param range         Bounds of value
+ * @return LLVMValue    Bounded value
+ */
+static LLVMValue llvmvalue_with_range(LLVMValue value, ValueRange range)
+{
+    ValueRange full = number_type_range(value.num_info.number_type);
+    if (D_ARGS->range_analysis && range_fits_number_type(range, value.num_info.number_type) &&
+        (range.min != full.min || range.max != full.max)) {
+        value.has_range = true;
+        value.range = range;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Find the value an extended register was extended from
+ * 
+ * @param value         Value that may have been extended
+ * @return LLVMValue*   Value before extension, or NULL if value wasn't extended
+ */
+static LLVMValue* extension_source(LLVMValue value)
+{
+    if (value.value_type != LLVMVALUETYPE_VIRTUAL_REGISTER || value.has_name) {
+        return NULL;
+    }
+
+    for (unsigned long long int i = 0; i < num_extensions; i++) {
+        if (extensions[i].extended == value.value.virtual_register_index) {
+            return &extensions[i].source;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Remember the value an extended register was extended from
+ * 
+ * @param extended  Register holding the extended value
+ * @param source    Value before extension
+ */
+static void add_extension(LLVMValue extended, LLVMValue source)
+{
+    if (num_extensions >= extensions_capacity) {
+        extensions_capacity = extensions_capacity ? extensions_capacity * 2 : 16;
+        extensions = tracked_realloc(MEMORY_CODEGEN, extensions,
+                                     sizeof(LLVMExtension) * extensions_capacity);
+        if (extensions == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to reallocate list of extended registers");
+        }
+    }
+
+    extensions[num_extensions++] =
+        (LLVMExtension){.extended = extended.value.virtual_register_index, .source = source};
+}
+
+/**
+ * @brief Get the overflow flags of an addition, subtraction, or multiplication. Arithmetic wraps in
+ * two's complement, so nsw is never given, but nuw is given when the operands' ranges prove that
+ * unsigned overflow can't happen
+ * 
+ * @param operation     Arithmetic operation
+ * @param left          Left operand
+ * @param right         Right operand
+ * @return const char*  Overflow flags of the instruction, each followed by a space
+ */
+static const char* overflow_flags(TokenType operation, LLVMValue left, LLVMValue right)
+{
+    ValueRange left_range = llvmvalue_range(left), right_range = llvmvalue_range(right), result;
+
+    // Non-negative values whose non-negative result fits the signed type can't wrap unsigned
+    if (D_ARGS->range_analysis && left_range.min >= 0 && right_range.min >= 0 &&
+        range_arithmetic(operation, left_range, right_range, &result) && result.min >= 0 &&
+        range_fits_number_type(result, left.num_info.number_type)) {
+        return "nuw ";
+    }
+
+    return "";
+}
+
+/**
+ * @brief Bound the result of an arithmetic operation by the bounds of its operands
+ * 
+ * @param operation     Arithmetic operation
+ * @param out           Result of operation
+ * @param left          Left operand
+ * @param right         Right operand
+ * @return LLVMValue    Bounded result
+ */
+static LLVMValue arithmetic_result(TokenType operation, LLVMValue out, LLVMValue left,
+                                   LLVMValue right)
+{
+    ValueRange result;
+    if (range_arithmetic(operation, llvmvalue_range(left), llvmvalue_range(right), &result)) {
+        out = llvmvalue_with_range(out, result);
+    }
+
+    return out;
 }
 
 /**
@@ -243,12 +881,15 @@ bool llvm_stack_allocation(LLVMStackEntryNode* stack_entries)
 static LLVMValue llvm_add(LLVMValue left_virtual_register, LLVMValue right_virtual_register)
 {
     print_function_annotation("llvm_add");
-    fprintf(D_LLVM_FILE, TAB "%%%llu = add nsw %s %s, ", get_next_local_virtual_register(),
+    fprintf(D_LLVM_FILE, TAB "%%%llu = add %s%s %s, ", get_next_local_virtual_register(),
+            overflow_flags(T_PLUS, left_virtual_register, right_virtual_register),
             numberTypeLLVMReprs[left_virtual_register.num_info.number_type],
             LLVM_REPR_NOTYPE(left_virtual_register));
     fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right_virtual_register));
-    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
-                                      left_virtual_register.num_info.number_type);
+    return arithmetic_result(T_PLUS,
+                             LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
+                                                        left_virtual_register.num_info.number_type),
+                             left_virtual_register, right_virtual_register);
 }
 
 /**
@@ -261,12 +902,15 @@ static LLVMValue llvm_add(LLVMValue left_virtual_register, LLVMValue right_virtu
 static LLVMValue llvm_subtract(LLVMValue left_virtual_register, LLVMValue right_virtual_register)
 {
     print_function_annotation("llvm_subtract");
-    fprintf(D_LLVM_FILE, TAB "%%%llu = sub nsw %s %s, ", get_next_local_virtual_register(),
+    fprintf(D_LLVM_FILE, TAB "%%%llu = sub %s%s %s, ", get_next_local_virtual_register(),
+            overflow_flags(T_MINUS, left_virtual_register, right_virtual_register),
             numberTypeLLVMReprs[left_virtual_register.num_info.number_type],
             LLVM_REPR_NOTYPE(left_virtual_register));
     fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right_virtual_register));
-    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
-                                      left_virtual_register.num_info.number_type);
+    return arithmetic_result(T_MINUS,
+                             LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
+                                                        left_virtual_register.num_info.number_type),
+                             left_virtual_register, right_virtual_register);
 }
 
 /**
@@ -279,12 +923,15 @@ static LLVMValue llvm_subtract(LLVMValue left_virtual_register, LLVMValue right_
 static LLVMValue llvm_multiply(LLVMValue left_virtual_register, LLVMValue right_virtual_register)
 {
     print_function_annotation("llvm_multiply");
-    fprintf(D_LLVM_FILE, TAB "%%%llu = mul nsw %s %s, ", get_next_local_virtual_register(),
+    fprintf(D_LLVM_FILE, TAB "%%%llu = mul %s%s %s, ", get_next_local_virtual_register(),
+            overflow_flags(T_STAR, left_virtual_register, right_virtual_register),
             numberTypeLLVMReprs[left_virtual_register.num_info.number_type],
             LLVM_REPR_NOTYPE(left_virtual_register));
     fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right_virtual_register));
-    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
-                                      left_virtual_register.num_info.number_type);
+    return arithmetic_result(T_STAR,
+                             LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
+                                                        left_virtual_register.num_info.number_type),
+                             left_virtual_register, right_virtual_register);
 }
 
 /**
@@ -300,61 +947,266 @@ static LLVMValue llvm_divide(LLVMValue left_virtual_register, LLVMValue right_vi
             numberTypeLLVMReprs[left_virtual_register.num_info.number_type],
             LLVM_REPR_NOTYPE(left_virtual_register));
     fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right_virtual_register));
-    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
-                                      left_virtual_register.num_info.number_type);
+    return arithmetic_result(T_SLASH,
+                             LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
+                                                        left_virtual_register.num_info.number_type),
+                             left_virtual_register, right_virtual_register);
 }
 
 /**
- * @brief Generates LLVM-IR for various binary arithmetic expressions
+ * @brief Generate a single binary instruction whose operands and result share a type
  * 
- * @param operation Operation to perform
- * @param left_virtual_register Operand left of operation
- * @param right_virtual_register Operand right of operation
- * @return int Number of virtual register in which the result is stored
+ * @param instruction   LLVM instruction to generate
+ * @param type          Type of operands and result
+ * @param left          Left operand
+ * @param right         Right operand
+ * @return LLVMValue    Virtual register holding result
  */
-LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_register,
-                                 LLVMValue right_virtual_register)
+static LLVMValue llvm_power_instruction(const char* instruction, NumberType type, LLVMValue left,
+                                        LLVMValue right)
 {
-    LLVMValue out_register;
+    fprintf(D_LLVM_FILE, TAB "%%%llu = %s %s %s, ", get_next_local_virtual_register(), instruction,
+            numberTypeLLVMReprs[type], LLVM_REPR_NOTYPE(left));
+    fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right));
+    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1, type);
+}
 
-    if (left_virtual_register.value_type == LLVMVALUETYPE_CONSTANT &&
-        right_virtual_register.value_type == LLVMVALUETYPE_CONSTANT) {
-        out_register = LLVMVALUE_CONSTANT(0);
-        switch (operation) {
-        case T_PLUS:
-            out_register.value.constant =
-                left_virtual_register.value.constant + right_virtual_register.value.constant;
-            break;
-        case T_MINUS:
-            out_register.value.constant =
-                left_virtual_register.value.constant - right_virtual_register.value.constant;
-            break;
-        case T_STAR:
-            out_register.value.constant =
-                left_virtual_register.value.constant * right_virtual_register.value.constant;
-            break;
-        case T_SLASH:
-            out_register.value.constant =
-                left_virtual_register.value.constant / right_virtual_register.value.constant;
-            break;
-        case T_EXPONENT:
-            out_register.value.constant = (int)pow(left_virtual_register.value.constant,
-                                                   right_virtual_register.value.constant);
-            break;
-        default:
-            fatal(RC_COMPILER_ERROR,
-                  "Can't perform compile-time reduction of constant integer values on operation "
-                  "\'%s\'",
-                  tokenStrings[operation]);
+/**
+ * @brief Generate code raising a value to a constant power as a chain of multiplications, squaring
+ * once for each bit of the exponent
+ * 
+ * @param base      Value to raise to a power
+ * @param exponent  Non-negative power to raise base to
+ * @return LLVMValue Virtual register holding result
+ */
+static LLVMValue llvm_unrolled_exponent(LLVMValue base, long long int exponent)
+{
+    NumberType type = base.num_info.number_type;
+
+    if (exponent == 0) {
+        LLVMValue one = LLVMVALUE_CONSTANT(1);
+        one.num_info.number_type = type;
+        return one;
+    }
+
+    // Work down from the highest set bit, so only the running result is ever live
+    int bit = 63 - __builtin_clzll(exponent);
+    LLVMValue result = base;
+    while (--bit >= 0) {
+        result = llvm_power_instruction("mul", type, result, result);
+        if (exponent & (1LL << bit)) {
+            result = llvm_power_instruction("mul", type, result, base);
         }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Generate code raising 2 to a power as a left shift, which is 0 once every bit has been
+ * shifted out
+ * 
+ * @param exponent      Power to raise 2 to
+ * @return LLVMValue    Virtual register holding result
+ */
+static LLVMValue llvm_shifted_exponent(LLVMValue exponent)
+{
+    NumberType type = exponent.num_info.number_type;
+    LLVMValue one = LLVMVALUE_CONSTANT(1);
+    one.num_info.number_type = type;
+
+    // shl is poison for shift amounts of at least the type's width
+    LLVMValue in_range = LLVMVALUE_VIRTUAL_REGISTER(get_next_local_virtual_register(), NT_INT1);
+    fprintf(D_LLVM_FILE, TAB "%%%llu = icmp ult %s %s, %d" NEWLINE,
+            in_range.value.virtual_register_index, numberTypeLLVMReprs[type],
+            LLVM_REPR_NOTYPE(exponent), numberTypeBitSizes[type]);
+    LLVMValue shifted = llvm_power_instruction("shl", type, one, exponent);
+
+    LLVMValue out = LLVMVALUE_VIRTUAL_REGISTER(get_next_local_virtual_register(), type);
+    fprintf(D_LLVM_FILE, TAB "%%%llu = select i1 %%%llu, %s ", out.value.virtual_register_index,
+            in_range.value.virtual_register_index, numberTypeLLVMReprs[type]);
+    fprintf(D_LLVM_FILE, "%s, %s 0" NEWLINE, LLVM_REPR_NOTYPE(shifted), numberTypeLLVMReprs[type]);
+
+    return out;
+}
+
+/**
+ * @brief Generate a square-and-multiply loop raising a value to a power
+ * 
+ * pre_label:
+ * jump header_label
+ * header_label:
+ * result, base, exponent = phi (1, base, exponent), (next_result, next_base, next_exponent)
+ * jump exit_label if exponent == 0
+ * body_label:
+ * next_result = exponent & 1 ? result * base : result
+ * next_base = base * base
+ * next_exponent = exponent >> 1
+ * jump header_label
+ * exit_label:
+ * 
+ * @param base      Value to raise to a power
+ * @param exponent  Power to raise base to
+ * @return LLVMValue Named virtual register holding result
+ */
+static LLVMValue llvm_exponent_loop(LLVMValue base, LLVMValue exponent)
+{
+    NumberType type = base.num_info.number_type;
+    const char* type_repr = numberTypeLLVMReprs[type];
+
+    LLVMValue pre_label = get_next_label();
+    LLVMValue header_label = get_next_label();
+    LLVMValue body_label = get_next_label();
+    LLVMValue exit_label = get_next_label();
+
+    // Every value of the loop is named after its header, so the phis may refer to values defined
+    // after them
+    char names[8][64];
+    const char* suffixes[] = {"result",    "base",          "exponent", "next_result",
+                              "next_base", "next_exponent", "is_odd",   "product"};
+    for (int i = 0; i < 8; i++) {
+        sprintf(names[i], "%%" PURPLE_POWER_PREFIX "%llu.%s", header_label.value.label_index,
+                suffixes[i]);
+    }
+    char *result = names[0], *loop_base = names[1], *loop_exponent = names[2],
+         *next_result = names[3], *next_base = names[4], *next_exponent = names[5],
+         *is_odd = names[6], *product = names[7];
+
+    // The loop's phis need a predecessor with a known name
+    llvm_jump(pre_label);
+    llvm_label(pre_label);
+    llvm_jump(header_label);
+    llvm_loop_header_label(header_label);
+
+    print_function_annotation("llvm_exponent_loop");
+    fprintf(D_LLVM_FILE, TAB "%s = phi %s [ 1, %%" PURPLE_LABEL_PREFIX "%llu ], ", result,
+            type_repr, pre_label.value.label_index);
+    fprintf(D_LLVM_FILE, "[ %s, %%" PURPLE_LABEL_PREFIX "%llu ]" NEWLINE, next_result,
+            body_label.value.label_index);
+    fprintf(D_LLVM_FILE, TAB "%s = phi %s [ %s, %%" PURPLE_LABEL_PREFIX "%llu ], ", loop_base,
+            type_repr, LLVM_REPR_NOTYPE(base), pre_label.value.label_index);
+    fprintf(D_LLVM_FILE, "[ %s, %%" PURPLE_LABEL_PREFIX "%llu ]" NEWLINE, next_base,
+            body_label.value.label_index);
+    fprintf(D_LLVM_FILE, TAB "%s = phi %s [ %s, %%" PURPLE_LABEL_PREFIX "%llu ], ", loop_exponent,
+            type_repr, LLVM_REPR_NOTYPE(exponent), pre_label.value.label_index);
+    fprintf(D_LLVM_FILE, "[ %s, %%" PURPLE_LABEL_PREFIX "%llu ]" NEWLINE, next_exponent,
+            body_label.value.label_index);
+
+    LLVMValue is_done = LLVMVALUE_VIRTUAL_REGISTER(get_next_local_virtual_register(), NT_INT1);
+    fprintf(D_LLVM_FILE, TAB "%%%llu = icmp eq %s %s, 0" NEWLINE,
+            is_done.value.virtual_register_index, type_repr, loop_exponent);
+    llvm_conditional_jump(is_done, exit_label, body_label, BRANCH_HINT_NONE);
+
+    llvm_label(body_label);
+    print_function_annotation("llvm_exponent_loop");
+    fprintf(D_LLVM_FILE, TAB "%s = trunc %s %s to i1" NEWLINE, is_odd, type_repr, loop_exponent);
+    fprintf(D_LLVM_FILE, TAB "%s = mul %s %s, %s" NEWLINE, product, type_repr, result, loop_base);
+    fprintf(D_LLVM_FILE, TAB "%s = select i1 %s, %s %s, %s %s" NEWLINE, next_result, is_odd,
+            type_repr, product, type_repr, result);
+    fprintf(D_LLVM_FILE, TAB "%s = mul %s %s, %s" NEWLINE, next_base, type_repr, loop_base,
+            loop_base);
+    fprintf(D_LLVM_FILE, TAB "%s = lshr %s %s, 1" NEWLINE, next_exponent, type_repr,
+            loop_exponent);
+    llvm_jump(header_label);
+    ssa_seal_block(header_label);
+
+    llvm_label(exit_label);
+
+    LLVMValue out = {.value_type = LLVMVALUETYPE_VIRTUAL_REGISTER,
+                     .num_info = (Number){.number_type = type, .pointer_depth = 0},
+                     .has_name = true};
+    // Named values are written without their "%"
+    strcpy(out.value.name, result + 1);
+    return out;
+}
+
+/**
+ * @brief Generate code for integer exponentiation. Overflow wraps, and the exponent is treated as
+ * unsigned, like the operands of division
+ * 
+ * @param base      Value to raise to a power
+ * @param exponent  Power to raise base to, of the same type as base
+ * @return LLVMValue Virtual register holding result
+ */
+static LLVMValue llvm_exponent(LLVMValue base, LLVMValue exponent)
+{
+    print_function_annotation("llvm_exponent");
+
+    if (exponent.value_type == LLVMVALUETYPE_CONSTANT && exponent.value.constant >= 0 &&
+        exponent.value.constant <= PURPLE_MAX_UNROLLED_EXPONENT) {
+        return llvm_unrolled_exponent(base, exponent.value.constant);
+    } else if (base.value_type == LLVMVALUETYPE_CONSTANT && base.value.constant == 2) {
+        return llvm_shifted_exponent(exponent);
+    }
+
+    return llvm_exponent_loop(base, exponent);
+}
+
+/**
+ * @brief Find the narrowest type that an addition, subtraction, or multiplication can be performed
+ * in without changing its result. The operands' ranges must prove that neither they nor the result
+ * are truncated by it, so that extending the result gives the value of the full-width operation
+ * 
+ * @param operation     Arithmetic operation
+ * @param left          Left operand
+ * @param right         Right operand
+ * @param result_type   Type of the operation in the source program
+ * @return NumberType   Type to perform the operation in
+ */
+static NumberType narrowest_arithmetic_type(TokenType operation, LLVMValue left, LLVMValue right,
+                                            NumberType result_type)
+{
+    ValueRange left_range = llvmvalue_range(left), right_range = llvmvalue_range(right), result;
+
+    if (!D_ARGS->range_analysis ||
+        (operation != T_PLUS && operation != T_MINUS && operation != T_STAR) ||
+        !range_arithmetic(operation, left_range, right_range, &result)) {
+        return result_type;
+    }
+
+    // Only types the operands had before being extended are tried, so that no more resizes are
+    // needed than before
+    LLVMValue* left_source = extension_source(left);
+    LLVMValue* right_source = extension_source(right);
+    for (NumberType type = NT_INT8; type < result_type; type++) {
+        bool is_operand_type = type == left.num_info.number_type ||
+                               type == right.num_info.number_type ||
+                               (left_source && type == left_source->num_info.number_type) ||
+                               (right_source && type == right_source->num_info.number_type);
+        if (is_operand_type && range_fits_number_type(left_range, type) &&
+            range_fits_number_type(right_range, type) && range_fits_number_type(result, type)) {
+            return type;
+        }
+    }
 
-        out_register.num_info.number_type = MIN(left_virtual_register.num_info.number_type,
-                                                right_virtual_register.num_info.number_type);
-        while (out_register.value.constant >
-               numberTypeMaxValues[out_register.num_info.number_type]) {
-            out_register.num_info.number_type++;
-        }
+    return result_type;
+}
 
+/**
+ * @brief Generates LLVM-IR for various binary arithmetic expressions
+ * 
+ * @param operation Operation to perform
+ * @param left_virtual_register Operand left of operation
+ * @param right_virtual_register Operand right of operation
+ * @return int Number of virtual register in which the result is stored
+ */
+LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_register,
+                                 LLVMValue right_virtual_register)
+{
+    LLVMValue out_register;
+    Number reduced;
+
+    // Constants are reduced in the type the operation would run in, wrapping like it would
+    if (D_ARGS->const_expr_reduce && left_virtual_register.value_type == LLVMVALUETYPE_CONSTANT &&
+        right_virtual_register.value_type == LLVMVALUETYPE_CONSTANT &&
+        wrapping_arithmetic(operation,
+                            NUMBER_FROM_TYPE_VAL(left_virtual_register.num_info.number_type,
+                                                 left_virtual_register.value.constant),
+                            NUMBER_FROM_TYPE_VAL(right_virtual_register.num_info.number_type,
+                                                 right_virtual_register.value.constant),
+                            &reduced)) {
+        out_register = LLVMVALUE_CONSTANT(reduced.value);
+        out_register.num_info.number_type = reduced.number_type;
         return out_register;
     }
 
@@ -363,7 +1215,7 @@ LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_reg
     if (loaded_registers != NULL) {
         left_virtual_register = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers (1)", "llvm_binary_arithmetic");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
         loaded_registers = NULL;
     }
 
@@ -371,18 +1223,18 @@ LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_reg
     if (loaded_registers != NULL) {
         right_virtual_register = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers (2)", "llvm_binary_arithmetic");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
     }
 
-    if (left_virtual_register.num_info.number_type != right_virtual_register.num_info.number_type) {
-        if (left_virtual_register.num_info.number_type <
-            right_virtual_register.num_info.number_type) {
-            left_virtual_register =
-                llvm_int_resize(left_virtual_register, right_virtual_register.num_info.number_type);
-        } else {
-            right_virtual_register =
-                llvm_int_resize(right_virtual_register, left_virtual_register.num_info.number_type);
-        }
+    NumberType result_type = MAX(left_virtual_register.num_info.number_type,
+                                 right_virtual_register.num_info.number_type);
+    NumberType operation_type = narrowest_arithmetic_type(operation, left_virtual_register,
+                                                          right_virtual_register, result_type);
+    if (left_virtual_register.num_info.number_type != operation_type) {
+        left_virtual_register = llvm_int_resize(left_virtual_register, operation_type);
+    }
+    if (right_virtual_register.num_info.number_type != operation_type) {
+        right_virtual_register = llvm_int_resize(right_virtual_register, operation_type);
     }
 
     switch (operation) {
@@ -399,8 +1251,7 @@ LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_reg
         out_register = llvm_divide(left_virtual_register, right_virtual_register);
         break;
     case T_EXPONENT:
-        fatal(RC_COMPILER_ERROR,
-              "Exponent not yet supported, as libc pow only takes floating-point types");
+        out_register = llvm_exponent(left_virtual_register, right_virtual_register);
         break;
     default:
         fatal(RC_COMPILER_ERROR,
@@ -408,25 +1259,51 @@ LLVMValue llvm_binary_arithmetic(TokenType operation, LLVMValue left_virtual_reg
               tokenStrings[operation]);
     }
 
-    return out_register;
+    // A narrowed result is extended back to the type the operation has in the source program
+    return llvm_int_resize(out_register, result_type);
 }
 
 /**
- * @brief Store a constant number value into a register
- * 
- * @param value Number struct containing information about the constant
- * @return int Register number value is held in
+ * @brief Combine a value into an accumulator. Unlike llvm_binary_arithmetic, overflow wraps, as the
+ * accumulated operations may be performed in a different order than the source program's
+ *
+ * @param operation     Associative and commutative operation to perform
+ * @param accumulator   Current value of accumulator
+ * @param value         Value to combine into accumulator, resized to accumulator's type
+ * @return LLVMValue    New value of accumulator
  */
-LLVMValue llvm_store_constant(Number value)
+LLVMValue llvm_accumulate(TokenType operation, LLVMValue accumulator, LLVMValue value)
 {
-    purple_log(LOG_DEBUG, "Storing constant value %ld", value.value);
-    print_function_annotation("llvm_store_constant");
-    type_register out_register_number = pop_stack_entry_linked_list(&freeVirtualRegistersHead);
-    fprintf(D_LLVM_FILE, TAB "store %s ", numberTypeLLVMReprs[value.number_type]);
-    fprintf(D_LLVM_FILE, numberTypeFormatStrings[value.number_type], value.value);
-    fprintf(D_LLVM_FILE, ", %s* %%%llu, align %d" NEWLINE, numberTypeLLVMReprs[value.number_type],
-            out_register_number, numberTypeByteSizes[value.number_type]);
-    return LLVMVALUE_VIRTUAL_REGISTER_POINTER(out_register_number, value.number_type, 1);
+    LLVMValue* loaded_registers = llvm_ensure_registers_fully_loaded(1, (LLVMValue[]){value});
+    if (loaded_registers != NULL) {
+        value = loaded_registers[0];
+        purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_accumulate");
+        tracked_free(loaded_registers);
+    }
+
+    if (value.num_info.number_type != accumulator.num_info.number_type) {
+        value = llvm_int_resize(value, accumulator.num_info.number_type);
+    }
+
+    const char* instruction;
+    switch (operation) {
+    case T_PLUS:
+        instruction = "add";
+        break;
+    case T_STAR:
+        instruction = "mul";
+        break;
+    default:
+        fatal(RC_COMPILER_ERROR, "llvm_accumulate received non-associative operator \"%s\"",
+              tokenStrings[operation]);
+    }
+
+    print_function_annotation("llvm_accumulate");
+    fprintf(D_LLVM_FILE, TAB "%%%llu = %s %s %s, ", get_next_local_virtual_register(), instruction,
+            numberTypeLLVMReprs[accumulator.num_info.number_type], LLVM_REPR_NOTYPE(accumulator));
+    fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(value));
+    return LLVMVALUE_VIRTUAL_REGISTER(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1,
+                                      accumulator.num_info.number_type);
 }
 
 /**
@@ -460,7 +1337,7 @@ LLVMValue llvm_load_global_variable(char* symbol_name)
     fprintf(D_LLVM_FILE, TAB "%%%llu = load %s%s, ", out_register_number,
             numberTypeLLVMReprs[symbol->type.value.number.number_type],
             REFSTRING(symbol->type.value.number.pointer_depth - 1));
-    fprintf(D_LLVM_FILE, "%s%s @%s" NEWLINE,
+    fprintf(D_LLVM_FILE, "%s%s @%s",
             numberTypeLLVMReprs[symbol->type.value.number.number_type],
             REFSTRING(symbol->type.value.number.pointer_depth), symbol_name);
 
@@ -468,6 +1345,14 @@ LLVMValue llvm_load_global_variable(char* symbol_name)
                                                        symbol->type.value.number.number_type,
                                                        symbol->type.value.number.pointer_depth - 1);
 
+    // Every value stored to the variable is known to be within its range
+    if (D_ARGS->range_analysis && symbol->has_range) {
+        fprintf(D_LLVM_FILE, ", !range !%d", llvm_range_metadata(out.num_info.number_type,
+                                                                 symbol->range));
+        out = llvmvalue_with_range(out, symbol->range);
+    }
+    fprintf(D_LLVM_FILE, NEWLINE);
+
     LLVMVALUE_SET_JUSTLOADED(out, symbol_name);
     return out;
 }
@@ -498,7 +1383,7 @@ void llvm_store_global_variable(char* symbol_name, LLVMValue rvalue_register)
             rvalue_register = loaded_registers[0];
             purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers",
                        "llvm_store_global_variable");
-            free(loaded_registers);
+            tracked_free(loaded_registers);
         }
         if (rvalue_register.num_info.pointer_depth != symbol->type.value.number.pointer_depth - 1) {
             fatal(RC_COMPILER_ERROR, "Pointer mismatch when trying to save global variable");
@@ -525,7 +1410,9 @@ void llvm_store_global_variable(char* symbol_name, LLVMValue rvalue_register)
 }
 
 /**
- * @brief Generates an extend or truncate statement to change the bit-width of an integer
+ * @brief Generates an extend or truncate statement to change the bit-width of an integer. Values
+ * that may be negative are sign-extended, and bools and values known to be non-negative are
+ * zero-extended
  * 
  * @param reg           Register whose contents are to be resized
  * @param new_type      New NumberType to resize to
@@ -534,32 +1421,52 @@ void llvm_store_global_variable(char* symbol_name, LLVMValue rvalue_register)
 LLVMValue llvm_int_resize(LLVMValue reg, NumberType new_type)
 {
     if (reg.value_type == LLVMVALUETYPE_CONSTANT) {
-        reg.value.constant = MIN(reg.value.constant, numberTypeMaxValues[new_type]);
+        // Constants are truncated to their low bits like registers are, and otherwise keep their
+        // value, which they were already extended to
+        reg.value.constant = wrap_to_number_type(reg.value.constant, new_type);
         reg.num_info.number_type = new_type;
         return reg;
     } else if (reg.value_type == LLVMVALUETYPE_NONE) {
         fatal(RC_COMPILER_ERROR, "llvm_int_resize tried to resize a null LLVMValue");
+    } else if (reg.num_info.number_type == new_type) {
+        return reg;
+    }
+
+    // Resizing an extended value resizes the value it was extended from instead, so that chains
+    // of resizes collapse into at most one
+    LLVMValue* source = extension_source(reg);
+    if (source && source->num_info.number_type == new_type) {
+        return *source;
+    } else if (source) {
+        reg = *source;
     }
 
     print_function_annotation("llvm_int_resize");
 
+    ValueRange range = llvmvalue_range(reg);
+    bool is_extension = reg.num_info.number_type < new_type;
     char* method;
 
-    if (reg.num_info.number_type < new_type) {
-        method = "zext";
-    } else if (reg.num_info.number_type > new_type) {
+    if (!is_extension) {
         method = "trunc";
+    } else if (reg.num_info.number_type == NT_INT1 || range.min >= 0) {
+        method = "zext";
     } else {
-        return reg;
+        method = "sext";
     }
 
     LLVMValue out = LLVMVALUE_VIRTUAL_REGISTER(get_next_local_virtual_register(), new_type);
 
-    fprintf(D_LLVM_FILE, TAB "%%%llu = %s %s %%%llu to %s" NEWLINE,
-            out.value.virtual_register_index, method, numberTypeLLVMReprs[reg.num_info.number_type],
-            reg.value.virtual_register_index, numberTypeLLVMReprs[new_type]);
+    fprintf(D_LLVM_FILE, TAB "%%%llu = %s %s %s to %s" NEWLINE, out.value.virtual_register_index,
+            method, numberTypeLLVMReprs[reg.num_info.number_type], LLVM_REPR_NOTYPE(reg),
+            numberTypeLLVMReprs[new_type]);
 
-    return out;
+    if (is_extension && D_ARGS->range_analysis) {
+        add_extension(out, reg);
+    }
+
+    // Truncation keeps the value only if it fits
+    return llvmvalue_with_range(out, range);
 }
 
 /**
@@ -570,13 +1477,20 @@ LLVMValue llvm_int_resize(LLVMValue reg, NumberType new_type)
  */
 void llvm_declare_global_number_variable(char* symbol_name, Number n)
 {
-    fprintf(D_LLVM_GLOBALS_FILE, "@%s = global %s%s ", symbol_name,
+    // Variables are private to the file that declares them, so files may reuse names
+    fprintf(D_LLVM_GLOBALS_FILE, "@%s = internal global %s%s ", symbol_name,
             numberTypeLLVMReprs[n.number_type], REFSTRING(n.pointer_depth - 1));
     if (n.pointer_depth - 1 <= 0) {
-        fprintf(D_LLVM_GLOBALS_FILE, "%lld" NEWLINE, n.value);
+        fprintf(D_LLVM_GLOBALS_FILE, "%lld", n.value);
     } else {
-        fprintf(D_LLVM_GLOBALS_FILE, "null" NEWLINE);
+        fprintf(D_LLVM_GLOBALS_FILE, "null");
+    }
+
+    int debug_metadata = debug_global_variable_metadata(GST_FIND(symbol_name));
+    if (debug_metadata >= 0) {
+        fprintf(D_LLVM_GLOBALS_FILE, ", !dbg !%d", debug_metadata);
     }
+    fprintf(D_LLVM_GLOBALS_FILE, NEWLINE);
 }
 
 /**
@@ -587,10 +1501,92 @@ void llvm_declare_global_number_variable(char* symbol_name, Number n)
  */
 void llvm_declare_assign_global_number_variable(char* symbol_name, Number number)
 {
-    fprintf(D_LLVM_GLOBALS_FILE, "@%s = global %s %lld" NEWLINE, symbol_name,
+    fprintf(D_LLVM_GLOBALS_FILE, "@%s = internal global %s %lld" NEWLINE, symbol_name,
             numberTypeLLVMReprs[number.number_type], number.value);
 }
 
+/**
+ * @brief Declare a function that is defined in another file
+ *
+ * @param symbol_name Name of function
+ */
+void llvm_declare_external_function(char* symbol_name)
+{
+    Function* function = &GST_FIND(symbol_name)->type.value.function;
+
+    print_function_annotation("llvm_declare_external_function");
+    fprintf(D_LLVM_FILE, "declare %s @%s(", type_to_llvm_type(function->return_type), symbol_name);
+    for (unsigned long long int i = 0; i < function->num_parameters; i++) {
+        fprintf(D_LLVM_FILE, "%s%s%s", i ? ", " : "",
+                numberTypeLLVMReprs[function->parameters[i].parameter_type.number_type],
+                REFSTRING(function->parameters[i].parameter_type.pointer_depth));
+    }
+    fprintf(D_LLVM_FILE, ")" NEWLINE NEWLINE);
+}
+
+/**Name of the function currently being generated*/
+static _Thread_local char function_name[MAX_IDENTIFIER_LENGTH + 1];
+/**Constants referred to by the function currently being generated, written after its body*/
+static _Thread_local FILE* function_constants_file = NULL;
+/**Buffer holding function_constants_file*/
+static _Thread_local char* function_constants_buffer = NULL;
+/**Size of function_constants_buffer*/
+static _Thread_local size_t function_constants_buffer_size = 0;
+/**Number of constants referred to by the function currently being generated*/
+static _Thread_local unsigned long long int num_function_constants = 0;
+/**Text of the constant prints that haven't been printed yet*/
+static _Thread_local char* pending_print_text = NULL;
+/**Number of bytes in pending_print_text*/
+static _Thread_local size_t pending_print_length = 0;
+/**Size of pending_print_text*/
+static _Thread_local size_t pending_print_capacity = 0;
+
+/**
+ * @brief Add a constant array of bytes for the current function's instructions to refer to
+ * 
+ * @param bytes                     Contents of the constant
+ * @param length                    Number of bytes in the constant
+ * @return unsigned long long int   Index of the constant within the function
+ */
+static unsigned long long int llvm_function_constant(const char* bytes, size_t length)
+{
+    if (function_constants_file == NULL) {
+        function_constants_file =
+            open_memstream(&function_constants_buffer, &function_constants_buffer_size);
+        if (function_constants_file == NULL) {
+            fatal(RC_FILE_ERROR, "Failed to open buffer for constants of function \"%s\"",
+                  function_name);
+        }
+    }
+
+    fprintf(function_constants_file,
+            "@" PURPLE_FUNCTION_CONSTANT_PREFIX "%s.%llu = private unnamed_addr constant "
+            "[%zu x i8] c\"",
+            function_name, num_function_constants, length);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char byte = (unsigned char)bytes[i];
+        if (byte >= ' ' && byte <= '~' && byte != '"' && byte != '\\') {
+            fputc(byte, function_constants_file);
+        } else {
+            fprintf(function_constants_file, "\\%02X", byte);
+        }
+    }
+    fprintf(function_constants_file, "\", align 1" NEWLINE);
+
+    return num_function_constants++;
+}
+
+/**
+ * @brief Generate code to flush the print runtime's buffer after a print, if the program's output
+ * is line-buffered
+ */
+static void llvm_flush_print(void)
+{
+    if (D_ARGS->line_buffered_output) {
+        fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "flush()" NEWLINE);
+    }
+}
+
 /**
  * @brief Generate code to print an integer
  * 
@@ -602,31 +1598,32 @@ void llvm_print_int(LLVMValue print_vr)
     if (loaded_register) {
         print_vr = loaded_register[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_register", "llvm_print_int");
-        free(loaded_register);
+        tracked_free(loaded_register);
     }
 
     print_function_annotation("llvm_print_int");
 
-    get_next_local_virtual_register();
     switch (print_vr.num_info.number_type) {
     case NT_INT8:
     case NT_INT16:
     case NT_INT32:
-        fprintf(D_LLVM_FILE,
-                TAB "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x "
-                    "i8]* @print_int_fstring , i32 0, i32 0), %s %s)" NEWLINE,
-                numberTypeLLVMReprs[print_vr.num_info.number_type], LLVM_REPR_NOTYPE(print_vr));
+        // The runtime prints every integer as a long
+        fprintf(D_LLVM_FILE, TAB "%%%llu = sext %s %s to %s" NEWLINE,
+                get_next_local_virtual_register(),
+                numberTypeLLVMReprs[print_vr.num_info.number_type], LLVM_REPR_NOTYPE(print_vr),
+                numberTypeLLVMReprs[NT_INT64]);
+        fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "i64(%s %%%llu)" NEWLINE,
+                numberTypeLLVMReprs[NT_INT64], D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1);
         break;
     case NT_INT64:
-        fprintf(D_LLVM_FILE,
-                TAB "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([5 x i8], [5 x "
-                    "i8]* @print_long_fstring , i32 0, i32 0), %s %s)" NEWLINE,
+        fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "i64(%s %s)" NEWLINE,
                 numberTypeLLVMReprs[NT_INT64], LLVM_REPR_NOTYPE(print_vr));
         break;
     default:
         fatal(RC_COMPILER_ERROR, "Unrecognized NumberType %s",
               numberTypeNames[print_vr.num_info.number_type]);
     }
+    llvm_flush_print();
 }
 
 /**
@@ -639,30 +1636,126 @@ void llvm_print_bool(LLVMValue print_vr)
     LLVMValue* loaded_register = llvm_ensure_registers_fully_loaded(1, (LLVMValue[]){print_vr});
     if (loaded_register) {
         print_vr = loaded_register[0];
+        tracked_free(loaded_register);
     }
 
     print_function_annotation("llvm_print_bool");
 
-    LLVMValue compare_register = print_vr;
-    LLVMValue true_label, false_label, end_label;
-    true_label = get_next_label();
-    false_label = get_next_label();
-    end_label = get_next_label();
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "i1(%s %s)" NEWLINE,
+            numberTypeLLVMReprs[NT_INT1], LLVM_REPR_NOTYPE(print_vr));
+    llvm_flush_print();
+}
 
-    llvm_conditional_jump(compare_register, true_label, false_label);
-    llvm_label(true_label);
-    get_next_local_virtual_register();
+/**
+ * @brief Generate code to print several values on one line with a single call to the runtime. The
+ * values are widened into an array of longs, alongside a constant array of their kinds
+ * 
+ * @param values        Registers holding the values to print
+ * @param num_values    Number of values to print
+ */
+void llvm_print_values(LLVMValue* values, unsigned long long int num_values)
+{
+    LLVMValue* loaded_registers = llvm_ensure_registers_fully_loaded(num_values, values);
+    if (loaded_registers) {
+        for (unsigned long long int i = 0; i < num_values; i++) {
+            values[i] = loaded_registers[i];
+        }
+        tracked_free(loaded_registers);
+    }
+
+    print_function_annotation("llvm_print_values");
+
+    char* kinds = (char*)tracked_malloc(MEMORY_CODEGEN, num_values);
+    if (kinds == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for print kinds");
+    }
+
+    LLVMValue array = llvm_allocate_stack_array(NT_INT64, num_values);
+    for (unsigned long long int i = 0; i < num_values; i++) {
+        LLVMValue value = values[i];
+        kinds[i] = value.num_info.number_type == NT_INT1 ? PURPLE_PRINT_KIND_BOOL
+                                                         : PURPLE_PRINT_KIND_LONG;
+
+        // Bools are stored as 0 or 1, and every integer as a long
+        if (value.num_info.number_type != NT_INT64) {
+            type_register widened = get_next_local_virtual_register();
+            fprintf(D_LLVM_FILE, TAB "%%%llu = %s %s %s to %s" NEWLINE, widened,
+                    value.num_info.number_type == NT_INT1 ? "zext" : "sext",
+                    numberTypeLLVMReprs[value.num_info.number_type], LLVM_REPR_NOTYPE(value),
+                    numberTypeLLVMReprs[NT_INT64]);
+            value = LLVMVALUE_VIRTUAL_REGISTER(widened, NT_INT64);
+        }
+
+        type_register element = get_next_local_virtual_register();
+        fprintf(D_LLVM_FILE,
+                TAB "%%%llu = getelementptr inbounds [%llu x i64], [%llu x i64]* %s, i64 0, "
+                    "i64 %llu" NEWLINE,
+                element, num_values, num_values, LLVM_REPR_NOTYPE(array), i);
+        fprintf(D_LLVM_FILE, TAB "store i64 %s, i64* %%%llu, align 8" NEWLINE,
+                LLVM_REPR_NOTYPE(value), element);
+    }
+
+    unsigned long long int kinds_constant = llvm_function_constant(kinds, num_values);
+    tracked_free(kinds);
+
+    type_register first = get_next_local_virtual_register();
+    fprintf(D_LLVM_FILE,
+            TAB "%%%llu = getelementptr inbounds [%llu x i64], [%llu x i64]* %s, i64 0, "
+                "i64 0" NEWLINE,
+            first, num_values, num_values, LLVM_REPR_NOTYPE(array));
     fprintf(D_LLVM_FILE,
-            TAB "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([6 x i8], [6 x "
-                "i8]* @print_true_fstring , i32 0, i32 0))" NEWLINE);
-    llvm_jump(end_label);
-    llvm_label(false_label);
-    get_next_local_virtual_register();
+            TAB "call void @" PURPLE_PRINT_PREFIX "values(i64* %%%llu, i8* getelementptr inbounds "
+                "([%llu x i8], [%llu x i8]* @" PURPLE_FUNCTION_CONSTANT_PREFIX "%s.%llu, i64 0, "
+                "i64 0), i64 %llu)" NEWLINE,
+            first, num_values, num_values, function_name, kinds_constant, num_values);
+    llvm_flush_print();
+}
+
+/**
+ * @brief Print text formatted at compile-time. Nothing is generated until something other than a
+ * constant print is, so that consecutive constant prints are printed with a single call
+ * 
+ * @param text Text to print
+ */
+void llvm_print_constant(const char* text)
+{
+    print_function_annotation("llvm_print_constant");
+
+    size_t length = strlen(text);
+    if (pending_print_length + length > pending_print_capacity) {
+        pending_print_capacity = MAX(pending_print_capacity * 2, pending_print_length + length);
+        pending_print_text =
+            (char*)tracked_realloc(MEMORY_CODEGEN, pending_print_text, pending_print_capacity);
+        if (pending_print_text == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for constant print text");
+        }
+    }
+
+    memcpy(pending_print_text + pending_print_length, text, length);
+    pending_print_length += length;
+}
+
+/**
+ * @brief Generate code to print the text of the constant prints that haven't been printed yet
+ */
+void llvm_flush_constant_prints(void)
+{
+    if (pending_print_length == 0) {
+        return;
+    }
+
+    print_function_annotation("llvm_flush_constant_prints");
+
+    unsigned long long int text = llvm_function_constant(pending_print_text, pending_print_length);
     fprintf(D_LLVM_FILE,
-            TAB "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([7 x i8], [7 x "
-                "i8]* @print_false_fstring , i32 0, i32 0))" NEWLINE);
-    llvm_jump(end_label);
-    llvm_label(end_label);
+            TAB "call void @" PURPLE_PRINT_PREFIX "text(i8* getelementptr inbounds ([%zu x i8], "
+                "[%zu x i8]* @" PURPLE_FUNCTION_CONSTANT_PREFIX "%s.%llu, i64 0, i64 0), "
+                "i64 %zu)" NEWLINE,
+            pending_print_length, pending_print_length, function_name, text,
+            pending_print_length);
+    llvm_flush_print();
+
+    pending_print_length = 0;
 }
 
 /**
@@ -750,6 +1843,82 @@ static void llvm_logical_compare(TokenType comparison_type, LLVMValue out_regist
     fprintf(D_LLVM_FILE, "%s" NEWLINE, LLVM_REPR_NOTYPE(right_virtual_register));
 }
 
+/**
+ * @brief Determine the outcome of a relational comparison from the ranges of its operands
+ * 
+ * @param comparison_type   Relational comparison
+ * @param left              Left operand
+ * @param right             Right operand
+ * @param out               Filled with the outcome of the comparison
+ * @return bool             True if every value in the operands' ranges gives the same outcome
+ */
+static bool range_decides_comparison(TokenType comparison_type, LLVMValue left, LLVMValue right,
+                                     long long int* out)
+{
+    // Signed comparisons of bools treat true as -1, which ranges don't
+    if (!D_ARGS->range_analysis || !TOKENTYPE_IS_COMPARATOR(comparison_type) ||
+        (left.value_type == LLVMVALUETYPE_CONSTANT && right.value_type == LLVMVALUETYPE_CONSTANT) ||
+        left.num_info.number_type == NT_INT1 || right.num_info.number_type == NT_INT1) {
+        return false;
+    }
+
+    ValueRange l = llvmvalue_range(left), r = llvmvalue_range(right);
+    bool is_less = l.max < r.min, is_greater = l.min > r.max;
+    bool is_equal = l.min == l.max && r.min == r.max && l.min == r.min;
+
+    switch (comparison_type) {
+    case T_EQ:
+    case T_NEQ:
+        if (!is_less && !is_greater && !is_equal) {
+            return false;
+        }
+        *out = is_equal == (comparison_type == T_EQ);
+        return true;
+    case T_LT:
+    case T_GE:
+        if (!is_less && l.min < r.max) {
+            return false;
+        }
+        *out = is_less == (comparison_type == T_LT);
+        return true;
+    case T_GT:
+    case T_LE:
+        if (!is_greater && l.max > r.min) {
+            return false;
+        }
+        *out = is_greater == (comparison_type == T_GT);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Find the type to perform a comparison of operands with different types in. Extending the
+ * narrower operand is always correct, but if the wider operand's range fits the narrower type,
+ * it is truncated instead, which usually removes an extension altogether
+ * 
+ * @param comparison_type   Type of comparison
+ * @param left              Left operand
+ * @param right             Right operand
+ * @return NumberType       Type to compare the operands in
+ */
+static NumberType narrowest_comparison_type(TokenType comparison_type, LLVMValue left,
+                                            LLVMValue right)
+{
+    NumberType narrower = MIN(left.num_info.number_type, right.num_info.number_type);
+    NumberType wider = MAX(left.num_info.number_type, right.num_info.number_type);
+
+    // Signed comparisons of bools treat true as -1
+    if (D_ARGS->range_analysis && TOKENTYPE_IS_COMPARATOR(comparison_type) &&
+        narrower != NT_INT1 && range_fits_number_type(llvmvalue_range(left), narrower) &&
+        range_fits_number_type(llvmvalue_range(right), narrower)) {
+        return narrower;
+    }
+
+    return wider;
+}
+
 /**
  * @brief Generate code to compare two registers
  * 
@@ -766,29 +1935,33 @@ LLVMValue llvm_compare(TokenType comparison_type, LLVMValue left_virtual_registe
     if (loaded_registers != NULL) {
         left_virtual_register = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_compare");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
     }
 
     loaded_registers = llvm_ensure_registers_fully_loaded(1, (LLVMValue[]){right_virtual_register});
     if (loaded_registers != NULL) {
         right_virtual_register = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_compare");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
         loaded_registers = NULL;
     }
 
+    long long int decided;
+    if (range_decides_comparison(comparison_type, left_virtual_register, right_virtual_register,
+                                 &decided)) {
+        LLVMValue out = LLVMVALUE_CONSTANT(decided);
+        out.num_info.number_type = NT_INT1;
+        return out;
+    }
+
     if (left_virtual_register.num_info.number_type != right_virtual_register.num_info.number_type) {
-        if (numberTypeBitSizes[left_virtual_register.num_info.number_type] <
-            numberTypeBitSizes[right_virtual_register.num_info.number_type]) {
-            left_virtual_register =
-                llvm_int_resize(left_virtual_register, right_virtual_register.num_info.number_type);
-        } else {
-            right_virtual_register =
-                llvm_int_resize(right_virtual_register, left_virtual_register.num_info.number_type);
-        }
+        NumberType comparison_number_type = narrowest_comparison_type(
+            comparison_type, left_virtual_register, right_virtual_register);
+        left_virtual_register = llvm_int_resize(left_virtual_register, comparison_number_type);
+        right_virtual_register = llvm_int_resize(right_virtual_register, comparison_number_type);
     }
 
-    if (left_virtual_register.value_type == LLVMVALUETYPE_CONSTANT &&
+    if (D_ARGS->const_expr_reduce && left_virtual_register.value_type == LLVMVALUETYPE_CONSTANT &&
         right_virtual_register.value_type == LLVMVALUETYPE_CONSTANT) {
         LLVMValue out = LLVMVALUE_CONSTANT(0);
         out.num_info.number_type = NT_INT1;
@@ -872,10 +2045,12 @@ LLVMValue llvm_compare(TokenType comparison_type, LLVMValue left_virtual_registe
  * @param left_virtual_register LLVMValue storing left value register index
  * @param right_virtual_register LLVMValue storing right value register index
  * @param false_label LLVMValue storing label data for the branch in which the condition is false
+ * @param hint How likely the condition is to be true
  * @return LLVMValue Register index of comparison value
  */
 LLVMValue llvm_compare_jump(TokenType comparison_type, LLVMValue left_virtual_register,
-                            LLVMValue right_virtual_register, LLVMValue false_label)
+                            LLVMValue right_virtual_register, LLVMValue false_label,
+                            BranchHint hint)
 {
     LLVMValue comparison_result =
         llvm_compare(comparison_type, left_virtual_register, right_virtual_register);
@@ -887,7 +2062,7 @@ LLVMValue llvm_compare_jump(TokenType comparison_type, LLVMValue left_virtual_re
 
     LLVMValue true_label = get_next_label();
 
-    llvm_conditional_jump(comparison_result, true_label, false_label);
+    llvm_conditional_jump(comparison_result, true_label, false_label, hint);
 
     llvm_label(true_label);
 
@@ -919,6 +2094,31 @@ void llvm_label(LLVMValue label)
     print_function_annotation("llvm_label");
 
     fprintf(D_LLVM_FILE, TAB PURPLE_LABEL_PREFIX "%llu:" NEWLINE, label.value.label_index);
+    fprintf(D_LLVM_FILE, PURPLE_PHI_PLACEHOLDER " %llu" NEWLINE, ssa_begin_block(label, true));
+
+    // Jumps may reach this block even if the previous one returned
+    D_CURRENT_FUNCTION_HAS_RETURNED = false;
+}
+
+/**
+ * @brief Generate label code for the header of a loop, whose back edge has not been generated yet.
+ * The header must be sealed with ssa_seal_block once the back edge is generated
+ * 
+ * @param label LLVMValue containing label information
+ */
+void llvm_loop_header_label(LLVMValue label)
+{
+    if (label.value_type != LLVMVALUETYPE_LABEL) {
+        fatal(RC_COMPILER_ERROR,
+              "Tried to generate a label statement, but received a non-label LLVMValue");
+    }
+
+    print_function_annotation("llvm_loop_header_label");
+
+    fprintf(D_LLVM_FILE, TAB PURPLE_LABEL_PREFIX "%llu:" NEWLINE, label.value.label_index);
+    fprintf(D_LLVM_FILE, PURPLE_PHI_PLACEHOLDER " %llu" NEWLINE, ssa_begin_block(label, false));
+
+    D_CURRENT_FUNCTION_HAS_RETURNED = false;
 }
 
 /**
@@ -933,10 +2133,14 @@ void llvm_jump(LLVMValue label)
               "Tried to generate a label statement, but received a non-label LLVMValue");
     }
 
+    llvm_flush_constant_prints();
+
     print_function_annotation("llvm_jump");
 
     fprintf(D_LLVM_FILE, TAB "br label %%" PURPLE_LABEL_PREFIX "%llu" NEWLINE,
             label.value.label_index);
+
+    ssa_add_successor(label);
 }
 
 /**
@@ -945,17 +2149,96 @@ void llvm_jump(LLVMValue label)
  * @param condition_register LLVMValue holding information about the register from the prior condition
  * @param true_label Label to jump to if condition is true
  * @param false_label Label to jump to if condition is false
+ * @param hint How likely the condition is to be true, which is passed to LLVM as branch weights
  */
 void llvm_conditional_jump(LLVMValue condition_register, LLVMValue true_label,
-                           LLVMValue false_label)
+                           LLVMValue false_label, BranchHint hint)
 {
+    llvm_flush_constant_prints();
+
     print_function_annotation("llvm_conditional_jump");
+
+    // Profiles count how often each branch is reached, and how often its condition is true
+    int true_counter = profile_next_counter();
+    int total_counter = profile_next_counter();
+    if (D_ARGS->profile_generate) {
+        LLVMValue taken = LLVMVALUE_VIRTUAL_REGISTER(get_next_local_virtual_register(), NT_INT64);
+        fprintf(D_LLVM_FILE, TAB "%%%llu = zext %s %s to i64" NEWLINE,
+                taken.value.virtual_register_index,
+                numberTypeLLVMReprs[condition_register.num_info.number_type],
+                LLVM_REPR_NOTYPE(condition_register));
+        profile_increment_counter(true_counter, taken);
+        profile_increment_counter(total_counter, LLVMVALUE_CONSTANT(1));
+    }
+
     fprintf(D_LLVM_FILE,
             TAB "br %s %s, label %%" PURPLE_LABEL_PREFIX "%llu, label %%" PURPLE_LABEL_PREFIX
-                "%llu" NEWLINE,
+                "%llu",
             numberTypeLLVMReprs[condition_register.num_info.number_type],
             LLVM_REPR_NOTYPE(condition_register), true_label.value.label_index,
             false_label.value.label_index);
+
+    // Measured weights take precedence over the ones the program was written with
+    unsigned long long int counts[2];
+    if (profile_counter_value(true_counter, &counts[0]) &&
+        profile_counter_value(total_counter, &counts[1]) && counts[1] > 0) {
+        counts[1] -= counts[0];
+        fprintf(D_LLVM_FILE, ", !prof !%d", profile_weights_metadata(counts, 2));
+    } else if (hint != BRANCH_HINT_NONE) {
+        fprintf(D_LLVM_FILE, ", !prof !%d", llvm_branch_weights_metadata(hint));
+    }
+    fprintf(D_LLVM_FILE, NEWLINE);
+
+    ssa_add_successor(true_label);
+    ssa_add_successor(false_label);
+}
+
+/**
+ * @brief Generate the jump from the latch of a loop back to its header, passing the loop's hints
+ * to LLVM's loop optimizations
+ * 
+ * @param header_label  Header of the loop
+ * @param loop_hints    LoopHint flags of the loop
+ * @param unroll_count  Number of times to unroll the loop, or 0 to let LLVM decide
+ */
+void llvm_loop_latch_jump(LLVMValue header_label, int loop_hints, int unroll_count)
+{
+    if (loop_hints == 0) {
+        llvm_jump(header_label);
+        return;
+    }
+
+    llvm_flush_constant_prints();
+
+    print_function_annotation("llvm_loop_latch_jump");
+
+    fprintf(D_LLVM_FILE, TAB "br label %%" PURPLE_LABEL_PREFIX "%llu, !llvm.loop !%d" NEWLINE,
+            header_label.value.label_index, llvm_loop_metadata(loop_hints, unroll_count));
+
+    ssa_add_successor(header_label);
+}
+
+/**File that the module is written to while function bodies are buffered*/
+static _Thread_local FILE* module_llvm_file = NULL;
+/**Buffer holding the body of the function currently being generated*/
+static _Thread_local char* function_body_buffer = NULL;
+/**Size of function_body_buffer*/
+static _Thread_local size_t function_body_buffer_size = 0;
+
+/**
+ * @brief Build the LLVMValue naming the stack slot of a local that lives in memory
+ * 
+ * @param local         Local to name the stack slot of
+ * @return LLVMValue    Pointer to the local's stack slot
+ */
+static LLVMValue local_slot_llvmvalue(SymbolTableEntry* local)
+{
+    LLVMValue out = LLVMVALUE_VIRTUAL_REGISTER_POINTER(0, local->type.value.number.number_type,
+                                                       local->type.value.number.pointer_depth + 1);
+    out.has_name = true;
+    snprintf(out.value.name, LLVMVALUE_NAME_LENGTH, "%s" PURPLE_LOCAL_SLOT_SUFFIX,
+             local->symbol_name);
+    return out;
 }
 
 /**
@@ -981,70 +2264,120 @@ LLVMValue* llvm_function_preamble(char* symbol_name)
     // through the expected number of arguments and pulling their types one by
     // one
     int args_size = 256;
-    char* args_str = (char*)calloc(1, sizeof(char) * args_size);
+    char* args_str = (char*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(char) * args_size);
     for (int i = 0; i < entry->type.value.function.num_parameters; i++) {
         // Sprintf into a temporary buffer first, so that we can make sure it won't
         // overflow the main buffer
-        char* curr_arg_str = (char*)calloc(1, 300);
-        sprintf(
-            curr_arg_str, "%s%s %%%llu%s",
-            numberTypeLLVMReprs[entry->type.value.function.parameters[i]
-                                    .parameter_type.number_type],
-            REFSTRING(entry->type.value.function.parameters[i].parameter_type.pointer_depth - 1),
-            get_next_local_virtual_register() - 1,
-            i != entry->type.value.function.num_parameters - 1 ? ", " : "");
+        FunctionParameter* parameter = &entry->type.value.function.parameters[i];
+        // The pointee of a parameter that always holds the address of a variable is known
+        char parameter_attributes[64] = "";
+        if (parameter->is_nonnull) {
+            snprintf(parameter_attributes, sizeof(parameter_attributes),
+                     "%s nonnull dereferenceable(%d)", parameter->is_noalias ? " noalias" : "",
+                     numberTypeByteSizes[parameter->parameter_type.number_type]);
+        }
+
+        char* curr_arg_str = (char*)tracked_calloc(MEMORY_CODEGEN, 1, 300);
+        sprintf(curr_arg_str, "%s%s%s %%%llu%s",
+                numberTypeLLVMReprs[parameter->parameter_type.number_type],
+                REFSTRING(parameter->parameter_type.pointer_depth), parameter_attributes,
+                get_next_local_virtual_register() - 1,
+                i != entry->type.value.function.num_parameters - 1 ? ", " : "");
         // If it does want to overflow, resize the main buffer
         while (strlen(args_str) + strlen(curr_arg_str) > args_size) {
             args_size += 256;
-            args_str = realloc(args_str, args_size);
+            args_str = tracked_realloc(MEMORY_CODEGEN, args_str, args_size);
         }
         strcat(args_str, curr_arg_str);
-        free(curr_arg_str);
+        tracked_free(curr_arg_str);
     }
 
     print_function_annotation("llvm_function_preamble");
 
-    fprintf(D_LLVM_FILE, "define dso_local %s @%s(%s) #0 {" NEWLINE,
-            type_to_llvm_type(entry->type.value.function.return_type), symbol_name, args_str);
+    // Profiles count how often each function is entered
+    int entry_counter = profile_next_counter();
+    unsigned long long int entry_count;
+    char entry_count_metadata[64] = "";
+    if (profile_counter_value(entry_counter, &entry_count)) {
+        char contents[64];
+        snprintf(contents, sizeof(contents), "!{!\"function_entry_count\", i64 %llu}",
+                 entry_count);
+        snprintf(entry_count_metadata, sizeof(entry_count_metadata), " !prof !%d",
+                 llvm_metadata_node(contents));
+    }
 
-    free(args_str);
+    char debug_metadata[32] = "";
+    if (debug_current_subprogram() >= 0) {
+        snprintf(debug_metadata, sizeof(debug_metadata), " !dbg !%d", debug_current_subprogram());
+    }
 
-    // Print our buffered stack entries
-    if (buffered_stack_entries_head != NULL) {
-        llvm_stack_allocation(buffered_stack_entries_head);
-        free_llvm_stack_entry_node_list(buffered_stack_entries_head);
-        buffered_stack_entries_head = NULL;
+    // Functions that can only be called from within the program may use a faster calling convention
+    fprintf(D_LLVM_FILE, "define %s %s @%s(%s) #%d%s%s {" NEWLINE,
+            entry->type.value.function.is_internal ? "internal fastcc" : "dso_local",
+            type_to_llvm_type(entry->type.value.function.return_type), symbol_name, args_str,
+            D_ARGS->infer_attributes ? llvm_function_attribute_group(&entry->type.value.function)
+                                     : 0,
+            entry_count_metadata, debug_metadata);
+
+    tracked_free(args_str);
+
+    // Constants that the function refers to are named after it
+    snprintf(function_name, sizeof(function_name), "%s", symbol_name);
+    num_function_constants = 0;
+
+    // Buffer the function's body so that phis can be placed once every definition is known
+    module_llvm_file = D_LLVM_FILE;
+    D_LLVM_FILE = open_memstream(&function_body_buffer, &function_body_buffer_size);
+    if (D_LLVM_FILE == NULL) {
+        fatal(RC_FILE_ERROR, "Failed to open buffer for body of function \"%s\"", symbol_name);
     }
 
-    D_CURRENT_FUNCTION_PREAMBLE_PRINTED = true;
+    // The entry block is implicitly numbered after the parameters
+    ssa_begin_function(D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER - 1);
 
     // Build a list of LLVMValues as they're generated
     LLVMValue* arguments_llvmvalues =
-        (LLVMValue*)malloc(sizeof(LLVMValue) * entry->type.value.function.num_parameters);
+        (LLVMValue*)tracked_malloc(MEMORY_CODEGEN,
+                                   sizeof(LLVMValue) * entry->type.value.function.num_parameters);
     for (unsigned long long int i = 0; i < entry->type.value.function.num_parameters; i++) {
         Number param_num = entry->type.value.function.parameters[i].parameter_type;
-        // Not needed yet? Not sure why
-        char* numstring = number_string(param_num);
-        fprintf(D_LLVM_FILE, TAB "%%%s = alloca %s%s, align %d" NEWLINE,
-                entry->type.value.function.parameters[i].parameter_name,
-                numberTypeLLVMReprs[param_num.number_type], REFSTRING(param_num.pointer_depth - 1),
-                numberTypeByteSizes[param_num.number_type]);
-        fprintf(D_LLVM_FILE, TAB "store %s%s %%%llu, %s%s* %%%s" NEWLINE,
-                numberTypeLLVMReprs[param_num.number_type], REFSTRING(param_num.pointer_depth - 1),
-                i, numberTypeLLVMReprs[param_num.number_type], _refstring_buf,
-                entry->type.value.function.parameters[i].parameter_name);
-        arguments_llvmvalues[i] = (LLVMValue){
-            .value_type = LLVMVALUETYPE_VIRTUAL_REGISTER, .num_info = param_num, .has_name = true};
-        arguments_llvmvalues[i].num_info.pointer_depth += 1;
-        strcpy(arguments_llvmvalues[i].value.name,
-               entry->type.value.function.parameters[i].parameter_name);
-
-        SymbolTableEntry* ste = STS_FIND(arguments_llvmvalues[i].value.name);
-        if (ste) {
+        char* param_name = entry->type.value.function.parameters[i].parameter_name;
+
+        SymbolTableEntry* ste = STS_FIND(param_name);
+        if (ste == NULL) {
+            fatal(RC_COMPILER_ERROR, "Failed to find parameter \"%s\" of function \"%s\"",
+                  param_name, symbol_name);
+        }
+
+        if (ste->in_memory) {
+            // The parameter's address is taken, so it needs a stack slot
+            fprintf(D_LLVM_FILE, TAB "%%%s" PURPLE_LOCAL_SLOT_SUFFIX " = alloca %s%s, align %d",
+                    param_name, numberTypeLLVMReprs[param_num.number_type],
+                    REFSTRING(param_num.pointer_depth), numberTypeByteSizes[param_num.number_type]);
+            fprintf(D_LLVM_FILE, NEWLINE TAB "store %s%s %%%llu, ",
+                    numberTypeLLVMReprs[param_num.number_type], REFSTRING(param_num.pointer_depth),
+                    i);
+            fprintf(D_LLVM_FILE, "%s%s* %%%s" PURPLE_LOCAL_SLOT_SUFFIX NEWLINE,
+                    numberTypeLLVMReprs[param_num.number_type], REFSTRING(param_num.pointer_depth),
+                    param_name);
+
+            arguments_llvmvalues[i] = local_slot_llvmvalue(ste);
             ste->latest_llvmvalue = arguments_llvmvalues[i];
+        } else {
+            // Otherwise the incoming register is the parameter's first definition
+            arguments_llvmvalues[i] = LLVMVALUE_VIRTUAL_REGISTER_POINTER(
+                i, param_num.number_type, param_num.pointer_depth);
+            if (ste->has_range) {
+                arguments_llvmvalues[i] = llvmvalue_with_range(arguments_llvmvalues[i], ste->range);
+            }
+            ssa_write_variable(ste, arguments_llvmvalues[i]);
         }
+
+        debug_declare_parameter(i, ste);
     }
 
+    profile_increment_counter(entry_counter, LLVMVALUE_CONSTANT(1));
+
     return arguments_llvmvalues;
 }
 
@@ -1054,7 +2387,47 @@ LLVMValue* llvm_function_preamble(char* symbol_name)
 void llvm_function_postamble(void)
 {
     print_function_annotation("llvm_function_postamble");
+
+    fclose(D_LLVM_FILE);
+    D_LLVM_FILE = module_llvm_file;
+
+    // Instructions are given the source locations they were generated for
+    char* located_body = debug_attach_locations(function_body_buffer);
+    if (located_body) {
+        tracked_free(function_body_buffer);
+        function_body_buffer = located_body;
+    }
+
+    // Every stack slot is allocated up front, in the entry block
+    llvm_stack_allocation();
+    ssa_write_function_body(D_LLVM_FILE, function_body_buffer);
     fprintf(D_LLVM_FILE, "}" NEWLINE NEWLINE);
+
+    // Constant prints after the function's last return are never reached
+    tracked_free(pending_print_text);
+    pending_print_text = NULL;
+    pending_print_length = 0;
+    pending_print_capacity = 0;
+    if (function_constants_file) {
+        fclose(function_constants_file);
+        fprintf(D_LLVM_FILE, "%s" NEWLINE, function_constants_buffer);
+        tracked_free(function_constants_buffer);
+        function_constants_file = NULL;
+        function_constants_buffer = NULL;
+        function_constants_buffer_size = 0;
+    }
+
+    tracked_free(function_body_buffer);
+    function_body_buffer = NULL;
+    function_body_buffer_size = 0;
+
+    // Register numbers start over in the next function
+    tracked_free(extensions);
+    extensions = NULL;
+    num_extensions = 0;
+    extensions_capacity = 0;
+
+    ssa_end_function();
 }
 
 /**
@@ -1078,9 +2451,11 @@ const char* type_to_llvm_type(TokenType type)
  * @param args              Currently unused function parameter
  * @param num_args          Number of args passed
  * @param symbol_name       Name of function to call
+ * @param tail_call_kind    What LLVM may assume about the call if its result is returned
  * @return LLVMValue        Output of function, or LLVMVALUE_NULL if it is a void function
  */
-LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, char* symbol_name)
+LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, char* symbol_name,
+                             TailCallKind tail_call_kind)
 {
     LLVMValue out = LLVMVALUE_NULL;
 
@@ -1103,9 +2478,10 @@ LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, c
               "phase, got %llu but expected %llu",
               num_args, entry->type.value.function.num_parameters);
     }
-    int passed_types_size, passed_values_size = 256;
-    char* passed_types = (char*)calloc(1, sizeof(char) * passed_types_size);
-    char* passed_values = (char*)calloc(1, sizeof(char) * passed_values_size);
+    int passed_types_size = 256, passed_values_size = 256;
+    char* passed_types = (char*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(char) * passed_types_size);
+    char* passed_values =
+        (char*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(char) * passed_values_size);
     for (unsigned long long int i = 0; i < num_args; i++) {
         FunctionParameter param = entry->type.value.function.parameters[i];
 
@@ -1114,19 +2490,25 @@ LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, c
         if (loaded_param) {
             args[i] = loaded_param[0];
             purple_log(LOG_DEBUG, "Freeing loaded_param in llvm_call_function");
-            free(loaded_param);
+            tracked_free(loaded_param);
             loaded_param = NULL;
         }
 
+        // Like a returned value, an argument is computed in the types of its operands
+        if (param.parameter_type.pointer_depth == 0 && args[i].num_info.pointer_depth == 0 &&
+            args[i].num_info.number_type != param.parameter_type.number_type) {
+            args[i] = llvm_int_resize(args[i], param.parameter_type.number_type);
+        }
+
         if (!NUMBERS_TYPEQUIV(param.parameter_type, args[i].num_info)) {
             char expectedstrarr[300];
             char* expectedstr = number_string(param.parameter_type);
             strcpy(expectedstrarr, expectedstr);
-            free(expectedstr);
+            tracked_free(expectedstr);
             char gotstrarr[300];
             char* gotstr = number_string(args[i].num_info);
             strcpy(gotstrarr, gotstr);
-            free(gotstr);
+            tracked_free(gotstr);
 
             fatal(RC_COMPILER_ERROR,
                   "Function '%s' expected parameter '%s' to have type '%s' but got '%s'",
@@ -1134,7 +2516,7 @@ LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, c
         }
 
         char curr_typ_str[300];
-        char* curr_arg_str = (char*)calloc(1, 300);
+        char* curr_arg_str = (char*)tracked_calloc(MEMORY_CODEGEN, 1, 300);
         char* numstring = number_string(param.parameter_type);
         char* argstring = llvmvalue_repr(args[i]);
         sprintf(curr_typ_str, "%s%s", numstring, i != num_args - 1 ? ", " : "");
@@ -1142,20 +2524,24 @@ LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, c
         // If it does want to overflow, resize the main buffers
         while (strlen(passed_types) + strlen(curr_typ_str) > passed_types_size) {
             passed_types_size += 256;
-            passed_types = realloc(passed_types, passed_types_size);
+            passed_types = tracked_realloc(MEMORY_CODEGEN, passed_types, passed_types_size);
         }
         while (strlen(passed_values) + strlen(curr_arg_str) > passed_values_size) {
             passed_values_size += 256;
-            passed_values = realloc(passed_values, passed_values_size);
+            passed_values = tracked_realloc(MEMORY_CODEGEN, passed_values, passed_values_size);
         }
         strcat(passed_types, curr_typ_str);
         strcat(passed_values, curr_arg_str);
-        free(numstring);
-        free(argstring);
+        tracked_free(numstring);
+        tracked_free(argstring);
     }
 
     print_function_annotation("llvm_call_function");
 
+    // Profiles count how often each call is made
+    int call_counter = profile_next_counter();
+    profile_increment_counter(call_counter, LLVMVALUE_CONSTANT(1));
+
     fprintf(D_LLVM_FILE, TAB);
 
     if (entry->type.value.function.return_type != T_VOID) {
@@ -1165,10 +2551,19 @@ LLVMValue llvm_call_function(LLVMValue* args, unsigned long long int num_args, c
         fprintf(D_LLVM_FILE, "%%%llu = ", out.value.virtual_register_index);
     }
 
-    fprintf(D_LLVM_FILE, "call %s (%s) @%s(%s)" NEWLINE,
+    static const char* tail_call_markers[] = {
+        [TAIL_CALL_NONE] = "", [TAIL_CALL_ALLOWED] = "tail ", [TAIL_CALL_REQUIRED] = "musttail "};
+    fprintf(D_LLVM_FILE, "%scall %s%s (%s) @%s(%s)", tail_call_markers[tail_call_kind],
+            entry->type.value.function.is_internal ? "fastcc " : "",
             type_to_llvm_type(entry->type.value.function.return_type), passed_types, symbol_name,
             passed_values);
 
+    unsigned long long int call_count;
+    if (profile_counter_value(call_counter, &call_count)) {
+        fprintf(D_LLVM_FILE, ", !prof !%d", profile_weights_metadata(&call_count, 1));
+    }
+    fprintf(D_LLVM_FILE, NEWLINE);
+
     return out;
 }
 
@@ -1197,10 +2592,20 @@ void llvm_return(LLVMValue value, char* symbol_name)
         if (loaded_registers != NULL) {
             value = loaded_registers[0];
             purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_return");
-            free(loaded_registers);
+            tracked_free(loaded_registers);
+        }
+
+        // The returned value is computed in the types of its operands
+        NumberType return_number_type =
+            token_type_to_number_type(entry->type.value.function.return_type);
+        if (value.num_info.pointer_depth == 0 && value.num_info.number_type != return_number_type) {
+            value = llvm_int_resize(value, return_number_type);
         }
     }
 
+    // Constant prints are printed before the block they are in ends
+    llvm_flush_constant_prints();
+
     print_function_annotation("llvm_return");
 
     fprintf(D_LLVM_FILE, TAB "ret %s", type_to_llvm_type(entry->type.value.function.return_type));
@@ -1215,7 +2620,8 @@ void llvm_return(LLVMValue value, char* symbol_name)
     }
 
     D_CURRENT_FUNCTION_HAS_RETURNED = true;
-    get_next_local_virtual_register();
+    // Anything generated after a return belongs to a new, unreachable, unnamed block
+    ssa_begin_unnamed_block(get_next_local_virtual_register());
 }
 
 /**
@@ -1253,6 +2659,8 @@ char* llvmvalue_repr_notype(char* buf, LLVMValue reg)
         strcat(buf, reg.value.name);
     } else if (reg.value_type == LLVMVALUETYPE_CONSTANT) {
         sprintf(buf + strlen(buf), "%lld", reg.value.constant);
+    } else if (reg.value_type == LLVMVALUETYPE_UNDEF) {
+        strcat(buf, "undef");
     } else if (reg.value_type == LLVMVALUETYPE_VIRTUAL_REGISTER ||
                reg.value_type == LLVMVALUETYPE_LABEL) {
         sprintf(buf + strlen(buf), "%llu", reg.value.virtual_register_index);
@@ -1280,24 +2688,24 @@ LLVMValue llvm_get_address(char* symbol_name)
               symbol_name);
     }
 
-    type_register free_reg = get_next_local_virtual_register();
-    LLVMValue lv = LLVMVALUE_VIRTUAL_REGISTER_POINTER(
-        free_reg, entry->type.value.number.number_type, entry->type.value.number.pointer_depth);
-
-    llvm_stack_allocation(
-        (LLVMStackEntryNode[]){(LLVMStackEntryNode){.reg = free_reg,
-                                                    .type = lv.num_info.number_type,
-                                                    .align_bytes = 4,
-                                                    .pointer_depth = lv.num_info.pointer_depth}});
+    // Locals in memory already have an address, their stack slot
+    if (entry != GST_FIND(symbol_name)) {
+        if (!entry->in_memory) {
+            fatal(RC_COMPILER_ERROR,
+                  "Tried to take the address of local \"%s\", which is not in memory", symbol_name);
+        }
+        return local_slot_llvmvalue(entry);
+    }
 
-    lv.num_info.pointer_depth++;
+    LLVMValue lv = llvm_allocate_stack_slot(entry->type.value.number.number_type,
+                                            entry->type.value.number.pointer_depth);
 
     print_function_annotation("llvm_get_address");
 
     fprintf(D_LLVM_FILE, TAB "store %s%s @%s, ", numberTypeLLVMReprs[lv.num_info.number_type],
             REFSTRING(entry->type.value.number.pointer_depth), symbol_name);
-    fprintf(D_LLVM_FILE, "%s%s %%%lld" NEWLINE, numberTypeLLVMReprs[lv.num_info.number_type],
-            REFSTRING(lv.num_info.pointer_depth), free_reg);
+    fprintf(D_LLVM_FILE, "%s%s %s" NEWLINE, numberTypeLLVMReprs[lv.num_info.number_type],
+            REFSTRING(lv.num_info.pointer_depth), LLVM_REPR_NOTYPE(lv));
 
     return lv;
 }
@@ -1339,7 +2747,7 @@ void llvm_store_dereference(LLVMValue destination, LLVMValue value)
     if (loaded_registers) {
         value = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers (1)", "llvm_store_dereference");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
         loaded_registers = NULL;
     }
 
@@ -1348,7 +2756,7 @@ void llvm_store_dereference(LLVMValue destination, LLVMValue value)
     if (loaded_registers) {
         destination = loaded_registers[0];
         purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_store_dereference");
-        free(loaded_registers);
+        tracked_free(loaded_registers);
         loaded_registers = NULL;
     }
 
@@ -1370,6 +2778,32 @@ void llvm_store_dereference(LLVMValue destination, LLVMValue value)
     }
 }
 
+/**
+ * @brief Get the current value of a local
+ * 
+ * @param symbol_name   Name of local to read
+ * @return LLVMValue    The local's stack slot if it is in memory, otherwise its current definition
+ */
+LLVMValue llvm_load_local(char* symbol_name)
+{
+    SymbolTableEntry* ste = STS_FIND(symbol_name);
+    if (!ste) {
+        fatal(RC_COMPILER_ERROR, "Tried to load from NULL SymbolTableEntry in llvm_load_local");
+    }
+
+    if (ste->in_memory) {
+        return local_slot_llvmvalue(ste);
+    }
+
+    return ssa_read_variable(ste);
+}
+
+/**
+ * @brief Assign a value to a local
+ * 
+ * @param symbol_name   Name of local to assign to
+ * @param val           Value to assign
+ */
 void llvm_store_local(char* symbol_name, LLVMValue val)
 {
     SymbolTableEntry* ste = STS_FIND(symbol_name);
@@ -1377,5 +2811,29 @@ void llvm_store_local(char* symbol_name, LLVMValue val)
         fatal(RC_COMPILER_ERROR, "Tried to store into NULL SymbolTableEntry in llvm_store_local");
     }
 
-    ste->latest_llvmvalue = val;
+    Number local_type = ste->type.value.number;
+
+    LLVMValue* loaded_registers =
+        llvm_ensure_registers_loaded(1, (LLVMValue[]){val}, local_type.pointer_depth);
+    if (loaded_registers) {
+        val = loaded_registers[0];
+        purple_log(LOG_DEBUG, "Freeing %s in %s", "loaded_registers", "llvm_store_local");
+        tracked_free(loaded_registers);
+    }
+
+    if (local_type.pointer_depth == 0 && val.num_info.number_type != local_type.number_type) {
+        val = llvm_int_resize(val, local_type.number_type);
+    }
+
+    if (!ste->in_memory) {
+        ssa_write_variable(ste, val);
+        return;
+    }
+
+    print_function_annotation("llvm_store_local");
+    fprintf(D_LLVM_FILE, TAB "store %s%s %s, ", numberTypeLLVMReprs[local_type.number_type],
+            REFSTRING(local_type.pointer_depth), LLVM_REPR_NOTYPE(val));
+    fprintf(D_LLVM_FILE, "%s%s* %%%s" PURPLE_LOCAL_SLOT_SUFFIX NEWLINE,
+            numberTypeLLVMReprs[local_type.number_type], REFSTRING(local_type.pointer_depth),
+            symbol_name);
 }
@@ -0,0 +1,471 @@
+/**
+ * @file profile.c
+ * @author Charles Averill
+ * @brief Logic for instrumenting programs with profile counters, and for passing the profiles they
+ * write back to LLVM as branch weights, call counts, function entry counts and a profile summary
+ * @date 19-Oct-2026
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "translate/codegen.h"
+#include "translate/profile.h"
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**Counters added to the program being instrumented, or read from the profile being used*/
+static ProfileCounters profile = {.counters = NULL, .num_counters = 0, .capacity = 0};
+
+/**Name of the function currently being translated*/
+static _Thread_local char* current_function_name = NULL;
+/**Checksum of the function currently being translated*/
+static _Thread_local unsigned long long int current_checksum = 0;
+/**Index of the next counter of the function currently being translated*/
+static _Thread_local int next_counter_index = 0;
+/**Counters read from the profile for the function currently being translated, or NULL if there
+ * are none*/
+static _Thread_local ProfileCounter* current_counters = NULL;
+/**Number of counters in current_counters*/
+static _Thread_local unsigned long long int num_current_counters = 0;
+
+/**
+ * @brief Add a counter to the end of a list of counters
+ *
+ * @param counters  List of counters to add to
+ * @param counter   Counter to add
+ */
+static void add_counter(ProfileCounters* counters, ProfileCounter counter)
+{
+    if (counters->num_counters >= counters->capacity) {
+        counters->capacity = counters->capacity ? counters->capacity * 2 : 64;
+        counters->counters = (ProfileCounter*)tracked_realloc(MEMORY_CODEGEN, counters->counters,
+                                                      sizeof(ProfileCounter) * counters->capacity);
+        if (counters->counters == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for profile counters");
+        }
+    }
+
+    counters->counters[counters->num_counters++] = counter;
+}
+
+/**
+ * @brief Mix a value into an FNV-1a hash
+ *
+ * @param hash                      Hash so far
+ * @param value                     Value to mix in
+ * @return unsigned long long int   New hash
+ */
+static unsigned long long int hash_value(unsigned long long int hash, unsigned long long int value)
+{
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Hash the structure of an AST, so that profiles of a function are only used for the same
+ * function
+ *
+ * @param node                      Root of AST
+ * @param hash                      Hash so far
+ * @return unsigned long long int   Hash including node
+ */
+static unsigned long long int hash_ast(ASTNode* node, unsigned long long int hash)
+{
+    if (node == NULL) {
+        return hash_value(hash, TOKENTYPE_MAX);
+    }
+
+    hash = hash_value(hash, node->ttype);
+    if (TOKENTYPE_IS_LITERAL(node->ttype)) {
+        hash = hash_value(hash, node->value.number_value);
+    } else if (node->ttype == T_IDENTIFIER || node->ttype == T_FUNCTION_CALL ||
+               node->ttype == T_AMPERSAND) {
+        for (char* c = node->value.symbol_name; *c; c++) {
+            hash = hash_value(hash, *c);
+        }
+    }
+
+    for (unsigned long long int i = 0; i < node->num_args; i++) {
+        hash = hash_ast(node->function_call_arguments[i], hash);
+    }
+
+    hash = hash_ast(node->left, hash);
+    hash = hash_ast(node->mid, hash);
+    return hash_ast(node->right, hash);
+}
+
+/**
+ * @brief Read the profile written by a program instrumented with --fprofile-generate
+ *
+ * @param filename Path to the profile
+ */
+void profile_load(char* filename)
+{
+    FILE* profile_file = fopen(filename, "r");
+    if (profile_file == NULL) {
+        fatal(RC_FILE_ERROR, "Unable to open profile %s: %s", filename, strerror(errno));
+    }
+
+    ProfileCounter counter;
+    int num_read;
+    while ((num_read = fscanf(profile_file, "%254s %llu %d %llu", counter.function_name,
+                              &counter.checksum, &counter.index, &counter.count)) == 4) {
+        add_counter(&profile, counter);
+    }
+
+    if (num_read != EOF) {
+        fatal(RC_FILE_ERROR, "Malformed profile %s after %llu counters", filename,
+              profile.num_counters);
+    }
+
+    fclose(profile_file);
+    purple_log(LOG_DEBUG, "Read %llu counters from profile %s", profile.num_counters, filename);
+}
+
+/**
+ * @brief Start numbering the counters of a function, and find its counters in the profile being
+ * used
+ *
+ * @param function_root Function declaration AST
+ */
+void profile_begin_function(ASTNode* function_root)
+{
+    if (!D_ARGS->profile_generate && !D_ARGS->profile_use) {
+        return;
+    }
+
+    current_function_name = function_root->value.symbol_name;
+    next_counter_index = 0;
+    current_counters = NULL;
+    num_current_counters = 0;
+
+    // Optimizations change which counters a function has, so they are part of its checksum
+    current_checksum = 14695981039346656037ULL;
+    current_checksum = hash_value(current_checksum, D_ARGS->const_expr_reduce |
+                                                        D_ARGS->const_propagate << 1 |
+                                                        D_ARGS->dead_code_elim << 2 |
+                                                        D_ARGS->inline_functions << 3 |
+                                                        D_ARGS->tail_calls << 4 |
+                                                        D_ARGS->infer_attributes << 5 |
+                                                        D_ARGS->range_analysis << 6);
+    current_checksum = hash_ast(function_root, current_checksum);
+
+    if (!D_ARGS->profile_use) {
+        return;
+    }
+
+    for (unsigned long long int i = 0; i < profile.num_counters; i++) {
+        if (strcmp(profile.counters[i].function_name, current_function_name)) {
+            continue;
+        }
+
+        if (profile.counters[i].checksum != current_checksum) {
+            purple_log(LOG_WARNING, "Profile of function \"%s\" is out of date and will be ignored",
+                       current_function_name);
+            return;
+        }
+
+        current_counters = &profile.counters[i];
+        while (i + num_current_counters < profile.num_counters &&
+               !strcmp(current_counters[num_current_counters].function_name,
+                       current_function_name)) {
+            num_current_counters++;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Add a counter to the function currently being translated
+ *
+ * @return int Index of the counter within its function, or -1 if the program isn't profiled
+ */
+int profile_next_counter(void)
+{
+    if (!D_ARGS->profile_generate && !D_ARGS->profile_use) {
+        return -1;
+    }
+
+    if (D_ARGS->profile_generate) {
+        ProfileCounter counter = {.checksum = current_checksum,
+                                  .index = next_counter_index,
+                                  .count = 0};
+        strcpy(counter.function_name, current_function_name);
+        add_counter(&codegen_current_context()->counters, counter);
+    }
+
+    return next_counter_index++;
+}
+
+/**
+ * @brief Add the counters of a translated function to the end of the profile, so that counters are
+ * in the order their functions were declared however many threads translated them. Frees the
+ * function's counters
+ *
+ * @param counters Counters added to the function
+ */
+void profile_merge_counters(ProfileCounters* counters)
+{
+    for (unsigned long long int i = 0; i < counters->num_counters; i++) {
+        add_counter(&profile, counters->counters[i]);
+    }
+
+    tracked_free(counters->counters);
+    *counters = (ProfileCounters){.counters = NULL, .num_counters = 0, .capacity = 0};
+}
+
+/**
+ * @brief Generate code adding to a counter of the function currently being translated
+ *
+ * @param counter   Index of the counter
+ * @param amount    i64 value to add to the counter
+ */
+void profile_increment_counter(int counter, LLVMValue amount)
+{
+    if (!D_ARGS->profile_generate) {
+        return;
+    }
+
+    type_register loaded = get_next_local_virtual_register();
+    type_register sum = get_next_local_virtual_register();
+
+    fprintf(D_LLVM_FILE,
+            TAB "%%%llu = load i64, i64* @" PURPLE_PROFILE_PREFIX "%s.%d, align 8" NEWLINE,
+            loaded, current_function_name, counter);
+    fprintf(D_LLVM_FILE, TAB "%%%llu = add i64 %%%llu, %s" NEWLINE, sum, loaded,
+            LLVM_REPR_NOTYPE(amount));
+    fprintf(D_LLVM_FILE,
+            TAB "store i64 %%%llu, i64* @" PURPLE_PROFILE_PREFIX "%s.%d, align 8" NEWLINE, sum,
+            current_function_name, counter);
+}
+
+/**
+ * @brief Get the count of a counter of the function currently being translated from the profile
+ * being used
+ *
+ * @param counter   Index of the counter
+ * @param out       Filled with the number of times the counter was reached
+ * @return bool     False if the profile has no count for the counter
+ */
+bool profile_counter_value(int counter, unsigned long long int* out)
+{
+    if (counter < 0 || counter >= num_current_counters ||
+        current_counters[counter].index != counter) {
+        return false;
+    }
+
+    *out = current_counters[counter].count;
+    return true;
+}
+
+/**
+ * @brief Get the number of a metadata node giving the weights of the successors of a branch, or
+ * the number of times a call is executed. Weights are scaled down to fit in 32 bits
+ *
+ * @param counts    Number of times each successor is taken
+ * @param num_counts Number of successors
+ * @return int      Number of the metadata node
+ */
+int profile_weights_metadata(unsigned long long int* counts, int num_counts)
+{
+    unsigned long long int max_count = 0;
+    for (int i = 0; i < num_counts; i++) {
+        max_count = MAX(max_count, counts[i]);
+    }
+    unsigned long long int scale = max_count / UINT_MAX + 1;
+
+    char contents[256];
+    int length = snprintf(contents, sizeof(contents), "!{!\"branch_weights\"");
+    for (int i = 0; i < num_counts; i++) {
+        length += snprintf(contents + length, sizeof(contents) - length, ", i32 %llu",
+                           counts[i] / scale);
+    }
+    snprintf(contents + length, sizeof(contents) - length, "}");
+
+    return llvm_metadata_node(contents);
+}
+
+/**
+ * @brief Compare counts so that they are sorted from largest to smallest
+ */
+static int compare_counts(const void* a, const void* b)
+{
+    unsigned long long int left = *(const unsigned long long int*)a;
+    unsigned long long int right = *(const unsigned long long int*)b;
+    return (left < right) - (left > right);
+}
+
+/**
+ * @brief Get the number of a metadata node summarizing the profile being used, which LLVM needs in
+ * order to tell hot code from cold code
+ *
+ * @return int Number of the metadata node, which is a module flag
+ */
+static int profile_summary_metadata(void)
+{
+    // Percentiles of the total count, in millionths, that LLVM's profile summaries describe
+    static const int cutoffs[] = {10000,  100000, 200000, 300000, 400000, 500000,
+                                  600000, 700000, 800000, 900000, 950000, 990000,
+                                  999000, 999900, 999990, 999999};
+    unsigned long long int* counts = (unsigned long long int*)tracked_malloc(MEMORY_CODEGEN, 
+        sizeof(unsigned long long int) * (profile.num_counters + 1));
+    if (counts == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for profile summary");
+    }
+
+    unsigned long long int total = 0, max_function_count = 0, num_functions = 0;
+    for (unsigned long long int i = 0; i < profile.num_counters; i++) {
+        counts[i] = profile.counters[i].count;
+        total += counts[i];
+        // The first counter of every function counts its entries
+        if (profile.counters[i].index == 0) {
+            max_function_count = MAX(max_function_count, counts[i]);
+            num_functions++;
+        }
+    }
+    qsort(counts, profile.num_counters, sizeof(unsigned long long int), compare_counts);
+
+    char detailed[2048] = "!{";
+    int length = 2;
+    unsigned long long int cumulative = 0, num_counts = 0;
+    for (int i = 0; i < sizeof(cutoffs) / sizeof(cutoffs[0]); i++) {
+        // Find the fewest largest counts that add up to the cutoff's share of the total count
+        unsigned long long int desired = (unsigned long long int)((double)total * cutoffs[i] / 1e6);
+        while (num_counts < profile.num_counters && (cumulative < desired || num_counts == 0)) {
+            cumulative += counts[num_counts++];
+        }
+
+        char entry[128];
+        snprintf(entry, sizeof(entry), "!{i32 %d, i64 %llu, i32 %llu}", cutoffs[i],
+                 num_counts ? counts[num_counts - 1] : 0, num_counts);
+        length += snprintf(detailed + length, sizeof(detailed) - length, "%s!%d", i ? ", " : "",
+                           llvm_metadata_node(entry));
+    }
+    snprintf(detailed + length, sizeof(detailed) - length, "}");
+
+    char contents[512];
+    char field[128];
+    int fields[8];
+    fields[0] = llvm_metadata_node("!{!\"ProfileFormat\", !\"InstrProf\"}");
+    snprintf(field, sizeof(field), "!{!\"TotalCount\", i64 %llu}", total);
+    fields[1] = llvm_metadata_node(field);
+    snprintf(field, sizeof(field), "!{!\"MaxCount\", i64 %llu}",
+             profile.num_counters ? counts[0] : 0);
+    fields[2] = llvm_metadata_node(field);
+    snprintf(field, sizeof(field), "!{!\"MaxInternalCount\", i64 %llu}",
+             profile.num_counters ? counts[0] : 0);
+    fields[3] = llvm_metadata_node(field);
+    snprintf(field, sizeof(field), "!{!\"MaxFunctionCount\", i64 %llu}", max_function_count);
+    fields[4] = llvm_metadata_node(field);
+    snprintf(field, sizeof(field), "!{!\"NumCounts\", i64 %llu}", profile.num_counters);
+    fields[5] = llvm_metadata_node(field);
+    snprintf(field, sizeof(field), "!{!\"NumFunctions\", i64 %llu}", num_functions);
+    fields[6] = llvm_metadata_node(field);
+    snprintf(contents, sizeof(contents), "!{!\"DetailedSummary\", !%d}",
+             llvm_metadata_node(detailed));
+    fields[7] = llvm_metadata_node(contents);
+
+    snprintf(contents, sizeof(contents), "!{!%d, !%d, !%d, !%d, !%d, !%d, !%d, !%d}", fields[0],
+             fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], fields[7]);
+    snprintf(field, sizeof(field), "!{i32 1, !\"ProfileSummary\", !%d}",
+             llvm_metadata_node(contents));
+
+    tracked_free(counts);
+    return llvm_metadata_node(field);
+}
+
+/**
+ * @brief Generate the counters of an instrumented program, along with a function registered to
+ * run at exit that writes them to the profile, or summarize the profile being used. Frees the
+ * profile
+ *
+ * @return int Number of the profile summary's module flag, or -1 if no profile is being used
+ */
+int profile_postamble(void)
+{
+    int summary = D_ARGS->profile_use ? profile_summary_metadata() : -1;
+
+    if (D_ARGS->profile_generate) {
+        char* filename = D_ARGS->profile_generate;
+
+        fprintf(D_LLVM_FILE,
+                "@" PURPLE_PROFILE_PREFIX "filename = private unnamed_addr constant [%lu x i8] "
+                "c\"%s\\00\", align 1" NEWLINE,
+                strlen(filename) + 1, filename);
+        fprintf(D_LLVM_FILE, "@" PURPLE_PROFILE_PREFIX "mode = private unnamed_addr constant "
+                             "[2 x i8] c\"w\\00\", align 1" NEWLINE);
+        fprintf(D_LLVM_FILE, "@" PURPLE_PROFILE_PREFIX "format = private unnamed_addr constant "
+                             "[17 x i8] c\"%%s %%llu %%d %%llu\\0A\\00\", align 1" NEWLINE);
+        for (unsigned long long int i = 0; i < profile.num_counters; i++) {
+            ProfileCounter* counter = &profile.counters[i];
+            fprintf(D_LLVM_FILE,
+                    "@" PURPLE_PROFILE_PREFIX "%s.%d = internal global i64 0, align 8" NEWLINE,
+                    counter->function_name, counter->index);
+            if (counter->index == 0) {
+                fprintf(D_LLVM_FILE,
+                        "@" PURPLE_PROFILE_PREFIX "name.%s = private unnamed_addr constant "
+                        "[%lu x i8] c\"%s\\00\", align 1" NEWLINE,
+                        counter->function_name, strlen(counter->function_name) + 1,
+                        counter->function_name);
+            }
+        }
+        fprintf(D_LLVM_FILE, NEWLINE);
+
+        // Write one line per counter, skipping the profile if it can't be opened
+        fprintf(D_LLVM_FILE, "define internal void @" PURPLE_PROFILE_PREFIX "write() {" NEWLINE);
+        fprintf(D_LLVM_FILE,
+                TAB "%%file = call i8* @fopen(i8* getelementptr inbounds ([%lu x i8], [%lu x i8]* "
+                    "@" PURPLE_PROFILE_PREFIX "filename, i32 0, i32 0), i8* getelementptr "
+                    "inbounds ([2 x i8], [2 x i8]* @" PURPLE_PROFILE_PREFIX "mode, i32 0, i32 0))"
+                        NEWLINE,
+                strlen(filename) + 1, strlen(filename) + 1);
+        fprintf(D_LLVM_FILE, TAB "%%failed = icmp eq i8* %%file, null" NEWLINE);
+        fprintf(D_LLVM_FILE, TAB "br i1 %%failed, label %%done, label %%write" NEWLINE);
+        fprintf(D_LLVM_FILE, "write:" NEWLINE);
+        for (unsigned long long int i = 0; i < profile.num_counters; i++) {
+            ProfileCounter* counter = &profile.counters[i];
+            unsigned long name_length = strlen(counter->function_name) + 1;
+            fprintf(D_LLVM_FILE,
+                    TAB "%%count.%llu = load i64, i64* @" PURPLE_PROFILE_PREFIX "%s.%d, align 8"
+                        NEWLINE,
+                    i, counter->function_name, counter->index);
+            fprintf(D_LLVM_FILE,
+                    TAB "call i32 (i8*, i8*, ...) @fprintf(i8* %%file, i8* getelementptr inbounds "
+                        "([17 x i8], [17 x i8]* @" PURPLE_PROFILE_PREFIX "format, i32 0, i32 0), "
+                        "i8* getelementptr inbounds ([%lu x i8], [%lu x i8]* "
+                        "@" PURPLE_PROFILE_PREFIX "name.%s, i32 0, i32 0), i64 %llu, i32 %d, "
+                        "i64 %%count.%llu)" NEWLINE,
+                    name_length, name_length, counter->function_name, counter->checksum,
+                    counter->index, i);
+        }
+        fprintf(D_LLVM_FILE, TAB "call i32 @fclose(i8* %%file)" NEWLINE);
+        fprintf(D_LLVM_FILE, TAB "br label %%done" NEWLINE);
+        fprintf(D_LLVM_FILE, "done:" NEWLINE TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+
+        // Constructors run before main, so the profile is written however the program is entered
+        fprintf(D_LLVM_FILE, "define internal void @" PURPLE_PROFILE_PREFIX "register() {" NEWLINE);
+        fprintf(D_LLVM_FILE,
+                TAB "call i32 @atexit(void ()* @" PURPLE_PROFILE_PREFIX "write)" NEWLINE);
+        fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+        fprintf(D_LLVM_FILE, "@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] "
+                             "[{ i32, void ()*, i8* } { i32 65535, void ()* "
+                             "@" PURPLE_PROFILE_PREFIX "register, i8* null }]" NEWLINE NEWLINE);
+
+        fprintf(D_LLVM_FILE, "declare i8* @fopen(i8*, i8*)" NEWLINE);
+        fprintf(D_LLVM_FILE, "declare i32 @fprintf(i8*, i8*, ...)" NEWLINE);
+        fprintf(D_LLVM_FILE, "declare i32 @fclose(i8*)" NEWLINE);
+        fprintf(D_LLVM_FILE, "declare i32 @atexit(void ()*)" NEWLINE NEWLINE);
+    }
+
+    tracked_free(profile.counters);
+    profile = (ProfileCounters){.counters = NULL, .num_counters = 0, .capacity = 0};
+    return summary;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file runtime.c
+ * @author Charles Averill
+ * @brief Logic for giving every module the runtime that its print statements call. Prints are
+ * converted to text by hand and collected in a large buffer, which is written to stdout when it
+ * fills and when the program exits, instead of making a printf call for every print
+ * @date 19-Oct-2026
+ */
+
+#include "data.h"
+#include "translate/llvm.h"
+#include "translate/runtime.h"
+#include "utils/formatting.h"
+
+/**
+ * @brief Write the buffer and the length of its contents
+ */
+static void runtime_buffer(void)
+{
+    fprintf(D_LLVM_FILE,
+            "@" PURPLE_PRINT_PREFIX "buffer = linkonce_odr global [%d x i8] zeroinitializer, "
+            "align 16" NEWLINE,
+            PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE,
+            "@" PURPLE_PRINT_PREFIX "length = linkonce_odr global i64 0, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE, "@" PURPLE_PRINT_PREFIX "true = linkonce_odr unnamed_addr constant "
+                         "[4 x i8] c\"true\", align 1" NEWLINE);
+    fprintf(D_LLVM_FILE, "@" PURPLE_PRINT_PREFIX "false = linkonce_odr unnamed_addr constant "
+                         "[5 x i8] c\"false\", align 1" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that writes text to stdout. write may take only part of the text, so
+ * it is written until all of it is taken. A failed write drops the rest of the text rather than
+ * retrying forever
+ */
+static void runtime_write(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "write(i8* %%text, "
+                         "i64 %%length) nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, "entry:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%empty = icmp eq i64 %%length, 0" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%empty, label %%done, label %%write" NEWLINE);
+
+    fprintf(D_LLVM_FILE, "write:" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%written = phi i64 [ 0, %%entry ], [ %%next_written, %%continue ]" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%remaining = sub i64 %%length, %%written" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%next_text = getelementptr inbounds i8, i8* %%text, i64 %%written" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%result = call i64 @write(i32 1, i8* %%next_text, i64 %%remaining)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%failed = icmp slt i64 %%result, 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%failed, label %%done, label %%continue" NEWLINE);
+    fprintf(D_LLVM_FILE, "continue:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%next_written = add i64 %%written, %%result" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%finished = icmp uge i64 %%next_written, %%length" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%finished, label %%done, label %%write" NEWLINE);
+
+    fprintf(D_LLVM_FILE, "done:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that writes the buffer to stdout and empties it
+ */
+static void runtime_flush(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "flush() nounwind "
+                         "uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%length = load i64, i64* @" PURPLE_PRINT_PREFIX "length, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "call void @" PURPLE_PRINT_PREFIX "write(i8* getelementptr inbounds ([%d x i8], "
+                "[%d x i8]* @" PURPLE_PRINT_PREFIX "buffer, i64 0, i64 0), i64 %%length)" NEWLINE,
+            PURPLE_PRINT_BUFFER_SIZE, PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE, TAB "store i64 0, i64* @" PURPLE_PRINT_PREFIX "length, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that makes room for a print in the buffer, flushing it if it is too
+ * full, and returns where the print should be written
+ */
+static void runtime_reserve(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr i64 @" PURPLE_PRINT_PREFIX "reserve(i64 %%size) "
+                         "nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, "entry:" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%length = load i64, i64* @" PURPLE_PRINT_PREFIX "length, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%space = sub i64 %d, %%length" NEWLINE, PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE, TAB "%%full = icmp ult i64 %%space, %%size" NEWLINE);
+    // The buffer fills at most once every PURPLE_PRINT_BUFFER_SIZE / PURPLE_PRINT_MAX_LENGTH prints
+    char weights[64];
+    snprintf(weights, sizeof(weights), "!{!\"branch_weights\", i32 1, i32 %d}",
+             PURPLE_PRINT_BUFFER_SIZE / PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%full, label %%flush, label %%done, !prof !%d" NEWLINE,
+            llvm_metadata_node(weights));
+    fprintf(D_LLVM_FILE, "flush:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "flush()" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br label %%done" NEWLINE);
+    fprintf(D_LLVM_FILE, "done:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%start = phi i64 [ %%length, %%entry ], [ 0, %%flush ]" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret i64 %%start" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the end of a print function, which copies %text_length bytes from %text into the
+ * buffer at %start
+ */
+static void runtime_copy_text(void)
+{
+    fprintf(D_LLVM_FILE,
+            TAB "%%destination = getelementptr inbounds [%d x i8], [%d x i8]* @" PURPLE_PRINT_PREFIX
+                "buffer, i64 0, i64 %%start" NEWLINE,
+            PURPLE_PRINT_BUFFER_SIZE, PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE, TAB "call void @llvm.memcpy.p0i8.p0i8.i64(i8* align 1 %%destination, "
+                             "i8* align 1 %%text, i64 %%text_length, i1 false)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%end = add i64 %%start, %%text_length" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "store i64 %%end, i64* @" PURPLE_PRINT_PREFIX "length, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that adds a long and the character following it to the buffer.
+ * Digits are written from the last to the first into a scratch array ending in the character, and
+ * the sign is written in front of them whether or not it is included in the text
+ */
+static void runtime_append_long(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "append.i64(i64 "
+                         "%%value, i8 %%terminator) nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, "entry:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%digits = alloca [%d x i8], align 16" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE, TAB "%%start = call i64 @" PURPLE_PRINT_PREFIX "reserve(i64 %d)" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE,
+            TAB "%%last = getelementptr inbounds [%d x i8], [%d x i8]* %%digits, i64 0, i64 %d"
+                NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH, PURPLE_PRINT_MAX_LENGTH, PURPLE_PRINT_MAX_LENGTH - 1);
+    fprintf(D_LLVM_FILE, TAB "store i8 %%terminator, i8* %%last, align 1" NEWLINE);
+    // The magnitude is unsigned, so the smallest long keeps its value when negated
+    fprintf(D_LLVM_FILE, TAB "%%negative = icmp slt i64 %%value, 0" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%negated = sub i64 0, %%value" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%magnitude = select i1 %%negative, i64 %%negated, i64 %%value" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br label %%digit" NEWLINE);
+
+    fprintf(D_LLVM_FILE, "digit:" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%position = phi i64 [ %d, %%entry ], [ %%next_position, %%digit ]" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH - 1);
+    fprintf(D_LLVM_FILE,
+            TAB "%%remaining = phi i64 [ %%magnitude, %%entry ], [ %%quotient, %%digit ]" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%next_position = sub i64 %%position, 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%quotient = udiv i64 %%remaining, 10" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%tens = mul i64 %%quotient, 10" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%ones = sub i64 %%remaining, %%tens" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%ones_byte = trunc i64 %%ones to i8" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%character = add i8 %%ones_byte, 48" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%slot = getelementptr inbounds [%d x i8], [%d x i8]* %%digits, i64 0, i64 "
+                "%%next_position" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH, PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE, TAB "store i8 %%character, i8* %%slot, align 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%more = icmp ne i64 %%quotient, 0" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%more, label %%digit, label %%sign" NEWLINE);
+
+    fprintf(D_LLVM_FILE, "sign:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%sign_position = sub i64 %%next_position, 1" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%sign_slot = getelementptr inbounds [%d x i8], [%d x i8]* %%digits, i64 0, i64 "
+                "%%sign_position" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH, PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE, TAB "store i8 45, i8* %%sign_slot, align 1" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%first = select i1 %%negative, i64 %%sign_position, i64 %%next_position" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%text = getelementptr inbounds [%d x i8], [%d x i8]* %%digits, i64 0, i64 "
+                "%%first" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH, PURPLE_PRINT_MAX_LENGTH);
+    fprintf(D_LLVM_FILE, TAB "%%text_length = sub i64 %d, %%first" NEWLINE,
+            PURPLE_PRINT_MAX_LENGTH);
+    runtime_copy_text();
+}
+
+/**
+ * @brief Write the function that adds a bool and the character following it to the buffer,
+ * selecting its text without branching
+ */
+static void runtime_append_bool(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "append.i1(i1 %%value, "
+                         "i8 %%terminator) nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%start = call i64 @" PURPLE_PRINT_PREFIX "reserve(i64 6)" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%text = select i1 %%value, i8* getelementptr inbounds ([4 x i8], [4 x i8]* "
+                "@" PURPLE_PRINT_PREFIX "true, i64 0, i64 0), i8* getelementptr inbounds ([5 x "
+                "i8], [5 x i8]* @" PURPLE_PRINT_PREFIX "false, i64 0, i64 0)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%word_length = select i1 %%value, i64 4, i64 5" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%destination = getelementptr inbounds [%d x i8], [%d x i8]* @" PURPLE_PRINT_PREFIX
+                "buffer, i64 0, i64 %%start" NEWLINE,
+            PURPLE_PRINT_BUFFER_SIZE, PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE, TAB "call void @llvm.memcpy.p0i8.p0i8.i64(i8* align 1 %%destination, "
+                             "i8* align 1 %%text, i64 %%word_length, i1 false)" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%terminator_slot = getelementptr inbounds i8, i8* %%destination, i64 "
+                "%%word_length" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "store i8 %%terminator, i8* %%terminator_slot, align 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%end = add i64 %%start, %%word_length" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%next_length = add i64 %%end, 1" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "store i64 %%next_length, i64* @" PURPLE_PRINT_PREFIX "length, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the functions that print a single long or bool on its own line
+ */
+static void runtime_print_value(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "i64(i64 %%value) "
+                         "nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "call void @" PURPLE_PRINT_PREFIX "append.i64(i64 %%value, i8 10)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "i1(i1 %%value) "
+                         "nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "call void @" PURPLE_PRINT_PREFIX "append.i1(i1 %%value, i8 10)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that prints several values on one line, separated by spaces. Each
+ * value is a long, or a bool if its kind is PURPLE_PRINT_KIND_BOOL
+ */
+static void runtime_print_values(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "values(i64* %%values, "
+                         "i8* %%kinds, i64 %%count) nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, "entry:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%last = sub i64 %%count, 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br label %%value" NEWLINE);
+
+    fprintf(D_LLVM_FILE, "value:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%index = phi i64 [ 0, %%entry ], [ %%next_index, %%next ]" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%is_last = icmp eq i64 %%index, %%last" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%terminator = select i1 %%is_last, i8 10, i8 32" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%value_slot = getelementptr inbounds i64, i64* %%values, i64 %%index" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%number = load i64, i64* %%value_slot, align 8" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%kind_slot = getelementptr inbounds i8, i8* %%kinds, i64 %%index" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%kind = load i8, i8* %%kind_slot, align 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%is_bool = icmp eq i8 %%kind, %d" NEWLINE, PURPLE_PRINT_KIND_BOOL);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%is_bool, label %%bool, label %%long" NEWLINE);
+    fprintf(D_LLVM_FILE, "bool:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%truth = icmp ne i64 %%number, 0" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "append.i1(i1 %%truth, i8 "
+                             "%%terminator)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br label %%next" NEWLINE);
+    fprintf(D_LLVM_FILE, "long:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "append.i64(i64 %%number, i8 "
+                             "%%terminator)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br label %%next" NEWLINE);
+    fprintf(D_LLVM_FILE, "next:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%next_index = add i64 %%index, 1" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%is_last, label %%done, label %%value" NEWLINE);
+    fprintf(D_LLVM_FILE, "done:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE "}" NEWLINE NEWLINE);
+}
+
+/**
+ * @brief Write the function that prints text formatted at compile-time. Text too long for the
+ * buffer is written straight to stdout
+ */
+static void runtime_print_text(void)
+{
+    fprintf(D_LLVM_FILE, "define linkonce_odr void @" PURPLE_PRINT_PREFIX "text(i8* %%text, "
+                         "i64 %%text_length) nounwind uwtable {" NEWLINE);
+    fprintf(D_LLVM_FILE, "entry:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "%%fits = icmp ule i64 %%text_length, %d" NEWLINE,
+            PURPLE_PRINT_BUFFER_SIZE);
+    fprintf(D_LLVM_FILE, TAB "br i1 %%fits, label %%copy, label %%direct" NEWLINE);
+    fprintf(D_LLVM_FILE, "direct:" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "flush()" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "call void @" PURPLE_PRINT_PREFIX "write(i8* %%text, i64 "
+                             "%%text_length)" NEWLINE);
+    fprintf(D_LLVM_FILE, TAB "ret void" NEWLINE);
+    fprintf(D_LLVM_FILE, "copy:" NEWLINE);
+    fprintf(D_LLVM_FILE,
+            TAB "%%start = call i64 @" PURPLE_PRINT_PREFIX "reserve(i64 %%text_length)" NEWLINE);
+    runtime_copy_text();
+}
+
+/**
+ * @brief Write the print runtime into the module. Its definitions are linkonce_odr, so that
+ * the modules of a program built from several files share one buffer
+ */
+void runtime_postamble(void)
+{
+    runtime_buffer();
+    runtime_write();
+    runtime_flush();
+    runtime_reserve();
+    runtime_append_long();
+    runtime_append_bool();
+    runtime_print_value();
+    runtime_print_values();
+    runtime_print_text();
+
+    // Destructors run once main returns, after everything the program prints
+    fprintf(D_LLVM_FILE, "@llvm.global_dtors = appending global [1 x { i32, void ()*, i8* }] "
+                         "[{ i32, void ()*, i8* } { i32 65535, void ()* "
+                         "@" PURPLE_PRINT_PREFIX "flush, i8* null }]" NEWLINE NEWLINE);
+
+    fprintf(D_LLVM_FILE, "declare i64 @write(i32, i8*, i64) #1" NEWLINE);
+    fprintf(D_LLVM_FILE, "declare void @llvm.memcpy.p0i8.p0i8.i64(i8* noalias nocapture writeonly, "
+                         "i8* noalias nocapture readonly, i64, i1 immarg)" NEWLINE NEWLINE);
+}
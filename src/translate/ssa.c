@@ -0,0 +1,592 @@
+/**
+ * @file ssa.c
+ * @author Charles Averill
+ * @brief On-the-fly SSA construction for local variables, following Braun et al., "Simple and
+ * Efficient Construction of Static Single Assignment Form"
+ * @date 19-Oct-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "translate/ssa.h"
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**Basic blocks of the function currently being translated*/
+static _Thread_local BasicBlock* blocks = NULL;
+/**Number of basic blocks*/
+static _Thread_local unsigned long long int num_blocks = 0;
+/**Size of blocks*/
+static _Thread_local unsigned long long int blocks_capacity = 0;
+/**Index of the block instructions are currently being generated in*/
+static _Thread_local unsigned long long int current_block = 0;
+
+/**Phis created in the current function, indexed by PhiNode.index*/
+static _Thread_local PhiNode** phis = NULL;
+/**Number of phis*/
+static _Thread_local unsigned long long int num_phis = 0;
+/**Size of phis*/
+static _Thread_local unsigned long long int phis_capacity = 0;
+
+/**Value of D_LABEL_INDEX when the current function began*/
+static _Thread_local type_label first_label_index = 0;
+/**Block index of each label generated in the current function, offset by first_label_index*/
+static _Thread_local long long int* label_blocks = NULL;
+/**Size of label_blocks*/
+static _Thread_local unsigned long long int label_blocks_capacity = 0;
+
+/**Locals that have been written to in the current function*/
+static _Thread_local SymbolTableEntry** written_variables = NULL;
+/**Number of written locals*/
+static _Thread_local unsigned long long int num_written_variables = 0;
+/**Size of written_variables*/
+static _Thread_local unsigned long long int written_variables_capacity = 0;
+
+/**
+ * @brief Grow a dynamic array so that it can hold at least `needed` elements
+ *
+ * @param array         Pointer to the array to grow
+ * @param capacity      Pointer to the current capacity of the array
+ * @param needed        Number of elements the array must be able to hold
+ * @param element_size  Size of a single element
+ */
+static void ensure_capacity(void** array, unsigned long long int* capacity,
+                            unsigned long long int needed, size_t element_size)
+{
+    if (needed <= *capacity) {
+        return;
+    }
+
+    unsigned long long int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    *array = tracked_realloc(MEMORY_CODEGEN, *array, new_capacity * element_size);
+    if (*array == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for SSA construction");
+    }
+    *capacity = new_capacity;
+}
+
+/**
+ * @brief Append a new, empty basic block
+ *
+ * @param label                     Label or unnamed register naming the block
+ * @return unsigned long long int   Index of the new block
+ */
+static unsigned long long int new_block(LLVMValue label)
+{
+    ensure_capacity((void**)&blocks, &blocks_capacity, num_blocks + 1, sizeof(BasicBlock));
+
+    blocks[num_blocks] = (BasicBlock){.label = label};
+
+    return num_blocks++;
+}
+
+/**
+ * @brief Find the block belonging to a label, creating it if it has not been referenced yet
+ *
+ * @param label                     Label to find the block of
+ * @return unsigned long long int   Index of the label's block
+ */
+static unsigned long long int block_for_label(LLVMValue label)
+{
+    if (label.value_type != LLVMVALUETYPE_LABEL || label.value.label_index < first_label_index) {
+        fatal(RC_COMPILER_ERROR,
+              "SSA construction received a label outside of the current function");
+    }
+
+    unsigned long long int offset = label.value.label_index - first_label_index;
+    if (offset >= label_blocks_capacity) {
+        unsigned long long int old_capacity = label_blocks_capacity;
+        ensure_capacity((void**)&label_blocks, &label_blocks_capacity, offset + 1,
+                        sizeof(long long int));
+        for (unsigned long long int i = old_capacity; i < label_blocks_capacity; i++) {
+            label_blocks[i] = -1;
+        }
+    }
+
+    if (label_blocks[offset] == -1) {
+        label_blocks[offset] = new_block(label);
+    }
+
+    return label_blocks[offset];
+}
+
+/**
+ * @brief Record that a block is the predecessor of another
+ *
+ * @param block         Index of the successor block
+ * @param predecessor   Index of the predecessor block
+ */
+static void add_predecessor(unsigned long long int block, unsigned long long int predecessor)
+{
+    BasicBlock* b = &blocks[block];
+
+    if (b->sealed) {
+        fatal(RC_COMPILER_ERROR, "Tried to add a predecessor to a sealed basic block");
+    }
+
+    ensure_capacity((void**)&b->predecessors, &b->predecessors_capacity, b->num_predecessors + 1,
+                    sizeof(unsigned long long int));
+    b->predecessors[b->num_predecessors++] = predecessor;
+}
+
+/**
+ * @brief Generate the LLVMValue naming a phi
+ *
+ * @param phi           Phi to name
+ * @return LLVMValue    Named virtual register holding the phi's value
+ */
+static LLVMValue phi_llvmvalue(PhiNode* phi)
+{
+    // Every definition the phi merges is within the variable's range
+    LLVMValue out = {.value_type = LLVMVALUETYPE_VIRTUAL_REGISTER,
+                     .num_info = phi->variable->type.value.number,
+                     .has_name = true,
+                     .has_range = phi->variable->has_range,
+                     .range = phi->variable->range};
+    sprintf(out.value.name, PURPLE_PHI_PREFIX "%llu", phi->index);
+    return out;
+}
+
+/**
+ * @brief Find the phi an LLVMValue names, if it names one
+ *
+ * @param value     LLVMValue to check
+ * @return PhiNode* Phi named by value, or NULL if value is not a phi
+ */
+static PhiNode* llvmvalue_phi(LLVMValue value)
+{
+    unsigned long long int index;
+
+    if (value.value_type != LLVMVALUETYPE_VIRTUAL_REGISTER || !value.has_name ||
+        strncmp(value.value.name, PURPLE_PHI_PREFIX, sizeof(PURPLE_PHI_PREFIX) - 1) ||
+        sscanf(value.value.name + sizeof(PURPLE_PHI_PREFIX) - 1, "%llu", &index) != 1 ||
+        index >= num_phis) {
+        return NULL;
+    }
+
+    return phis[index];
+}
+
+/**
+ * @brief Create an operandless phi at the start of a block
+ *
+ * @param block     Block to place the phi in
+ * @param variable  Local whose definitions the phi merges
+ * @return PhiNode* New phi
+ */
+static PhiNode* new_phi(unsigned long long int block, SymbolTableEntry* variable)
+{
+    PhiNode* phi = (PhiNode*)tracked_calloc(MEMORY_CODEGEN, 1, sizeof(PhiNode));
+    if (phi == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for phi node");
+    }
+
+    phi->index = num_phis;
+    phi->block = block;
+    phi->variable = variable;
+
+    ensure_capacity((void**)&phis, &phis_capacity, num_phis + 1, sizeof(PhiNode*));
+    phis[num_phis++] = phi;
+
+    return phi;
+}
+
+/**
+ * @brief Record the definition of a local in a given block
+ *
+ * @param variable  Local being defined
+ * @param block     Block the definition belongs to
+ * @param value     Defined value
+ */
+static void write_variable_in_block(SymbolTableEntry* variable, unsigned long long int block,
+                                    LLVMValue value)
+{
+    if (variable->block_llvmvalues == NULL) {
+        ensure_capacity((void**)&written_variables, &written_variables_capacity,
+                        num_written_variables + 1, sizeof(SymbolTableEntry*));
+        written_variables[num_written_variables++] = variable;
+    }
+
+    if (block >= variable->num_block_llvmvalues) {
+        unsigned long long int old_length = variable->num_block_llvmvalues;
+        ensure_capacity((void**)&variable->block_llvmvalues, &variable->num_block_llvmvalues,
+                        MAX(block + 1, num_blocks), sizeof(LLVMValue));
+        for (unsigned long long int i = old_length; i < variable->num_block_llvmvalues; i++) {
+            variable->block_llvmvalues[i] = LLVMVALUE_NULL;
+        }
+    }
+
+    variable->block_llvmvalues[block] = value;
+    variable->latest_llvmvalue = value;
+}
+
+static LLVMValue read_variable_in_block(SymbolTableEntry* variable, unsigned long long int block);
+
+/**
+ * @brief Fill a phi's operands with the reaching definitions from each predecessor of its block
+ *
+ * @param phi Phi to fill
+ */
+static void add_phi_operands(PhiNode* phi)
+{
+    unsigned long long int num_predecessors = blocks[phi->block].num_predecessors;
+
+    phi->operands =
+        (LLVMValue*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMValue) * num_predecessors);
+    if (phi->operands == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for phi operands");
+    }
+
+    for (unsigned long long int i = 0; i < num_predecessors; i++) {
+        phi->operands[i] =
+            read_variable_in_block(phi->variable, blocks[phi->block].predecessors[i]);
+        phi->num_operands++;
+    }
+}
+
+/**
+ * @brief Look up the definition of a local reaching a block that does not define it
+ *
+ * @param variable      Local to look up
+ * @param block         Block to look up the local's definition in
+ * @return LLVMValue    Reaching definition
+ */
+static LLVMValue read_variable_recursive(SymbolTableEntry* variable, unsigned long long int block)
+{
+    LLVMValue value;
+
+    if (!blocks[block].sealed) {
+        // Not every predecessor is known yet, so place an operandless phi to complete when sealing
+        PhiNode* phi = new_phi(block, variable);
+        BasicBlock* b = &blocks[block];
+        ensure_capacity((void**)&b->incomplete_phis, &b->incomplete_phis_capacity,
+                        b->num_incomplete_phis + 1, sizeof(PhiNode*));
+        b->incomplete_phis[b->num_incomplete_phis++] = phi;
+        value = phi_llvmvalue(phi);
+    } else if (blocks[block].num_predecessors == 0) {
+        // Entry or unreachable block
+        value = LLVMVALUE_UNDEF(variable->type.value.number);
+    } else if (blocks[block].num_predecessors == 1) {
+        value = read_variable_in_block(variable, blocks[block].predecessors[0]);
+    } else {
+        // Break potential cycles by defining the variable with an operandless phi first
+        PhiNode* phi = new_phi(block, variable);
+        value = phi_llvmvalue(phi);
+        write_variable_in_block(variable, block, value);
+        add_phi_operands(phi);
+    }
+
+    write_variable_in_block(variable, block, value);
+    return value;
+}
+
+/**
+ * @brief Look up the definition of a local reaching a given block
+ *
+ * @param variable      Local to look up
+ * @param block         Block to look up the local's definition in
+ * @return LLVMValue    Reaching definition
+ */
+static LLVMValue read_variable_in_block(SymbolTableEntry* variable, unsigned long long int block)
+{
+    if (block < variable->num_block_llvmvalues &&
+        variable->block_llvmvalues[block].value_type != LLVMVALUETYPE_NONE) {
+        return variable->block_llvmvalues[block];
+    }
+
+    return read_variable_recursive(variable, block);
+}
+
+/**
+ * @brief Reset SSA construction for a new function
+ *
+ * @param entry_block_register Virtual register number LLVM implicitly gives the entry block
+ */
+void ssa_begin_function(type_register entry_block_register)
+{
+    first_label_index = D_LABEL_INDEX;
+    for (unsigned long long int i = 0; i < label_blocks_capacity; i++) {
+        label_blocks[i] = -1;
+    }
+
+    num_blocks = 0;
+    ssa_begin_unnamed_block(entry_block_register);
+}
+
+/**
+ * @brief Free all memory used to construct SSA form for the current function
+ */
+void ssa_end_function(void)
+{
+    for (unsigned long long int i = 0; i < num_blocks; i++) {
+        tracked_free(blocks[i].predecessors);
+        tracked_free(blocks[i].incomplete_phis);
+    }
+    num_blocks = 0;
+
+    for (unsigned long long int i = 0; i < num_phis; i++) {
+        tracked_free(phis[i]->operands);
+        tracked_free(phis[i]);
+    }
+    num_phis = 0;
+
+    for (unsigned long long int i = 0; i < num_written_variables; i++) {
+        tracked_free(written_variables[i]->block_llvmvalues);
+        written_variables[i]->block_llvmvalues = NULL;
+        written_variables[i]->num_block_llvmvalues = 0;
+    }
+    num_written_variables = 0;
+}
+
+/**
+ * @brief Begin generating instructions in the block of a label
+ *
+ * @param label                     Label beginning the block
+ * @param seal                      True if every jump to this label has already been generated
+ * @return unsigned long long int   Index of the block
+ */
+unsigned long long int ssa_begin_block(LLVMValue label, bool seal)
+{
+    current_block = block_for_label(label);
+
+    if (seal) {
+        ssa_seal_block(label);
+    }
+
+    return current_block;
+}
+
+/**
+ * @brief Begin generating instructions in an unnamed block, such as the entry block or the
+ * unreachable block following a return
+ *
+ * @param block_register Virtual register number LLVM implicitly gives the block
+ */
+void ssa_begin_unnamed_block(type_register block_register)
+{
+    current_block = new_block(LLVMVALUE_VIRTUAL_REGISTER(block_register, NT_INT1));
+    blocks[current_block].sealed = true;
+}
+
+/**
+ * @brief Record a jump from the current block to a label
+ *
+ * @param label Label being jumped to
+ */
+void ssa_add_successor(LLVMValue label)
+{
+    add_predecessor(block_for_label(label), current_block);
+}
+
+/**
+ * @brief Mark that every jump to a label has been generated, completing any phis waiting on it
+ *
+ * @param label Label of block to seal
+ */
+void ssa_seal_block(LLVMValue label)
+{
+    unsigned long long int block = block_for_label(label);
+
+    if (blocks[block].sealed) {
+        return;
+    }
+
+    for (unsigned long long int i = 0; i < blocks[block].num_incomplete_phis; i++) {
+        add_phi_operands(blocks[block].incomplete_phis[i]);
+    }
+
+    blocks[block].num_incomplete_phis = 0;
+    blocks[block].sealed = true;
+}
+
+/**
+ * @brief Define a local in the current block
+ *
+ * @param variable  Local being assigned to
+ * @param value     Value assigned
+ */
+void ssa_write_variable(SymbolTableEntry* variable, LLVMValue value)
+{
+    write_variable_in_block(variable, current_block, value);
+}
+
+/**
+ * @brief Get the value of a local in the current block
+ *
+ * @param variable      Local being read
+ * @return LLVMValue    Value of the local, which may be a phi
+ */
+LLVMValue ssa_read_variable(SymbolTableEntry* variable)
+{
+    return read_variable_in_block(variable, current_block);
+}
+
+/**
+ * @brief Determine if two LLVMValues refer to the same value
+ *
+ * @param a     First LLVMValue
+ * @param b     Second LLVMValue
+ * @return bool True if a and b are the same value
+ */
+static bool llvmvalues_equal(LLVMValue a, LLVMValue b)
+{
+    if (a.value_type != b.value_type || a.has_name != b.has_name) {
+        return false;
+    }
+
+    if (a.has_name) {
+        return !strcmp(a.value.name, b.value.name);
+    }
+
+    return a.value_type == LLVMVALUETYPE_UNDEF || a.value.constant == b.value.constant;
+}
+
+/**
+ * @brief Follow the replacements of trivial phis until reaching a non-trivial value
+ *
+ * @param value         Value to resolve
+ * @return LLVMValue    Value that every use of value should refer to
+ */
+static LLVMValue resolve_llvmvalue(LLVMValue value)
+{
+    PhiNode* phi;
+
+    while ((phi = llvmvalue_phi(value)) != NULL && phi->is_trivial) {
+        value = phi->replacement;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Replace every phi whose operands are all the same value (or the phi itself) with that
+ * value, until no trivial phis remain
+ */
+static void remove_trivial_phis(void)
+{
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (unsigned long long int i = 0; i < num_phis; i++) {
+            PhiNode* phi = phis[i];
+            if (phi->is_trivial) {
+                continue;
+            }
+
+            LLVMValue self = phi_llvmvalue(phi);
+            LLVMValue same = LLVMVALUE_NULL;
+            bool trivial = true;
+            for (unsigned long long int j = 0; j < phi->num_operands; j++) {
+                LLVMValue operand = resolve_llvmvalue(phi->operands[j]);
+                if (llvmvalues_equal(operand, self) ||
+                    (same.value_type != LLVMVALUETYPE_NONE && llvmvalues_equal(operand, same))) {
+                    continue;
+                }
+                if (same.value_type != LLVMVALUETYPE_NONE) {
+                    trivial = false;
+                    break;
+                }
+                same = operand;
+            }
+
+            if (trivial) {
+                phi->is_trivial = true;
+                phi->replacement = same.value_type == LLVMVALUETYPE_NONE
+                                       ? LLVMVALUE_UNDEF(phi->variable->type.value.number)
+                                       : same;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Write the name of a block as it is referenced by branches and phis
+ *
+ * @param out   File to write to
+ * @param block Index of block to name
+ */
+static void print_block_name(FILE* out, unsigned long long int block)
+{
+    if (blocks[block].label.value_type == LLVMVALUETYPE_LABEL) {
+        fprintf(out, "%%" PURPLE_LABEL_PREFIX "%llu", blocks[block].label.value.label_index);
+    } else {
+        fprintf(out, "%%%llu", blocks[block].label.value.virtual_register_index);
+    }
+}
+
+/**
+ * @brief Write the non-trivial phis placed at the start of a block
+ *
+ * @param out   File to write to
+ * @param block Index of block whose phis are written
+ */
+static void print_block_phis(FILE* out, unsigned long long int block)
+{
+    for (unsigned long long int i = 0; i < num_phis; i++) {
+        PhiNode* phi = phis[i];
+        if (phi->block != block || phi->is_trivial) {
+            continue;
+        }
+
+        Number type = phi->variable->type.value.number;
+        fprintf(out, TAB "%%" PURPLE_PHI_PREFIX "%llu = phi %s%s ", phi->index,
+                numberTypeLLVMReprs[type.number_type], REFSTRING(type.pointer_depth));
+        for (unsigned long long int j = 0; j < phi->num_operands; j++) {
+            fprintf(out, "%s[ %s, ", j ? ", " : "",
+                    LLVM_REPR_NOTYPE(resolve_llvmvalue(phi->operands[j])));
+            print_block_name(out, blocks[block].predecessors[j]);
+            fprintf(out, " ]");
+        }
+        fprintf(out, NEWLINE);
+    }
+}
+
+/**
+ * @brief Write a buffered function body, placing phis at their block placeholders and replacing
+ * uses of trivial phis with the values they stand for
+ *
+ * @param out   File to write the finished body to
+ * @param body  Buffered function body
+ */
+void ssa_write_function_body(FILE* out, char* body)
+{
+    const size_t phi_prefix_length = sizeof("%" PURPLE_PHI_PREFIX) - 1;
+
+    remove_trivial_phis();
+
+    while (*body) {
+        if (!strncmp(body, PURPLE_PHI_PLACEHOLDER, PURPLE_PHI_PLACEHOLDER_LEN)) {
+            unsigned long long int block = strtoull(body + PURPLE_PHI_PLACEHOLDER_LEN, &body, 10);
+            print_block_phis(out, block);
+            // Skip the placeholder's newline
+            if (*body == '\n') {
+                body++;
+            }
+        } else if (!strncmp(body, "%" PURPLE_PHI_PREFIX, phi_prefix_length)) {
+            char* index_end;
+            unsigned long long int index = strtoull(body + phi_prefix_length, &index_end, 10);
+            if (index_end == body + phi_prefix_length || index >= num_phis) {
+                // Some other name that happens to start with the phi prefix
+                fputc(*body++, out);
+                continue;
+            }
+            LLVMValue resolved = resolve_llvmvalue(phis[index]->is_trivial
+                                                       ? phis[index]->replacement
+                                                       : phi_llvmvalue(phis[index]));
+            fprintf(out, "%s", LLVM_REPR_NOTYPE(resolved));
+            body = index_end;
+        } else {
+            fputc(*body++, out);
+        }
+    }
+}
@@ -9,9 +9,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "data.h"
 #include "translate/symbol_table.h"
 #include "utils/hash.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/trace.h"
 
 /**
  * @brief Create a new Symbol Table Stack
@@ -20,7 +23,8 @@
  */
 SymbolTableStack* new_symbol_table_stack(void)
 {
-    SymbolTableStack* stack = (SymbolTableStack*)malloc(sizeof(SymbolTableStack));
+    SymbolTableStack* stack =
+        (SymbolTableStack*)tracked_malloc(MEMORY_SYMBOL_TABLES, sizeof(SymbolTableStack));
     stack->length = 0;
     stack->top = NULL;
     return stack;
@@ -38,6 +42,23 @@ SymbolTableStack* new_nonempty_symbol_table_stack(void)
     return out;
 }
 
+/**
+ * @brief Create a new Symbol Table Stack holding a function's scope above the Global Symbol Table.
+ * The Global Symbol Table isn't modified, so that several functions may be translated at once
+ * 
+ * @param function_scope        Symbol Table holding the function's parameters
+ * @return SymbolTableStack*    Pointer to new Symbol Table Stack
+ */
+SymbolTableStack* new_function_symbol_table_stack(SymbolTable* function_scope)
+{
+    SymbolTableStack* out = new_symbol_table_stack();
+    function_scope->prev = NULL;
+    function_scope->next = D_GLOBAL_SYMBOL_TABLE;
+    out->top = function_scope;
+    out->length = 2;
+    return out;
+}
+
 /**
  * @brief Free all memory in a Symbol Table Stack
  */
@@ -101,7 +122,7 @@ void pop_and_free_symbol_table(SymbolTableStack* stack)
     SymbolTable* table = stack->top;
     stack->top = stack->top->next;
     purple_log(LOG_DEBUG, "Freeing %s in %s", "table", "pop_and_free_symbol_table");
-    free(table);
+    tracked_free(table);
     stack->length--;
 }
 
@@ -133,9 +154,11 @@ SymbolTable* new_symbol_table(void)
  */
 SymbolTable* new_symbol_table_with_length(int length)
 {
-    SymbolTable* table = (SymbolTable*)malloc(sizeof(SymbolTable));
-    table->buckets = (SymbolTableEntry**)malloc(sizeof(SymbolTableEntry*) * length);
+    SymbolTable* table = (SymbolTable*)tracked_malloc(MEMORY_SYMBOL_TABLES, sizeof(SymbolTable));
+    table->buckets =
+        (SymbolTableEntry**)tracked_calloc(MEMORY_SYMBOL_TABLES, length, sizeof(SymbolTableEntry*));
     table->length = 0;
+    table->num_entries = 0;
     table->capacity = length;
     table->total_buckets = length;
     table->next = NULL;
@@ -151,7 +174,8 @@ void resize_symbol_table(SymbolTable* table)
 {
     int new_capacity = table->total_buckets * 2;
     table->buckets =
-        (SymbolTableEntry**)realloc(table->buckets, sizeof(SymbolTableEntry*) * new_capacity);
+        (SymbolTableEntry**)tracked_realloc(MEMORY_SYMBOL_TABLES, table->buckets,
+                                            sizeof(SymbolTableEntry*) * new_capacity);
     table->capacity += table->total_buckets;
     table->total_buckets *= 2;
 }
@@ -203,13 +227,19 @@ SymbolTableEntry* find_symbol_table_stack_entry(SymbolTableStack* stack, char* s
  */
 SymbolTableEntry* new_symbol_table_entry(char* symbol_name)
 {
-    SymbolTableEntry* entry = (SymbolTableEntry*)malloc(sizeof(SymbolTableEntry));
+    SymbolTableEntry* entry =
+        (SymbolTableEntry*)tracked_malloc(MEMORY_SYMBOL_TABLES, sizeof(SymbolTableEntry));
     strcpy(entry->symbol_name, symbol_name);
     entry->length = strlen(symbol_name);
     entry->next = NULL;
     entry->bucket_index = 0;
     entry->chain_index = 0;
     entry->latest_llvmvalue = LLVMVALUE_NULL;
+    entry->in_memory = false;
+    entry->block_llvmvalues = NULL;
+    entry->num_block_llvmvalues = 0;
+    entry->is_used = false;
+    entry->has_range = false;
     return entry;
 }
 
@@ -232,6 +262,7 @@ SymbolTableEntry* add_symbol_table_entry(SymbolTable* table, char* symbol_name,
     SymbolTableEntry* entry = new_symbol_table_entry(symbol_name);
     entry->bucket_index = FNV_1(symbol_name) % table->total_buckets;
     entry->type = type;
+    entry->line_number = D_LINE_NUMBER;
 
     if (table->buckets[entry->bucket_index] != NULL) {
         SymbolTableEntry* curr = table->buckets[entry->bucket_index];
@@ -243,5 +274,9 @@ SymbolTableEntry* add_symbol_table_entry(SymbolTable* table, char* symbol_name,
         table->buckets[entry->bucket_index] = entry;
     }
 
+    table->num_entries++;
+    trace_counter("Symbol Table entries", table == D_GLOBAL_SYMBOL_TABLE ? "global" : "scope",
+                  table->num_entries);
+
     return entry;
 }
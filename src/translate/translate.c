@@ -7,22 +7,34 @@
 
 #include "translate/translate.h"
 #include "data.h"
+#include "optimize.h"
+#include "translate/codegen.h"
+#include "translate/debug.h"
+#include "translate/profile.h"
+#include "translate/ssa.h"
+#include "utils/clang.h"
 #include "utils/logging.h"
-
-LLVMStackEntryNode* freeVirtualRegistersHead = NULL;
+#include "utils/memory.h"
+#include "utils/timing.h"
 
 /**
  * @brief Initialize any values required for LLVM translation
  */
 static void translate_init(void)
 {
-    D_LLVM_FN = D_ARGS->filenames[1];
-    D_LLVM_FILE = fopen(D_ARGS->filenames[1], "w");
+    D_LLVM_FILE = fopen(D_LLVM_FN, "w");
     if (D_LLVM_FILE == NULL) {
-        fatal(RC_FILE_ERROR, "Could not open %s for writing LLVM", D_ARGS->filenames[1]);
+        fatal(RC_FILE_ERROR, "Could not open %s for writing LLVM", D_LLVM_FN);
     }
 
-    D_LLVM_GLOBALS_FN = "globals.ll";
+    // Global variables are written beside the LLVM file, so that programs compiled at the same
+    // time in the same directory don't share them
+    D_LLVM_GLOBALS_FN =
+        (char*)tracked_malloc(MEMORY_CODEGEN, strlen(D_LLVM_FN) + sizeof(PURPLE_GLOBALS_SUFFIX));
+    if (D_LLVM_GLOBALS_FN == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for global variables filename");
+    }
+    sprintf(D_LLVM_GLOBALS_FN, "%s" PURPLE_GLOBALS_SUFFIX, D_LLVM_FN);
     D_LLVM_GLOBALS_FILE = fopen(D_LLVM_GLOBALS_FN, "w");
     if (D_LLVM_GLOBALS_FILE == NULL) {
         fatal(RC_FILE_ERROR, "Could not open %s for writing LLVM global variables",
@@ -30,87 +42,237 @@ static void translate_init(void)
     }
 
     D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER = 1;
-
-    D_CURRENT_FUNCTION_PREAMBLE_PRINTED = false;
 }
 
 /**
- * @brief Perform a DFS on an AST to determine the stack allocation needed for a binary expression
+ * @brief Determine if an identifier refers to a global variable, rather than a local that may
+ * shadow one
  * 
- * @param root Root of AST to find stack allocation for
- * @return LLVMStackEntryNode* Pointer to front of the stack allocation linked list
+ * @param symbol_name   Identifier to check
+ * @return bool         True if symbol_name refers to a global
  */
-LLVMStackEntryNode* determine_binary_expression_stack_allocation(ASTNode* root)
+static bool is_global_symbol(char* symbol_name)
 {
-    LLVMStackEntryNode* temp_left;
-    LLVMStackEntryNode* temp_right;
-    LLVMStackEntryNode* curr;
+    SymbolTableEntry* entry = STS_FIND(symbol_name);
+    return entry != NULL && entry == GST_FIND(symbol_name);
+}
 
+/**
+ * @brief Determine if an AST takes the address of a symbol anywhere
+ * 
+ * @param root          Root of AST to search
+ * @param symbol_name   Name of symbol to search for
+ * @return bool         True if the address of symbol_name is taken in root
+ */
+static bool ast_takes_address(ASTNode* root, char* symbol_name)
+{
     if (root == NULL) {
-        return NULL;
+        return false;
     }
 
-    if (root->left || root->right) {
-        if (root->left) {
-            temp_left = determine_binary_expression_stack_allocation(root->left);
-        }
-        if (root->right) {
-            temp_right = determine_binary_expression_stack_allocation(root->right);
-        }
+    if (root->ttype == T_AMPERSAND && !strcmp(root->value.symbol_name, symbol_name)) {
+        return true;
+    }
 
-        if (temp_left) {
-            curr = temp_left;
-            while (curr->next) {
-                curr = curr->next;
+    if (root->ttype == T_FUNCTION_CALL && root->function_call_arguments) {
+        SymbolTableEntry* function = GST_FIND(root->value.symbol_name);
+        unsigned long long int num_arguments =
+            function ? function->type.value.function.num_parameters : 0;
+        for (unsigned long long int i = 0; i < num_arguments; i++) {
+            if (ast_takes_address(root->function_call_arguments[i], symbol_name)) {
+                return true;
             }
-            curr->next = temp_right;
-        } else {
-            temp_left = temp_right;
         }
+    }
 
-        return temp_left;
-    } else if (TOKENTYPE_IS_LITERAL(root->ttype)) {
-        if (D_ARGS->const_expr_reduce) {
-            return NULL;
+    return ast_takes_address(root->left, symbol_name) ||
+           ast_takes_address(root->mid, symbol_name) ||
+           ast_takes_address(root->right, symbol_name);
+}
+
+/**
+ * @brief Mark the parameters of a function whose addresses are taken as living in memory, all
+ * others are kept in SSA registers
+ * 
+ * @param root Function declaration AST
+ */
+static void mark_in_memory_parameters(ASTNode* root)
+{
+    Function function = GST_FIND(root->value.symbol_name)->type.value.function;
+
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        SymbolTableEntry* param = STS_FIND(function.parameters[i].parameter_name);
+        if (param) {
+            param->in_memory = ast_takes_address(root->left, param->symbol_name);
         }
+    }
+}
 
-        LLVMStackEntryNode* current = (LLVMStackEntryNode*)malloc(sizeof(LLVMStackEntryNode));
+/**Name of the variable accumulating the results of self-recursive calls turned into a loop, which
+ * can't clash with any identifier*/
+#define TAIL_RECURSION_ACCUMULATOR_NAME "tailrecurse.acc"
 
-        current->reg = get_next_local_virtual_register();
-        prepend_stack_entry_linked_list(&freeVirtualRegistersHead, current->reg);
+/**Function currently being translated*/
+static _Thread_local SymbolTableEntry* current_function = NULL;
+/**How the self-recursive tail calls of the current function are turned into a loop*/
+static _Thread_local TailRecursion tail_recursion;
+/**Label following the entry block of the current function, which self-recursive tail calls jump
+ * back to*/
+static _Thread_local LLVMValue tail_recursion_label;
+/**Variable combining the results of the self-recursive calls replaced by jumps*/
+static _Thread_local SymbolTableEntry* tail_recursion_accumulator = NULL;
 
-        current->type = root->tree_type.number_type;
-        current->align_bytes = numberTypeByteSizes[current->type];
-        current->next = NULL;
+/**
+ * @brief Begin the loop that replaces the self-recursive tail calls of the current function
+ */
+static void begin_tail_recursion(void)
+{
+    if (tail_recursion.accumulator_operation != T_EOF) {
+        TokenType return_type = current_function->type.value.function.return_type;
+        tail_recursion_accumulator =
+            STS_INSERT(TAIL_RECURSION_ACCUMULATOR_NAME,
+                       TYPE_NUMBER_FROM_NUMBERTYPE_FROM_TOKEN(return_type));
+
+        // The identity of the accumulating operation
+        LLVMValue identity =
+            LLVMVALUE_CONSTANT(tail_recursion.accumulator_operation == T_STAR ? 1 : 0);
+        identity.num_info.number_type = token_type_to_number_type(return_type);
+        ssa_write_variable(tail_recursion_accumulator, identity);
+    }
 
-        return current;
-    } else if (root->ttype == T_IDENTIFIER) {
-        if (D_ARGS->const_expr_reduce) {
-            return NULL;
-        }
-        SymbolTableEntry* symbol = STS_FIND(root->value.symbol_name);
-        if (symbol == NULL) {
-            fatal(RC_COMPILER_ERROR,
-                  "Failed to find symbol in determine_binary_expression_stack_allocation");
+    // Nothing may jump to the entry block, so the loop begins in the block after it
+    tail_recursion_label = get_next_label();
+    llvm_jump(tail_recursion_label);
+    llvm_loop_header_label(tail_recursion_label);
+}
+
+/**
+ * @brief Determine if an AST node is a self-recursive tail call that will be replaced by a jump
+ *
+ * @param node  AST node to check
+ * @return bool True if node is a self-recursive tail call of the current function
+ */
+static bool is_tail_recursive_call(ASTNode* node)
+{
+    return tail_recursion.is_tail_recursive && node != NULL && node->ttype == T_FUNCTION_CALL &&
+           node->is_tail_call && !strcmp(node->value.symbol_name, current_function->symbol_name);
+}
+
+/**
+ * @brief Find the self-recursive tail call returned by a return statement, either directly or
+ * combined with the accumulator
+ *
+ * @param return_node   Return statement AST node
+ * @return ASTNode*     The self-recursive tail call, or NULL if there is none
+ */
+static ASTNode* returned_tail_recursive_call(ASTNode* return_node)
+{
+    ASTNode* value = return_node->left;
+
+    if (is_tail_recursive_call(value)) {
+        return value;
+    } else if (value != NULL && value->ttype == tail_recursion.accumulator_operation) {
+        if (is_tail_recursive_call(value->right)) {
+            return value->right;
+        } else if (is_tail_recursive_call(value->left)) {
+            return value->left;
         }
+    }
 
-        LLVMStackEntryNode* current = (LLVMStackEntryNode*)malloc(sizeof(LLVMStackEntryNode));
+    return NULL;
+}
+
+/**
+ * @brief Generate LLVM-IR for a self-recursive tail call, which reassigns the function's parameters
+ * and jumps back to the beginning of its body
+ *
+ * @param value     Returned expression containing call, or call itself
+ * @param call      Self-recursive tail call
+ * @return LLVMValue LLVMVALUE_NULL
+ */
+static LLVMValue tail_recursion_ast_to_llvm(ASTNode* value, ASTNode* call)
+{
+    Function function = current_function->type.value.function;
+
+    if (value != call) {
+        // The rest of this call's result is folded into the accumulator before recursing
+        ASTNode* operand = value->left == call ? value->right : value->left;
+        LLVMValue operand_value = ast_to_llvm(operand, LLVMVALUE_NULL, value->ttype);
+        ssa_write_variable(tail_recursion_accumulator,
+                           llvm_accumulate(tail_recursion.accumulator_operation,
+                                           ssa_read_variable(tail_recursion_accumulator),
+                                           operand_value));
+    }
+
+    // Arguments may read the parameters, so none are reassigned until every argument is evaluated
+    LLVMValue* arguments =
+        (LLVMValue*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMValue) * function.num_parameters);
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        arguments[i] =
+            ast_to_llvm(call->function_call_arguments[i], LLVMVALUE_NULL, T_FUNCTION_CALL);
+    }
+    for (unsigned long long int i = 0; i < function.num_parameters; i++) {
+        llvm_store_local(function.parameters[i].parameter_name, arguments[i]);
+    }
+    tracked_free(arguments);
 
-        current->reg = get_next_local_virtual_register();
-        prepend_stack_entry_linked_list(&freeVirtualRegistersHead, current->reg);
+    llvm_jump(tail_recursion_label);
 
-        current->type = symbol->type.value.number.number_type;
-        if (current->type == -1) {
-            fatal(RC_COMPILER_ERROR, "Symbol number type is ill-formed");
-        }
+    // Like a return, nothing may follow the jump in its block
+    D_CURRENT_FUNCTION_HAS_RETURNED = true;
+    ssa_begin_unnamed_block(get_next_local_virtual_register());
 
-        current->align_bytes = numberTypeByteSizes[symbol->type.value.number.number_type];
-        current->next = NULL;
+    return LLVMVALUE_NULL;
+}
 
-        return current;
+/**
+ * @brief Generate a return from the current function, first combining the returned value with the
+ * results of any self-recursive calls that were replaced by jumps
+ *
+ * @param value         Value to return
+ * @param symbol_name   Name of current function
+ */
+static void return_to_llvm(LLVMValue value, char* symbol_name)
+{
+    if (tail_recursion.accumulator_operation != T_EOF) {
+        value = llvm_accumulate(tail_recursion.accumulator_operation,
+                                ssa_read_variable(tail_recursion_accumulator), value);
     }
 
-    return NULL;
+    llvm_return(value, symbol_name);
+}
+
+/**
+ * @brief Determine what LLVM may assume about a function call
+ *
+ * @param call              Function call AST node
+ * @return TailCallKind     How the call may reuse its caller's stack frame
+ */
+static TailCallKind tail_call_kind(ASTNode* call)
+{
+    if (!call->is_tail_call) {
+        return TAIL_CALL_NONE;
+    }
+
+    Function caller = current_function->type.value.function;
+    Function callee = GST_FIND(call->value.symbol_name)->type.value.function;
+
+    // A guaranteed tail call must be returned unchanged from a caller with the same prototype and
+    // calling convention
+    if (caller.return_type == T_VOID || tail_recursion.accumulator_operation != T_EOF ||
+        caller.return_type != callee.return_type || caller.is_internal != callee.is_internal ||
+        caller.num_parameters != callee.num_parameters) {
+        return TAIL_CALL_ALLOWED;
+    }
+
+    for (unsigned long long int i = 0; i < caller.num_parameters; i++) {
+        if (!NUMBERS_TYPEQUIV(caller.parameters[i].parameter_type,
+                              callee.parameters[i].parameter_type)) {
+            return TAIL_CALL_ALLOWED;
+        }
+    }
+
+    return TAIL_CALL_REQUIRED;
 }
 
 /**
@@ -157,12 +319,19 @@ static LLVMValue if_ast_to_llvm(ASTNode* n)
 }
 
 /**
- * @brief Generate LLVM-IR for a while-else statement AST
+ * @brief Generate LLVM-IR for a while-else statement AST. Loops are rotated, so that the condition
+ * is tested once before entering the loop and again by its last block
  * 
- * condition_label:
  * jump else_label if !condition
+ * jump body_label
+ * body_label:
  * body()
- * jump condition_label
+ * postamble()
+ * jump exit_label if !condition
+ * latch_label:
+ * jump body_label
+ * exit_label:
+ * jump else_label
  * else_label:
  * elsebody()
  * 
@@ -171,38 +340,97 @@ static LLVMValue if_ast_to_llvm(ASTNode* n)
  */
 static LLVMValue while_else_ast_to_llvm(ASTNode* n)
 {
-    LLVMValue condition_label, else_label;
+    LLVMValue body_label, exit_label, else_label;
+    ASTNode* postamble = NULL;
+    ASTNode* else_body = n->right;
+
+    // For loops keep their postamble (NULL for a while loop) and else body in a glue node
+    if (n->right && n->right->ttype == T_AST_GLUE) {
+        postamble = n->right->left;
+        else_body = n->right->right;
+    }
 
-    condition_label = get_next_label();
+    body_label = get_next_label();
+    exit_label = get_next_label();
     else_label = get_next_label();
 
-    llvm_jump(condition_label);
-    llvm_label(condition_label);
-
+    // The condition's true branch is the loop's preheader
     ast_to_llvm(n->left, else_label, n->ttype);
+    llvm_jump(body_label);
+    llvm_loop_header_label(body_label);
+
     ast_to_llvm(n->mid, LLVMVALUE_NULL, n->ttype);
+    ast_to_llvm(postamble, LLVMVALUE_NULL, n->ttype);
 
-    if (n->right) {
-        switch (n->right->ttype) {
-        case T_AST_GLUE:
-            // For loop
-            ast_to_llvm(n->right->left, LLVMVALUE_NULL, n->ttype);
-            llvm_jump(condition_label);
-            llvm_label(else_label);
-            ast_to_llvm(n->right->right, LLVMVALUE_NULL, n->ttype);
+    // The condition's true branch is the loop's only latch, which carries its hints
+    ast_to_llvm(n->left, exit_label, n->ttype);
+    llvm_loop_latch_jump(body_label, n->loop_hints, n->loop_unroll_count);
+    ssa_seal_block(body_label);
+
+    // The loop's only exit is kept apart from the else body, which is also reached from the guard
+    llvm_label(exit_label);
+    llvm_jump(else_label);
+    llvm_label(else_label);
+    ast_to_llvm(else_body, LLVMVALUE_NULL, n->ttype);
+
+    return LLVMVALUE_NULL;
+}
+
+/**
+ * @brief Determine if every value of a print statement is a literal, so that its text can be
+ * formatted at compile-time
+ * 
+ * @param root  Root AST node
+ * @return bool True if root is a print statement of literals
+ */
+static bool is_constant_print(ASTNode* root)
+{
+    if (root->ttype != T_PRINT) {
+        return false;
+    }
+
+    for (ASTNode* print = root; print; print = print->right) {
+        if (!TOKENTYPE_IS_LITERAL(print->left->ttype)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Format the text of a print statement of literals
+ * 
+ * @param root Root AST node
+ */
+static void constant_print_ast_to_llvm(ASTNode* root)
+{
+    for (ASTNode* print = root; print; print = print->right) {
+        char text[32];
+        char terminator = print->right ? ' ' : '\n';
+        number_literal_type value = print->left->value.number_value;
+
+        // Literals are printed as they would be at runtime, in the width of their type
+        switch (token_type_to_number_type(print->left->ttype)) {
+        case NT_INT1:
+            snprintf(text, sizeof(text), "%s%c", value ? "true" : "false", terminator);
+            break;
+        case NT_INT8:
+            snprintf(text, sizeof(text), "%d%c", (signed char)value, terminator);
+            break;
+        case NT_INT16:
+            snprintf(text, sizeof(text), "%d%c", (short)value, terminator);
+            break;
+        case NT_INT32:
+            snprintf(text, sizeof(text), "%d%c", (int)value, terminator);
             break;
         default:
-            // Standard while loop
-            llvm_jump(condition_label);
-            llvm_label(else_label);
-            ast_to_llvm(n->right, LLVMVALUE_NULL, n->ttype);
+            snprintf(text, sizeof(text), "%lld%c", (long long int)value, terminator);
+            break;
         }
-    } else {
-        llvm_jump(condition_label);
-        llvm_label(else_label);
-    }
 
-    return LLVMVALUE_NULL;
+        llvm_print_constant(text);
+    }
 }
 
 /**
@@ -211,8 +439,36 @@ static LLVMValue while_else_ast_to_llvm(ASTNode* n)
  * @param n Root AST node
  * @return LLVMValue LLVMVALUE_NULL
  */
-static LLVMValue print_ast_to_llvm(ASTNode* root, LLVMValue virtual_register)
+static LLVMValue print_ast_to_llvm(ASTNode* root)
 {
+    if (is_constant_print(root)) {
+        constant_print_ast_to_llvm(root);
+        return LLVMVALUE_NULL;
+    }
+
+    // Several values are printed with a single call
+    if (root->right) {
+        unsigned long long int num_values = 0;
+        for (ASTNode* print = root; print; print = print->right) {
+            num_values++;
+        }
+
+        LLVMValue* values =
+            (LLVMValue*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMValue) * num_values);
+        if (values == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for printed values");
+        }
+        unsigned long long int i = 0;
+        for (ASTNode* print = root; print; print = print->right) {
+            values[i++] = ast_to_llvm(print->left, LLVMVALUE_NULL, root->ttype);
+        }
+
+        llvm_print_values(values, num_values);
+        tracked_free(values);
+        return LLVMVALUE_NULL;
+    }
+
+    LLVMValue virtual_register = ast_to_llvm(root->left, LLVMVALUE_NULL, root->ttype);
     if (root->left->tree_type.number_type == NT_INT1) {
         llvm_print_bool(virtual_register);
     } else {
@@ -239,6 +495,45 @@ static LLVMValue print_ast_to_llvm(ASTNode* root, LLVMValue virtual_register)
     return LLVMVALUE_NULL;
 }
 
+/**
+ * @brief Generate LLVM-IR for a list of statements. Lists grow to the left, one glue per
+ * statement, so they're walked with a loop rather than recursion that long functions would
+ * overflow the stack with
+ *
+ * @param root  Last glue of the list
+ * @return LLVMValue LLVMVALUE_NULL
+ */
+static LLVMValue glue_ast_to_llvm(ASTNode* root)
+{
+    unsigned long long int num_glues = 0;
+    for (ASTNode* glue = root; glue && glue->ttype == T_AST_GLUE; glue = glue->left) {
+        num_glues++;
+    }
+
+    ASTNode** glues = (ASTNode**)tracked_malloc(MEMORY_CODEGEN, sizeof(ASTNode*) * num_glues);
+    if (glues == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for statement list");
+    }
+    unsigned long long int i = 0;
+    for (ASTNode* glue = root; glue && glue->ttype == T_AST_GLUE; glue = glue->left) {
+        glues[i++] = glue;
+    }
+
+    // Temporaries don't outlive their statement, so each statement may reuse the stack slots
+    // of the statements before it
+    ast_to_llvm(glues[num_glues - 1]->left, LLVMVALUE_NULL, T_AST_GLUE);
+    llvm_release_stack_slots();
+    while (i-- > 0) {
+        ast_to_llvm(glues[i]->mid, LLVMVALUE_NULL, T_AST_GLUE);
+        llvm_release_stack_slots();
+        ast_to_llvm(glues[i]->right, LLVMVALUE_NULL, T_AST_GLUE);
+        llvm_release_stack_slots();
+    }
+
+    tracked_free(glues);
+    return LLVMVALUE_NULL;
+}
+
 /**
  * @brief Generates LLVM-IR from a given AST
  * 
@@ -259,25 +554,60 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
         return LLVMVALUE_NULL;
     }
 
+    // Consecutive constant prints are printed together once something else is generated
+    if (root->ttype != T_AST_GLUE && !is_constant_print(root)) {
+        llvm_flush_constant_prints();
+    }
+
+    debug_location(root->line_number, root->char_number);
+
     // Special kinds of TokenTypes that shouldn't have their left and right branches generated in the standard manner
     switch (root->ttype) {
     case T_IF:
         return if_ast_to_llvm(root);
     case T_WHILE:
         return while_else_ast_to_llvm(root);
+    case T_PRINT:
+        return print_ast_to_llvm(root);
     case T_AST_GLUE:
-        ast_to_llvm(root->left, LLVMVALUE_NULL, root->ttype);
-        ast_to_llvm(root->mid, LLVMVALUE_NULL, root->ttype);
-        ast_to_llvm(root->right, LLVMVALUE_NULL, root->ttype);
-        return LLVMVALUE_NULL;
+        return glue_ast_to_llvm(root);
     case T_FUNCTION_DECLARATION:
-        llvm_function_preamble(root->value.symbol_name);
+        mark_in_memory_parameters(root);
+        current_function = GST_FIND(root->value.symbol_name);
+        tail_recursion = D_ARGS->tail_calls ? mark_tail_calls(root)
+                                            : (TailRecursion){.is_tail_recursive = false,
+                                                              .accumulator_operation = T_EOF};
+
+        profile_begin_function(root);
+        debug_begin_function(root);
+        tracked_free(llvm_function_preamble(root->value.symbol_name));
+        if (tail_recursion.is_tail_recursive) {
+            begin_tail_recursion();
+        }
+
         ast_to_llvm(root->left, LLVMVALUE_NULL, root->ttype);
         if (!D_CURRENT_FUNCTION_HAS_RETURNED) {
-            llvm_return(LLVMVALUE_CONSTANT(0), root->value.symbol_name);
+            return_to_llvm(LLVMVALUE_CONSTANT(0), root->value.symbol_name);
+        }
+
+        if (tail_recursion.is_tail_recursive) {
+            // Every jump back to the beginning of the body has been generated
+            ssa_seal_block(tail_recursion_label);
         }
         llvm_function_postamble();
         return LLVMVALUE_NULL;
+    case T_RETURN:;
+        ASTNode* tail_recursive_call = returned_tail_recursive_call(root);
+        if (tail_recursive_call) {
+            return tail_recursion_ast_to_llvm(root->left, tail_recursive_call);
+        }
+        break;
+    case T_FUNCTION_CALL:
+        // A void function's last statement may be a self-recursive call
+        if (is_tail_recursive_call(root)) {
+            return tail_recursion_ast_to_llvm(root, root);
+        }
+        break;
     default:
         break;
     }
@@ -305,7 +635,8 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
                                          "without a label index");
             }
 
-            return llvm_compare_jump(root->ttype, left_vr, right_vr, llvm_value);
+            return llvm_compare_jump(root->ttype, left_vr, right_vr, llvm_value,
+                                     root->branch_hint);
         } else {
             return llvm_compare(root->ttype, left_vr, right_vr);
         }
@@ -325,57 +656,33 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
                                          "without a label index");
             }
 
-            return llvm_compare_jump(root->ttype, left_vr, right_vr, llvm_value);
+            return llvm_compare_jump(root->ttype, left_vr, right_vr, llvm_value,
+                                     root->branch_hint);
         } else {
             return llvm_compare(root->ttype, left_vr, right_vr);
         }
     } else if (TOKENTYPE_IS_LITERAL(root->ttype)) {
-        if (D_ARGS->const_expr_reduce) {
-            LLVMValue out = LLVMVALUE_CONSTANT(root->value.number_value);
-            out.num_info.number_type = token_type_to_number_type(root->ttype);
-            return out;
-        }
-
-        // Allocate stack space
-        purple_log(LOG_DEBUG, "Determining stack space");
-        LLVMStackEntryNode* stack_entries = determine_binary_expression_stack_allocation(root);
-        purple_log(LOG_DEBUG, "Allocating stack space");
-        if (llvm_stack_allocation(stack_entries)) {
-            purple_log(LOG_DEBUG, "Freeing stack space entries");
-            free_llvm_stack_entry_node_list(stack_entries);
-            stack_entries = NULL;
-        }
-
-        NumberType store_type;
-        if ((store_type = token_type_to_number_type(root->ttype)) != -1) {
-            out = llvm_store_constant(NUMBER_FROM_TYPE_VAL(store_type, root->value.number_value));
-        } else {
-            fatal(RC_COMPILER_ERROR, "Failed to match TokenType \"%s\" to NumberType",
-                  tokenStrings[root->ttype]);
-        }
-
+        out = LLVMVALUE_CONSTANT(root->value.number_value);
+        out.num_info.number_type = token_type_to_number_type(root->ttype);
         return out;
     } else {
         switch (root->ttype) {
         case T_IDENTIFIER:
             if (root->is_rvalue || parent_operation == T_DEREFERENCE) {
-                if (GST_FIND(root->value.symbol_name)) {
+                if (is_global_symbol(root->value.symbol_name)) {
                     return llvm_load_global_variable(root->value.symbol_name);
+                } else if (STS_FIND(root->value.symbol_name)) {
+                    return llvm_load_local(root->value.symbol_name);
                 } else {
-                    SymbolTableEntry* entry = STS_FIND(root->value.symbol_name);
-                    if (entry) {
-                        return entry->latest_llvmvalue;
-                    } else {
-                        fatal(RC_COMPILER_ERROR,
-                              "Expected STE with LLVMValue but got STE without LLVMValue");
-                    }
+                    fatal(RC_COMPILER_ERROR, "Failed to find symbol \"%s\"",
+                          root->value.symbol_name);
                 }
             }
             return LLVMVALUE_NULL;
         case T_ASSIGN:
             if (root->right) {
                 if (root->right->ttype == T_IDENTIFIER) {
-                    if (GST_FIND(root->right->value.symbol_name)) {
+                    if (is_global_symbol(root->right->value.symbol_name)) {
                         llvm_store_global_variable(root->right->value.symbol_name, left_vr);
                     } else {
                         llvm_store_local(root->right->value.symbol_name, left_vr);
@@ -389,8 +696,6 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
                       tokenStrings[root->right->ttype]);
             }
             fatal(RC_COMPILER_ERROR, "T_ASSIGN case in ast_to_llvm didn't detect a right child");
-        case T_PRINT:
-            return print_ast_to_llvm(root, left_vr);
         case T_FUNCTION_CALL:;
             symbol = GST_FIND(root->value.symbol_name);
             if (symbol == NULL) {
@@ -398,14 +703,15 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
                       root->value.symbol_name);
             }
             unsigned long long int num_parameters = symbol->type.value.function.num_parameters;
-            LLVMValue* passed_llvmvalues = (LLVMValue*)malloc(sizeof(LLVMValue) * num_parameters);
+            LLVMValue* passed_llvmvalues =
+                (LLVMValue*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMValue) * num_parameters);
             for (int i = 0; i < num_parameters; i++) {
                 passed_llvmvalues[i] =
                     ast_to_llvm(root->function_call_arguments[i], LLVMVALUE_NULL, T_FUNCTION_CALL);
             }
-            LLVMValue out =
-                llvm_call_function(passed_llvmvalues, num_parameters, root->value.symbol_name);
-            free(passed_llvmvalues);
+            LLVMValue out = llvm_call_function(passed_llvmvalues, num_parameters,
+                                               root->value.symbol_name, tail_call_kind(root));
+            tracked_free(passed_llvmvalues);
             return out;
         case T_AMPERSAND:
             return llvm_get_address(root->value.symbol_name);
@@ -425,9 +731,7 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
                 }
             }
 
-            llvm_return(
-
-                left_vr, root->value.symbol_name);
+            return_to_llvm(left_vr, root->value.symbol_name);
             return LLVMVALUE_NULL;
         default:
             fatal(RC_COMPILER_ERROR, "Unknown operator \"%s\"", tokenStrings[root->ttype]);
@@ -437,6 +741,101 @@ LLVMValue ast_to_llvm(ASTNode* root, LLVMValue llvm_value, TokenType parent_oper
     return LLVMVALUE_NULL;
 }
 
+/**
+ * @brief Parse every function in the input, folding and pruning each one as it is parsed
+ *
+ * @return ParsedProgram Every function in the input, in the order they were declared
+ */
+static ParsedProgram parse_program(void)
+{
+    ParsedProgram program = {.functions = NULL, .num_functions = 0, .capacity = 0};
+
+    while (D_GLOBAL_TOKEN.token_type != T_EOF) {
+        if (program.num_functions >= program.capacity) {
+            program.capacity = program.capacity ? program.capacity * 2 : 16;
+            program.functions = (ParsedFunction*)tracked_realloc(MEMORY_CODEGEN, 
+                program.functions, sizeof(ParsedFunction) * program.capacity);
+            if (program.functions == NULL) {
+                fatal(RC_MEMORY_ERROR, "Failed to allocate memory for parsed functions");
+            }
+        }
+
+        TimeSpan start = time_function_begin();
+        push_symbol_table(D_SYMBOL_TABLE_STACK);
+        time_phase_begin(TIME_PHASE_PARSING);
+        ASTNode* root = function_declaration();
+        time_phase_end(TIME_PHASE_PARSING);
+        if (root == NULL) {
+            // Prototypes only declare functions defined in other files
+            pop_and_free_symbol_table(D_SYMBOL_TABLE_STACK);
+            continue;
+        }
+        time_phase_begin(TIME_PHASE_OPTIMIZATION);
+        if (D_ARGS->const_expr_reduce || D_ARGS->const_propagate) {
+            root = fold_constants(root);
+        }
+        root = eliminate_unreachable_statements(root);
+        time_phase_end(TIME_PHASE_OPTIMIZATION);
+        time_function_end(TIME_FUNCTION_PARSE, root->value.symbol_name, start);
+
+        program.functions[program.num_functions++] = (ParsedFunction){
+            .root = root, .scope = pop_symbol_table(D_SYMBOL_TABLE_STACK), .is_reachable = true};
+    }
+
+    return program;
+}
+
+/**
+ * @brief Give every function that can only be called from within the program internal linkage, so
+ * that it may use a faster calling convention. Without an entry point, and for exported functions,
+ * other programs may be the callers
+ *
+ * @param program Every function in the input
+ */
+static void mark_internal_functions(ParsedProgram* program)
+{
+    SymbolTableEntry* main_function = GST_FIND("main");
+    bool has_entry_point = main_function != NULL && main_function->type.is_function;
+
+    for (unsigned long long int i = 0; i < program->num_functions; i++) {
+        char* symbol_name = program->functions[i].root->value.symbol_name;
+        Function* function = &GST_FIND(symbol_name)->type.value.function;
+        function->is_internal =
+            has_entry_point && !function->is_exported && strcmp(symbol_name, "main");
+    }
+}
+
+/**
+ * @brief Declare the global variables that are used by the generated program, or every global
+ * variable if dead code is not being eliminated
+ */
+static void declare_global_variables(void)
+{
+    for (unsigned long int i = 0; i < D_GLOBAL_SYMBOL_TABLE->total_buckets; i++) {
+        for (SymbolTableEntry* entry = D_GLOBAL_SYMBOL_TABLE->buckets[i]; entry;
+             entry = entry->next) {
+            if (!entry->type.is_function && (entry->is_used || !D_ARGS->dead_code_elim)) {
+                llvm_declare_global_number_variable(entry->symbol_name, entry->type.value.number);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Declare the functions whose prototypes were given, but whose bodies are in other files
+ */
+static void declare_external_functions(void)
+{
+    for (unsigned long int i = 0; i < D_GLOBAL_SYMBOL_TABLE->total_buckets; i++) {
+        for (SymbolTableEntry* entry = D_GLOBAL_SYMBOL_TABLE->buckets[i]; entry;
+             entry = entry->next) {
+            if (entry->type.is_function && entry->type.value.function.is_external) {
+                llvm_declare_external_function(entry->symbol_name);
+            }
+        }
+    }
+}
+
 /**
  * @brief Wrapper function for generating LLVM
  */
@@ -446,24 +845,48 @@ void generate_llvm(void)
 
     translate_init();
 
+    if (D_ARGS->profile_use) {
+        profile_load(D_ARGS->profile_use);
+    }
+
+    time_phase_begin(TIME_PHASE_CODEGEN);
     llvm_preamble();
+    debug_preamble();
+    time_phase_end(TIME_PHASE_CODEGEN);
 
-    while (D_GLOBAL_TOKEN.token_type != T_EOF) {
-        D_CURRENT_FUNCTION_HAS_RETURNED = false;
-        push_symbol_table(D_SYMBOL_TABLE_STACK);
-        ASTNode* root = function_declaration();
-        ast_to_llvm(root, LLVMVALUE_NULL, root->ttype);
-        pop_symbol_table(D_SYMBOL_TABLE_STACK);
+    ParsedProgram program = parse_program();
+
+    time_phase_begin(TIME_PHASE_OPTIMIZATION);
+    if (D_ARGS->tail_calls || D_ARGS->infer_attributes || D_ARGS->range_analysis) {
+        mark_internal_functions(&program);
+    }
+
+    if (D_ARGS->inline_functions) {
+        inline_functions(&program);
+    }
+
+    if (D_ARGS->dead_code_elim) {
+        eliminate_dead_code(&program);
+    }
 
-        D_CURRENT_FUNCTION_PREAMBLE_PRINTED = false;
-        D_LLVM_LOCAL_VIRTUAL_REGISTER_NUMBER = 1;
+    if (D_ARGS->infer_attributes) {
+        infer_function_attributes(&program);
+    }
 
-        free_llvm_stack_entry_node_list(freeVirtualRegistersHead);
-        freeVirtualRegistersHead = NULL;
-        free_ast_node(root);
+    if (D_ARGS->range_analysis) {
+        infer_variable_ranges(&program);
     }
+    time_phase_end(TIME_PHASE_OPTIMIZATION);
+
+    time_phase_begin(TIME_PHASE_CODEGEN);
+    codegen_functions(&program);
+    tracked_free(program.functions);
+
+    declare_global_variables();
+    declare_external_functions();
 
     llvm_postamble();
+    time_phase_end(TIME_PHASE_CODEGEN);
 
     purple_log(LOG_DEBUG, "LLVM written to %s", D_LLVM_FN);
 }
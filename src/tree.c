@@ -11,6 +11,7 @@
 #include "data.h"
 
 #include "tree.h"
+#include "utils/memory.h"
 
 /**
  * @brief Constructs a new AST Node with the provided values
@@ -29,7 +30,7 @@ ASTNode* create_ast_node(TokenType ttype, ASTNode* left, ASTNode* mid, ASTNode*
     ASTNode* out;
 
     // Allocate memory for new node
-    out = (ASTNode*)malloc(sizeof(ASTNode));
+    out = (ASTNode*)tracked_calloc(MEMORY_PARSER, 1, sizeof(ASTNode));
     if (out == NULL) {
         fatal(RC_MEMORY_ERROR, "Unable to allocate memory for new AST Node");
     }
@@ -194,6 +195,39 @@ void ast_debug_level_order(ASTNode* root, LogLevel log_level)
     }
 }
 
+/**
+ * @brief Make a deep copy of an AST, including the arguments of function calls
+ * 
+ * @param root      Root of AST to copy
+ * @return ASTNode* Root of the new AST
+ */
+ASTNode* copy_ast(ASTNode* root)
+{
+    if (root == NULL) {
+        return NULL;
+    }
+
+    ASTNode* out = (ASTNode*)tracked_malloc(MEMORY_PARSER, sizeof(ASTNode));
+    if (out == NULL) {
+        fatal(RC_MEMORY_ERROR, "Unable to allocate memory for copied AST Node");
+    }
+
+    *out = *root;
+    out->left = copy_ast(root->left);
+    out->mid = copy_ast(root->mid);
+    out->right = copy_ast(root->right);
+
+    if (root->function_call_arguments) {
+        out->function_call_arguments =
+            (ASTNode**)tracked_malloc(MEMORY_PARSER, sizeof(ASTNode*) * root->num_args);
+        for (unsigned long long int i = 0; i < root->num_args; i++) {
+            out->function_call_arguments[i] = copy_ast(root->function_call_arguments[i]);
+        }
+    }
+
+    return out;
+}
+
 void free_ast_node(ASTNode* root)
 {
     if (root->left)
@@ -205,6 +239,9 @@ void free_ast_node(ASTNode* root)
 
     for (int i = 0; i < root->num_args; i++) {
         if (root->function_call_arguments[i])
-            free(root->function_call_arguments[i]);
+            free_ast_node(root->function_call_arguments[i]);
     }
+    tracked_free(root->function_call_arguments);
+
+    tracked_free(root);
 }
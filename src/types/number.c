@@ -57,6 +57,102 @@ int number_to_token_type(Number number)
     }
 }
 
+/**
+ * @brief Determine if a value is representable by a NumberType
+ * 
+ * @param value Value to check
+ * @param type  NumberType to check against
+ * @return bool True if value fits in type without being truncated
+ */
+bool value_fits_number_type(long long int value, NumberType type)
+{
+    if (type == NT_INT1) {
+        return value == 0 || value == 1;
+    }
+
+    return value <= (long long int)numberTypeMaxValues[type] &&
+           value >= -(long long int)numberTypeMaxValues[type] - 1;
+}
+
+/**
+ * @brief Truncate a value to a NumberType the way a two's-complement machine does
+ * 
+ * @param value         Value to truncate
+ * @param type          NumberType to truncate to
+ * @return long long int Low bits of value that fit in type, sign-extended from type's width
+ */
+long long int wrap_to_number_type(long long int value, NumberType type)
+{
+    int bits = numberTypeBitSizes[type];
+    if (bits >= 64) {
+        return value;
+    } else if (type == NT_INT1) {
+        return value & 1;
+    }
+
+    unsigned long long int mask = (1ULL << bits) - 1;
+    unsigned long long int low = (unsigned long long int)value & mask;
+    if (low >> (bits - 1)) {
+        low |= ~mask;
+    }
+
+    return (long long int)low;
+}
+
+/**
+ * @brief Perform a binary arithmetic operation on two numbers the way it runs: in the wider of
+ * their types, with two's-complement wraparound
+ * 
+ * @param operation TokenType of the operation
+ * @param left      Left operand
+ * @param right     Right operand
+ * @param out       Filled with the result
+ * @return bool     True if the operation is supported and doesn't divide by zero
+ */
+bool wrapping_arithmetic(int operation, Number left, Number right, Number* out)
+{
+    NumberType type = left.number_type > right.number_type ? left.number_type : right.number_type;
+    int bits = numberTypeBitSizes[type];
+    unsigned long long int mask = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+    // Unsigned arithmetic wraps without undefined behavior, and its low bits are the same
+    unsigned long long int l = (unsigned long long int)left.value;
+    unsigned long long int r = (unsigned long long int)right.value;
+    unsigned long long int result = 1;
+
+    switch (operation) {
+    case T_PLUS:
+        result = l + r;
+        break;
+    case T_MINUS:
+        result = l - r;
+        break;
+    case T_STAR:
+        result = l * r;
+        break;
+    case T_SLASH:
+        // Division is unsigned, on the operands' bits in the operation's type
+        if ((r & mask) == 0) {
+            return false;
+        }
+        result = (l & mask) / (r & mask);
+        break;
+    case T_EXPONENT:
+        // The exponent is also treated as unsigned, and the low bits of each product are kept
+        for (r &= mask; r > 0; r >>= 1) {
+            if (r & 1) {
+                result *= l;
+            }
+            l *= l;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    *out = NUMBER_FROM_TYPE_VAL(type, wrap_to_number_type((long long int)result, type));
+    return true;
+}
+
 /**
  * @brief Finds the maximum NumberType possible for a given value
  * 
@@ -72,3 +168,91 @@ NumberType max_numbertype_for_val(long long int value)
     }
     return -1;
 }
+
+/**
+ * @brief Get the range of every value a NumberType can represent
+ * 
+ * @param type          NumberType to get the range of
+ * @return ValueRange   Smallest and largest values of type
+ */
+ValueRange number_type_range(NumberType type)
+{
+    if (type == NT_INT1) {
+        return (ValueRange){.min = 0, .max = 1};
+    }
+
+    return (ValueRange){.min = -(long long int)numberTypeMaxValues[type] - 1,
+                        .max = (long long int)numberTypeMaxValues[type]};
+}
+
+/**
+ * @brief Determine if every value in a range is representable by a NumberType
+ * 
+ * @param range Range to check
+ * @param type  NumberType to check against
+ * @return bool True if no value in range is truncated by type
+ */
+bool range_fits_number_type(ValueRange range, NumberType type)
+{
+    return value_fits_number_type(range.min, type) && value_fits_number_type(range.max, type);
+}
+
+/**
+ * @brief Get the smallest range containing two ranges
+ * 
+ * @param a             First range
+ * @param b             Second range
+ * @return ValueRange   Range containing every value of a and b
+ */
+ValueRange range_union(ValueRange a, ValueRange b)
+{
+    return (ValueRange){.min = a.min < b.min ? a.min : b.min, .max = a.max > b.max ? a.max : b.max};
+}
+
+/**
+ * @brief Compute the range of the result of an arithmetic operation on values in two ranges
+ * 
+ * @param operation TokenType of the operation
+ * @param left      Range of the left operand
+ * @param right     Range of the right operand
+ * @param out       Filled with the range of the result
+ * @return bool     True if the operation is supported and no result overflows 64 bits or divides
+ * by zero
+ */
+bool range_arithmetic(int operation, ValueRange left, ValueRange right, ValueRange* out)
+{
+    long long int corners[4];
+
+    switch (operation) {
+    case T_PLUS:
+        return !__builtin_add_overflow(left.min, right.min, &out->min) &&
+               !__builtin_add_overflow(left.max, right.max, &out->max);
+    case T_MINUS:
+        return !__builtin_sub_overflow(left.min, right.max, &out->min) &&
+               !__builtin_sub_overflow(left.max, right.min, &out->max);
+    case T_STAR:
+        if (__builtin_mul_overflow(left.min, right.min, &corners[0]) ||
+            __builtin_mul_overflow(left.min, right.max, &corners[1]) ||
+            __builtin_mul_overflow(left.max, right.min, &corners[2]) ||
+            __builtin_mul_overflow(left.max, right.max, &corners[3])) {
+            return false;
+        }
+
+        out->min = out->max = corners[0];
+        for (int i = 1; i < 4; i++) {
+            *out = range_union(*out, (ValueRange){.min = corners[i], .max = corners[i]});
+        }
+        return true;
+    case T_SLASH:
+        // Division is unsigned, which only matches signed division for non-negative operands
+        if (left.min < 0 || right.min < 1) {
+            return false;
+        }
+
+        out->min = left.min / right.max;
+        out->max = left.max / right.min;
+        return true;
+    default:
+        return false;
+    }
+}
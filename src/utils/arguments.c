@@ -7,16 +7,18 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "info.h"
 #include "utils/arguments.h"
 #include "utils/formatting.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
 
 const char* argp_program_version = PROJECT_NAME_AND_VERS;
 const char* argp_program_bug_address = "charlesaverill20@gmail.com";
 static char doc[] = "The standard compiler for the Purple programming language";
-static char args_doc[] = "PROGRAM";
+static char args_doc[] = "PROGRAM...";
 
 static struct argp_option options[] = {
     {0, 0, 0, 0, "Informational Options:", 1},
@@ -32,16 +34,116 @@ static struct argp_option options[] = {
     {"cmd", 'c', "PROGRAM", OPTION_HIDDEN, "Program passed in as a string", 0},
     {"llvm-output", ARGP_LLVM_OUTPUT, "FILE", 0, "Path to the generated LLVM file", 0},
     {"output", 'o', "FILE", 0, "Path to compiled binary", 0},
+    {"compile-only", ARGP_COMPILE_ONLY, 0, 0,
+     "Compile each PROGRAM to an object file named after it, without linking", 0},
+    {"jobs", 'j', "JOBS", 0,
+     "Compile each PROGRAM into a program of its own named after it, JOBS at a time, or one per "
+     "processor if JOBS is 0. With --compile-only, PROGRAMs are still compiled JOBS at a time",
+     0},
+    {"lto", ARGP_LTO, 0, 0, "Optimize every file of the program as a whole when linking", 0},
+    {"thin-lto", ARGP_THIN_LTO, 0, 0,
+     "Optimize files separately when linking, importing the functions they call from each other",
+     0},
     {"opt", 'O', "OPTLEVEL", 0, "Level of optimization to enable (0-3)"},
+    {"debug-info", ARGP_DEBUG_INFO, 0, 0,
+     "Emit DWARF debug information mapping the program to its source lines, variables and "
+     "parameters",
+     0},
+    {"debug-line-tables-only", ARGP_DEBUG_LINE_TABLES_ONLY, 0, 0,
+     "Emit only the DWARF line tables needed for profilers to attribute samples to source lines",
+     0},
+    {"codegen-threads", ARGP_CODEGEN_THREADS, "THREADS", 0,
+     "Number of threads translating functions at once, or 0 for one per processor (default is 1)",
+     0},
+    {"line-buffered-output", ARGP_LINE_BUFFERED_OUTPUT, 0, 0,
+     "Write the program's output after every print, for interactive programs, instead of buffering "
+     "it until the buffer fills or the program exits",
+     0},
+    {"server", ARGP_SERVER, "SOCKET", 0,
+     "Run as a compile server listening on the Unix domain socket SOCKET, compiling the programs "
+     "sent by clients without restarting the compiler",
+     0},
+    {"connect", ARGP_CONNECT, "SOCKET", 0,
+     "Send the other arguments to the compile server listening on SOCKET, instead of compiling "
+     "here",
+     0},
+    {"cache-dir", ARGP_CACHE_DIR, "DIR", 0,
+     "Store compiled programs in the build cache DIR, and restore programs compiled before from it "
+     "instead of compiling them again",
+     0},
+    {"cache-size", ARGP_CACHE_SIZE, "MEGABYTES", 0,
+     "Number of megabytes the build cache may hold before the least recently used programs are "
+     "evicted from it (default is 512)",
+     0},
     {"fconst-expr-reduce", FCONST_EXPR_REDUCE_CODE, 0, OPTION_HIDDEN,
      "Reduces constant expressions at compile-time", 0},
     {"fprint-func-annotations", FPRINT_FUNC_ANNOTATIONS, 0, OPTION_HIDDEN,
      "When generating llvm, prints a comment containing which function in the compiler is printing",
      0},
+    {"fconst-propagate", FCONST_PROPAGATE_CODE, 0, OPTION_HIDDEN,
+     "Substitutes variables' known constant values for their uses and removes constant branches",
+     0},
+    {"fdead-code-elim", FDEAD_CODE_ELIM_CODE, 0, OPTION_HIDDEN,
+     "Removes functions unreachable from main and variables that are never read", 0},
+    {"finline-functions", FINLINE_FUNCTIONS_CODE, 0, OPTION_HIDDEN,
+     "Substitutes the bodies of small functions and functions declared \"inline\" at their calls",
+     0},
+    {"ftail-calls", FTAIL_CALLS_CODE, 0, OPTION_HIDDEN,
+     "Turns self-recursive tail calls into loops and lets other tail calls reuse their caller's "
+     "stack frame",
+     0},
+    {"finfer-attributes", FINFER_ATTRIBUTES_CODE, 0, OPTION_HIDDEN,
+     "Gives functions attributes describing their effects, so LLVM may delete, hoist and merge "
+     "calls",
+     0},
+    {"frange-analysis", FRANGE_ANALYSIS_CODE, 0, OPTION_HIDDEN,
+     "Tracks the ranges of integer values to remove extensions, narrow comparisons, and mark "
+     "arithmetic that can't overflow",
+     0},
+    {"fprofile-generate", FPROFILE_GENERATE_CODE, "FILE", OPTION_ARG_OPTIONAL | OPTION_HIDDEN,
+     "Counts how often the program's branches, calls and functions run, and writes the counts to "
+     "FILE (default is \"" PURPLE_DEFAULT_PROFILE_FILENAME "\") when it exits",
+     0},
+    {"fprofile-use", FPROFILE_USE_CODE, "FILE", OPTION_HIDDEN,
+     "Passes the counts written by a program built with --fprofile-generate to LLVM, so that it "
+     "may optimize for the program's hot paths",
+     0},
+    {"ftime-report", FTIME_REPORT_CODE, "FORMAT", OPTION_ARG_OPTIONAL | OPTION_HIDDEN,
+     "Prints how long each phase of the compile and the slowest functions took when the compiler "
+     "exits, as a table or, if FORMAT is \"json\", as JSON",
+     0},
+    {"fmem-report", FMEM_REPORT_CODE, "FORMAT", OPTION_ARG_OPTIONAL | OPTION_HIDDEN,
+     "Prints how much memory each part of the compiler allocated, and the compiler's and clang's "
+     "peak resident set sizes, when the compiler exits, as a table or, if FORMAT is \"json\", as "
+     "JSON",
+     0},
+    {"ftrace", FTRACE_CODE, "FILE", OPTION_HIDDEN,
+     "Writes the compile's phases, functions, Symbol Table growth and clang processes to FILE as "
+     "Chrome trace events, to be loaded into a trace viewer",
+     0},
     {0, 0, 0, 0, "Generic Options:", -1},
     {0},
 };
 
+/**
+ * @brief Parse the format of a report that the compiler prints about its own work
+ *
+ * @param arg               Format given for the report, or NULL if none was given
+ * @param report            Name of the report, for error messages
+ * @return ReportFormat     Format of the report
+ */
+static ReportFormat parse_report_format(const char* arg, const char* report)
+{
+    if (arg != NULL && !strcmp("json", arg)) {
+        return REPORT_JSON;
+    } else if (arg != NULL && strcmp("table", arg)) {
+        fatal(RC_ARG_ERROR, "Expected a %s report format of table or json, but got \"%s\"",
+              report, arg);
+    }
+
+    return REPORT_TABLE;
+}
+
 error_t parse_opt(int key, char* arg, struct argp_state* state)
 {
     PurpleArgs* arguments = state->input;
@@ -72,6 +174,17 @@ error_t parse_opt(int key, char* arg, struct argp_state* state)
             argp_usage(state);
         }
         break;
+    case 'j':;
+        char* jobs_end;
+        long jobs = strtol(arg, &jobs_end, 10);
+        if (*arg == '\0' || *jobs_end != '\0' || jobs < 0 || jobs > PURPLE_MAX_JOBS) {
+            fatal(RC_ARG_ERROR, "Expected a number of jobs from 0 to %d, but got \"%s\"",
+                  PURPLE_MAX_JOBS, arg);
+        }
+        long jobs_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        arguments->batch = true;
+        arguments->jobs = jobs ? jobs : jobs_processors > 0 ? jobs_processors : 1;
+        break;
     case ARGP_LLVM_OUTPUT:
         arguments->filenames[1] = arg;
         break;
@@ -90,6 +203,54 @@ error_t parse_opt(int key, char* arg, struct argp_state* state)
         }
         set_opt_level(arguments, atoi(arg));
         break;
+    case ARGP_COMPILE_ONLY:
+        arguments->compile_only = true;
+        break;
+    case ARGP_LTO:
+        arguments->lto = LTO_FULL;
+        break;
+    case ARGP_THIN_LTO:
+        arguments->lto = LTO_THIN;
+        break;
+    case ARGP_DEBUG_INFO:
+        arguments->debug_info = DEBUG_INFO_FULL;
+        break;
+    case ARGP_DEBUG_LINE_TABLES_ONLY:
+        arguments->debug_info = DEBUG_INFO_LINE_TABLES_ONLY;
+        break;
+    case ARGP_CODEGEN_THREADS:;
+        char* end;
+        long threads = strtol(arg, &end, 10);
+        if (*arg == '\0' || *end != '\0' || threads < 0 || threads > PURPLE_MAX_CODEGEN_THREADS) {
+            fatal(RC_ARG_ERROR, "Expected a number of codegen threads from 0 to %d, but got \"%s\"",
+                  PURPLE_MAX_CODEGEN_THREADS, arg);
+        }
+        // A thread is started for every processor if 0 is given
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        arguments->codegen_threads = threads ? threads : processors > 0 ? processors : 1;
+        break;
+    case ARGP_LINE_BUFFERED_OUTPUT:
+        arguments->line_buffered_output = true;
+        break;
+    case ARGP_SERVER:
+        arguments->server_socket = arg;
+        break;
+    case ARGP_CONNECT:
+        arguments->connect_socket = arg;
+        break;
+    case ARGP_CACHE_DIR:
+        arguments->cache_dir = arg;
+        break;
+    case ARGP_CACHE_SIZE:;
+        char* cache_size_end;
+        long cache_size = strtol(arg, &cache_size_end, 10);
+        if (*arg == '\0' || *cache_size_end != '\0' || cache_size < 0 ||
+            cache_size > PURPLE_MAX_CACHE_SIZE) {
+            fatal(RC_ARG_ERROR, "Expected a number of megabytes from 0 to %d, but got \"%s\"",
+                  PURPLE_MAX_CACHE_SIZE, arg);
+        }
+        arguments->cache_size = cache_size;
+        break;
     case ARGP_HELP_FLAGS:
         help_flags();
         exit(0);
@@ -99,24 +260,112 @@ error_t parse_opt(int key, char* arg, struct argp_state* state)
     case FPRINT_FUNC_ANNOTATIONS:
         arguments->print_func_annotations = true;
         break;
+    case FCONST_PROPAGATE_CODE:
+        arguments->const_propagate = true;
+        break;
+    case FDEAD_CODE_ELIM_CODE:
+        arguments->dead_code_elim = true;
+        break;
+    case FINLINE_FUNCTIONS_CODE:
+        arguments->inline_functions = true;
+        break;
+    case FTAIL_CALLS_CODE:
+        arguments->tail_calls = true;
+        break;
+    case FINFER_ATTRIBUTES_CODE:
+        arguments->infer_attributes = true;
+        break;
+    case FRANGE_ANALYSIS_CODE:
+        arguments->range_analysis = true;
+        break;
+    case FPROFILE_GENERATE_CODE:
+        arguments->profile_generate = arg ? arg : PURPLE_DEFAULT_PROFILE_FILENAME;
+        break;
+    case FPROFILE_USE_CODE:
+        arguments->profile_use = arg;
+        break;
+    case FTIME_REPORT_CODE:
+        arguments->time_report = parse_report_format(arg, "time");
+        break;
+    case FMEM_REPORT_CODE:
+        arguments->memory_report = parse_report_format(arg, "memory");
+        break;
+    case FTRACE_CODE:
+        arguments->trace_fn = arg;
+        break;
     case ARGP_KEY_ARG:
-        // Check for too many arguments
-        if (state->arg_num > 1) {
+        if (arguments->from_command_line_argument != NULL) {
             argp_usage(state);
         }
 
-        if (arguments->from_command_line_argument != NULL) {
-            argp_usage(state);
+        arguments->input_filenames = (char**)tracked_realloc(MEMORY_DRIVER, 
+            arguments->input_filenames, sizeof(char*) * (arguments->num_input_filenames + 1));
+        if (arguments->input_filenames == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for input filenames");
         }
+        arguments->input_filenames[arguments->num_input_filenames++] = arg;
 
-        arguments->filenames[0] = arg;
+        if (arguments->filenames[0] == NULL) {
+            arguments->filenames[0] = arg;
+        }
 
         break;
     case ARGP_KEY_END:
+        // A compile server is sent its programs by clients
+        if (arguments->server_socket) {
+            if (arguments->connect_socket) {
+                fatal(RC_ARG_ERROR, "--server and --connect may not be used together");
+            } else if (state->arg_num > 0 || arguments->from_command_line_argument) {
+                fatal(RC_ARG_ERROR, "--server may not be given a PROGRAM, since clients send them");
+            }
+            break;
+        }
+
         // Check for not enough arguments
         if (state->arg_num < 1 && arguments->from_command_line_argument == NULL) {
             argp_usage(state);
         }
+
+        if (arguments->profile_generate && arguments->profile_use) {
+            fatal(RC_ARG_ERROR, "--fprofile-generate and --fprofile-use may not be used together");
+        }
+
+        int num_programs = 0;
+        for (int i = 0; i < arguments->num_input_filenames; i++) {
+            num_programs += is_purple_program(arguments->input_filenames[i]);
+        }
+
+        // Programs built from several files name their LLVM and object files after each input
+        bool is_separate = arguments->compile_only || num_programs > 1 ||
+                           num_programs < arguments->num_input_filenames;
+        if (arguments->compile_only && arguments->from_command_line_argument) {
+            fatal(RC_ARG_ERROR, "--compile-only may only be used with PROGRAM files");
+        } else if (arguments->batch && arguments->from_command_line_argument) {
+            fatal(RC_ARG_ERROR, "--jobs may only be used with PROGRAM files");
+        } else if (arguments->batch && !arguments->compile_only &&
+                   num_programs < arguments->num_input_filenames) {
+            fatal(RC_ARG_ERROR, "--jobs compiles each PROGRAM on its own, so it may not be given "
+                                "files to link them with");
+        } else if (arguments->batch && num_programs > 1 && arguments->filenames[2]) {
+            fatal(RC_ARG_ERROR, "--output may not be used with --jobs and more than one PROGRAM");
+        } else if (is_separate && num_programs > 1 && arguments->filenames[1]) {
+            fatal(RC_ARG_ERROR, "--llvm-output may not be used with more than one PROGRAM");
+        } else if (arguments->compile_only && num_programs > 1 && arguments->filenames[2]) {
+            fatal(RC_ARG_ERROR, "--output may not be used with --compile-only and more than one "
+                                "PROGRAM");
+        } else if (is_separate && arguments->profile_generate) {
+            // Every file would overwrite the profile when the program exits
+            fatal(RC_ARG_ERROR, "--fprofile-generate may only be used to build a program from a "
+                                "single file");
+        }
+
+        // Programs compiled with --jobs are named after their files unless they are named here
+        if (!is_separate && !arguments->batch && arguments->filenames[1] == NULL) {
+            arguments->filenames[1] = "a.ll";
+        }
+        if (!arguments->compile_only && !arguments->batch && arguments->filenames[2] == NULL) {
+            arguments->filenames[2] = "a.out";
+        }
         break;
     default:
         return ARGP_ERR_UNKNOWN;
@@ -133,14 +382,41 @@ static struct argp argp = {options, parse_opt, args_doc, doc, 0, 0, 0};
 void parse_args(PurpleArgs* args, int argc, char* argv[])
 {
     args->logging = LOG_INFO;
-    args->filenames[1] = "a.ll";
-    args->filenames[2] = "a.out";
     args->clang_executable = "/usr/bin/clang";
     args->from_command_line_argument = NULL;
+    args->codegen_threads = 1;
+    args->jobs = 1;
+    args->cache_size = PURPLE_DEFAULT_CACHE_SIZE;
 
     argp_parse(&argp, argc, argv, 0, 0, args);
 }
 
+/**
+ * @brief Determine if an input file is a Purple program, rather than a file that Purple programs
+ * are linked with
+ *
+ * @param filename  Name of input file
+ * @return bool     True if filename doesn't have the extension of an LLVM-IR, bitcode, object or
+ *                  library file
+ */
+bool is_purple_program(const char* filename)
+{
+    static const char* link_extensions[] = {".ll", ".bc", ".o", ".a", ".so"};
+
+    const char* extension = strrchr(filename, '.');
+    if (extension == NULL) {
+        return true;
+    }
+
+    for (unsigned long int i = 0; i < sizeof(link_extensions) / sizeof(link_extensions[0]); i++) {
+        if (!strcmp(extension, link_extensions[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * @brief Set optimization flags based on a given opt level
  * 
@@ -149,6 +425,9 @@ void parse_args(PurpleArgs* args, int argc, char* argv[])
  */
 void set_opt_level(PurpleArgs* args, int opt_level)
 {
+    // clang only has levels 0 through 3
+    args->opt_level = opt_level < 0 ? 0 : opt_level > 3 ? 3 : opt_level;
+
     switch (opt_level) {
     // On-purpose fallthrough so that higher levels automatically
     // set the flags from lower levels
@@ -156,6 +435,12 @@ void set_opt_level(PurpleArgs* args, int opt_level)
     case 2:
     case 1:
         args->const_expr_reduce = true;
+        args->const_propagate = true;
+        args->dead_code_elim = true;
+        args->inline_functions = true;
+        args->tail_calls = true;
+        args->infer_attributes = true;
+        args->range_analysis = true;
         break;
     default:
         break;
@@ -0,0 +1,418 @@
+/**
+ * @file cache.c
+ * @author Charles Averill
+ * @brief Logic for the build cache. Entries are directories named after the hash of everything
+ * their outputs were compiled from, which is stored in the entry and compared on every lookup so
+ * that colliding hashes are never mistaken for each other. Entries are written to a temporary
+ * directory and renamed into place, so that compiles running at once never see half an entry
+ * @date 19-Oct-2026
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "data.h"
+#include "info.h"
+#include "utils/cache.h"
+#include "utils/clang.h"
+#include "utils/hash.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**
+ * @brief Format the name of a file in the build cache
+ *
+ * @param fn        Buffer of PATH_MAX characters to write the name to
+ * @param format    Format string of the name
+ * @return bool     True if the whole name fit in fn
+ */
+static bool format_fn(char* fn, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(fn, PATH_MAX, format, args);
+    va_end(args);
+
+    return length >= 0 && length < PATH_MAX;
+}
+
+/**
+ * @brief Append the contents of a file to a stream
+ *
+ * @param stream    Stream to append to
+ * @param fn        Name of file to append
+ * @return bool     True if the whole file was appended
+ */
+static bool append_file(FILE* stream, const char* fn)
+{
+    FILE* file = fopen(fn, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        fwrite(buffer, 1, length, stream);
+    }
+    bool read_all = !ferror(file);
+    fclose(file);
+
+    return read_all;
+}
+
+/**
+ * @brief Copy a file, giving the copy the same permissions
+ *
+ * @param from_fn   Name of file to copy
+ * @param to_fn     Name of the copy
+ * @return bool     True if the file was copied
+ */
+static bool copy_file(const char* from_fn, const char* to_fn)
+{
+    struct stat from_stat;
+    int from = open(from_fn, O_RDONLY);
+    if (from < 0 || fstat(from, &from_stat) < 0) {
+        if (from >= 0) {
+            close(from);
+        }
+        return false;
+    }
+    int to = open(to_fn, O_WRONLY | O_CREAT | O_TRUNC, from_stat.st_mode & 0777);
+    if (to < 0) {
+        close(from);
+        return false;
+    }
+
+    bool copied = fchmod(to, from_stat.st_mode & 0777) == 0;
+    char buffer[65536];
+    ssize_t length;
+    while (copied && (length = read(from, buffer, sizeof(buffer))) != 0) {
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        copied = length > 0 && write(to, buffer, length) == length;
+    }
+
+    close(from);
+    return close(to) == 0 && copied;
+}
+
+/**
+ * @brief Remove a cache entry's directory and the files in it
+ *
+ * @param directory Directory to remove
+ */
+static void remove_entry_directory(const char* directory)
+{
+    DIR* entries = opendir(directory);
+    if (entries == NULL) {
+        return;
+    }
+
+    struct dirent* file;
+    char fn[PATH_MAX];
+    while ((file = readdir(entries)) != NULL) {
+        if (strcmp(file->d_name, ".") && strcmp(file->d_name, "..") &&
+            format_fn(fn, "%s/%s", directory, file->d_name)) {
+            unlink(fn);
+        }
+    }
+    closedir(entries);
+
+    rmdir(directory);
+}
+
+/**
+ * @brief Build the entry of the build cache for a program, if the build cache is enabled
+ *
+ * @param input_fn      Name of the program file
+ * @param is_binary     True if the program is compiled into a binary rather than an object file
+ * @return CacheEntry*  The program's entry, or NULL if the build cache is disabled or the program
+ *                      can't be read
+ */
+CacheEntry* cache_entry(const char* input_fn, bool is_binary)
+{
+    if (D_ARGS->cache_dir == NULL) {
+        return NULL;
+    }
+
+    CacheEntry* entry = (CacheEntry*)tracked_calloc(MEMORY_DRIVER, 1, sizeof(CacheEntry));
+    if (entry == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for build cache entry");
+    }
+    FILE* key = open_memstream(&entry->key, &entry->key_length);
+    if (key == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for build cache key");
+    }
+
+    fprintf(key, "%s\n", PROJECT_NAME_AND_VERS);
+    char* target_triple = get_target_triple();
+    char* target_datalayout = get_target_datalayout();
+    fprintf(key, "target %s %s\nclang %s\n", target_triple, target_datalayout,
+            D_ARGS->clang_executable);
+    tracked_free(target_triple);
+    tracked_free(target_datalayout);
+
+    fprintf(key, "%s -O%d lto %d debug-info %d line-buffered %d annotations %d\n",
+            is_binary ? "binary" : "object", D_ARGS->opt_level, D_ARGS->lto, D_ARGS->debug_info,
+            D_ARGS->line_buffered_output, D_ARGS->print_func_annotations);
+    fprintf(key, "flags %d %d %d %d %d %d %d\n", D_ARGS->const_expr_reduce,
+            D_ARGS->const_propagate, D_ARGS->dead_code_elim, D_ARGS->inline_functions,
+            D_ARGS->tail_calls, D_ARGS->infer_attributes, D_ARGS->range_analysis);
+
+    // Debug information and instrumented programs name files relative to the working directory
+    const char* basename = strrchr(input_fn, '/') ? strrchr(input_fn, '/') + 1 : input_fn;
+    fprintf(key, "module %s\n", basename);
+    if (D_ARGS->debug_info != DEBUG_INFO_NONE || D_ARGS->profile_generate) {
+        char* cwd = getcwd(NULL, 0);
+        fprintf(key, "file %s in %s\n", input_fn, cwd ? cwd : "");
+        tracked_free(cwd);
+    }
+    if (D_ARGS->profile_generate) {
+        fprintf(key, "profile-generate %s\n", D_ARGS->profile_generate);
+    }
+    if (D_ARGS->profile_use) {
+        fprintf(key, "profile-use %s\n", D_ARGS->profile_use);
+        append_file(key, D_ARGS->profile_use);
+        fprintf(key, "\n");
+    }
+
+    fprintf(key, "source\n");
+    bool read_source = append_file(key, input_fn);
+    fclose(key);
+    if (!read_source) {
+        // The compile will report that the program can't be read
+        free_cache_entry(entry);
+        return NULL;
+    }
+
+    entry->directory = (char*)tracked_malloc(MEMORY_DRIVER, strlen(D_ARGS->cache_dir) + 18);
+    if (entry->directory == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for build cache entry");
+    }
+    sprintf(entry->directory, "%s/%016lx", D_ARGS->cache_dir,
+            FNV_1_bytes(entry->key, entry->key_length));
+
+    return entry;
+}
+
+/**
+ * @brief Restore the outputs of a program from its entry in the build cache, marking the entry as
+ * the most recently used
+ *
+ * @param entry     The program's entry
+ * @param llvm_fn   Name of the LLVM file to restore
+ * @param output_fn Name of the object file or binary to restore
+ * @return bool     True if the entry was in the cache and its outputs were restored
+ */
+bool cache_restore(CacheEntry* entry, const char* llvm_fn, const char* output_fn)
+{
+    char fn[PATH_MAX];
+    if (!format_fn(fn, "%s/" PURPLE_CACHE_KEY_FN, entry->directory)) {
+        return false;
+    }
+
+    char* key = NULL;
+    size_t key_length = 0;
+    FILE* key_stream = open_memstream(&key, &key_length);
+    if (key_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for build cache key");
+    }
+    bool found = append_file(key_stream, fn);
+    fclose(key_stream);
+    found = found && key_length == entry->key_length && !memcmp(key, entry->key, key_length);
+    tracked_free(key);
+    if (!found) {
+        return false;
+    }
+    utime(fn, NULL);
+
+    // An entry evicted while it is copied is compiled again
+    if (!format_fn(fn, "%s/" PURPLE_CACHE_LLVM_FN, entry->directory) || !copy_file(fn, llvm_fn)) {
+        return false;
+    }
+    if (!format_fn(fn, "%s/" PURPLE_CACHE_OUTPUT_FN, entry->directory) ||
+        !copy_file(fn, output_fn)) {
+        return false;
+    }
+
+    purple_log(LOG_DEBUG, "Restored %s and %s from build cache entry %s", llvm_fn, output_fn,
+               entry->directory);
+    return true;
+}
+
+/**
+ * @brief Information about an entry of the build cache used to choose entries to evict
+ */
+typedef struct CacheEntryUse {
+    /**Name of the entry's directory*/
+    char name[32];
+    /**When the entry was last stored or restored*/
+    struct timespec used;
+    /**Number of bytes in the entry's files*/
+    off_t size;
+} CacheEntryUse;
+
+/**
+ * @brief Order entries of the build cache from least to most recently used
+ */
+static int compare_entry_uses(const void* a, const void* b)
+{
+    const struct timespec* a_used = &((const CacheEntryUse*)a)->used;
+    const struct timespec* b_used = &((const CacheEntryUse*)b)->used;
+
+    if (a_used->tv_sec != b_used->tv_sec) {
+        return a_used->tv_sec < b_used->tv_sec ? -1 : 1;
+    }
+    return (a_used->tv_nsec > b_used->tv_nsec) - (a_used->tv_nsec < b_used->tv_nsec);
+}
+
+/**
+ * @brief Evict the least recently used entries of the build cache until it holds no more than
+ * D_ARGS->cache_size megabytes
+ */
+static void cache_evict(void)
+{
+    DIR* entries = opendir(D_ARGS->cache_dir);
+    if (entries == NULL) {
+        return;
+    }
+
+    CacheEntryUse* uses = NULL;
+    int num_uses = 0;
+    off_t total_size = 0;
+    struct dirent* entry;
+    char fn[PATH_MAX];
+    while ((entry = readdir(entries)) != NULL) {
+        // Entries being written or evicted are in temporary directories beginning with '.'
+        struct stat file_stat;
+        if (entry->d_name[0] == '.' || strlen(entry->d_name) >= sizeof(uses->name)) {
+            continue;
+        }
+        if (!format_fn(fn, "%s/%s/" PURPLE_CACHE_KEY_FN, D_ARGS->cache_dir, entry->d_name) ||
+            stat(fn, &file_stat) < 0) {
+            continue;
+        }
+
+        CacheEntryUse* grown =
+            (CacheEntryUse*)tracked_realloc(MEMORY_DRIVER, uses,
+                                            sizeof(CacheEntryUse) * (num_uses + 1));
+        if (grown == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for build cache entries");
+        }
+        uses = grown;
+        CacheEntryUse* use = &uses[num_uses++];
+        strcpy(use->name, entry->d_name);
+        use->used = file_stat.st_mtim;
+        use->size = file_stat.st_size;
+
+        const char* output_fns[] = {PURPLE_CACHE_LLVM_FN, PURPLE_CACHE_OUTPUT_FN};
+        for (size_t i = 0; i < sizeof(output_fns) / sizeof(output_fns[0]); i++) {
+            if (format_fn(fn, "%s/%s/%s", D_ARGS->cache_dir, entry->d_name, output_fns[i]) &&
+                stat(fn, &file_stat) == 0) {
+                use->size += file_stat.st_size;
+            }
+        }
+        total_size += use->size;
+    }
+    closedir(entries);
+
+    off_t limit = (off_t)D_ARGS->cache_size << 20;
+    if (total_size > limit) {
+        qsort(uses, num_uses, sizeof(CacheEntryUse), compare_entry_uses);
+    }
+    for (int i = 0; i < num_uses && total_size > limit; i++) {
+        // Renaming first keeps restores from seeing an entry that is half removed
+        char evicted[PATH_MAX];
+        if (format_fn(fn, "%s/%s", D_ARGS->cache_dir, uses[i].name) &&
+            format_fn(evicted, "%s/.evict.%d.%s", D_ARGS->cache_dir, (int)getpid(),
+                      uses[i].name) &&
+            rename(fn, evicted) == 0) {
+            purple_log(LOG_DEBUG, "Evicting build cache entry %s", fn);
+            remove_entry_directory(evicted);
+        }
+        total_size -= uses[i].size;
+    }
+
+    tracked_free(uses);
+}
+
+/**
+ * @brief Store the outputs of a program in its entry of the build cache, then evict entries until
+ * the cache fits in its size
+ *
+ * @param entry     The program's entry
+ * @param llvm_fn   Name of the LLVM file to store
+ * @param output_fn Name of the object file or binary to store
+ */
+void cache_store(CacheEntry* entry, const char* llvm_fn, const char* output_fn)
+{
+    if (mkdir(D_ARGS->cache_dir, 0777) < 0 && errno != EEXIST) {
+        purple_log(LOG_WARNING, "Failed to create build cache %s: %s", D_ARGS->cache_dir,
+                   strerror(errno));
+        return;
+    }
+
+    char temp_directory[PATH_MAX];
+    if (!format_fn(temp_directory, "%s/.store.%d.%s", D_ARGS->cache_dir, (int)getpid(),
+                   strrchr(entry->directory, '/') + 1)) {
+        purple_log(LOG_WARNING, "Build cache %s has too long a path to store entries in",
+                   D_ARGS->cache_dir);
+        return;
+    }
+    if (mkdir(temp_directory, 0777) < 0) {
+        purple_log(LOG_WARNING, "Failed to create build cache entry %s: %s", temp_directory,
+                   strerror(errno));
+        return;
+    }
+
+    char fn[PATH_MAX];
+    FILE* key = format_fn(fn, "%s/" PURPLE_CACHE_KEY_FN, temp_directory) ? fopen(fn, "wb") : NULL;
+    bool stored = key != NULL && fwrite(entry->key, 1, entry->key_length, key) == entry->key_length;
+    if (key != NULL) {
+        stored = fclose(key) == 0 && stored;
+    }
+    stored = stored && format_fn(fn, "%s/" PURPLE_CACHE_LLVM_FN, temp_directory) &&
+             copy_file(llvm_fn, fn);
+    stored = stored && format_fn(fn, "%s/" PURPLE_CACHE_OUTPUT_FN, temp_directory) &&
+             copy_file(output_fn, fn);
+
+    // Another compile of the same program may have stored it first
+    if (!stored || rename(temp_directory, entry->directory) < 0) {
+        if (!stored) {
+            purple_log(LOG_WARNING, "Failed to store %s in build cache", output_fn);
+        }
+        remove_entry_directory(temp_directory);
+        return;
+    }
+    purple_log(LOG_DEBUG, "Stored %s and %s in build cache entry %s", llvm_fn, output_fn,
+               entry->directory);
+
+    cache_evict();
+}
+
+/**
+ * @brief Free a build cache entry
+ *
+ * @param entry Entry to free
+ */
+void free_cache_entry(CacheEntry* entry)
+{
+    if (entry == NULL) {
+        return;
+    }
+
+    tracked_free(entry->key);
+    tracked_free(entry->directory);
+    tracked_free(entry);
+}
@@ -13,6 +13,9 @@
 #include "data.h"
 #include "utils/clang.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/timing.h"
+#include "utils/trace.h"
 
 /**
  * @brief Get the default temporary directory
@@ -33,7 +36,7 @@ const char* get_temp_dir(void)
 
     // Ensure ends with slash
     if (tmpdir && tmpdir[strlen(tmpdir) - 1] != '/') {
-        char* formatted = (char*)malloc(strlen(tmpdir + 2));
+        char* formatted = (char*)tracked_malloc(MEMORY_DRIVER, strlen(tmpdir + 2));
         formatted[0] = '\0';
 
         strcat(formatted, tmpdir);
@@ -84,6 +87,7 @@ void create_tmp_generator_program(void)
 
     // Open the process
     purple_log(LOG_DEBUG, "Running clang with \"%s\"", cmd);
+    trace_begin("clang", "process", cmd);
     FILE* clang_process = popen(cmd, "r");
 
     // Let process run
@@ -95,6 +99,7 @@ void create_tmp_generator_program(void)
 
     // Finish up
     clang_status = pclose(clang_process);
+    trace_end();
     if (clang_status == -1) {
         purple_log(LOG_ERROR, "clang failed with errno %d while compiling generator program",
                    errno);
@@ -107,8 +112,8 @@ void create_tmp_generator_program(void)
 }
 
 /**
- * @brief Link globals.ll to main LLVM file by copying the contents of each LLVM file into a temporary file, then 
- * copying back to the main LLVM file
+ * @brief Link the globals file to main LLVM file by copying the contents of each LLVM file into a temporary file, then 
+ * copying back to the main LLVM file. The globals file is removed once it is linked
  */
 void link_globals(void)
 {
@@ -165,31 +170,28 @@ void link_globals(void)
     // Close LLVM and temp files
     fclose(llvm_file);
     fclose(temp_file);
+
+    remove(D_LLVM_GLOBALS_FN);
+    tracked_free(D_LLVM_GLOBALS_FN);
+    D_LLVM_GLOBALS_FN = NULL;
 }
 
 /**
- * @brief Starts up the clang compiler to compile the generated LLVM-IR into a binary
- * 
- * @param fn Name of file to compile
+ * @brief Run a clang command, printing its output when debugging
+ *
+ * @param cmd   Command to run
+ * @return int  Return code of clang
  */
-void clang_compile_llvm(const char* fn)
+static int run_clang(const char* cmd)
 {
-    purple_log(LOG_DEBUG, "Compiling LLVM with clang");
-
     int clang_status;
-    char* process_out;
+    char* process_out = NULL;
     size_t process_out_buf_len = 256;
-    // Generate the clang command
-    char cmd[sizeof(D_ARGS->clang_executable) + 270] = {0};
-
-    strcat(cmd, D_ARGS->clang_executable);
-    strcat(cmd, " ");
-    strcat(cmd, fn);
-    strcat(cmd, " -o");
-    strcat(cmd, D_ARGS->filenames[2]);
 
     // Open the process
     purple_log(LOG_DEBUG, "Running clang with \"%s\"", cmd);
+    time_phase_begin(TIME_PHASE_CLANG);
+    trace_begin("clang", "process", cmd);
     FILE* clang_process = popen(cmd, "r");
 
     // Let process run
@@ -198,14 +200,149 @@ void clang_compile_llvm(const char* fn)
             printf("%s", process_out);
         }
     }
+    tracked_free(process_out);
 
     // Finish up
     clang_status = pclose(clang_process);
+    trace_end();
+    time_phase_end(TIME_PHASE_CLANG);
     if (clang_status == -1) {
         purple_log(LOG_ERROR, "clang failed with errno %d", errno);
     } else if (clang_status != 0) {
         purple_log(LOG_ERROR, "clang exited with return code %d", clang_status);
     }
+
+    return clang_status;
+}
+
+/**
+ * @brief Get the clang flags that select the kind of link-time optimization to perform
+ *
+ * @return const char* Flags to add to clang commands, beginning with a space if not empty
+ */
+static const char* lto_flags(void)
+{
+    switch (D_ARGS->lto) {
+    case LTO_FULL:
+        return " -flto";
+    case LTO_THIN:
+        return " -flto=thin";
+    default:
+        return "";
+    }
+}
+
+/**
+ * @brief Starts up the clang compiler to compile the generated LLVM-IR into a binary
+ * 
+ * @param fn    Name of file to compile
+ * @return int  Return code of clang
+ */
+int clang_compile_llvm(const char* fn)
+{
+    purple_log(LOG_DEBUG, "Compiling LLVM with clang");
+
+    char* cmd = NULL;
+    size_t cmd_size = 0;
+    FILE* cmd_stream = open_memstream(&cmd, &cmd_size);
+    if (cmd_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for clang command");
+    }
+    // LLVM only acts on the attributes and profile metadata Purple emits when it optimizes
+    fprintf(cmd_stream, "%s -O%d %s -o %s", D_ARGS->clang_executable, D_ARGS->opt_level, fn,
+            D_ARGS->filenames[2]);
+    fclose(cmd_stream);
+
+    int clang_status = run_clang(cmd);
+    tracked_free(cmd);
+    return clang_status;
+}
+
+/**
+ * @brief Compile the LLVM-IR generated for one file of a program into an object file. With
+ * link-time optimization, the object file holds LLVM bitcode
+ *
+ * @param llvm_fn   Name of LLVM file to compile
+ * @param object_fn Name of object file to write
+ * @return int      Return code of clang
+ */
+int clang_compile_object(const char* llvm_fn, const char* object_fn)
+{
+    purple_log(LOG_DEBUG, "Compiling %s to %s with clang", llvm_fn, object_fn);
+
+    char* cmd = NULL;
+    size_t cmd_size = 0;
+    FILE* cmd_stream = open_memstream(&cmd, &cmd_size);
+    if (cmd_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for clang command");
+    }
+    fprintf(cmd_stream, "%s -c -O%d%s %s -o %s", D_ARGS->clang_executable, D_ARGS->opt_level,
+            lto_flags(), llvm_fn, object_fn);
+    fclose(cmd_stream);
+
+    int clang_status = run_clang(cmd);
+    tracked_free(cmd);
+    return clang_status;
+}
+
+/**
+ * @brief Link the files of a program into a binary, optimizing across them if link-time
+ * optimization is enabled
+ *
+ * @param fns       Names of object, bitcode, LLVM-IR and library files to link
+ * @param num_fns   Number of files in fns
+ * @return int      Return code of clang
+ */
+int clang_link(char** fns, int num_fns)
+{
+    purple_log(LOG_DEBUG, "Linking %d files with clang", num_fns);
+
+    char* cmd = NULL;
+    size_t cmd_size = 0;
+    FILE* cmd_stream = open_memstream(&cmd, &cmd_size);
+    if (cmd_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for clang command");
+    }
+    fprintf(cmd_stream, "%s -O%d%s", D_ARGS->clang_executable, D_ARGS->opt_level, lto_flags());
+    for (int i = 0; i < num_fns; i++) {
+        fprintf(cmd_stream, " %s", fns[i]);
+    }
+    fprintf(cmd_stream, " -o %s", D_ARGS->filenames[2]);
+    fclose(cmd_stream);
+
+    int clang_status = run_clang(cmd);
+    tracked_free(cmd);
+    return clang_status;
+}
+
+/**Target datalayout found by clang_cache_target_information*/
+static char* cached_target_datalayout = NULL;
+/**Target triple found by clang_cache_target_information*/
+static char* cached_target_triple = NULL;
+/**clang executable that the cached target information was found with, or NULL if none was found*/
+static char* cached_clang_executable = NULL;
+
+/**
+ * @brief Determine if the target information of the clang executable in use has been cached
+ *
+ * @return bool True if clang doesn't need to be asked about the target
+ */
+static bool target_information_is_cached(void)
+{
+    return cached_clang_executable && !strcmp(cached_clang_executable, D_ARGS->clang_executable);
+}
+
+/**
+ * @brief Ask clang about the target once, so that processes forked from this one don't need to
+ */
+void clang_cache_target_information(void)
+{
+    cached_target_datalayout = get_target_datalayout();
+    cached_target_triple = get_target_triple();
+    cached_clang_executable = tracked_strdup(MEMORY_DRIVER, D_ARGS->clang_executable);
+    if (cached_clang_executable == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for target information");
+    }
 }
 
 /**
@@ -217,6 +354,11 @@ char* get_target_datalayout(void)
 {
     char* out = NULL;
 
+    if (target_information_is_cached()) {
+        return tracked_strdup(MEMORY_DRIVER, cached_target_datalayout);
+    }
+
+    time_phase_begin(TIME_PHASE_TARGET_PROBES);
     if (!generatorProgramWritten) {
         create_tmp_generator_program();
     }
@@ -237,6 +379,7 @@ char* get_target_datalayout(void)
     }
 
     fclose(generatorProgramFilePointer);
+    time_phase_end(TIME_PHASE_TARGET_PROBES);
 
     if (out == NULL) {
         fatal(RC_COMPILER_ERROR, "Failed to determine target datalayout");
@@ -252,14 +395,20 @@ char* get_target_datalayout(void)
  */
 char* get_target_triple(void)
 {
-    char* process_out = (char*)malloc(64);
+    if (target_information_is_cached()) {
+        return tracked_strdup(MEMORY_DRIVER, cached_target_triple);
+    }
+
+    char* process_out = (char*)tracked_malloc(MEMORY_DRIVER, 64);
     int clang_status;
 
     purple_log(LOG_DEBUG, "Retrieving target triple");
 
     // Open the process
+    time_phase_begin(TIME_PHASE_TARGET_PROBES);
     char process_cmd[strlen(D_ARGS->clang_executable) + 22];
     sprintf(process_cmd, "%s %s", D_ARGS->clang_executable, "-print-target-triple");
+    trace_begin("clang", "process", process_cmd);
     FILE* clang_process = popen(process_cmd, "r");
 
     // Let process run
@@ -267,6 +416,8 @@ char* get_target_triple(void)
 
     // Finish up
     clang_status = pclose(clang_process);
+    trace_end();
+    time_phase_end(TIME_PHASE_TARGET_PROBES);
     if (clang_status == -1) {
         fatal(RC_ERROR, "clang failed with errno %d while printing target triple", errno);
     } else if (clang_status != 0) {
@@ -301,7 +452,7 @@ char* regex_match(const char* regex, char* target_str, int len, int group_index)
     }
 
     if (regexec(&re, target_str, 2, rm, 0) == 0) {
-        char* out = (char*)malloc(len + 1);
+        char* out = (char*)tracked_malloc(MEMORY_DRIVER, len + 1);
         sprintf(out, "%.*s", (int)(rm[group_index].rm_eo - rm[group_index].rm_so),
                 target_str + rm[group_index].rm_so);
         return out;
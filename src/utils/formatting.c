@@ -0,0 +1,29 @@
+/**
+ * @file formatting.c
+ * @author Charles Averill
+ * @brief Functions for string formatting
+ * @date 19-Oct-2026
+ */
+
+#include "utils/formatting.h"
+
+/**
+ * @brief Print a string as a JSON string, escaping the characters JSON doesn't allow in one
+ *
+ * @param stream Stream to print to
+ * @param string String to print
+ */
+void fprint_json_string(FILE* stream, const char* string)
+{
+    fputc('"', stream);
+    for (; *string; string++) {
+        if (*string == '"' || *string == '\\') {
+            fprintf(stream, "\\%c", *string);
+        } else if ((unsigned char)*string < 0x20) {
+            fprintf(stream, "\\u%04x", *string);
+        } else {
+            fputc(*string, stream);
+        }
+    }
+    fputc('"', stream);
+}
@@ -25,3 +25,22 @@ unsigned long int FNV_1(char* str)
 
     return hash;
 }
+
+/**
+ * @brief FNV-1 hashing algorithm over a buffer that may hold null bytes
+ * 
+ * @param data Buffer to be hashed
+ * @param length Number of bytes in the buffer
+ * @return unsigned long int Hash value
+ */
+unsigned long int FNV_1_bytes(const char* data, size_t length)
+{
+    unsigned long int hash = FNV_OFFSET_BASIS;
+
+    for (size_t i = 0; i < length; i++) {
+        hash *= FNV_PRIME;
+        hash ^= data[i];
+    }
+
+    return hash;
+}
@@ -9,6 +9,7 @@
 
 #include "utils/llvm_stack_entry.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
 
 /**
  * @brief Initialize a stack entry linked list
@@ -28,7 +29,8 @@ void initialize_stack_entry_linked_list(LLVMStackEntryNode** head)
  */
 void prepend_stack_entry_linked_list(LLVMStackEntryNode** head, type_register register_index)
 {
-    LLVMStackEntryNode* temp = (LLVMStackEntryNode*)malloc(sizeof(LLVMStackEntryNode));
+    LLVMStackEntryNode* temp =
+        (LLVMStackEntryNode*)tracked_malloc(MEMORY_CODEGEN, sizeof(LLVMStackEntryNode));
     temp->reg = register_index;
     temp->next = NULL;
 
@@ -56,7 +58,7 @@ type_register pop_stack_entry_linked_list(LLVMStackEntryNode** head)
 
     type_register out = (*head)->reg;
     temp = (*head)->next;
-    free(*head);
+    tracked_free(*head);
     *head = temp;
 
     return out;
@@ -76,7 +78,7 @@ void free_llvm_stack_entry_node_list(LLVMStackEntryNode* head)
         current = current->next;
         purple_log(LOG_DEBUG, "Freeing LLVMStackEntryNode at %p in free_llvm_stack_entry_node_list",
                    prev);
-        free(prev);
+        tracked_free(prev);
     }
     head = NULL;
 }
@@ -0,0 +1,389 @@
+/**
+ * @file memory.c
+ * @author Charles Averill
+ * @brief Logic for memory accounting. While a report is requested, every tracked allocation is
+ * kept in a table of live allocations, so that freeing it is charged to the subsystem that
+ * allocated it. Memory allocated by the C library, such as getline's buffers, isn't in the table,
+ * and freeing it is ignored
+ * @date 19-Oct-2026
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+
+/**Names of the subsystems in tables*/
+static const char* subsystem_names[NUM_MEMORY_SUBSYSTEMS] = {
+    "Scanner", "Parser and AST", "Symbol tables", "Code generation", "Driver"};
+/**Names of the subsystems in JSON*/
+static const char* subsystem_keys[NUM_MEMORY_SUBSYSTEMS] = {"scanner", "parser", "symbol_tables",
+                                                           "codegen", "driver"};
+
+/**Format the report is printed in, or REPORT_NONE if no report was requested*/
+static ReportFormat report_format = REPORT_NONE;
+/**What the report describes, such as the program being compiled*/
+static const char* report_label = NULL;
+/**Memory allocated by each subsystem*/
+static MemoryUsage usages[NUM_MEMORY_SUBSYSTEMS];
+/**Memory allocated by every subsystem together*/
+static MemoryUsage total_usage;
+/**Table of live allocations, found by the hash of their pointers*/
+static MemoryAllocation* allocations = NULL;
+/**Number of slots in allocations, which is a power of two*/
+static size_t allocations_capacity = 0;
+/**Number of allocations in allocations*/
+static size_t num_allocations = 0;
+/**Lock held while allocating and freeing tracked memory, since functions are translated on several
+ * threads*/
+static pthread_mutex_t allocations_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Find the slot of the table of live allocations that an allocation's search begins at
+ *
+ * @param pointer   Allocated memory
+ * @return size_t   Index of the slot
+ */
+static size_t allocation_slot(void* pointer)
+{
+    // Allocations are aligned, so the low bits of their pointers are mixed into the rest
+    uint64_t hash = (uintptr_t)pointer;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+
+    return hash & (allocations_capacity - 1);
+}
+
+/**
+ * @brief Add an allocation to the table of live allocations, growing it if it is half full
+ *
+ * @param allocation Allocation to add
+ */
+static void insert_allocation(MemoryAllocation allocation)
+{
+    if ((num_allocations + 1) * 2 > allocations_capacity) {
+        MemoryAllocation* old_allocations = allocations;
+        size_t old_capacity = allocations_capacity;
+
+        allocations_capacity = old_capacity ? old_capacity * 2 : PURPLE_MEMORY_INITIAL_CAPACITY;
+        allocations = (MemoryAllocation*)calloc(allocations_capacity, sizeof(MemoryAllocation));
+        if (allocations == NULL) {
+            fatal(RC_MEMORY_ERROR, "Failed to allocate memory for memory accounting");
+        }
+        num_allocations = 0;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_allocations[i].pointer) {
+                insert_allocation(old_allocations[i]);
+            }
+        }
+        free(old_allocations);
+    }
+
+    size_t slot = allocation_slot(allocation.pointer);
+    while (allocations[slot].pointer) {
+        slot = (slot + 1) & (allocations_capacity - 1);
+    }
+    allocations[slot] = allocation;
+    num_allocations++;
+}
+
+/**
+ * @brief Remove an allocation from the table of live allocations, moving back the allocations
+ * after it that would otherwise no longer be found
+ *
+ * @param pointer       Allocated memory
+ * @param allocation    Set to the allocation that was removed
+ * @return bool         True if the allocation was in the table
+ */
+static bool remove_allocation(void* pointer, MemoryAllocation* allocation)
+{
+    if (allocations_capacity == 0) {
+        return false;
+    }
+
+    size_t mask = allocations_capacity - 1;
+    size_t slot = allocation_slot(pointer);
+    while (allocations[slot].pointer != pointer) {
+        if (allocations[slot].pointer == NULL) {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    *allocation = allocations[slot];
+
+    for (size_t next = (slot + 1) & mask; allocations[next].pointer; next = (next + 1) & mask) {
+        // An allocation may fill the hole if its search began at or before the hole
+        size_t home = allocation_slot(allocations[next].pointer);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            allocations[slot] = allocations[next];
+            slot = next;
+        }
+    }
+    allocations[slot].pointer = NULL;
+    num_allocations--;
+
+    return true;
+}
+
+/**
+ * @brief Charge an allocation to its subsystem
+ *
+ * @param allocation Allocation to charge
+ */
+static void charge_allocation(MemoryAllocation allocation)
+{
+    MemoryUsage* charged[] = {&usages[allocation.subsystem], &total_usage};
+
+    for (size_t i = 0; i < sizeof(charged) / sizeof(charged[0]); i++) {
+        charged[i]->live_bytes += allocation.size;
+        charged[i]->allocations++;
+        if (charged[i]->live_bytes > charged[i]->peak_bytes) {
+            charged[i]->peak_bytes = charged[i]->live_bytes;
+        }
+    }
+}
+
+/**
+ * @brief Stop charging a freed allocation to its subsystem
+ *
+ * @param allocation Allocation that was freed
+ */
+static void uncharge_allocation(MemoryAllocation allocation)
+{
+    usages[allocation.subsystem].live_bytes -= allocation.size;
+    total_usage.live_bytes -= allocation.size;
+}
+
+/**
+ * @brief Record memory that was allocated, if a report was requested
+ *
+ * @param subsystem Subsystem to charge the memory to
+ * @param pointer   Allocated memory, or NULL if the allocation failed
+ * @param size      Number of bytes allocated
+ * @return void*    pointer
+ */
+static void* track_allocation(MemorySubsystem subsystem, void* pointer, size_t size)
+{
+    if (report_format == REPORT_NONE || pointer == NULL) {
+        return pointer;
+    }
+
+    MemoryAllocation allocation = {.pointer = pointer, .size = size, .subsystem = subsystem};
+    pthread_mutex_lock(&allocations_lock);
+    insert_allocation(allocation);
+    charge_allocation(allocation);
+    pthread_mutex_unlock(&allocations_lock);
+
+    return pointer;
+}
+
+/**
+ * @brief Allocate memory, charging it to a subsystem
+ *
+ * @param subsystem Subsystem to charge the memory to
+ * @param size      Number of bytes to allocate
+ * @return void*    Allocated memory, or NULL if the allocation failed
+ */
+void* tracked_malloc(MemorySubsystem subsystem, size_t size)
+{
+    return track_allocation(subsystem, malloc(size), size);
+}
+
+/**
+ * @brief Allocate zeroed memory for an array, charging it to a subsystem
+ *
+ * @param subsystem Subsystem to charge the memory to
+ * @param count     Number of elements to allocate
+ * @param size      Number of bytes in each element
+ * @return void*    Allocated memory, or NULL if the allocation failed
+ */
+void* tracked_calloc(MemorySubsystem subsystem, size_t count, size_t size)
+{
+    return track_allocation(subsystem, calloc(count, size), count * size);
+}
+
+/**
+ * @brief Resize memory, charging the resized memory to a subsystem
+ *
+ * @param subsystem Subsystem to charge the resized memory to
+ * @param pointer   Memory to resize, or NULL to allocate new memory
+ * @param size      Number of bytes to resize the memory to
+ * @return void*    Resized memory, or NULL if resizing failed and pointer is still allocated
+ */
+void* tracked_realloc(MemorySubsystem subsystem, void* pointer, size_t size)
+{
+    if (report_format == REPORT_NONE) {
+        return realloc(pointer, size);
+    }
+
+    // The lock is held until the old memory is removed, so no allocation may reuse it before then
+    pthread_mutex_lock(&allocations_lock);
+    MemoryAllocation old_allocation;
+    bool was_tracked = pointer && remove_allocation(pointer, &old_allocation);
+    void* resized = realloc(pointer, size);
+    if (resized == NULL) {
+        if (was_tracked) {
+            insert_allocation(old_allocation);
+        }
+        pthread_mutex_unlock(&allocations_lock);
+        return NULL;
+    }
+
+    if (was_tracked) {
+        uncharge_allocation(old_allocation);
+    }
+    MemoryAllocation allocation = {.pointer = resized, .size = size, .subsystem = subsystem};
+    insert_allocation(allocation);
+    charge_allocation(allocation);
+    pthread_mutex_unlock(&allocations_lock);
+
+    return resized;
+}
+
+/**
+ * @brief Copy a string into memory charged to a subsystem
+ *
+ * @param subsystem Subsystem to charge the copy to
+ * @param string    String to copy
+ * @return char*    Copy of the string, or NULL if the allocation failed
+ */
+char* tracked_strdup(MemorySubsystem subsystem, const char* string)
+{
+    size_t size = strlen(string) + 1;
+    char* copy = (char*)tracked_malloc(subsystem, size);
+    if (copy) {
+        memcpy(copy, string, size);
+    }
+
+    return copy;
+}
+
+/**
+ * @brief Free memory, no longer charging it to the subsystem that allocated it
+ *
+ * @param pointer Memory to free
+ */
+void tracked_free(void* pointer)
+{
+    if (report_format != REPORT_NONE && pointer) {
+        MemoryAllocation allocation;
+        pthread_mutex_lock(&allocations_lock);
+        if (remove_allocation(pointer, &allocation)) {
+            uncharge_allocation(allocation);
+        }
+        pthread_mutex_unlock(&allocations_lock);
+    }
+
+    free(pointer);
+}
+
+/**
+ * @brief Print the report as a table
+ *
+ * @param peak_rss          Peak resident set size of the compiler, in kilobytes
+ * @param clang_peak_rss    Largest peak resident set size of the clang processes, in kilobytes
+ */
+static void print_table(long peak_rss, long clang_peak_rss)
+{
+    fprintf(stderr, "===== Memory report: %s =====\n", report_label);
+    fprintf(stderr, "%-20s %14s %14s %12s\n", "Subsystem", "Live (bytes)", "Peak (bytes)",
+            "Allocations");
+    for (int i = 0; i <= NUM_MEMORY_SUBSYSTEMS; i++) {
+        MemoryUsage* usage = i < NUM_MEMORY_SUBSYSTEMS ? &usages[i] : &total_usage;
+        fprintf(stderr, "%-20s %14zu %14zu %12llu\n",
+                i < NUM_MEMORY_SUBSYSTEMS ? subsystem_names[i] : "Total", usage->live_bytes,
+                usage->peak_bytes, usage->allocations);
+    }
+    fprintf(stderr, "Live bytes were never freed. Peak resident set size: %ld KB, clang: %ld KB\n",
+            peak_rss, clang_peak_rss);
+}
+
+/**
+ * @brief Print a subsystem's memory usage as a JSON object
+ *
+ * @param usage Memory usage to print
+ */
+static void print_json_usage(MemoryUsage* usage)
+{
+    fprintf(stderr, "{\"live_bytes\": %zu, \"peak_bytes\": %zu, \"allocations\": %llu}",
+            usage->live_bytes, usage->peak_bytes, usage->allocations);
+}
+
+/**
+ * @brief Print the report as a JSON object on one line
+ *
+ * @param peak_rss          Peak resident set size of the compiler, in kilobytes
+ * @param clang_peak_rss    Largest peak resident set size of the clang processes, in kilobytes
+ */
+static void print_json(long peak_rss, long clang_peak_rss)
+{
+    fprintf(stderr, "{\"label\": ");
+    fprint_json_string(stderr, report_label);
+    fprintf(stderr, ", \"subsystems\": {");
+    for (int i = 0; i < NUM_MEMORY_SUBSYSTEMS; i++) {
+        fprintf(stderr, "%s\"%s\": ", i ? ", " : "", subsystem_keys[i]);
+        print_json_usage(&usages[i]);
+    }
+    fprintf(stderr, "}, \"total\": ");
+    print_json_usage(&total_usage);
+    fprintf(stderr, ", \"peak_rss_kb\": %ld, \"clang_peak_rss_kb\": %ld}\n", peak_rss,
+            clang_peak_rss);
+}
+
+/**
+ * @brief Print the report to stderr, in the format it was requested in
+ */
+static void memory_report_print(void)
+{
+    if (report_format == REPORT_NONE) {
+        return;
+    }
+
+    struct rusage self_usage;
+    struct rusage children_usage;
+    getrusage(RUSAGE_SELF, &self_usage);
+    getrusage(RUSAGE_CHILDREN, &children_usage);
+
+    pthread_mutex_lock(&allocations_lock);
+    if (report_format == REPORT_JSON) {
+        print_json(self_usage.ru_maxrss, children_usage.ru_maxrss);
+    } else {
+        print_table(self_usage.ru_maxrss, children_usage.ru_maxrss);
+    }
+    pthread_mutex_unlock(&allocations_lock);
+}
+
+/**
+ * @brief Start counting the memory allocated by each subsystem, to be printed when the compiler
+ * exits. Starting again, as a forked process does for the program it compiles, forgets everything
+ * counted before
+ *
+ * @param format    Format to print the report in
+ * @param label     What the report describes, such as the program being compiled
+ */
+void memory_report_start(ReportFormat format, const char* label)
+{
+    if (report_format == REPORT_NONE && format != REPORT_NONE) {
+        atexit(memory_report_print);
+    }
+
+    pthread_mutex_lock(&allocations_lock);
+    memset(usages, 0, sizeof(usages));
+    memset(&total_usage, 0, sizeof(total_usage));
+    free(allocations);
+    allocations = NULL;
+    allocations_capacity = 0;
+    num_allocations = 0;
+
+    report_format = format;
+    report_label = label;
+    pthread_mutex_unlock(&allocations_lock);
+}
@@ -0,0 +1,356 @@
+/**
+ * @file server.c
+ * @author Charles Averill
+ * @brief Logic for the compile server, which compiles programs for clients connected to it over a
+ * Unix domain socket. The server asks clang about the target once, then forks a process for every
+ * request that inherits what it learned, so requests skip the compiler's startup. Clients pass
+ * their standard streams along with their requests, and compiles write to them directly
+ * @date 19-Oct-2026
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// The socket library's shutdown would conflict with the compiler's, and isn't used
+#define shutdown socket_shutdown
+#include <sys/socket.h>
+#undef shutdown
+
+#include "data.h"
+#include "utils/clang.h"
+#include "utils/logging.h"
+#include "utils/memory.h"
+#include "utils/server.h"
+
+/**Path of the socket the server is listening on, which is removed when the server is stopped*/
+static char server_socket_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+
+/**
+ * @brief Build the address of a compile server's socket
+ *
+ * @param socket_fn             Path of the socket
+ * @return struct sockaddr_un   Address of the socket
+ */
+static struct sockaddr_un server_address(const char* socket_fn)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+
+    if (strlen(socket_fn) >= sizeof(address.sun_path)) {
+        fatal(RC_ARG_ERROR, "Socket path \"%s\" is longer than %zu characters", socket_fn,
+              sizeof(address.sun_path) - 1);
+    }
+    strcpy(address.sun_path, socket_fn);
+
+    return address;
+}
+
+/**
+ * @brief Write every byte of a buffer to a file descriptor
+ *
+ * @param fd        File descriptor to write to
+ * @param data      Buffer to write
+ * @param length    Number of bytes to write
+ * @return bool     True if every byte was written
+ */
+static bool write_all(int fd, const void* data, size_t length)
+{
+    const char* bytes = (const char*)data;
+
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read a number of bytes from a file descriptor into a buffer
+ *
+ * @param fd        File descriptor to read from
+ * @param data      Buffer to read into
+ * @param length    Number of bytes to read
+ * @return bool     True if every byte was read before the end of the file
+ */
+static bool read_all(int fd, void* data, size_t length)
+{
+    char* bytes = (char*)data;
+
+    while (length > 0) {
+        ssize_t received = read(fd, bytes, length);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        } else if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        length -= received;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Remove the server's socket and stop the server
+ *
+ * @param signal Signal that stopped the server
+ */
+static void server_stop(int signal)
+{
+    (void)signal;
+
+    unlink(server_socket_path);
+    _exit(RC_OK);
+}
+
+/**
+ * @brief Handle a request from a client, in a process forked for it. The request is compiled in a
+ * process of its own, since the compiler exits when it finds an error, and its return code is
+ * sent back to the client
+ *
+ * @param connection    Connection to the client
+ * @param compile       Function that compiles the request
+ */
+static void server_handle_request(int connection, ServerCompileFunction compile)
+{
+    ServerRequestHeader header;
+    int streams[PURPLE_SERVER_NUM_STREAMS];
+    char control[CMSG_SPACE(sizeof(streams))];
+    struct iovec header_iov = {.iov_base = &header, .iov_len = sizeof(header)};
+    struct msghdr message = {.msg_iov = &header_iov,
+                             .msg_iovlen = 1,
+                             .msg_control = control,
+                             .msg_controllen = sizeof(control)};
+
+    // The client's streams arrive with the first bytes of the header
+    ssize_t received = recvmsg(connection, &message, 0);
+    if (received <= 0 || !read_all(connection, (char*)&header + received,
+                                   sizeof(header) - received)) {
+        fatal(RC_ERROR, "Failed to receive request from client");
+    }
+    struct cmsghdr* streams_message = CMSG_FIRSTHDR(&message);
+    if (streams_message == NULL || streams_message->cmsg_level != SOL_SOCKET ||
+        streams_message->cmsg_type != SCM_RIGHTS ||
+        streams_message->cmsg_len != CMSG_LEN(sizeof(streams))) {
+        fatal(RC_ERROR, "Request from client did not carry its standard streams");
+    }
+    memcpy(streams, CMSG_DATA(streams_message), sizeof(streams));
+
+    if (header.length == 0 || header.length > PURPLE_SERVER_MAX_REQUEST_LENGTH) {
+        fatal(RC_ERROR, "Request from client has %llu bytes, but must have 1 to %d",
+              (unsigned long long int)header.length, PURPLE_SERVER_MAX_REQUEST_LENGTH);
+    }
+    // The working directory and each argument end in a NUL, so arguments are fewer than bytes
+    if (header.num_arguments >= header.length) {
+        fatal(RC_ERROR, "Request from client has %lu arguments in only %llu bytes",
+              (unsigned long int)header.num_arguments, (unsigned long long int)header.length);
+    }
+    char* strings = (char*)tracked_malloc(MEMORY_DRIVER, header.length + 1);
+    char** argv = (char**)tracked_malloc(MEMORY_DRIVER, sizeof(char*) * (header.num_arguments + 1));
+    if (strings == NULL || argv == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for request from client");
+    }
+    if (!read_all(connection, strings, header.length)) {
+        fatal(RC_ERROR, "Failed to receive request from client");
+    }
+    strings[header.length] = '\0';
+
+    // The working directory comes first, followed by the arguments
+    char* cwd = strings;
+    char* next = cwd + strlen(cwd) + 1;
+    for (uint32_t i = 0; i < header.num_arguments; i++) {
+        if (next >= strings + header.length) {
+            fatal(RC_ERROR, "Request from client is missing arguments");
+        }
+        argv[i] = next;
+        next += strlen(next) + 1;
+    }
+    argv[header.num_arguments] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(connection);
+        for (int i = 0; i < PURPLE_SERVER_NUM_STREAMS; i++) {
+            dup2(streams[i], i);
+            close(streams[i]);
+        }
+        if (chdir(cwd) < 0) {
+            fatal(RC_FILE_ERROR, "Failed to enter %s: %s", cwd, strerror(errno));
+        }
+
+        compile(header.num_arguments, argv);
+        exit(RC_OK);
+    }
+
+    for (int i = 0; i < PURPLE_SERVER_NUM_STREAMS; i++) {
+        close(streams[i]);
+    }
+
+    int status;
+    int32_t rc = RC_ERROR;
+    if (pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status)) {
+        rc = WEXITSTATUS(status);
+    }
+    write_all(connection, &rc, sizeof(rc));
+    close(connection);
+
+    tracked_free(argv);
+    tracked_free(strings);
+    exit(RC_OK);
+}
+
+/**
+ * @brief Compile programs for clients connected to a Unix domain socket, until the server is
+ * stopped with SIGINT or SIGTERM
+ *
+ * @param socket_fn Path of the socket to listen on
+ * @param compile   Function that compiles a request, given the client's arguments
+ */
+void server_run(const char* socket_fn, ServerCompileFunction compile)
+{
+    struct sockaddr_un address = server_address(socket_fn);
+
+    // Every request reuses what clang says about the target now
+    clang_cache_target_information();
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fatal(RC_ERROR, "Failed to create socket: %s", strerror(errno));
+    }
+
+    // A socket left behind by a server that was killed is replaced, but a running server's isn't
+    struct stat socket_stat;
+    if (lstat(socket_fn, &socket_stat) == 0 && S_ISSOCK(socket_stat.st_mode)) {
+        if (connect(listener, (struct sockaddr*)&address, sizeof(address)) == 0) {
+            fatal(RC_ERROR, "A compile server is already listening on %s", socket_fn);
+        }
+        unlink(socket_fn);
+    }
+
+    // Requests are compiled as the server's user, in directories the clients choose, so only that
+    // user may connect. The socket is created with mode 0600 rather than changed after binding, so
+    // that no other user can connect in between
+    mode_t previous_umask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    int bind_rc = bind(listener, (struct sockaddr*)&address, sizeof(address));
+    umask(previous_umask);
+    if (bind_rc < 0 || listen(listener, SOMAXCONN) < 0) {
+        fatal(RC_ERROR, "Failed to listen on %s: %s", socket_fn, strerror(errno));
+    }
+    strcpy(server_socket_path, socket_fn);
+    signal(SIGINT, server_stop);
+    signal(SIGTERM, server_stop);
+    // Handlers are reaped as soon as they exit
+    signal(SIGCHLD, SIG_IGN);
+
+    purple_log(LOG_INFO, "Compile server listening on %s", socket_fn);
+
+    while (true) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            fatal(RC_ERROR, "Failed to accept connection on %s: %s", socket_fn, strerror(errno));
+        }
+
+        // Buffered output would otherwise be written again by the handler
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            purple_log(LOG_ERROR, "Failed to start handling request: %s", strerror(errno));
+        } else if (pid == 0) {
+            close(listener);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            signal(SIGCHLD, SIG_DFL);
+            server_handle_request(connection, compile);
+        }
+        close(connection);
+    }
+}
+
+/**
+ * @brief Send the arguments of this invocation to a compile server, which compiles them as if they
+ * had been given to it, writing to this process's standard streams
+ *
+ * @param socket_fn Path of the socket the server is listening on
+ * @param argc      Number of command line arguments
+ * @param argv      Array of command line arguments
+ * @return int      Return code of the compile
+ */
+int server_forward(const char* socket_fn, int argc, char* argv[])
+{
+    struct sockaddr_un address = server_address(socket_fn);
+
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || connect(connection, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        fatal(RC_ERROR, "Failed to connect to compile server on %s: %s", socket_fn,
+              strerror(errno));
+    }
+
+    // Relative paths among the arguments are relative to this process's working directory
+    char* cwd = getcwd(NULL, 0);
+    if (cwd == NULL) {
+        fatal(RC_FILE_ERROR, "Failed to get working directory: %s", strerror(errno));
+    }
+    char* strings = NULL;
+    size_t strings_size = 0;
+    FILE* strings_stream = open_memstream(&strings, &strings_size);
+    if (strings_stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for request to compile server");
+    }
+    fwrite(cwd, strlen(cwd) + 1, 1, strings_stream);
+    for (int i = 0; i < argc; i++) {
+        fwrite(argv[i], strlen(argv[i]) + 1, 1, strings_stream);
+    }
+    fclose(strings_stream);
+    tracked_free(cwd);
+
+    ServerRequestHeader header = {.length = strings_size, .num_arguments = argc};
+    int streams[PURPLE_SERVER_NUM_STREAMS] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    char control[CMSG_SPACE(sizeof(streams))];
+    memset(control, 0, sizeof(control));
+    struct iovec header_iov = {.iov_base = &header, .iov_len = sizeof(header)};
+    struct msghdr message = {.msg_iov = &header_iov,
+                             .msg_iovlen = 1,
+                             .msg_control = control,
+                             .msg_controllen = sizeof(control)};
+    struct cmsghdr* streams_message = CMSG_FIRSTHDR(&message);
+    streams_message->cmsg_level = SOL_SOCKET;
+    streams_message->cmsg_type = SCM_RIGHTS;
+    streams_message->cmsg_len = CMSG_LEN(sizeof(streams));
+    memcpy(CMSG_DATA(streams_message), streams, sizeof(streams));
+
+    // Anything this process has printed comes before what the compile prints
+    fflush(stdout);
+    fflush(stderr);
+
+    if (sendmsg(connection, &message, 0) != sizeof(header) ||
+        !write_all(connection, strings, strings_size)) {
+        fatal(RC_ERROR, "Failed to send request to compile server on %s: %s", socket_fn,
+              strerror(errno));
+    }
+    tracked_free(strings);
+
+    int32_t rc;
+    if (!read_all(connection, &rc, sizeof(rc))) {
+        fatal(RC_ERROR, "Compile server on %s stopped before finishing the request", socket_fn);
+    }
+    close(connection);
+
+    return rc;
+}
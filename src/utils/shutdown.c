@@ -5,10 +5,12 @@
  * @date 13-Sep-2022
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "data.h"
 #include "utils/logging.h"
+#include "utils/memory.h"
 
 /**
  * @brief Close any open input/output files
@@ -40,8 +42,15 @@ void shutdown(void)
 
     close_files();
 
+    // Globals of a program that was not linked are left over
+    if (D_LLVM_GLOBALS_FN) {
+        remove(D_LLVM_GLOBALS_FN);
+        tracked_free(D_LLVM_GLOBALS_FN);
+        D_LLVM_GLOBALS_FN = NULL;
+    }
+
     if (D_ARGS) {
-        free(D_ARGS);
+        tracked_free(D_ARGS);
         D_ARGS = NULL;
     }
 }
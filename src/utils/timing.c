@@ -0,0 +1,362 @@
+/**
+ * @file timing.c
+ * @author Charles Averill
+ * @brief Logic for the time report. Phases are timed on the thread that started the report, with
+ * time charged to the innermost phase running, so that scanning isn't counted again as parsing.
+ * Functions may be timed on any thread, and are charged their thread's CPU time
+ * @date 19-Oct-2026
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/misc.h"
+#include "utils/timing.h"
+#include "utils/trace.h"
+
+/**Names of the phases in tables*/
+static const char* phase_names[NUM_TIME_PHASES] = {
+    "Target probes",   "Scanning",        "Parsing", "Optimization",
+    "Code generation", "Linking globals", "clang",   "Build cache"};
+/**Names of the phases in JSON*/
+static const char* phase_keys[NUM_TIME_PHASES] = {
+    "target_probes", "scanning",     "parsing", "optimization",
+    "codegen",       "link_globals", "clang",   "build_cache"};
+/**Names of the kinds of work done on functions in tables*/
+static const char* function_kind_names[NUM_TIME_FUNCTION_KINDS] = {"parse", "translate"};
+/**Names of the kinds of work done on functions in JSON*/
+static const char* function_kind_keys[NUM_TIME_FUNCTION_KINDS] = {"parse", "codegen"};
+
+/**Format the report is printed in, or REPORT_NONE if no report was requested*/
+static ReportFormat report_format = REPORT_NONE;
+/**What the report describes, such as the program being compiled*/
+static const char* report_label = NULL;
+/**Thread that phases are timed on*/
+static pthread_t report_thread;
+/**Time when the report was started*/
+static TimeSpan report_start;
+/**Time charged to each phase*/
+static TimeSpan phase_times[NUM_TIME_PHASES];
+/**Phases running, innermost last*/
+static TimePhase phase_stack[PURPLE_TIME_REPORT_MAX_DEPTH];
+/**Number of phases running*/
+static int phase_depth = 0;
+/**Time when the innermost phase running was last charged*/
+static TimeSpan last_charge;
+/**Time spent on each function, for each kind of work*/
+static FunctionTime* function_times[NUM_TIME_FUNCTION_KINDS];
+/**Number of functions timed for each kind of work*/
+static int num_function_times[NUM_TIME_FUNCTION_KINDS];
+/**Lock held while adding to function_times*/
+static pthread_mutex_t function_times_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Read a clock in nanoseconds
+ *
+ * @param clock     Clock to read
+ * @return uint64_t Nanoseconds on the clock
+ */
+static uint64_t read_clock(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Get the wall time and the process's CPU time
+ *
+ * @return TimeSpan The time now
+ */
+static TimeSpan process_now(void)
+{
+    return (TimeSpan){.wall = read_clock(CLOCK_MONOTONIC),
+                      .cpu = read_clock(CLOCK_PROCESS_CPUTIME_ID)};
+}
+
+/**
+ * @brief Charge the time since the last charge to the innermost phase running
+ */
+static void charge_phase(void)
+{
+    TimeSpan now = process_now();
+
+    if (phase_depth > 0) {
+        TimeSpan* charged = &phase_times[phase_stack[phase_depth - 1]];
+        charged->wall += now.wall - last_charge.wall;
+        charged->cpu += now.cpu - last_charge.cpu;
+    }
+    last_charge = now;
+}
+
+/**
+ * @brief Check if phases are being timed on the calling thread
+ *
+ * @return bool True if a report was requested and this is the thread that started it
+ */
+static bool is_timing_phases(void)
+{
+    return report_format != REPORT_NONE && pthread_equal(pthread_self(), report_thread);
+}
+
+/**
+ * @brief Begin timing a phase, pausing the phase it is nested in, and begin its span of the trace
+ *
+ * @param phase Phase to begin
+ */
+void time_phase_begin(TimePhase phase)
+{
+    // Tokens are scanned one at a time, too briefly for each to be worth a span of the trace
+    if (phase != TIME_PHASE_SCANNING) {
+        trace_begin(phase_names[phase], "phase", NULL);
+    }
+
+    if (!is_timing_phases()) {
+        return;
+    }
+
+    charge_phase();
+    if (phase_depth < PURPLE_TIME_REPORT_MAX_DEPTH) {
+        phase_stack[phase_depth] = phase;
+    }
+    phase_depth++;
+}
+
+/**
+ * @brief Finish timing a phase, resuming the phase it is nested in, and end its span of the trace
+ *
+ * @param phase Phase to finish
+ */
+void time_phase_end(TimePhase phase)
+{
+    if (phase != TIME_PHASE_SCANNING) {
+        trace_end();
+    }
+
+    if (!is_timing_phases()) {
+        return;
+    }
+
+    if (phase_depth > PURPLE_TIME_REPORT_MAX_DEPTH || phase_depth <= 0 ||
+        phase_stack[phase_depth - 1] != phase) {
+        fatal(RC_COMPILER_ERROR, "Finished timing %s, which is not the innermost phase",
+              phase_names[phase]);
+    }
+    charge_phase();
+    phase_depth--;
+}
+
+/**
+ * @brief Begin timing work on a function, on the calling thread
+ *
+ * @return TimeSpan The wall time and the thread's CPU time now, to pass to time_function_end
+ */
+TimeSpan time_function_begin(void)
+{
+    if (report_format == REPORT_NONE && !is_tracing()) {
+        return (TimeSpan){.wall = 0, .cpu = 0};
+    }
+
+    return (TimeSpan){.wall = read_clock(CLOCK_MONOTONIC),
+                      .cpu = read_clock(CLOCK_THREAD_CPUTIME_ID)};
+}
+
+/**
+ * @brief Finish timing work on a function, and record how long it took in the report and the
+ * trace
+ *
+ * @param kind  Kind of work done
+ * @param name  Name of the function
+ * @param start What time_function_begin returned when the work began
+ */
+void time_function_end(TimeFunctionKind kind, const char* name, TimeSpan start)
+{
+    if (is_tracing()) {
+        char span_name[strlen(function_kind_names[kind]) + strlen(name) + 2];
+        sprintf(span_name, "%s %s", function_kind_names[kind], name);
+        trace_complete(span_name, function_kind_keys[kind], start.wall);
+    }
+
+    if (report_format == REPORT_NONE) {
+        return;
+    }
+
+    TimeSpan time = {.wall = read_clock(CLOCK_MONOTONIC) - start.wall,
+                     .cpu = read_clock(CLOCK_THREAD_CPUTIME_ID) - start.cpu};
+    char* name_copy = strdup(name);
+    if (name_copy == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for function time");
+    }
+
+    pthread_mutex_lock(&function_times_lock);
+    FunctionTime* grown = (FunctionTime*)realloc(
+        function_times[kind], sizeof(FunctionTime) * (num_function_times[kind] + 1));
+    if (grown == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for function time");
+    }
+    function_times[kind] = grown;
+    function_times[kind][num_function_times[kind]++] =
+        (FunctionTime){.name = name_copy, .time = time};
+    pthread_mutex_unlock(&function_times_lock);
+}
+
+/**
+ * @brief Order function times from slowest to fastest
+ */
+static int compare_function_times(const void* a, const void* b)
+{
+    uint64_t a_wall = ((const FunctionTime*)a)->time.wall;
+    uint64_t b_wall = ((const FunctionTime*)b)->time.wall;
+
+    return (a_wall < b_wall) - (a_wall > b_wall);
+}
+
+/**
+ * @brief Print the report as a table
+ *
+ * @param total Time since the report was started
+ * @param other Time not charged to any phase
+ */
+static void print_table(TimeSpan total, TimeSpan other)
+{
+    fprintf(stderr, "===== Time report: %s =====\n", report_label);
+    fprintf(stderr, "%-20s %12s %12s %8s\n", "Phase", "Wall (ms)", "CPU (ms)", "Wall %");
+    for (int i = 0; i <= NUM_TIME_PHASES; i++) {
+        TimeSpan time = i < NUM_TIME_PHASES ? phase_times[i] : other;
+        fprintf(stderr, "%-20s %12.3f %12.3f %7.1f%%\n",
+                i < NUM_TIME_PHASES ? phase_names[i] : "Other", time.wall / 1e6, time.cpu / 1e6,
+                total.wall ? 100.0 * time.wall / total.wall : 0.0);
+    }
+    fprintf(stderr, "%-20s %12.3f %12.3f %7.1f%%\n", "Total", total.wall / 1e6, total.cpu / 1e6,
+            100.0);
+
+    for (int kind = 0; kind < NUM_TIME_FUNCTION_KINDS; kind++) {
+        if (num_function_times[kind] == 0) {
+            continue;
+        }
+        fprintf(stderr, "Slowest functions to %s:\n%12s %12s  %s\n", function_kind_names[kind],
+                "Wall (ms)", "CPU (ms)", "Function");
+        int num_functions = MIN(num_function_times[kind], PURPLE_TIME_REPORT_NUM_FUNCTIONS);
+        for (int i = 0; i < num_functions; i++) {
+            FunctionTime* function = &function_times[kind][i];
+            fprintf(stderr, "%12.3f %12.3f  %s\n", function->time.wall / 1e6,
+                    function->time.cpu / 1e6, function->name);
+        }
+    }
+}
+
+/**
+ * @brief Print the report as a JSON object on one line
+ *
+ * @param total Time since the report was started
+ * @param other Time not charged to any phase
+ */
+static void print_json(TimeSpan total, TimeSpan other)
+{
+    fprintf(stderr, "{\"label\": ");
+    fprint_json_string(stderr, report_label);
+    fprintf(stderr, ", \"total\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}, \"phases\": {",
+            total.wall / 1e6, total.cpu / 1e6);
+    for (int i = 0; i <= NUM_TIME_PHASES; i++) {
+        TimeSpan time = i < NUM_TIME_PHASES ? phase_times[i] : other;
+        fprintf(stderr, "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}", i ? ", " : "",
+                i < NUM_TIME_PHASES ? phase_keys[i] : "other", time.wall / 1e6, time.cpu / 1e6);
+    }
+    fprintf(stderr, "}, \"functions\": {");
+    for (int kind = 0; kind < NUM_TIME_FUNCTION_KINDS; kind++) {
+        fprintf(stderr, "%s\"%s\": [", kind ? ", " : "", function_kind_keys[kind]);
+        int num_functions = MIN(num_function_times[kind], PURPLE_TIME_REPORT_NUM_FUNCTIONS);
+        for (int i = 0; i < num_functions; i++) {
+            FunctionTime* function = &function_times[kind][i];
+            fprintf(stderr, "%s{\"name\": ", i ? ", " : "");
+            fprint_json_string(stderr, function->name);
+            fprintf(stderr, ", \"wall_ms\": %.3f, \"cpu_ms\": %.3f}", function->time.wall / 1e6,
+                    function->time.cpu / 1e6);
+        }
+        fprintf(stderr, "]");
+    }
+    fprintf(stderr, "}}\n");
+}
+
+/**
+ * @brief Forget the time spent on every function
+ */
+static void free_function_times(void)
+{
+    for (int kind = 0; kind < NUM_TIME_FUNCTION_KINDS; kind++) {
+        for (int i = 0; i < num_function_times[kind]; i++) {
+            free(function_times[kind][i].name);
+        }
+        free(function_times[kind]);
+        function_times[kind] = NULL;
+        num_function_times[kind] = 0;
+    }
+}
+
+/**
+ * @brief Print the report to stderr, in the format it was requested in
+ */
+static void time_report_print(void)
+{
+    if (report_format == REPORT_NONE) {
+        return;
+    }
+
+    // Phases left running by an error are charged up to now
+    if (pthread_equal(pthread_self(), report_thread)) {
+        charge_phase();
+    }
+
+    TimeSpan now = process_now();
+    TimeSpan total = {.wall = now.wall - report_start.wall, .cpu = now.cpu - report_start.cpu};
+    TimeSpan other = total;
+    for (int i = 0; i < NUM_TIME_PHASES; i++) {
+        other.wall -= MIN(other.wall, phase_times[i].wall);
+        other.cpu -= MIN(other.cpu, phase_times[i].cpu);
+    }
+
+    for (int kind = 0; kind < NUM_TIME_FUNCTION_KINDS; kind++) {
+        qsort(function_times[kind], num_function_times[kind], sizeof(FunctionTime),
+              compare_function_times);
+    }
+
+    if (report_format == REPORT_JSON) {
+        print_json(total, other);
+    } else {
+        print_table(total, other);
+    }
+
+    free_function_times();
+}
+
+/**
+ * @brief Start timing the compiler's phases on the calling thread, to be printed when the compiler
+ * exits. Starting again, as a forked process does for the program it compiles, forgets everything
+ * timed before
+ *
+ * @param format    Format to print the report in
+ * @param label     What the report describes, such as the program being compiled
+ */
+void time_report_start(ReportFormat format, const char* label)
+{
+    if (report_format == REPORT_NONE && format != REPORT_NONE) {
+        atexit(time_report_print);
+    }
+
+    free_function_times();
+    memset(phase_times, 0, sizeof(phase_times));
+    phase_depth = 0;
+
+    report_format = format;
+    report_label = label;
+    report_thread = pthread_self();
+    report_start = process_now();
+    last_charge = report_start;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file trace.c
+ * @author Charles Averill
+ * @brief Logic for the trace. Events are written as they happen, each in a single write to a file
+ * opened for appending, so that the threads and forked processes of a compile may all write to it
+ * without their events being interleaved
+ * @date 19-Oct-2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils/formatting.h"
+#include "utils/logging.h"
+#include "utils/trace.h"
+
+/**File descriptor of the trace file, or -1 if the compiler isn't tracing*/
+static int trace_fd = -1;
+/**Process that opened the trace file, which finishes it when it exits*/
+static pid_t trace_owner;
+/**True once the first event has been written, so that later events are separated from it*/
+static bool wrote_event = false;
+
+/**
+ * @brief Check if the compiler is tracing
+ *
+ * @return bool True if a trace file was requested and opened
+ */
+bool is_tracing(void)
+{
+    return trace_fd >= 0;
+}
+
+/**
+ * @brief Read the monotonic clock, which is shared by the compiler's processes
+ *
+ * @return uint64_t Nanoseconds on the clock
+ */
+static uint64_t trace_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Write bytes to the trace file. Errors stop the trace instead of the compile
+ *
+ * @param bytes     Bytes to write
+ * @param length    Number of bytes to write
+ */
+static void write_trace(const char* bytes, size_t length)
+{
+    while (length > 0) {
+        ssize_t written = write(trace_fd, bytes, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0) {
+            purple_log(LOG_ERROR, "Failed to write trace: %s", strerror(errno));
+            close(trace_fd);
+            trace_fd = -1;
+            return;
+        }
+        bytes += written;
+        length -= written;
+    }
+}
+
+/**
+ * @brief Begin an event, with the fields every event has
+ *
+ * @param event     Event to begin
+ * @param type      Chrome's type of the event
+ * @param name      Name of the event, or NULL if it ends a span and needs none
+ * @param category  Category of the event, ignored if name is NULL
+ * @param time      Time of the event on the monotonic clock, in nanoseconds
+ */
+static void begin_event(TraceEvent* event, const char* type, const char* name,
+                        const char* category, uint64_t time)
+{
+    event->text = NULL;
+    event->length = 0;
+    event->stream = open_memstream(&event->text, &event->length);
+    if (event->stream == NULL) {
+        fatal(RC_MEMORY_ERROR, "Failed to allocate memory for trace event");
+    }
+
+    fprintf(event->stream, "%s{", wrote_event ? ",\n" : "\n");
+    if (name) {
+        fprintf(event->stream, "\"name\": ");
+        fprint_json_string(event->stream, name);
+        fprintf(event->stream, ", \"cat\": ");
+        fprint_json_string(event->stream, category);
+        fprintf(event->stream, ", ");
+    }
+    fprintf(event->stream, "\"ph\": \"%s\", \"ts\": %.3f, \"pid\": %d, \"tid\": %ld", type,
+            time / 1e3, (int)getpid(), (long)syscall(SYS_gettid));
+}
+
+/**
+ * @brief Finish an event and write it to the trace file
+ *
+ * @param event Event to finish
+ */
+static void end_event(TraceEvent* event)
+{
+    fputc('}', event->stream);
+    fclose(event->stream);
+
+    write_trace(event->text, event->length);
+    free(event->text);
+}
+
+/**
+ * @brief Finish the trace file when the process that opened it exits, so that it holds a complete
+ * JSON array
+ */
+static void trace_finish(void)
+{
+    if (trace_fd < 0) {
+        return;
+    }
+
+    if (getpid() == trace_owner) {
+        write_trace("\n]\n", 3);
+    }
+    if (trace_fd >= 0) {
+        close(trace_fd);
+        trace_fd = -1;
+    }
+}
+
+/**
+ * @brief Start tracing into a file, which is finished when the compiler exits. Starting again, as a
+ * forked process does for the program it compiles, names the process in the same trace
+ *
+ * @param trace_fn  Name of the file to write the trace to
+ * @param label     What the process does, such as the program it compiles
+ */
+void trace_start(const char* trace_fn, const char* label)
+{
+    if (trace_fd < 0) {
+        trace_fd = open(trace_fn, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (trace_fd < 0) {
+            fatal(RC_FILE_ERROR, "Failed to open trace file %s: %s", trace_fn, strerror(errno));
+        }
+        trace_owner = getpid();
+        atexit(trace_finish);
+
+        write_trace("[", 1);
+    }
+
+    TraceEvent event;
+    begin_event(&event, "M", "process_name", "__metadata", trace_now());
+    fprintf(event.stream, ", \"args\": {\"name\": ");
+    fprint_json_string(event.stream, label);
+    fprintf(event.stream, "}");
+    end_event(&event);
+    // Threads and forked processes only write events after the first
+    wrote_event = true;
+}
+
+/**
+ * @brief Begin a span on the calling thread, which lasts until the next trace_end on it that isn't
+ * ending a span nested in it
+ *
+ * @param name      Name of the span
+ * @param category  Category of the span
+ * @param command   Command line of the process the span runs, or NULL if it doesn't run one
+ */
+void trace_begin(const char* name, const char* category, const char* command)
+{
+    if (!is_tracing()) {
+        return;
+    }
+
+    TraceEvent event;
+    begin_event(&event, "B", name, category, trace_now());
+    if (command) {
+        fprintf(event.stream, ", \"args\": {\"command\": ");
+        fprint_json_string(event.stream, command);
+        fprintf(event.stream, "}");
+    }
+    end_event(&event);
+}
+
+/**
+ * @brief End the innermost span begun on the calling thread
+ */
+void trace_end(void)
+{
+    if (!is_tracing()) {
+        return;
+    }
+
+    TraceEvent event;
+    begin_event(&event, "E", NULL, NULL, trace_now());
+    end_event(&event);
+}
+
+/**
+ * @brief Record a span on the calling thread that has just ended
+ *
+ * @param name      Name of the span
+ * @param category  Category of the span
+ * @param start     Time the span began on the monotonic clock, in nanoseconds
+ */
+void trace_complete(const char* name, const char* category, uint64_t start)
+{
+    if (!is_tracing()) {
+        return;
+    }
+
+    uint64_t now = trace_now();
+    TraceEvent event;
+    begin_event(&event, "X", name, category, start);
+    fprintf(event.stream, ", \"dur\": %.3f", (now - start) / 1e3);
+    end_event(&event);
+}
+
+/**
+ * @brief Record the new value of a counter, which trace viewers plot over time
+ *
+ * @param name      Name of the counter
+ * @param series    Name of the value counted
+ * @param value     New value of the counter
+ */
+void trace_counter(const char* name, const char* series, unsigned long int value)
+{
+    if (!is_tracing()) {
+        return;
+    }
+
+    TraceEvent event;
+    begin_event(&event, "C", name, "counter", trace_now());
+    fprintf(event.stream, ", \"args\": {");
+    fprint_json_string(event.stream, series);
+    fprintf(event.stream, ": %lu}", value);
+    end_event(&event);
+}
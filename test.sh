@@ -57,6 +57,233 @@ function run_test() {
     echo ""
 }
 
+function run_pgo_test() {
+    printf "%-25s" "[$1]"
+    for OPTLEVEL in 0 1
+    do
+        # Build with counters, run to write the profile, then rebuild using it
+        [ -f a.out ] && rm a.out
+        [ -f "$4" ] && rm "$4"
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --fprofile-generate=$4" "$OPTLEVEL")
+        if [ $? -ne 0 ] || [ ! -f "$4" ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        fi
+
+        rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --fprofile-use=$4" "$OPTLEVEL")
+        TEST_RC=$?
+        rm "$4"
+        if [ $TEST_RC -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+    echo ""
+}
+
+function run_codegen_threads_test() {
+    printf "%-25s" "[$1]"
+    for OPTLEVEL in 0 1
+    do
+        # Functions translated on several threads must give the same module as on one thread
+        [ -f a.out ] && rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --codegen-threads=1" "$OPTLEVEL")
+        if [ $? -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        fi
+
+        mv a.ll serial.ll
+        rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --codegen-threads=$4" "$OPTLEVEL")
+        TEST_RC=$?
+        cmp -s serial.ll a.ll
+        CMP_RC=$?
+        rm serial.ll
+        if [ $TEST_RC -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        elif [ $CMP_RC -ne 0 ] ; then
+            printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET} (LLVM differs from one thread's)\n"
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+    echo ""
+}
+
+function run_server_test() {
+    printf "%-25s" "[$1]"
+    # Programs compiled by a compile server must behave as if they were compiled directly
+    [ -S purple.sock ] && rm purple.sock
+    bin/purple --server=purple.sock > /dev/null &
+    SERVER_PID=$!
+    for i in $(seq 50)
+    do
+        [ -S purple.sock ] && break
+        sleep 0.1
+    done
+
+    for OPTLEVEL in 0 1
+    do
+        [ -f a.out ] && rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --connect=purple.sock" "$OPTLEVEL")
+        if [ $? -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            kill $SERVER_PID
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+
+    kill $SERVER_PID
+    wait $SERVER_PID 2> /dev/null
+    echo ""
+}
+
+function run_failure_test() {
+    printf "%-25s" "[$1]"
+    # Programs clang fails to build must fail to compile, whether directly or by a compile server
+    [ -S purple.sock ] && rm purple.sock
+    bin/purple --server=purple.sock > /dev/null &
+    SERVER_PID=$!
+    for i in $(seq 50)
+    do
+        [ -S purple.sock ] && break
+        sleep 0.1
+    done
+
+    for OPTLEVEL in 0 1
+    do
+        for FLAGS in "$2" "$2 --connect=purple.sock" "$3"
+        do
+            bin/purple $FLAGS -O$OPTLEVEL -o missing_directory/a.out > /dev/null 2>&1
+            if [ $? -eq 0 ] ; then
+                printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET}\n"
+                kill $SERVER_PID
+                exit 1
+            fi
+        done
+        printf "${ANSI_GREEN}${ANSI_BOLD}OK${ANSI_RESET} "
+    done
+
+    kill $SERVER_PID
+    wait $SERVER_PID 2> /dev/null
+    echo ""
+}
+
+function run_batch_test() {
+    printf "%-25s" "[$1]"
+    for OPTLEVEL in 0 1
+    do
+        # Each program compiled in a batch must behave as if it was compiled on its own
+        bin/purple -j 2 "$3" "$5" -O$OPTLEVEL --fprint-func-annotations > /dev/null
+        first_output=$(./$(basename "$3" .prp))
+        second_output=$(./$(basename "$5" .prp))
+        rm -f $(basename "$3" .prp) $(basename "$3" .prp).ll $(basename "$5" .prp) \
+            $(basename "$5" .prp).ll
+        if [ "$2" != "$first_output" ] || [ "$4" != "$second_output" ] ; then
+            printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET}\n"
+            exit 1
+        else
+            printf "${ANSI_GREEN}${ANSI_BOLD}OK${ANSI_RESET} "
+        fi
+    done
+    echo ""
+}
+
+function run_cache_test() {
+    printf "%-25s" "[$1]"
+    # A program restored from the build cache must be the program compiled the first time
+    rm -rf purple_cache
+    for OPTLEVEL in 0 1
+    do
+        [ -f a.out ] && rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --cache-dir=purple_cache" "$OPTLEVEL")
+        if [ $? -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            rm -rf purple_cache
+            exit 1
+        fi
+
+        mv a.ll compiled.ll
+        rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --cache-dir=purple_cache" "$OPTLEVEL")
+        TEST_RC=$?
+        cmp -s compiled.ll a.ll
+        CMP_RC=$?
+        rm compiled.ll
+        if [ $TEST_RC -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            rm -rf purple_cache
+            exit 1
+        elif [ $CMP_RC -ne 0 ] || [ $(ls purple_cache | wc -l) -ne $((OPTLEVEL + 1)) ] ; then
+            printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET} (not restored from the cache)\n"
+            rm -rf purple_cache
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+    rm -rf purple_cache
+    echo ""
+}
+
+function run_report_test() {
+    printf "%-25s" "[$1]"
+    for OPTLEVEL in 0 1
+    do
+        # The report is written to stderr, and must not change the program
+        [ -f a.out ] && rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 $4" "$OPTLEVEL" 2> report.json)
+        TEST_RC=$?
+        grep -q "$5" report.json
+        GREP_RC=$?
+        rm report.json
+        if [ $TEST_RC -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        elif [ $GREP_RC -ne 0 ] ; then
+            printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET} (no report)\n"
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+    echo ""
+}
+
+function run_trace_test() {
+    printf "%-25s" "[$1]"
+    for OPTLEVEL in 0 1
+    do
+        # The trace must be a finished JSON array, with spans for functions and clang processes
+        [ -f a.out ] && rm a.out
+        TEST_OUTPUT=$(strings_are_okay "$2" "$3 --ftrace=trace.json --codegen-threads=4" \
+            "$OPTLEVEL")
+        TEST_RC=$?
+        [ "$(tail -n 1 trace.json)" == "]" ] && grep -q '"name": "translate main"' trace.json \
+            && grep -q '"cat": "process", "ph": "B"' trace.json
+        TRACE_RC=$?
+        rm trace.json
+        if [ $TEST_RC -ne 0 ] ; then
+            printf "%s " "$TEST_OUTPUT"
+            exit 1
+        elif [ $TRACE_RC -ne 0 ] ; then
+            printf "${ANSI_RED}${ANSI_BOLD}NOT OK${ANSI_RESET} (no trace)\n"
+            exit 1
+        else
+            printf "%s " "$TEST_OUTPUT"
+        fi
+    done
+    echo ""
+}
+
 condition_test_output="true
 true
 true
@@ -131,8 +358,11 @@ function_test_output="89
 33
 42
 10
-6
-120"
+720
+120
+10
+3
+5"
 
 comparison_test_output="1
 true
@@ -153,7 +383,149 @@ pointer2_test_output="3
 3
 3
 5
-50"
+50
+2000000"
+
+constant_test_output="40
+-301
+1
+8
+2
+10
+4
+0
+-128
+-56
+64
+200"
+
+dead_code_test_output="3
+4
+12
+-1
+1
+0"
+
+inline_test_output="140
+12
+42
+20
+103
+1
+-294967296
+-294967296
+4000000000"
+
+tail_call_test_output="50005000
+35
+1024
+3
+2
+1
+42"
+
+exponent_test_output="1594323
+-128
+1
+343
+1048576
+0
+512
+0
+4611686018427387904"
+
+attribute_test_output="54
+10
+42
+2
+1
+0
+610
+4
+64"
+
+range_test_output="354
+73
+1027
+31"
+
+overflow_test_output="false
+-2147483646
+44
+3003
+-1291967296
+41
+-3
+-2"
+
+loop_hint_test_output="5050
+0
+8
+-1
+285
+3
+5"
+
+branch_hint_test_output="42
+-7
+7
+15
+45"
+
+pgo_test_output="26623
+178"
+
+module_test_output="21
+574056
+1
+2
+100
+true
+true
+false"
+
+debug_info_test_output="12
+42
+2870
+true"
+
+buffered_print_test_output="$(seq -10000 10000)
+-9223372036854775808
+9223372036854775807
+-128
+true
+false"
+
+multi_print_test_output="1 2 3
+true -5 false
+7 9223372036854775807 -128 true
+3
+4
+9 16
+10
+20 30
+0
+10
+20 30
+1
+10
+20 30
+2
+1
+2
+4
+3 4
+5"
+
+argument_test_output="-8
+-6
+-8
+16
+44"
+
+division_test_output="2147483646
+858993457
+14"
 
 run_test    "Variable"      "$variable_test_output"     "examples/variable_test.prp"
 run_test    "Condition"     "$condition_test_output"    "examples/condition_test.prp"
@@ -165,6 +537,39 @@ run_test    "Comparison"    "$comparison_test_output"   "examples/comparison_tes
 run_test    "Empty Program" ""                          "examples/empty_prog.prp"
 run_test    "Pointer"       "$pointer_test_output"      "examples/pointer_test.prp"
 run_test    "Pointer 2"     "$pointer2_test_output"     "examples/pointer_test_2.prp"
+run_test    "Constant"      "$constant_test_output"     "examples/constant_test.prp"
+run_test    "Dead Code"     "$dead_code_test_output"    "examples/dead_code_test.prp"
+run_test    "Inline"        "$inline_test_output"       "examples/inline_test.prp"
+run_test    "Tail Call"     "$tail_call_test_output"    "examples/tail_call_test.prp"
+run_test    "Exponent"      "$exponent_test_output"     "examples/exponent_test.prp"
+run_test    "Argument"      "$argument_test_output"     "examples/argument_test.prp"
+run_test    "Division"      "$division_test_output"     "examples/division_test.prp"
+run_test    "Attribute"     "$attribute_test_output"    "examples/attribute_test.prp"
+run_test    "Range"         "$range_test_output"        "examples/range_test.prp"
+run_test    "Overflow"      "$overflow_test_output"     "examples/overflow_test.prp"
+run_test    "Loop Hint"     "$loop_hint_test_output"    "examples/loop_hint_test.prp"
+run_test    "Branch Hint"   "$branch_hint_test_output"  "examples/branch_hint_test.prp"
+run_pgo_test "PGO"          "$pgo_test_output"          "examples/pgo_test.prp" "pgo_test.purpleprof"
+run_test    "Module"        "$module_test_output"       "examples/module_test.prp examples/module_test_lib.prp"
+rm -f module_test.ll module_test.o module_test_lib.ll module_test_lib.o
+run_test    "Debug Info"    "$debug_info_test_output"   "examples/debug_info_test.prp --debug-info"
+run_test    "Line Tables"   "$debug_info_test_output"   "examples/debug_info_test.prp --debug-line-tables-only"
+run_codegen_threads_test "Codegen Threads" "$debug_info_test_output" "examples/debug_info_test.prp --debug-info" 4
+run_test    "Buffered Print" "$buffered_print_test_output" "examples/buffered_print_test.prp"
+run_test    "Line Buffered" "$buffered_print_test_output" "examples/buffered_print_test.prp --line-buffered-output"
+run_test    "Multi Print"   "$multi_print_test_output"  "examples/multi_print_test.prp"
+run_server_test "Server"    "$multi_print_test_output"  "examples/multi_print_test.prp"
+run_failure_test "Failed Build" "examples/multi_print_test.prp" \
+    "examples/module_test.prp examples/module_test_lib.prp"
+rm -f module_test.ll module_test.o module_test_lib.ll module_test_lib.o
+run_batch_test "Batch"      "$loop_test_output" "examples/loop_test.prp" \
+    "$multi_print_test_output" "examples/multi_print_test.prp"
+run_cache_test "Build Cache" "$multi_print_test_output"  "examples/multi_print_test.prp"
+run_report_test "Time Report" "$function_test_output" "examples/function_test.prp" \
+    "--ftime-report=json --codegen-threads=4" '"phases": {"target_probes"'
+run_report_test "Memory Report" "$function_test_output" "examples/function_test.prp" \
+    "--fmem-report=json --codegen-threads=4" '"subsystems": {"scanner"'
+run_trace_test "Trace" "$function_test_output" "examples/function_test.prp"
 
 rm a.ll
 rm a.out